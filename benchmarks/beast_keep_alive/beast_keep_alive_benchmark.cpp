@@ -0,0 +1,174 @@
+#include "../../webpp/beast/beast.hpp"
+#include "../../webpp/http/http.hpp"
+#include "../benchmark.hpp"
+
+#include <boost/asio/connect.hpp>
+#include <boost/asio/ip/tcp.hpp>
+#include <boost/beast/core.hpp>
+#include <boost/beast/http.hpp>
+#include <chrono>
+#include <thread>
+
+// NOLINTBEGIN(*-magic-numbers)
+
+namespace bhttp = boost::beast::http;
+using tcp       = boost::asio::ip::tcp;
+
+namespace {
+
+    constexpr std::uint16_t bench_port = 18'081;
+
+    // a large html payload; the response body is written to the socket without being copied
+    std::string const& large_body() {
+        static std::string const body(256UL * 1024UL, 'x');
+        return body;
+    }
+
+    struct hello_app {
+        webpp::http::HTTPResponse auto operator()(webpp::http::HTTPRequest auto&& req) {
+            using response_type = webpp::http::simple_response<webpp::default_traits>;
+            if (req.uri() == "/large") {
+                return response_type::with_body(req, large_body());
+            }
+            return response_type::with_body(req, "Hello World");
+        }
+    };
+
+    using server_type = webpp::beast<hello_app>;
+
+    // The server runs in the background for the whole duration of the benchmarks
+    struct server_runner {
+        server_type server;
+        std::thread thread;
+
+        server_runner() {
+            server.address("127.0.0.1").port(bench_port).max_requests_per_connection(0);
+            thread = std::thread{[this] {
+                [[maybe_unused]] auto const res = server();
+            }};
+            std::this_thread::sleep_for(std::chrono::milliseconds(200));
+        }
+
+        server_runner(server_runner const&)            = delete;
+        server_runner(server_runner&&)                 = delete;
+        server_runner& operator=(server_runner const&) = delete;
+        server_runner& operator=(server_runner&&)      = delete;
+
+        ~server_runner() {
+            server.stop();
+            thread.join();
+        }
+    };
+
+    server_runner& runner() {
+        static server_runner srv;
+        return srv;
+    }
+
+    struct client {
+        boost::asio::io_context    io;
+        boost::beast::tcp_stream   stream{io};
+        boost::beast::flat_buffer  buf;
+        tcp::endpoint const        endpoint{boost::asio::ip::make_address("127.0.0.1"), bench_port};
+
+        void connect() {
+            buf.clear();
+            stream.connect(endpoint);
+        }
+
+        void close() {
+            boost::beast::error_code err;
+            stream.socket().shutdown(tcp::socket::shutdown_both, err);
+            stream.close();
+        }
+
+        void write(bool const keep_alive, char const* target = "/") {
+            bhttp::request<bhttp::empty_body> req{bhttp::verb::get, target, 11};
+            req.set(bhttp::field::host, "localhost");
+            req.keep_alive(keep_alive);
+            bhttp::write(stream, req);
+        }
+
+        // returns true if the connection is still usable
+        bool read() {
+            bhttp::response<bhttp::string_body> res;
+            bhttp::read(stream, buf, res);
+            benchmark::DoNotOptimize(res.body().data());
+            return res.keep_alive();
+        }
+    };
+
+} // namespace
+
+static void BeastConnectionPerRequest(benchmark::State& state) {
+    runner();
+    client cli;
+    for (auto _ : state) {
+        cli.connect();
+        cli.write(false);
+        cli.read();
+        cli.close();
+    }
+    state.SetItemsProcessed(static_cast<std::int64_t>(state.iterations()));
+}
+
+BENCHMARK(BeastConnectionPerRequest);
+
+static void BeastKeepAlive(benchmark::State& state) {
+    runner();
+    client cli;
+    cli.connect();
+    for (auto _ : state) {
+        cli.write(true);
+        if (!cli.read()) {
+            cli.close();
+            cli.connect();
+        }
+    }
+    cli.close();
+    state.SetItemsProcessed(static_cast<std::int64_t>(state.iterations()));
+}
+
+BENCHMARK(BeastKeepAlive);
+
+static void BeastPipelined(benchmark::State& state) {
+    runner();
+    auto const depth = static_cast<std::size_t>(state.range(0));
+    client     cli;
+    cli.connect();
+    for (auto _ : state) {
+        for (std::size_t i = 0; i != depth; ++i) {
+            cli.write(true);
+        }
+        for (std::size_t i = 0; i != depth; ++i) {
+            if (!cli.read()) {
+                cli.close();
+                cli.connect();
+                break;
+            }
+        }
+    }
+    cli.close();
+    state.SetItemsProcessed(static_cast<std::int64_t>(state.iterations() * depth));
+}
+
+BENCHMARK(BeastPipelined)->Arg(4)->Arg(16);
+
+static void BeastLargeBody(benchmark::State& state) {
+    runner();
+    client cli;
+    cli.connect();
+    for (auto _ : state) {
+        cli.write(true, "/large");
+        if (!cli.read()) {
+            cli.close();
+            cli.connect();
+        }
+    }
+    cli.close();
+    state.SetBytesProcessed(static_cast<std::int64_t>(state.iterations() * large_body().size()));
+}
+
+BENCHMARK(BeastLargeBody);
+
+// NOLINTEND(*-magic-numbers)
@@ -0,0 +1,151 @@
+#include "../../webpp/beast/beast.hpp"
+#include "../../webpp/http/http.hpp"
+#include "../benchmark.hpp"
+
+#include <boost/asio/ip/tcp.hpp>
+#include <boost/beast/core.hpp>
+#include <boost/beast/http.hpp>
+#include <chrono>
+#include <thread>
+
+// NOLINTBEGIN(*-magic-numbers)
+
+namespace bhttp = boost::beast::http;
+using tcp       = boost::asio::ip::tcp;
+
+namespace {
+
+    constexpr std::uint16_t shared_port     = 18'082;
+    constexpr std::uint16_t reuse_port_port = 18'083;
+
+    struct hello_app {
+        webpp::http::HTTPResponse auto operator()(webpp::http::HTTPRequest auto&& req) {
+            using namespace webpp::http;
+            static static_router router{[] {
+                return "Hello World";
+            }};
+            return router(req);
+        }
+    };
+
+    using server_type = webpp::beast<hello_app>;
+
+    // The server runs in the background for the whole duration of the benchmarks
+    struct server_runner {
+        server_type server;
+        std::thread thread;
+
+        explicit server_runner(std::uint16_t const port, bool const reuse_port) {
+            server.address("127.0.0.1").port(port).max_requests_per_connection(0);
+            if (reuse_port) {
+                server.enable_reuse_port().enable_thread_pinning();
+            }
+            thread = std::thread{[this] {
+                [[maybe_unused]] auto const res = server();
+            }};
+            std::this_thread::sleep_for(std::chrono::milliseconds(200));
+        }
+
+        server_runner(server_runner const&)            = delete;
+        server_runner(server_runner&&)                 = delete;
+        server_runner& operator=(server_runner const&) = delete;
+        server_runner& operator=(server_runner&&)      = delete;
+
+        ~server_runner() {
+            server.stop();
+            thread.join();
+        }
+    };
+
+    void start_servers() {
+        static server_runner shared_srv{shared_port, false};
+        static server_runner reuse_port_srv{reuse_port_port, true};
+    }
+
+    struct client {
+        boost::asio::io_context   io;
+        boost::beast::tcp_stream  stream{io};
+        boost::beast::flat_buffer buf;
+        tcp::endpoint             endpoint;
+
+        explicit client(std::uint16_t const port) : endpoint{boost::asio::ip::make_address("127.0.0.1"), port} {}
+
+        void connect() {
+            buf.clear();
+            stream.connect(endpoint);
+        }
+
+        void close() {
+            boost::beast::error_code err;
+            stream.socket().shutdown(tcp::socket::shutdown_both, err);
+            stream.close();
+        }
+
+        // send a request and read the response; returns true if the connection is still usable
+        bool request(bool const keep_alive) {
+            bhttp::request<bhttp::empty_body> req{bhttp::verb::get, "/", 11};
+            req.set(bhttp::field::host, "localhost");
+            req.keep_alive(keep_alive);
+            bhttp::write(stream, req);
+
+            bhttp::response<bhttp::string_body> res;
+            bhttp::read(stream, buf, res);
+            benchmark::DoNotOptimize(res.body().data());
+            return res.keep_alive();
+        }
+    };
+
+    // every benchmark thread acts as one wrk connection
+    void run_keep_alive(benchmark::State& state, std::uint16_t const port) {
+        client cli{port};
+        cli.connect();
+        for (auto _ : state) {
+            if (!cli.request(true)) {
+                cli.close();
+                cli.connect();
+            }
+        }
+        cli.close();
+        state.SetItemsProcessed(static_cast<std::int64_t>(state.iterations()));
+    }
+
+    void run_connection_per_request(benchmark::State& state, std::uint16_t const port) {
+        client cli{port};
+        for (auto _ : state) {
+            cli.connect();
+            cli.request(false);
+            cli.close();
+        }
+        state.SetItemsProcessed(static_cast<std::int64_t>(state.iterations()));
+    }
+
+} // namespace
+
+static void BeastSharedKeepAlive(benchmark::State& state) {
+    run_keep_alive(state, shared_port);
+}
+
+static void BeastReusePortKeepAlive(benchmark::State& state) {
+    run_keep_alive(state, reuse_port_port);
+}
+
+static void BeastSharedConnectionPerRequest(benchmark::State& state) {
+    run_connection_per_request(state, shared_port);
+}
+
+static void BeastReusePortConnectionPerRequest(benchmark::State& state) {
+    run_connection_per_request(state, reuse_port_port);
+}
+
+// the servers have to be up before any of the benchmark threads start
+static int const init_servers = [] {
+    start_servers();
+    return 0;
+}();
+
+BENCHMARK(BeastSharedKeepAlive)->ThreadRange(1, 64)->UseRealTime();
+BENCHMARK(BeastReusePortKeepAlive)->ThreadRange(1, 64)->UseRealTime();
+BENCHMARK(BeastSharedConnectionPerRequest)->ThreadRange(1, 64)->UseRealTime();
+BENCHMARK(BeastReusePortConnectionPerRequest)->ThreadRange(1, 64)->UseRealTime();
+
+// NOLINTEND(*-magic-numbers)
@@ -0,0 +1,101 @@
+#include "../../webpp/http/bodies/string.hpp"
+#include "../../webpp/http/routes/context.hpp"
+#include "../../webpp/http/routes/dynamic_router.hpp"
+#include "../../webpp/http/routes/methods.hpp"
+#include "../../webpp/http/routes/path.hpp"
+#include "../benchmark.hpp"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+using namespace webpp;
+using namespace webpp::http;
+
+// NOLINTBEGIN(*-magic-numbers)
+
+namespace {
+
+    /**
+     * The way the dynamic router used to dispatch the requests: run every route, in order, until one of
+     * them fills the response.
+     */
+    struct linear_router {
+        using route_type = dynamic_route<default_dynamic_traits>;
+
+        std::vector<std::unique_ptr<route_type>> routes;
+
+        template <typename C>
+        void add(C&& callable) {
+            routes.push_back(std::make_unique<dynamic_route<default_dynamic_traits, std::remove_cvref_t<C>>>(
+              std::forward<C>(callable)));
+        }
+
+        response operator()(request& req) {
+            context ctx{req};
+            for (auto& route : routes) {
+                ctx.current_route(*route);
+                (*route)(ctx);
+                if (!ctx.response.empty()) {
+                    return ctx.response;
+                }
+            }
+            ctx.response = status_code::not_found;
+            return ctx.response;
+        }
+    };
+
+    // "/api/res{index}/list" and "/api/res{index}/item", the last one is requested
+    template <typename Router>
+    void add_routes(Router& router, std::size_t count) {
+        for (std::size_t index = 0; index != count; ++index) {
+            std::string const name = "res" + std::to_string(index);
+            auto              list = get / "api" / name % "list" >> [] {
+                return "list";
+            };
+            auto item = get / "api" / name % "item" >> [] {
+                return "item";
+            };
+            if constexpr (requires { router.add(list); }) {
+                router.add(std::move(list));
+                router.add(std::move(item));
+            } else {
+                router += std::move(list);
+                router += std::move(item);
+            }
+        }
+    }
+
+    void run(benchmark::State& state, auto& router) {
+        enable_owner_traits<default_dynamic_traits> et;
+
+        request req{et};
+        req.method("GET");
+        req.uri("/api/res" + std::to_string(state.range(0) - 1) + "/item");
+        for (auto _ : state) {
+            auto res = router(req);
+            benchmark::DoNotOptimize(res);
+        }
+        state.SetItemsProcessed(static_cast<std::int64_t>(state.iterations()));
+    }
+
+} // namespace
+
+static void DRouter_Linear(benchmark::State& state) {
+    linear_router router;
+    add_routes(router, static_cast<std::size_t>(state.range(0)));
+    run(state, router);
+}
+
+BENCHMARK(DRouter_Linear)->Arg(10)->Arg(100)->Arg(1000);
+
+static void DRouter_Indexed(benchmark::State& state) {
+    enable_owner_traits<default_dynamic_traits> et;
+    dynamic_router                              router{et};
+    add_routes(router, static_cast<std::size_t>(state.range(0)));
+    run(state, router);
+}
+
+BENCHMARK(DRouter_Indexed)->Arg(10)->Arg(100)->Arg(1000);
+
+// NOLINTEND(*-magic-numbers)
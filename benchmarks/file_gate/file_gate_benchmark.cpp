@@ -0,0 +1,92 @@
+#include "../../webpp/storage/directory_gate.hpp"
+#include "../../webpp/storage/file_gate.hpp"
+#include "../benchmark.hpp"
+
+#include <filesystem>
+#include <random>
+#include <string>
+
+using namespace webpp;
+
+// NOLINTBEGIN(*-magic-numbers)
+
+namespace {
+
+    constexpr int key_count = 1000;
+
+    std::string value_of(int const key) {
+        return std::string(200, static_cast<char>('a' + (key % 26)));
+    }
+
+    // get random keys out of a gate that has "key_count" keys of 200 bytes each
+    template <typename GateT>
+    void get_keys(benchmark::State& state, GateT& gate) {
+        for (int key = 0; key != key_count; ++key) {
+            gate.set(key, value_of(key), 0);
+        }
+        std::mt19937                       gen{42}; // NOLINT(cert-msc32-c)
+        std::uniform_int_distribution<int> key_dist{0, key_count - 1};
+        for (auto _ : state) {
+            auto data = gate.get(key_dist(gen));
+            benchmark::DoNotOptimize(data);
+        }
+    }
+
+    auto temp_path(char const* name) {
+        return std::filesystem::temp_directory_path() / name;
+    }
+
+} // namespace
+
+static void FileGate_Get_Directory(benchmark::State& state) {
+    enable_owner_traits<default_traits> etraits;
+    auto const                          dir = temp_path("webpp-directory-gate-benchmark");
+    std::filesystem::create_directory(dir);
+    {
+        using gate_type = directory_gate::storage_gate<default_traits, int, std::string, std::size_t>;
+        gate_type gate{etraits, dir, "bench"};
+        get_keys(state, gate);
+    }
+    std::filesystem::remove_all(dir);
+}
+
+BENCHMARK(FileGate_Get_Directory);
+
+static void FileGate_Get_Log(benchmark::State& state) {
+    enable_owner_traits<default_traits> etraits;
+    auto const                          file = temp_path("webpp-file-gate-benchmark.cache");
+    std::filesystem::remove(file);
+    {
+        file_gate::storage_gate<default_traits, int, std::string, std::size_t> gate{etraits, file};
+        get_keys(state, gate);
+    }
+    std::filesystem::remove(file);
+}
+
+BENCHMARK(FileGate_Get_Log);
+
+// the cost of a warm restart: replaying the log of "key_count" keys, each of them set 10 times
+static void FileGate_Replay(benchmark::State& state) {
+    enable_owner_traits<default_traits> etraits;
+    auto const                          file = temp_path("webpp-file-gate-replay-benchmark.cache");
+    std::filesystem::remove(file);
+    {
+        file_gate::storage_gate<default_traits, int, std::string, std::size_t> gate{etraits,
+                                                                                    file,
+                                                                                    {.auto_compact = false}};
+        for (int round = 0; round != 10; ++round) {
+            for (int key = 0; key != key_count; ++key) {
+                gate.set(key, value_of(key + round), 0);
+            }
+        }
+    }
+    for (auto _ : state) {
+        file_gate::storage_gate<default_traits, int, std::string, std::size_t> gate{etraits, file};
+        benchmark::DoNotOptimize(gate.size());
+    }
+    std::filesystem::remove(file);
+}
+
+BENCHMARK(FileGate_Replay);
+
+// NOLINTEND(*-magic-numbers)
@@ -1,6 +1,11 @@
+#include "../../webpp/http/header_fields.hpp"
+#include "../../webpp/http/response_headers.hpp"
+#include "../../webpp/traits/enable_traits.hpp"
 #include "../benchmark.hpp"
 #include "headers.hpp"
 
+#include <algorithm>
+
 using namespace std;
 
 static void EmptyRandom(benchmark::State& state) {
@@ -88,3 +93,83 @@ static void JoelHasMo2(benchmark::State& state) {
 }
 
 BENCHMARK(JoelHasMo2);
+
+//////////////////////////////////////////////////
+// The real headers: finding a field by checking the names one by one (case-insensitively), against the
+// index of the fields (the hash of the name, and the id of the well-known names)
+
+using headers_type = webpp::http::response_headers<
+  webpp::http::header_fields_provider<webpp::http::header_field_of<webpp::default_traits>>>;
+
+static webpp::enable_owner_traits<webpp::default_traits> headers_traits;
+
+static auto prepare_headers(std::int64_t count) {
+    static constexpr std::array<std::string_view, 8> names{
+      "Date", "Server", "Cache-Control", "Vary", "ETag", "Set-Cookie", "X-Frame-Options", "Connection"};
+    headers_type headers{headers_traits};
+    for (std::int64_t i = 0; i < count - 2; i++) {
+        if (i < static_cast<std::int64_t>(names.size())) {
+            headers.set(names[static_cast<std::size_t>(i)], "value");
+        } else {
+            headers.set("X-Custom-" + std::to_string(i), "value");
+        }
+    }
+    // the ones that we look for are the last ones
+    headers.set("X-Request-Id", "42");
+    headers.set("Content-Length", "10");
+    return headers;
+}
+
+static void HeadersLinearKnown(benchmark::State& state) {
+    auto headers = prepare_headers(state.range(0));
+    for (auto _ : state) {
+        auto has_it = std::find_if(headers.begin(), headers.end(), [](auto const& field) {
+                          return field.is_name("content-length");
+                      }) != headers.end();
+        benchmark::DoNotOptimize(has_it);
+    }
+}
+
+BENCHMARK(HeadersLinearKnown)->Arg(8)->Arg(16)->Arg(32)->Arg(64);
+
+static void HeadersIndexedKnown(benchmark::State& state) {
+    auto headers = prepare_headers(state.range(0));
+    for (auto _ : state) {
+        auto has_it = headers.has("content-length");
+        benchmark::DoNotOptimize(has_it);
+    }
+}
+
+BENCHMARK(HeadersIndexedKnown)->Arg(8)->Arg(16)->Arg(32)->Arg(64);
+
+static void HeadersIndexedKnownId(benchmark::State& state) {
+    auto headers = prepare_headers(state.range(0));
+    for (auto _ : state) {
+        auto has_it = headers.has(webpp::http::header_id::content_length);
+        benchmark::DoNotOptimize(has_it);
+    }
+}
+
+BENCHMARK(HeadersIndexedKnownId)->Arg(8)->Arg(16)->Arg(32)->Arg(64);
+
+static void HeadersLinearUnknown(benchmark::State& state) {
+    auto headers = prepare_headers(state.range(0));
+    for (auto _ : state) {
+        auto has_it = std::find_if(headers.begin(), headers.end(), [](auto const& field) {
+                          return field.is_name("x-request-id");
+                      }) != headers.end();
+        benchmark::DoNotOptimize(has_it);
+    }
+}
+
+BENCHMARK(HeadersLinearUnknown)->Arg(8)->Arg(16)->Arg(32)->Arg(64);
+
+static void HeadersIndexedUnknown(benchmark::State& state) {
+    auto headers = prepare_headers(state.range(0));
+    for (auto _ : state) {
+        auto has_it = headers.has("x-request-id");
+        benchmark::DoNotOptimize(has_it);
+    }
+}
+
+BENCHMARK(HeadersIndexedUnknown)->Arg(8)->Arg(16)->Arg(32)->Arg(64);
@@ -0,0 +1,119 @@
+#include "../../webpp/views/html.hpp"
+#include "../benchmark.hpp"
+
+#include <string>
+
+using namespace webpp;
+
+// NOLINTBEGIN(*-magic-numbers)
+
+namespace {
+
+    // The escaper that html.hpp had before; it appends the characters one by one
+    template <istl::String StrT, istl::StringViewifiable StrVT>
+    StrT& html_escape_v1(StrVT&& input, StrT& out) {
+        out.reserve(input.size() * 2);
+        for (auto const ch : input) {
+            switch (ch) {
+                case '&': out.append({'&', 'a', 'm', 'p', ';'}); break;
+                case '<': out.append({'&', 'l', 't', ';'}); break;
+                case '>': out.append({'&', 'g', 't', ';'}); break;
+                case '\"': out.append({'&', 'q', 'u', 'o', 't', ';'}); break;
+                case '\'': out.append({'&', 'a', 'p', 'o', 's', ';'}); break;
+                default: out.append(1, ch); break;
+            }
+        }
+        return out;
+    }
+
+    // a user's name, or a title
+    std::string const& short_text() {
+        static std::string const text = "Items & Things";
+        return text;
+    }
+
+    // a comment, or an article; an escaped character every few hundred characters
+    std::string const& clean_text() {
+        static std::string const text = [] {
+            std::string str;
+            while (str.size() < 16UL * 1024UL) {
+                str += "Lorem ipsum dolor sit amet, consectetur adipiscing elit, sed do eiusmod tempor "
+                       "incididunt ut labore et dolore magna aliqua. Ut enim ad minim veniam, quis nostrud "
+                       "exercitation ullamco laboris nisi ut aliquip ex ea commodo consequat. \"Duis\" aute "
+                       "irure dolor in reprehenderit in voluptate velit esse cillum dolore eu fugiat nulla. ";
+            }
+            return str;
+        }();
+        return text;
+    }
+
+    // a piece of HTML or code; an escaped character every few characters
+    std::string const& heavy_text() {
+        static std::string const text = [] {
+            std::string str;
+            while (str.size() < 16UL * 1024UL) {
+                str += "<a href=\"/items?id=1&amp;sort='asc'\"><b>x</b> & <i>y</i></a>\n";
+            }
+            return str;
+        }();
+        return text;
+    }
+
+    template <typename EscaperT>
+    void escape(benchmark::State& state, std::string const& input, EscaperT escaper) {
+        std::string out;
+        for (auto _ : state) {
+            out.clear();
+            escaper(input, out);
+            benchmark::DoNotOptimize(out);
+        }
+        state.SetBytesProcessed(static_cast<std::int64_t>(state.iterations() * input.size()));
+    }
+
+    constexpr auto v1 = [](std::string const& input, std::string& out) {
+        html_escape_v1(input, out);
+    };
+
+    constexpr auto simd = [](std::string const& input, std::string& out) {
+        html_escape(input, out);
+    };
+
+} // namespace
+
+static void HTMLEscape_Short_V1(benchmark::State& state) {
+    escape(state, short_text(), v1);
+}
+
+BENCHMARK(HTMLEscape_Short_V1);
+
+static void HTMLEscape_Short_SIMD(benchmark::State& state) {
+    escape(state, short_text(), simd);
+}
+
+BENCHMARK(HTMLEscape_Short_SIMD);
+
+static void HTMLEscape_Clean_V1(benchmark::State& state) {
+    escape(state, clean_text(), v1);
+}
+
+BENCHMARK(HTMLEscape_Clean_V1);
+
+static void HTMLEscape_Clean_SIMD(benchmark::State& state) {
+    escape(state, clean_text(), simd);
+}
+
+BENCHMARK(HTMLEscape_Clean_SIMD);
+
+static void HTMLEscape_Heavy_V1(benchmark::State& state) {
+    escape(state, heavy_text(), v1);
+}
+
+BENCHMARK(HTMLEscape_Heavy_V1);
+
+static void HTMLEscape_Heavy_SIMD(benchmark::State& state) {
+    escape(state, heavy_text(), simd);
+}
+
+BENCHMARK(HTMLEscape_Heavy_SIMD);
+
+// NOLINTEND(*-magic-numbers)
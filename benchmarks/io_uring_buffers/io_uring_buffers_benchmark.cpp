@@ -0,0 +1,120 @@
+#include "../../webpp/io/io_uring/io_uring.hpp"
+#include "../benchmark.hpp"
+
+#include <array>
+#include <cstdlib> // mkstemp
+#include <fcntl.h>
+#include <unistd.h>
+#include <utility>
+
+// NOLINTBEGIN(*-magic-numbers)
+
+#ifdef WEBPP_IO_URING_SUPPORT
+
+namespace {
+
+    constexpr std::size_t block_size = 4096;
+
+    // A temp file with a few blocks in it, removed when the benchmark ends
+    struct temp_file {
+        std::array<char, 32> path{"/tmp/webpp-bench-XXXXXX"};
+        int                  fd = ::mkstemp(path.data());
+
+        temp_file() {
+            std::array<char, block_size> block{};
+            block.fill('x');
+            for (int i = 0; i != 16; ++i) {
+                [[maybe_unused]] auto const res = ::write(fd, block.data(), block.size());
+            }
+        }
+
+        temp_file(temp_file const&)            = delete;
+        temp_file(temp_file&&)                 = delete;
+        temp_file& operator=(temp_file const&) = delete;
+        temp_file& operator=(temp_file&&)      = delete;
+
+        ~temp_file() {
+            ::close(fd);
+            ::unlink(path.data());
+        }
+    };
+
+    namespace io = webpp::io;
+
+    using service_type = io::io_uring_service<>;
+
+    template <typename... Args>
+    void read(service_type& service, int const fd, Args&&... args) {
+        io::syscall(io::syscall_read{}, service, io::file_handle{fd}, std::forward<Args>(args)...);
+    }
+
+    void discard(io::io_result res) {
+        benchmark::DoNotOptimize(res);
+    }
+
+} // namespace
+
+static void PlainRead(benchmark::State& state) {
+    temp_file                    file;
+    std::array<char, block_size> buf{};
+    for (auto _ : state) {
+        auto const res = ::pread(file.fd, buf.data(), buf.size(), 0);
+        benchmark::DoNotOptimize(res);
+        benchmark::DoNotOptimize(buf.data());
+    }
+    state.SetBytesProcessed(static_cast<std::int64_t>(state.iterations() * block_size));
+}
+
+BENCHMARK(PlainRead);
+
+static void IOUringOwnBuffer(benchmark::State& state) {
+    temp_file                         file;
+    service_type                      service;
+    std::array<std::byte, block_size> buf{};
+    for (auto _ : state) {
+        read(service, file.fd, io::buffer_span{buf}, 0ULL, discard);
+        service(1);
+    }
+    state.SetBytesProcessed(static_cast<std::int64_t>(state.iterations() * block_size));
+}
+
+BENCHMARK(IOUringOwnBuffer);
+
+static void IOUringProvidedBuffer(benchmark::State& state) {
+    temp_file    file;
+    service_type service;
+    if (!service.has_provided_buffers()) {
+        state.SkipWithError("provided buffer rings are not supported");
+        return;
+    }
+    for (auto _ : state) {
+        read(service, file.fd, 0ULL, discard);
+        service(1);
+    }
+    state.SetBytesProcessed(static_cast<std::int64_t>(state.iterations() * block_size));
+}
+
+BENCHMARK(IOUringProvidedBuffer);
+
+static void IOUringProvidedBufferBatch(benchmark::State& state) {
+    temp_file    file;
+    service_type service;
+    if (!service.has_provided_buffers()) {
+        state.SkipWithError("provided buffer rings are not supported");
+        return;
+    }
+    auto const depth = static_cast<std::size_t>(state.range(0));
+    for (auto _ : state) {
+        for (std::size_t i = 0; i != depth; ++i) {
+            read(service, file.fd, i * block_size, discard);
+        }
+        service(depth);
+    }
+    state.SetBytesProcessed(static_cast<std::int64_t>(state.iterations() * depth * block_size));
+}
+
+BENCHMARK(IOUringProvidedBufferBatch)->Arg(4)->Arg(16);
+
+#endif // WEBPP_IO_URING_SUPPORT
+
+// NOLINTEND(*-magic-numbers)
@@ -0,0 +1,118 @@
+#include "../../webpp/storage/lru_cache.hpp"
+#include "../benchmark.hpp"
+
+#include <random>
+#include <vector>
+
+using namespace webpp;
+
+// NOLINTBEGIN(*-magic-numbers)
+
+namespace {
+
+    /**
+     * The LRU strategy that lru_strategy has replaced: each entry holds the time that it was used last in
+     * the options of the storage gate, and the old ones are erased with an erase_if over the whole gate.
+     */
+    struct stamped_lru_strategy {
+        template <Traits TraitsType, CacheKey KeyT, CacheValue ValueT, StorageGate SG>
+        struct strategy {
+            using traits_type = TraitsType;
+            using key_type    = KeyT;
+            using value_type  = ValueT;
+            using storage_gate_type =
+              typename SG::template storage_gate<traits_type, key_type, value_type, stl::size_t>;
+            using bundle_type = typename storage_gate_type::bundle_type;
+
+          private:
+            stl::size_t       max_size;
+            stl::size_t       next_usage = 1;
+            storage_gate_type gate;
+
+            void clean_up() {
+                if (next_usage <= max_size) {
+                    return;
+                }
+                stl::size_t break_index = next_usage - max_size;
+                gate.erase_if([break_index](auto const& item) noexcept {
+                    return item.options < break_index;
+                });
+            }
+
+          protected:
+            constexpr storage_gate_type& get_gate() noexcept {
+                return gate;
+            }
+
+          public:
+            template <EnabledTraits ET>
+            explicit constexpr strategy(ET&& etraits, stl::size_t const max_size_value)
+              : max_size{max_size_value},
+                gate{stl::forward<ET>(etraits)} {}
+
+            template <typename K, typename V>
+            constexpr void set(K&& key, V&& value) {
+                gate.set(stl::forward<K>(key), stl::forward<V>(value), next_usage++);
+                clean_up();
+            }
+
+            template <typename K>
+            constexpr stl::optional<value_type> get(K&& key) {
+                stl::optional<bundle_type> const data = gate.get(key);
+                if (!data) {
+                    return stl::nullopt;
+                }
+                gate.set_options(key, next_usage++);
+                return data->value;
+            }
+        };
+    };
+
+    constexpr std::size_t operations = 1'000'000;
+
+    // half of them are sets, half of them are gets; the keys are twice as many as what fits in the cache
+    std::vector<std::pair<bool, int>> const& operations_of(std::size_t const max_size) {
+        static std::vector<std::pair<bool, int>> ops;
+        ops.clear();
+        std::mt19937                       gen{42}; // NOLINT(cert-msc32-c,cert-msc51-cpp)
+        std::uniform_int_distribution<int> key_dist{0, static_cast<int>(max_size * 2)};
+        std::bernoulli_distribution        is_set{0.5};
+        for (std::size_t index = 0; index != operations; ++index) {
+            ops.emplace_back(is_set(gen), key_dist(gen));
+        }
+        return ops;
+    }
+
+    template <typename CacheType>
+    void run_operations(benchmark::State& state) {
+        auto const                          max_size = static_cast<std::size_t>(state.range(0));
+        auto const&                         ops      = operations_of(max_size);
+        enable_owner_traits<default_traits> etraits;
+        for (auto _ : state) {
+            CacheType cache{etraits, max_size};
+            for (auto const& [is_set, key] : ops) {
+                if (is_set) {
+                    cache.set(key, key);
+                } else {
+                    benchmark::DoNotOptimize(cache.get(key));
+                }
+            }
+        }
+        state.SetItemsProcessed(static_cast<std::int64_t>(state.iterations() * operations));
+    }
+
+} // namespace
+
+static void LRUCache_Stamped(benchmark::State& state) {
+    run_operations<cache<default_traits, int, int, stamped_lru_strategy, memory_gate<>>>(state);
+}
+
+BENCHMARK(LRUCache_Stamped)->Arg(64)->Arg(1024)->Unit(benchmark::kMillisecond);
+
+static void LRUCache_Linked(benchmark::State& state) {
+    run_operations<lru_cache<default_traits, int, int, memory_gate<>>>(state);
+}
+
+BENCHMARK(LRUCache_Linked)->Arg(64)->Arg(1024)->Unit(benchmark::kMillisecond);
+
+// NOLINTEND(*-magic-numbers)
@@ -0,0 +1,138 @@
+#include "../../webpp/http/request_body.hpp"
+#include "../../webpp/http/routes/context.hpp"
+#include "../../webpp/traits/default_traits.hpp"
+#include "../../webpp/views/mustache_view.hpp"
+#include "../benchmark.hpp"
+#include "mustache_tree.hpp"
+
+#include <string>
+
+using namespace webpp;
+using namespace webpp::views;
+
+// NOLINTBEGIN(*-magic-numbers)
+
+namespace {
+
+    using traits_type = std_traits;
+    using view_type   = mustache_view<traits_type>;
+    using data_type   = typename view_type::data_type;
+    using list_type   = typename view_type::variable_type::list_type;
+
+    constexpr std::string_view variable_scheme = "My name is {{name}}";
+
+    constexpr std::string_view sections_scheme =
+      "{{! comment }}A\n  {{#show}}  \n{{#show}}\n  {{name}}\n{{/show}}\n  {{/show}}\nB\n"
+      "{{#hide}}shown{{/hide}}{{^hide}}hidden{{/hide}} {{person.last}}\n"
+      "{{html}} {{&html}} {{{html}}}\n";
+
+    constexpr std::string_view listing_scheme =
+      "<!doctype html>\n"
+      "<html>\n"
+      "  <head><title>{{title}}</title></head>\n"
+      "  <body>\n"
+      "    <h1>{{title}}</h1>\n"
+      "    <ul>\n"
+      "    {{#items}}\n"
+      "      <li><a href=\"/items/{{.}}\">{{.}}</a></li>\n"
+      "    {{/items}}\n"
+      "    </ul>\n"
+      "    {{^items}}\n"
+      "    <p>Nothing here</p>\n"
+      "    {{/items}}\n"
+      "  </body>\n"
+      "</html>\n";
+
+    data_type make_data(enable_owner_traits<traits_type>& etraits) {
+        data_type data;
+        data.emplace_back(etraits, "name", "moisrex");
+        data.emplace_back(etraits, "title", "Items & Things");
+        data.emplace_back(etraits, "show", true);
+        data.emplace_back(etraits, "hide", false);
+        data.emplace_back(etraits, "html", "<b>&</b>");
+        list_type person;
+        person.emplace_back(etraits, "last", "Bahoosh");
+        data.emplace_back(etraits, "person", person);
+        list_type items;
+        for (int index = 0; index != 100; ++index) {
+            items.emplace_back(etraits, "item", "item-" + std::to_string(index));
+        }
+        data.emplace_back(etraits, "items", items);
+        return data;
+    }
+
+    void render_tree(benchmark::State& state, std::string_view scheme) {
+        enable_owner_traits<traits_type>     etraits;
+        view_type                            view{etraits};
+        view.scheme(scheme);
+        auto const                           data = make_data(etraits);
+        v1::tree_renderer<traits_type> const renderer{view};
+        for (auto _ : state) {
+            std::string out;
+            renderer.render(out, data);
+            benchmark::DoNotOptimize(out);
+        }
+    }
+
+    void render_program(benchmark::State& state, std::string_view scheme) {
+        enable_owner_traits<traits_type> etraits;
+        view_type                        view{etraits};
+        view.scheme(scheme);
+        auto const data = make_data(etraits);
+
+        // both of them should render the same thing
+        std::string tree_out;
+        std::string program_out;
+        v1::tree_renderer<traits_type>{view}.render(tree_out, data);
+        view.render(program_out, data);
+        if (tree_out != program_out) {
+            state.SkipWithError("The program and the tree render different results.");
+            return;
+        }
+
+        for (auto _ : state) {
+            std::string out;
+            view.render(out, data);
+            benchmark::DoNotOptimize(out);
+        }
+    }
+
+} // namespace
+
+static void Mustache_Variable_Tree(benchmark::State& state) {
+    render_tree(state, variable_scheme);
+}
+
+BENCHMARK(Mustache_Variable_Tree);
+
+static void Mustache_Variable_Program(benchmark::State& state) {
+    render_program(state, variable_scheme);
+}
+
+BENCHMARK(Mustache_Variable_Program);
+
+static void Mustache_Sections_Tree(benchmark::State& state) {
+    render_tree(state, sections_scheme);
+}
+
+BENCHMARK(Mustache_Sections_Tree);
+
+static void Mustache_Sections_Program(benchmark::State& state) {
+    render_program(state, sections_scheme);
+}
+
+BENCHMARK(Mustache_Sections_Program);
+
+static void Mustache_Listing_Tree(benchmark::State& state) {
+    render_tree(state, listing_scheme);
+}
+
+BENCHMARK(Mustache_Listing_Tree);
+
+static void Mustache_Listing_Program(benchmark::State& state) {
+    render_program(state, listing_scheme);
+}
+
+BENCHMARK(Mustache_Listing_Program);
+
+// NOLINTEND(*-magic-numbers)
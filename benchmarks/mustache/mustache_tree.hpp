@@ -0,0 +1,123 @@
+// The renderer that mustache_view used before its templates were compiled to programs; it walks the
+// component tree, and it doesn't support lambdas and partials.
+
+#ifndef WEBPP_BENCHMARK_MUSTACHE_TREE_HPP
+#define WEBPP_BENCHMARK_MUSTACHE_TREE_HPP
+
+#include "../../webpp/views/mustache_view.hpp"
+
+namespace webpp::views::v1 {
+
+    template <Traits TraitsType>
+    struct tree_renderer {
+        using traits_type    = TraitsType;
+        using view_type      = mustache_view<traits_type>;
+        using string_type    = typename view_type::string_type;
+        using component_type = typename view_type::component_type;
+        using data_type      = typename view_type::data_type;
+        using variable_type  = typename view_type::variable_type;
+        using render_handler = typename view_type::render_handler;
+
+      private:
+        view_type const* view;
+
+        static void render_current_line(render_handler const&           handler,
+                                        line_buffer_state<traits_type>& line_buffer,
+                                        component_type const*           comp) {
+            if (!line_buffer.contained_section_tag || !line_buffer.is_empty_or_contains_only_whitespace()) {
+                handler(line_buffer.data);
+                if (comp) {
+                    handler(comp->text);
+                }
+            }
+            line_buffer.clear();
+        }
+
+        void render_children(render_handler const&          handler,
+                             context_internal<traits_type>& ctx,
+                             component_type const&          parent) const {
+            for (auto const& comp : parent.children) {
+                render_component(handler, ctx, comp);
+            }
+        }
+
+        void render_component(render_handler const&          handler,
+                              context_internal<traits_type>& ctx,
+                              component_type const&          comp) const {
+            if (comp.is_text()) {
+                if (comp.is_newline()) {
+                    render_current_line(handler, ctx.line_buffer, &comp);
+                } else {
+                    ctx.line_buffer.data.append(comp.text);
+                }
+                return;
+            }
+            variable_type const* var = ctx.ctx->get(comp.tag.name);
+            switch (comp.tag.type) {
+                using enum details::tag_type;
+                case variable:
+                case unescaped_variable:
+                    if (var != nullptr && var->is_string()) {
+                        if (comp.tag.type == variable) {
+                            string_type out;
+                            html_escape(var->string_value(), out);
+                            ctx.line_buffer.data.append(out);
+                        } else {
+                            ctx.line_buffer.data.append(var->string_value());
+                        }
+                    }
+                    break;
+                case section_begin:
+                    if (var != nullptr && !var->is_false()) {
+                        render_section(handler, ctx, comp, var);
+                    }
+                    break;
+                case section_begin_inverted:
+                    if (var == nullptr || var->is_false()) {
+                        render_section(handler, ctx, comp, var);
+                    }
+                    break;
+                default: break;
+            }
+        }
+
+        void render_section(render_handler const&          handler,
+                            context_internal<traits_type>& ctx,
+                            component_type const&          comp,
+                            variable_type const*           var) const {
+            if (var && var->is_non_empty_list()) {
+                for (auto const& item : var->list_value()) {
+                    ctx.line_buffer.contained_section_tag = true;
+                    context_pusher<traits_type> const ctxpusher{ctx, &item};
+                    render_children(handler, ctx, comp);
+                    ctx.line_buffer.contained_section_tag = true;
+                }
+            } else if (var) {
+                ctx.line_buffer.contained_section_tag = true;
+                context_pusher<traits_type> const ctxpusher{ctx, var};
+                render_children(handler, ctx, comp);
+                ctx.line_buffer.contained_section_tag = true;
+            } else {
+                ctx.line_buffer.contained_section_tag = true;
+                render_children(handler, ctx, comp);
+                ctx.line_buffer.contained_section_tag = true;
+            }
+        }
+
+      public:
+        explicit tree_renderer(view_type const& inp_view) noexcept : view{&inp_view} {}
+
+        void render(string_type& out, data_type const& data) const {
+            context<traits_type>          ctx{*view, &data};
+            context_internal<traits_type> internal_ctx{ctx};
+            render_handler const          handler{[&out](auto str) {
+                out += str;
+            }};
+            render_children(handler, internal_ctx, view->components());
+            render_current_line(handler, internal_ctx.line_buffer, nullptr);
+        }
+    };
+
+} // namespace webpp::views::v1
+
+#endif // WEBPP_BENCHMARK_MUSTACHE_TREE_HPP
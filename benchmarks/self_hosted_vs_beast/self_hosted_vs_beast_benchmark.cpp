@@ -0,0 +1,213 @@
+#include "../../webpp/beast/beast.hpp"
+#include "../../webpp/http/http.hpp"
+#include "../../webpp/hub/self_hosted.hpp"
+#include "../benchmark.hpp"
+
+#include <boost/asio/connect.hpp>
+#include <boost/asio/ip/tcp.hpp>
+#include <boost/beast/core.hpp>
+#include <boost/beast/http.hpp>
+#include <chrono>
+#include <thread>
+
+// NOLINTBEGIN(*-magic-numbers)
+
+namespace bhttp = boost::beast::http;
+using tcp       = boost::asio::ip::tcp;
+
+namespace {
+
+    constexpr std::uint16_t self_hosted_port = 18'082;
+    constexpr std::uint16_t beast_port       = 18'083;
+
+    std::string const& large_body() {
+        static std::string const body(256UL * 1024UL, 'x');
+        return body;
+    }
+
+    struct hello_app {
+        webpp::http::HTTPResponse auto operator()(webpp::http::HTTPRequest auto&& req) {
+            using response_type = webpp::http::simple_response<webpp::default_traits>;
+            if (req.uri() == "/large") {
+                return response_type::with_body(req, large_body());
+            }
+            return response_type::with_body(req, "Hello World");
+        }
+    };
+
+    // The servers run in the background for the whole duration of the benchmarks
+    template <typename ServerType, std::uint16_t Port>
+    struct server_runner {
+        ServerType  server;
+        std::thread thread;
+
+        server_runner() {
+            server.address("127.0.0.1").port(Port).max_requests_per_connection(0);
+            thread = std::thread{[this] {
+                [[maybe_unused]] auto const res = server();
+            }};
+            std::this_thread::sleep_for(std::chrono::milliseconds(200));
+        }
+
+        server_runner(server_runner const&)            = delete;
+        server_runner(server_runner&&)                 = delete;
+        server_runner& operator=(server_runner const&) = delete;
+        server_runner& operator=(server_runner&&)      = delete;
+
+        ~server_runner() {
+            server.stop();
+            thread.join();
+        }
+    };
+
+    template <typename ServerType, std::uint16_t Port>
+    std::uint16_t run_server() {
+        static server_runner<ServerType, Port> srv;
+        return Port;
+    }
+
+    std::uint16_t self_hosted_server() {
+        return run_server<webpp::self_hosted<hello_app>, self_hosted_port>();
+    }
+
+    std::uint16_t beast_server() {
+        return run_server<webpp::beast<hello_app>, beast_port>();
+    }
+
+    struct client {
+        boost::asio::io_context   io;
+        boost::beast::tcp_stream  stream{io};
+        boost::beast::flat_buffer buf;
+        tcp::endpoint const       endpoint;
+
+        explicit client(std::uint16_t const port)
+          : endpoint{boost::asio::ip::make_address("127.0.0.1"), port} {}
+
+        void connect() {
+            buf.clear();
+            stream.connect(endpoint);
+        }
+
+        void close() {
+            boost::beast::error_code err;
+            stream.socket().shutdown(tcp::socket::shutdown_both, err);
+            stream.close();
+        }
+
+        void write(bool const keep_alive, char const* target = "/") {
+            bhttp::request<bhttp::empty_body> req{bhttp::verb::get, target, 11};
+            req.set(bhttp::field::host, "localhost");
+            req.keep_alive(keep_alive);
+            bhttp::write(stream, req);
+        }
+
+        // returns true if the connection is still usable
+        bool read() {
+            bhttp::response<bhttp::string_body> res;
+            bhttp::read(stream, buf, res);
+            benchmark::DoNotOptimize(res.body().data());
+            return res.keep_alive();
+        }
+    };
+
+    void connection_per_request(benchmark::State& state, std::uint16_t const port) {
+        client cli{port};
+        for (auto _ : state) {
+            cli.connect();
+            cli.write(false);
+            cli.read();
+            cli.close();
+        }
+        state.SetItemsProcessed(static_cast<std::int64_t>(state.iterations()));
+    }
+
+    void keep_alive(benchmark::State& state, std::uint16_t const port, char const* target = "/") {
+        client cli{port};
+        cli.connect();
+        for (auto _ : state) {
+            cli.write(true, target);
+            if (!cli.read()) {
+                cli.close();
+                cli.connect();
+            }
+        }
+        cli.close();
+        state.SetItemsProcessed(static_cast<std::int64_t>(state.iterations()));
+    }
+
+    void pipelined(benchmark::State& state, std::uint16_t const port) {
+        auto const depth = static_cast<std::size_t>(state.range(0));
+        client     cli{port};
+        cli.connect();
+        for (auto _ : state) {
+            for (std::size_t i = 0; i != depth; ++i) {
+                cli.write(true);
+            }
+            for (std::size_t i = 0; i != depth; ++i) {
+                if (!cli.read()) {
+                    cli.close();
+                    cli.connect();
+                    break;
+                }
+            }
+        }
+        cli.close();
+        state.SetItemsProcessed(static_cast<std::int64_t>(state.iterations() * depth));
+    }
+
+    void large_body(benchmark::State& state, std::uint16_t const port) {
+        keep_alive(state, port, "/large");
+        state.SetBytesProcessed(static_cast<std::int64_t>(state.iterations() * large_body().size()));
+    }
+
+} // namespace
+
+static void SelfHostedConnectionPerRequest(benchmark::State& state) {
+    connection_per_request(state, self_hosted_server());
+}
+
+BENCHMARK(SelfHostedConnectionPerRequest);
+
+static void BeastConnectionPerRequest(benchmark::State& state) {
+    connection_per_request(state, beast_server());
+}
+
+BENCHMARK(BeastConnectionPerRequest);
+
+static void SelfHostedKeepAlive(benchmark::State& state) {
+    keep_alive(state, self_hosted_server());
+}
+
+BENCHMARK(SelfHostedKeepAlive);
+
+static void BeastKeepAlive(benchmark::State& state) {
+    keep_alive(state, beast_server());
+}
+
+BENCHMARK(BeastKeepAlive);
+
+static void SelfHostedPipelined(benchmark::State& state) {
+    pipelined(state, self_hosted_server());
+}
+
+BENCHMARK(SelfHostedPipelined)->Arg(4)->Arg(16);
+
+static void BeastPipelined(benchmark::State& state) {
+    pipelined(state, beast_server());
+}
+
+BENCHMARK(BeastPipelined)->Arg(4)->Arg(16);
+
+static void SelfHostedLargeBody(benchmark::State& state) {
+    large_body(state, self_hosted_server());
+}
+
+BENCHMARK(SelfHostedLargeBody);
+
+static void BeastLargeBody(benchmark::State& state) {
+    large_body(state, beast_server());
+}
+
+BENCHMARK(BeastLargeBody);
+
+// NOLINTEND(*-magic-numbers)
@@ -0,0 +1,186 @@
+#include "../../webpp/concurrency/thread_pool.hpp"
+#include "../benchmark.hpp"
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <latch>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// NOLINTBEGIN(*-magic-numbers)
+
+namespace {
+
+    constexpr std::size_t thread_count = 4;
+
+    /**
+     * The old task_system: a mutex-protected std::deque of std::function per thread, the threads poll
+     * the other queues with try_lock before they sleep on their own condition variable.
+     */
+    struct mutex_queue_pool {
+        struct queue {
+            std::deque<std::function<void()>> tasks;
+            bool                              done = false;
+            std::mutex                        mutex;
+            std::condition_variable           ready;
+
+            bool try_pop(std::function<void()>& func) {
+                std::unique_lock lock{mutex, std::try_to_lock};
+                if (!lock || tasks.empty()) {
+                    return false;
+                }
+                func = std::move(tasks.front());
+                tasks.pop_front();
+                return true;
+            }
+
+            template <typename F>
+            bool try_push(F&& func) {
+                {
+                    std::unique_lock lock{mutex, std::try_to_lock};
+                    if (!lock) {
+                        return false;
+                    }
+                    tasks.emplace_back(std::forward<F>(func));
+                }
+                ready.notify_one();
+                return true;
+            }
+
+            bool pop(std::function<void()>& func) {
+                std::unique_lock lock{mutex};
+                while (tasks.empty() && !done) {
+                    ready.wait(lock);
+                }
+                if (tasks.empty()) {
+                    return false;
+                }
+                func = std::move(tasks.front());
+                tasks.pop_front();
+                return true;
+            }
+
+            template <typename F>
+            void push(F&& func) {
+                {
+                    std::scoped_lock lock{mutex};
+                    tasks.emplace_back(std::forward<F>(func));
+                }
+                ready.notify_one();
+            }
+        };
+
+        std::vector<queue>       queues;
+        std::vector<std::thread> threads;
+        std::atomic<unsigned>    index{0};
+
+        explicit mutex_queue_pool(std::size_t const count) : queues(count) {
+            for (std::size_t pos = 0; pos != count; ++pos) {
+                threads.emplace_back([this, pos] {
+                    run(pos);
+                });
+            }
+        }
+
+        mutex_queue_pool(mutex_queue_pool const&)            = delete;
+        mutex_queue_pool(mutex_queue_pool&&)                 = delete;
+        mutex_queue_pool& operator=(mutex_queue_pool const&) = delete;
+        mutex_queue_pool& operator=(mutex_queue_pool&&)      = delete;
+
+        ~mutex_queue_pool() {
+            for (auto& cur : queues) {
+                {
+                    std::scoped_lock lock{cur.mutex};
+                    cur.done = true;
+                }
+                cur.ready.notify_all();
+            }
+            for (auto& cur : threads) {
+                cur.join();
+            }
+        }
+
+        void run(std::size_t const pos) {
+            auto const count = queues.size();
+            for (;;) {
+                std::function<void()> func;
+                for (std::size_t cur = 0; cur != count * 32; ++cur) {
+                    if (queues[(pos + cur) % count].try_pop(func)) {
+                        break;
+                    }
+                }
+                if (!func && !queues[pos].pop(func)) {
+                    break;
+                }
+                func();
+            }
+        }
+
+        template <typename F>
+        void post(F&& func) {
+            auto const first = index++;
+            auto const count = queues.size();
+            for (std::size_t pos = 0; pos != count; ++pos) {
+                if (queues[(first + pos) % count].try_push(func)) {
+                    return;
+                }
+            }
+            queues[first % count].push(std::forward<F>(func));
+        }
+    };
+
+    using work_stealing_pool = webpp::thread_pool<>;
+
+    // post all the tasks from outside, and wait for all of them
+    template <typename Pool>
+    void fan_out_fan_in(benchmark::State& state) {
+        Pool       pool{thread_count};
+        auto const tasks = static_cast<std::ptrdiff_t>(state.range(0));
+        for (auto _ : state) {
+            std::latch done{tasks};
+            for (std::ptrdiff_t i = 0; i != tasks; ++i) {
+                pool.post([&done] {
+                    done.count_down();
+                });
+            }
+            done.wait();
+        }
+        state.SetItemsProcessed(state.iterations() * tasks);
+    }
+
+    // a few tasks, each of them posts many tiny tasks from inside the pool
+    template <typename Pool>
+    void many_small_tasks(benchmark::State& state) {
+        Pool       pool{thread_count};
+        auto const tasks   = static_cast<std::ptrdiff_t>(state.range(0));
+        auto const parents = static_cast<std::ptrdiff_t>(thread_count);
+        for (auto _ : state) {
+            std::latch            done{tasks * parents};
+            std::atomic<unsigned> sum{0};
+            for (std::ptrdiff_t p = 0; p != parents; ++p) {
+                pool.post([&] {
+                    for (std::ptrdiff_t i = 0; i != tasks; ++i) {
+                        pool.post([&sum, &done, i] {
+                            sum.fetch_add(static_cast<unsigned>(i), std::memory_order_relaxed);
+                            done.count_down();
+                        });
+                    }
+                });
+            }
+            done.wait();
+            benchmark::DoNotOptimize(sum.load());
+        }
+        state.SetItemsProcessed(state.iterations() * tasks * parents);
+    }
+
+} // namespace
+
+BENCHMARK(fan_out_fan_in<mutex_queue_pool>)->Arg(1'000)->Arg(10'000)->UseRealTime();
+BENCHMARK(fan_out_fan_in<work_stealing_pool>)->Arg(1'000)->Arg(10'000)->UseRealTime();
+BENCHMARK(many_small_tasks<mutex_queue_pool>)->Arg(1'000)->Arg(10'000)->UseRealTime();
+BENCHMARK(many_small_tasks<work_stealing_pool>)->Arg(1'000)->Arg(10'000)->UseRealTime();
+
+// NOLINTEND(*-magic-numbers)
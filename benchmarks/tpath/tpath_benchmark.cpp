@@ -0,0 +1,37 @@
+#include "../../webpp/http/routes/context.hpp"
+#include "../../webpp/http/routes/tpath.hpp"
+#include "../benchmark.hpp"
+
+using namespace webpp;
+using namespace webpp::http;
+
+// NOLINTBEGIN(*-magic-numbers)
+
+static void TPath_ParseVars(benchmark::State& state) {
+    for (auto _ : state) {
+        auto vars = parse_vars("/users/{user_id}/posts/{post_id}", "/users/123/posts/456");
+        benchmark::DoNotOptimize(to_int(vars["user_id"]) + to_int(vars["post_id"]));
+    }
+}
+
+BENCHMARK(TPath_ParseVars);
+
+static void TPath_Typed(benchmark::State& state) {
+    enable_owner_traits<default_dynamic_traits> et;
+
+    request req{et};
+    req.uri("/users/123/posts/456");
+    context ctx{req};
+
+    constexpr auto user_post = tpath<"/users/{int:user_id}/posts/{int:post_id}">;
+    for (auto _ : state) {
+        ctx.path_traverser().reset();
+        benchmark::DoNotOptimize(user_post(ctx));
+        auto const& vars = user_post.captures(ctx);
+        benchmark::DoNotOptimize(vars.get<"user_id">() + vars.get<"post_id">());
+    }
+}
+
+BENCHMARK(TPath_Typed);
+
+// NOLINTEND(*-magic-numbers)
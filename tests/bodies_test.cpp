@@ -1,5 +1,7 @@
 // Created by moisrex on 2/4/20.
 
+#include "../webpp/http/bodies/chunked.hpp"
+#include "../webpp/http/bodies/file.hpp"
 #include "../webpp/http/bodies/string.hpp"
 #include "../webpp/http/response_body.hpp"
 #include "../webpp/std/string.hpp"
@@ -99,6 +101,132 @@ TEST(Body, File) {
     std::filesystem::remove(file);
 }
 
+TEST(Body, FileBody) {
+    std::filesystem::path file = std::filesystem::temp_directory_path();
+    file.append("webpp_test_file_body");
+    std::ofstream handle{file};
+    handle << "Hello World";
+    handle.close();
+
+    auto const read_all = [](file_body const& fbody) {
+        std::string out(fbody.size(), '\0');
+        auto const  read = fbody.read(reinterpret_cast<std::byte*>(out.data()), 100);
+        out.resize(static_cast<std::size_t>(read));
+        return out;
+    };
+
+    file_body fbody{file};
+    ASSERT_TRUE(fbody.is_open());
+    EXPECT_EQ(fbody.file_size(), 11);
+    EXPECT_EQ(fbody.size(), 11);
+    EXPECT_EQ(read_all(fbody), "Hello World");
+    EXPECT_TRUE(fbody.empty());
+
+    EXPECT_EQ(file_body{file}.apply_range("bytes=0-1,3-4"), file_range_status::whole);
+    EXPECT_EQ(file_body{file}.apply_range("bytes=a-4"), file_range_status::whole);
+    EXPECT_EQ(file_body{file}.apply_range("bytes=5-4"), file_range_status::whole);
+    EXPECT_EQ(file_body{file}.apply_range("items=0-4"), file_range_status::whole);
+    EXPECT_EQ(file_body{file}.apply_range("bytes=11-"), file_range_status::unsatisfiable);
+    EXPECT_EQ(file_body{file}.apply_range("bytes=-0"), file_range_status::unsatisfiable);
+
+    file_body first{file};
+    EXPECT_EQ(first.apply_range("bytes=0-4"), file_range_status::partial);
+    EXPECT_EQ(first.size(), 5);
+    EXPECT_EQ(read_all(first), "Hello");
+
+    file_body last{file};
+    EXPECT_EQ(last.apply_range("bytes=-5"), file_range_status::partial);
+    EXPECT_EQ(last.range_first(), 6);
+    EXPECT_EQ(last.range_last(), 10);
+    file_body const last_copy{last};
+    EXPECT_EQ(read_all(last), "World");
+    EXPECT_EQ(read_all(last_copy), "World");
+
+    file_body rest{file};
+    EXPECT_EQ(rest.apply_range("bytes=6-100"), file_range_status::partial);
+    EXPECT_EQ(read_all(rest), "World");
+
+    EXPECT_FALSE(file_body{file.parent_path()}.is_open());
+    EXPECT_FALSE(file_body{file.string() + ".nonexistent"}.is_open());
+
+    std::filesystem::remove(file);
+}
+
+TEST(Body, FileBodyCommunicator) {
+    enable_owner_traits<default_traits> et;
+    std::filesystem::path               file = std::filesystem::temp_directory_path();
+    file.append("webpp_test_file_body_communicator");
+    std::ofstream handle{file};
+    handle << "Hello World";
+    handle.close();
+
+    body_type the_body{et};
+    the_body = file_body{file};
+    EXPECT_EQ(the_body.which_communicator(), communicator_type::file_based);
+    EXPECT_EQ(the_body.size(), 11);
+    EXPECT_FALSE(the_body.empty());
+    EXPECT_EQ(the_body.as<std::string>(), "Hello World");
+    EXPECT_EQ(the_body.as<std::string>(), "Hello World") << "Reading it as a string should not consume it";
+
+    body_type const copied{the_body};
+    EXPECT_EQ(copied.which_communicator(), communicator_type::file_based);
+    EXPECT_EQ(copied.as<std::string>(), "Hello World");
+
+    the_body = "text";
+    EXPECT_EQ(the_body.which_communicator(), communicator_type::text_based);
+    EXPECT_EQ(the_body.as<std::string>(), "text");
+
+    std::filesystem::remove(file);
+}
+
+TEST(Body, ChunkedBody) {
+    enable_owner_traits<default_traits> et;
+    using chunked_type = chunked_body<default_traits>;
+
+    // produces "0123456789" in pieces of at least chunk_size
+    auto const make_body = [&](std::size_t const chunk_size) {
+        return chunked_type{et,
+                            [index = 0](string_type& out, std::size_t const size) mutable {
+                                while (index != 10 && out.size() < size) {
+                                    out.push_back(static_cast<char>('0' + index++));
+                                }
+                                return index != 10;
+                            },
+                            chunk_size};
+    };
+
+    auto chunks = make_body(4);
+    EXPECT_FALSE(chunks.empty());
+    ASSERT_TRUE(chunks.next_chunk());
+    EXPECT_EQ(chunks.chunk(), "0123");
+    ASSERT_TRUE(chunks.next_chunk());
+    EXPECT_EQ(chunks.chunk(), "4567");
+    ASSERT_TRUE(chunks.next_chunk());
+    EXPECT_EQ(chunks.chunk(), "89");
+    EXPECT_FALSE(chunks.next_chunk());
+    EXPECT_TRUE(chunks.empty());
+    EXPECT_FALSE(chunked_type{et}.next_chunk());
+
+    body_type the_body{et};
+    the_body = make_body(3);
+    EXPECT_EQ(the_body.which_communicator(), communicator_type::chunked_based);
+    EXPECT_FALSE(the_body.empty());
+    EXPECT_EQ(the_body.as<std::string>(), "0123456789");
+    EXPECT_TRUE(the_body.empty()) << "The chunks are produced only once";
+
+    body_type read_body{et};
+    read_body = make_body(4);
+    std::string out(6, '\0');
+    EXPECT_EQ(read_body.read(reinterpret_cast<std::byte*>(out.data()), 6), 6);
+    EXPECT_EQ(out, "012345");
+    EXPECT_EQ(read_body.read(reinterpret_cast<std::byte*>(out.data()), 6), 4);
+    EXPECT_EQ(out.substr(0, 4), "6789");
+
+    the_body = "text";
+    EXPECT_EQ(the_body.which_communicator(), communicator_type::text_based);
+    EXPECT_EQ(the_body.as<std::string>(), "text");
+}
+
 TEST(Body, StringCustomBody) {
     enable_owner_traits<default_traits> et;
     static_assert(istl::String<stl::string> && stl::is_default_constructible_v<stl::string>,
@@ -1,10 +1,18 @@
 #include "../webpp/storage/cache.hpp"
 
 #include "../webpp/storage/directory_gate.hpp"
+#include "../webpp/storage/expiring_cache.hpp"
 #include "../webpp/storage/file_gate.hpp"
 #include "../webpp/storage/lru_cache.hpp"
+#include "../webpp/storage/sharded_cache.hpp"
+#include "../webpp/storage/unified_caches.hpp"
 #include "common/tests_common_pch.hpp"
 
+#include <list>
+#include <random>
+#include <thread>
+#include <unordered_map>
+
 using namespace webpp;
 
 static_assert(CacheKey<int>);
@@ -53,6 +61,15 @@ TEST(Cache, LRUCacheTest) {
     for (auto const& [key, value] : c2) {
         EXPECT_TRUE(key < 10);
     }
+
+    // with a gate that's already there
+    using cache_type = lru_cache<default_traits, int>;
+    cache_type c3{t, cache_type::storage_gate_type{t}, 2};
+    c3.set(1, "one");
+    c3.set(2, "two");
+    c3.set(3, "three");
+    EXPECT_TRUE(!c3.get(1));
+    EXPECT_EQ("three", c3.get(3).value());
 }
 
 TEST(Cache, CacheResultTest) {
@@ -117,4 +134,346 @@ TEST(Cache, ReferenceTest) {
     EXPECT_EQ("new new value", c.get("one").value());
 }
 
+TEST(Cache, LRUStressTest) {
+    // the reference: a list of the keys, from the most recently used one
+    struct reference_lru {
+        std::size_t                                                       max_size;
+        std::list<std::pair<int, int>>                                    items;
+        std::unordered_map<int, std::list<std::pair<int, int>>::iterator> index;
+
+        void set(int key, int value) {
+            if (auto pos = index.find(key); pos != index.end()) {
+                items.erase(pos->second);
+            }
+            items.emplace_front(key, value);
+            index[key] = items.begin();
+            if (items.size() > max_size) {
+                index.erase(items.back().first);
+                items.pop_back();
+            }
+        }
+
+        stl::optional<int> get(int key) {
+            auto pos = index.find(key);
+            if (pos == index.end()) {
+                return stl::nullopt;
+            }
+            items.splice(items.begin(), items, pos->second);
+            return pos->second->second;
+        }
+    };
+
+    enable_owner_traits<default_traits> t;
+    for (std::size_t const max_size : {1U, 2U, 17U, 256U}) {
+        lru_cache<default_traits, int, int, memory_gate<>> c{t, max_size};
+        reference_lru                                      ref{max_size, {}, {}};
+        std::mt19937 gen{static_cast<std::mt19937::result_type>(max_size)}; // NOLINT(cert-msc32-c)
+        std::uniform_int_distribution<int> key_dist{0, static_cast<int>(max_size * 3)};
+        std::uniform_int_distribution<int> op_dist{0, 2};
+        for (int index = 0; index != 200'000; ++index) {
+            auto const key = key_dist(gen);
+            switch (op_dist(gen)) {
+                case 0:
+                    c.set(key, index);
+                    ref.set(key, index);
+                    break;
+                case 1: ASSERT_EQ(c.get(key), ref.get(key)) << key; break;
+                default: {
+                    auto const* val = c.get_ptr(key);
+                    auto const  exp = ref.get(key);
+                    ASSERT_EQ(val != nullptr, exp.has_value()) << key;
+                    if (val != nullptr) {
+                        ASSERT_EQ(*val, *exp) << key;
+                    }
+                }
+            }
+            ASSERT_EQ(c.size(), ref.items.size());
+        }
+    }
+}
+
+TEST(Cache, ConcurrentCacheTest) {
+    enable_owner_traits<default_traits>                          t;
+    concurrent_cache<default_traits, int, int>                   c{t, 64};
+    concurrent_cache<default_traits, int, int, memory_gate<>, 1> single{t, 4};
+    c.set(1, 10);
+    c.set(1, 11);
+    EXPECT_EQ(c.get(1), 11);
+    EXPECT_EQ(c.get(2, -1), -1);
+    EXPECT_EQ(c[5].value_or(0), 0);
+    {
+        auto val = c.get_ptr(1);
+        ASSERT_TRUE(val);
+        EXPECT_EQ(*val, 11);
+    }
+    EXPECT_EQ(*c.emplace_get_ptr(3, 30), 30);
+    EXPECT_TRUE(c.get_ptr(4) == nullptr);
+    c.erase(3);
+    EXPECT_FALSE(c.get(3));
+
+    for (int key = 0; key != 1000; ++key) {
+        c.set(key, key * 2);
+    }
+    EXPECT_LE(c.size(), 64U);
+    EXPECT_GT(c.size(), 0U);
+
+    // CLOCK: the entries that are used since the hand passed them survive the eviction
+    single.set(1, 1);
+    single.set(2, 2);
+    single.set(3, 3);
+    single.set(4, 4);
+    EXPECT_TRUE(single.get(1));
+    single.set(5, 5);
+    EXPECT_TRUE(single.get(1));
+    EXPECT_FALSE(single.get(2));
+    EXPECT_EQ(single.size(), 4U);
+}
+
+TEST(Cache, ConcurrentCacheThreadsTest) {
+    enable_owner_traits<default_traits>        t;
+    concurrent_cache<default_traits, int, int> c{t, 256};
+    std::atomic<int>                           wrong{0};
+    std::vector<std::thread>                   threads;
+    for (int id = 0; id != 8; ++id) {
+        threads.emplace_back([&, id] {
+            std::mt19937                       gen{static_cast<std::mt19937::result_type>(id)};
+            std::uniform_int_distribution<int> key_dist{0, 1024};
+            for (int index = 0; index != 20'000; ++index) {
+                auto const key = key_dist(gen);
+                switch (index % 3) {
+                    case 0: c.set(key, key * 7); break;
+                    case 1:
+                        if (auto const val = c.get(key); val && *val != key * 7) {
+                            ++wrong;
+                        }
+                        break;
+                    default:
+                        if (auto const val = c.get_ptr(key); val && *val != key * 7) {
+                            ++wrong;
+                        }
+                }
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    EXPECT_EQ(wrong.load(), 0);
+    EXPECT_LE(c.size(), 256U);
+}
+
+TEST(Cache, UnifiedCachesTest) {
+    using strings_cache = concurrent_cache<default_traits, std::string, std::string>;
+    using numbers_cache = lru_cache<default_traits, int, int, memory_gate<>>;
+
+    enable_owner_traits<default_traits>          t;
+    unified_caches<strings_cache, numbers_cache> caches{t};
+    caches.strings_cache::set("one", "1");
+    caches.numbers_cache::set(1, 1);
+    EXPECT_EQ(caches.strings_cache::get("one"), "1");
+    EXPECT_EQ(caches.numbers_cache::get(1), 1);
+    static_assert(decltype(caches)::can_use_as_key<int>());
+}
+
+namespace {
+    // a clock that only moves when it's told to
+    struct test_clock {
+        using duration                  = std::chrono::milliseconds;
+        using rep                       = duration::rep;
+        using period                    = duration::period;
+        using time_point                = std::chrono::time_point<test_clock>;
+        static constexpr bool is_steady = false;
+
+        static inline time_point current{std::chrono::hours{1}};
+
+        static time_point now() noexcept {
+            return current;
+        }
+    };
+
+    template <typename KeyT, typename ValueT, typename GateT = memory_gate<>>
+    using test_expiring_cache = cache<default_traits, KeyT, ValueT, expiring_strategy<test_clock>, GateT>;
+} // namespace
+
+TEST(Cache, ExpiringCacheTest) {
+    using namespace std::chrono_literals;
+
+    enable_owner_traits<default_traits> t;
+    test_expiring_cache<int, int>       c{t, 10s};
+    c.set(1, 1);
+    c.set(2, 2, 30s);
+    c.set(3, 3, 90min);
+    EXPECT_EQ(c.get(1), 1);
+    EXPECT_EQ(*c.get_ptr(2), 2);
+
+    test_clock::current += 10s;
+    EXPECT_FALSE(c.get(1)); // lazily dropped
+    EXPECT_EQ(c.size(), 2);
+    EXPECT_EQ(c.get(2), 2);
+
+    test_clock::current += 25s;
+    EXPECT_EQ(c.sweep(), 1); // only the second one
+    EXPECT_EQ(c.size(), 1);
+    EXPECT_TRUE(c.get_ptr(2) == nullptr);
+
+    // setting it again extends it
+    c.set(3, 4, 1min);
+    test_clock::current += 59s;
+    EXPECT_EQ(c.sweep(), 0);
+    EXPECT_EQ(c.get(3), 4);
+    test_clock::current += 2s;
+    EXPECT_EQ(c.sweep(), 1);
+    EXPECT_EQ(c.size(), 0);
+
+    // further than the wheel holds, with one second ticks (~194 days)
+    c.set(5, 5, std::chrono::days{200});
+    test_clock::current += std::chrono::days{199};
+    EXPECT_EQ(c.sweep(), 0);
+    EXPECT_EQ(c.get(5), 5);
+    test_clock::current += std::chrono::days{1} + 1s; // it's swept in the tick after it expires
+    EXPECT_EQ(c.sweep(), 1);
+}
+
+TEST(Cache, ExpiringDirectoryGateTest) {
+    using namespace std::chrono_literals;
+
+    enable_owner_traits<default_traits> t;
+    auto                                dir  = stl::filesystem::temp_directory_path();
+    dir                                     /= "webpp-expiring-cache-test";
+    stl::filesystem::create_directory(dir);
+    {
+        test_expiring_cache<int, std::string, directory_gate> c{t, 1min, dir, "expiring"};
+        c.set(1, "one");
+        c.set(2, "two", 1h);
+        EXPECT_EQ(c.get(1), "one");
+    }
+
+    // the expiry times are in the files
+    test_expiring_cache<int, std::string, directory_gate> c{t, 1min, dir, "expiring"};
+    EXPECT_EQ(c.size(), 0);
+    test_clock::current += 2min;
+    EXPECT_FALSE(c.get(1));
+    EXPECT_EQ(c.get(2), "two");
+    EXPECT_EQ(c.size(), 1);
+    test_clock::current += 1h;
+    EXPECT_EQ(c.sweep(), 1);
+    EXPECT_FALSE(c.get(2));
+
+    stl::filesystem::remove_all(dir);
+}
+
+TEST(Cache, FileGateTest) {
+    using gate_type = file_gate::storage_gate<default_traits, std::string, std::string, std::size_t>;
+
+    enable_owner_traits<default_traits> t;
+    auto const file = stl::filesystem::temp_directory_path() / "webpp-file-gate-test.cache";
+    stl::filesystem::remove(file);
+    {
+        gate_type gate{t, file};
+        gate.set("one", "value", 1);
+        gate.set("two", "value 2", 2);
+        gate.set("one", "new value", 3);
+        gate.set("three", "", 4);
+        gate.erase("two");
+        EXPECT_EQ(gate.size(), 2);
+        EXPECT_EQ(gate.get("one")->value, "new value");
+        EXPECT_EQ(gate.get("one")->options, 3);
+        EXPECT_EQ(gate.view("one"), "new value");
+        EXPECT_EQ(gate.view("three"), "");
+        EXPECT_FALSE(gate.get("two"));
+        gate.set_options("three", 5);
+        EXPECT_EQ(gate.get("three")->options, 5);
+    }
+
+    // replay the log
+    {
+        gate_type gate{t, file};
+        EXPECT_EQ(gate.size(), 2);
+        EXPECT_EQ(gate.view("one"), "new value");
+        EXPECT_EQ(gate.get("three")->options, 5);
+        EXPECT_FALSE(gate.get("two"));
+    }
+
+    // a crash in the middle of writing the last record
+    auto const size = stl::filesystem::file_size(file);
+    {
+        gate_type gate{t, file};
+        gate.set("four", "a long value that is not written completely");
+    }
+    stl::filesystem::resize_file(file, stl::filesystem::file_size(file) - 10);
+    {
+        gate_type gate{t, file};
+        EXPECT_EQ(gate.size(), 2);
+        EXPECT_FALSE(gate.get("four"));
+        EXPECT_EQ(gate.file_bytes(), size);
+        gate.set("four", "4");
+        EXPECT_EQ(gate.view("four"), "4");
+    }
+    {
+        gate_type gate{t, file};
+        EXPECT_EQ(gate.size(), 3);
+        EXPECT_EQ(gate.view("four"), "4");
+    }
+
+    stl::filesystem::remove(file);
+
+    // without a path, the file is temporary
+    stl::filesystem::path temp_file;
+    {
+        gate_type gate{t};
+        gate.set("one", "1");
+        temp_file = gate.path();
+        EXPECT_TRUE(stl::filesystem::exists(temp_file));
+        EXPECT_EQ(stl::filesystem::status(temp_file).permissions(),
+                  stl::filesystem::perms::owner_read | stl::filesystem::perms::owner_write);
+        EXPECT_EQ(stl::filesystem::status(temp_file.parent_path()).permissions(),
+                  stl::filesystem::perms::owner_all);
+    }
+    EXPECT_FALSE(stl::filesystem::exists(temp_file));
+    EXPECT_FALSE(stl::filesystem::exists(temp_file.parent_path()));
+}
+
+TEST(Cache, FileGateCompactionTest) {
+    using gate_type = file_gate::storage_gate<default_traits, int, std::string, std::size_t>;
+
+    enable_owner_traits<default_traits> t;
+    auto const file = stl::filesystem::temp_directory_path() / "webpp-file-gate-compaction-test.cache";
+    stl::filesystem::remove(file);
+    {
+        gate_type gate{t, file, {.min_garbage = 4096}};
+        for (int round = 0; round != 100; ++round) {
+            for (int key = 0; key != 50; ++key) {
+                gate.set(key, std::to_string(key * round));
+            }
+        }
+        EXPECT_EQ(gate.size(), 50);
+        EXPECT_LT(gate.file_bytes(), 3 * 8192); // compacted
+        for (int key = 0; key != 50; ++key) {
+            EXPECT_EQ(gate.view(key), std::to_string(key * 99));
+        }
+        gate.erase_if([](auto const& data) {
+            return data.key % 2 == 0;
+        });
+        EXPECT_EQ(gate.size(), 25);
+        gate.compact();
+        EXPECT_EQ(gate.get(1)->value, "99");
+    }
+    {
+        gate_type gate{t, file};
+        EXPECT_EQ(gate.size(), 25);
+        EXPECT_FALSE(gate.get(2));
+        EXPECT_EQ(gate.get(49)->value, std::to_string(49 * 99));
+    }
+
+    // as the gate of a cache
+    {
+        lru_cache<default_traits, int, std::string, file_gate> c{t, 2, file};
+        c.set(100, "hundred");
+        EXPECT_EQ(c.get(100), "hundred");
+        EXPECT_EQ(c.get(1), "99"); // from the file
+    }
+
+    stl::filesystem::remove(file);
+}
+
 // NOLINTEND(*-magic-numbers)
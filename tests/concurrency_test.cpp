@@ -2,9 +2,18 @@
 
 
 #include "../webpp/concurrency/atomic_counter.hpp"
+#include "../webpp/concurrency/mpmc_queue.hpp"
+#include "../webpp/concurrency/task.hpp"
+#include "../webpp/concurrency/task_manager.hpp"
+#include "../webpp/concurrency/thread_pool.hpp"
+#include "../webpp/concurrency/work_stealing_deque.hpp"
 #include "common/tests_common_pch.hpp"
 
+#include <array>
+#include <latch>
+#include <memory>
 #include <thread>
+#include <vector>
 
 using namespace webpp;
 using namespace webpp::stl;
@@ -49,4 +58,259 @@ TEST(ConcurrencyTest, STDAtomicCounter) {
     EXPECT_LT(counter, 3000);
 }
 
+TEST(ConcurrencyTest, MPMCQueueBounds) {
+    mpmc_queue<int> queue{3};
+    EXPECT_EQ(queue.capacity(), 4);
+    EXPECT_TRUE(queue.empty_approx());
+
+    for (int i = 0; i != 4; i++) {
+        EXPECT_TRUE(queue.try_push(i));
+    }
+    EXPECT_FALSE(queue.try_push(4)) << "The queue should be full";
+    EXPECT_EQ(queue.size_approx(), 4);
+
+    int value = -1;
+    for (int i = 0; i != 4; i++) {
+        EXPECT_TRUE(queue.try_pop(value));
+        EXPECT_EQ(value, i);
+    }
+    EXPECT_FALSE(queue.try_pop(value)) << "The queue should be empty";
+
+    // wrapping around
+    EXPECT_TRUE(queue.try_push(10));
+    EXPECT_TRUE(queue.try_pop(value));
+    EXPECT_EQ(value, 10);
+}
+
+TEST(ConcurrencyTest, MPMCQueueThreads) {
+    constexpr int   per_thread = 10'000;
+    constexpr int   producers  = 4;
+    mpmc_queue<int> queue{64};
+
+    atomic<long long> sum{0};
+    atomic<int>       popped{0};
+
+    vector<thread> threads;
+    for (int p = 0; p != producers; p++) {
+        threads.emplace_back([&] {
+            for (int i = 1; i <= per_thread; i++) {
+                while (!queue.try_push(i)) {
+                    this_thread::yield();
+                }
+            }
+        });
+        threads.emplace_back([&] {
+            int value = 0;
+            while (popped.load() != producers * per_thread) {
+                if (queue.try_pop(value)) {
+                    sum += value;
+                    ++popped;
+                } else {
+                    this_thread::yield();
+                }
+            }
+        });
+    }
+    for (auto& cur_th : threads) {
+        cur_th.join();
+    }
+
+    EXPECT_EQ(popped.load(), producers * per_thread);
+    EXPECT_EQ(sum.load(), producers * (static_cast<long long>(per_thread) * (per_thread + 1) / 2));
+    EXPECT_TRUE(queue.empty_approx());
+}
+
+TEST(ConcurrencyTest, TaskSmallBuffer) {
+    int  value = 0;
+    task small{[&value] {
+        ++value;
+    }};
+    static_assert(task::is_inline<decltype([&value] {
+        ++value;
+    })>);
+    EXPECT_TRUE(small);
+    small();
+    EXPECT_FALSE(small) << "A task runs only once";
+    EXPECT_EQ(value, 1);
+
+    // move-only, and too big to be inline
+    auto ptr = std::make_unique<int>(10);
+    task big{[ptr = std::move(ptr), &value, padding = std::array<char, 64>{}] {
+        value += *ptr + padding[0];
+    }};
+    task moved{std::move(big)};
+    EXPECT_FALSE(big); // NOLINT(bugprone-use-after-move)
+    moved();
+    EXPECT_EQ(value, 11);
+
+    // destroyed without running
+    auto counter = std::make_shared<int>(0);
+    {
+        task unused{[counter] {
+            ++*counter;
+        }};
+        EXPECT_EQ(counter.use_count(), 2);
+    }
+    EXPECT_EQ(counter.use_count(), 1);
+    EXPECT_EQ(*counter, 0);
+}
+
+TEST(ConcurrencyTest, WorkStealingDequeOrder) {
+    work_stealing_deque<int> deque{2};
+    for (int i = 0; i != 10; i++) {
+        deque.push(i); // it grows
+    }
+    EXPECT_GE(deque.capacity(), 10);
+    EXPECT_EQ(deque.size_approx(), 10);
+
+    // the owner takes the newest, the thieves steal the oldest
+    EXPECT_EQ(deque.take(), 9);
+    EXPECT_EQ(deque.steal(), 0);
+    EXPECT_EQ(deque.steal(), 1);
+    EXPECT_EQ(deque.take(), 8);
+    for (int i = 2; i != 8; i++) {
+        EXPECT_EQ(deque.steal(), i);
+    }
+    EXPECT_FALSE(deque.take());
+    EXPECT_FALSE(deque.steal());
+}
+
+TEST(ConcurrencyTest, WorkStealingDequeThreads) {
+    constexpr int            total   = 100'000;
+    constexpr int            thieves = 3;
+    work_stealing_deque<int> deque{16};
+
+    atomic<long long> sum{0};
+    atomic<int>       taken{0};
+
+    vector<thread> threads;
+    for (int t = 0; t != thieves; t++) {
+        threads.emplace_back([&] {
+            while (taken.load() != total) {
+                if (auto value = deque.steal()) {
+                    sum += *value;
+                    ++taken;
+                }
+            }
+        });
+    }
+    for (int i = 1; i <= total; i++) {
+        deque.push(i);
+        if (i % 3 == 0) {
+            if (auto value = deque.take()) {
+                sum += *value;
+                ++taken;
+            }
+        }
+    }
+    while (auto value = deque.take()) {
+        sum += *value;
+        ++taken;
+    }
+    for (auto& cur_th : threads) {
+        cur_th.join();
+    }
+
+    EXPECT_EQ(taken.load(), total);
+    EXPECT_EQ(sum.load(), static_cast<long long>(total) * (total + 1) / 2);
+}
+
+TEST(ConcurrencyTest, ThreadPoolFanOut) {
+    constexpr int   tasks = 10'000;
+    thread_pool<>   pool{4};
+    atomic<int>     executed{0};
+    std::latch      done{tasks};
+
+    for (int i = 0; i != tasks; i++) {
+        pool.post([&] {
+            ++executed;
+            done.count_down();
+        });
+    }
+    done.wait();
+    EXPECT_EQ(executed.load(), tasks);
+}
+
+TEST(ConcurrencyTest, ThreadPoolNested) {
+    constexpr int parents  = 100;
+    constexpr int children = 100;
+    thread_pool<> pool{4};
+    atomic<int>   executed{0};
+    std::latch    done{parents * children};
+
+    for (int i = 0; i != parents; i++) {
+        pool.post([&] {
+            EXPECT_TRUE(pool.is_current_thread());
+            for (int j = 0; j != children; j++) {
+                pool.post([&] {
+                    ++executed;
+                    done.count_down();
+                });
+            }
+        });
+    }
+    done.wait();
+    EXPECT_EQ(executed.load(), parents * children);
+    EXPECT_FALSE(pool.is_current_thread());
+}
+
+TEST(ConcurrencyTest, ThreadPoolJoin) {
+    atomic<int> executed{0};
+    {
+        thread_pool<> pool{2};
+        for (int i = 0; i != 1'000; i++) {
+            pool.post([&] {
+                ++executed;
+            });
+        }
+        pool.join(); // runs everything that's posted already
+        EXPECT_EQ(executed.load(), 1'000);
+
+        EXPECT_FALSE(pool.post([&] {
+            ++executed;
+        }));
+        EXPECT_EQ(executed.load(), 1'001) << "The caller should run it after the pool is joined";
+    }
+
+    {
+        task_system<std::allocator<std::byte>> tasks;
+        for (int i = 0; i != 100; i++) {
+            tasks.async_([&] {
+                ++executed;
+            });
+        }
+    }
+    EXPECT_EQ(executed.load(), 1'101);
+}
+
+TEST(ConcurrencyTest, ThreadPoolPostWhileJoining) {
+    constexpr int posters = 4;
+    constexpr int tasks   = 10'000;
+    for (int round = 0; round != 20; round++) {
+        atomic<int> executed{0};
+        {
+            thread_pool<>            pool{2};
+            std::latch               ready{posters + 1};
+            std::vector<std::thread> threads;
+            threads.reserve(posters);
+            for (int i = 0; i != posters; i++) {
+                threads.emplace_back([&] {
+                    ready.arrive_and_wait();
+                    for (int j = 0; j != tasks; j++) {
+                        pool.post([&] {
+                            ++executed;
+                        });
+                    }
+                });
+            }
+            ready.arrive_and_wait();
+            pool.join();
+            for (auto& cur : threads) {
+                cur.join();
+            }
+        }
+        ASSERT_EQ(executed.load(), posters * tasks) << "A task that's posted while joining is lost";
+    }
+}
+
 // NOLINTEND(*-magic-numbers)
@@ -626,3 +626,113 @@ TEST(DynamicRouter, PathWithQueries) {
     EXPECT_EQ(res.headers.status_code(), status_code::ok);
     EXPECT_EQ(as<std::string>(res.body), "parsed") << as<std::string>(res.body);
 }
+
+TEST(DynamicRouter, RouteIndexLookup) {
+    using index_type  = basic_route_index<default_dynamic_traits>;
+    using prefix_type = typename index_type::prefix_type;
+
+    auto const add = [](index_type& index, std::initializer_list<std::string_view> segs, bool exact) {
+        prefix_type prefix;
+        for (auto const seg : segs) {
+            prefix.append_segment(seg);
+        }
+        if (exact) {
+            prefix.end_path();
+        }
+        index.insert(prefix);
+    };
+    auto const lookup = [](index_type const& index, std::string_view path_str) {
+        uri::basic_path<std::string> path{path_str};
+        path.normalize(true);
+        auto const candidates = index.lookup(path);
+        return std::vector<index_type::index_type>{candidates.begin(), candidates.end()};
+    };
+    using list = std::vector<index_type::index_type>;
+
+    index_type index;
+    add(index, {"api", "users", "list"}, true); // 0
+    add(index, {}, false);                      // 1: can't be indexed
+    add(index, {"api", "users"}, false);        // 2: splits the first one
+    add(index, {"api", "posts"}, true);         // 3: splits again
+    add(index, {"static"}, false);              // 4
+
+    EXPECT_EQ(lookup(index, "/api/users/list"), (list{0, 1, 2}));
+    EXPECT_EQ(lookup(index, "/api/users/list/more"), (list{1, 2}));
+    EXPECT_EQ(lookup(index, "/api/users/1"), (list{1, 2}));
+    EXPECT_EQ(lookup(index, "/api/users"), (list{1, 2}));
+    EXPECT_EQ(lookup(index, "/api/posts"), (list{1, 3}));
+    EXPECT_EQ(lookup(index, "/api/posts/1"), (list{1}));
+    EXPECT_EQ(lookup(index, "/api"), (list{1}));
+    EXPECT_EQ(lookup(index, "/static/style.css"), (list{1, 4}));
+    EXPECT_EQ(lookup(index, "/"), (list{1}));
+}
+
+TEST(DynamicRouter, IndexedRoutesKeepTheOrder) {
+    enable_owner_traits<default_dynamic_traits> etraits;
+    dynamic_router                              router{etraits};
+
+    router += router / "api" / "users" % "list" >> [] {
+        return "list";
+    };
+    router += [](context& ctx) {
+        // not indexed, it should run for every path
+        if (ctx.path_traverser().get_path().size() == 3) {
+            ctx.response = "any three segments";
+        }
+    };
+    router += router / "api" / "users" >> [] {
+        return "user";
+    };
+    router += http::post / "api" % "posts" >> [] {
+        return "new post";
+    };
+    router += http::get / "api" % "posts" >> [] {
+        return "posts";
+    };
+
+    request req{etraits};
+    req.method("GET");
+
+    auto const body_of = [&](std::string_view uri) {
+        req.uri(uri);
+        HTTPResponse auto const res = router(req);
+        if (res.headers.status_code() != status_code::ok) {
+            return std::string{"not found"};
+        }
+        return as<std::string>(res.body);
+    };
+
+    EXPECT_EQ(body_of("/api/users/list"), "list") << router.to_string();
+    EXPECT_EQ(body_of("/api/users/one"), "any three segments");
+    EXPECT_EQ(body_of("/api/users"), "user");
+    EXPECT_EQ(body_of("/api/users/one/two"), "user");
+    EXPECT_EQ(body_of("/api/posts"), "posts");
+    EXPECT_EQ(body_of("/api/posts/one"), "any three segments");
+    EXPECT_EQ(body_of("/api"), "not found");
+
+    req.method("POST");
+    EXPECT_EQ(body_of("/api/posts"), "new post");
+}
+
+TEST(DynamicRouter, IndexedRoutesAfterResettingThePath) {
+    enable_owner_traits<default_dynamic_traits> etraits;
+    dynamic_router                              router{etraits};
+
+    router += router / "old" >> [](context& ctx) {
+        ctx.reset_path("/new/page");
+    };
+    router += router / "old" >> [] {
+        return "old";
+    };
+    router += router / "new" >> [] {
+        return "new";
+    };
+
+    request req{etraits};
+    req.method("GET");
+    req.uri("/old");
+
+    HTTPResponse auto const res = router(req);
+    EXPECT_EQ(res.headers.status_code(), status_code::ok);
+    EXPECT_EQ(as<std::string>(res.body), "new") << router.to_string();
+}
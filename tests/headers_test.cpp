@@ -1,7 +1,13 @@
 // Created by moisrex on 6/4/24.
+#include "../webpp/http/header_fields.hpp"
+#include "../webpp/http/known_headers.hpp"
+#include "../webpp/http/response_headers.hpp"
 #include "../webpp/http/status_code.hpp"
+#include "../webpp/traits/enable_traits.hpp"
 #include "common/tests_common_pch.hpp"
 
+#include <string>
+
 
 using namespace webpp;
 
@@ -11,3 +17,99 @@ TEST(HeadersTest, StatusCodeSerialize) {
     EXPECT_EQ(std::format("{}", http::status_code::forbidden), "403 Forbidden");
 }
 #endif
+
+TEST(HeadersTest, KnownHeaders) {
+    static_assert(http::known_header("Content-Type") == http::header_id::content_type);
+    static_assert(http::header_name_hash("Content-Type") == http::header_name_hash("content-type"));
+
+    EXPECT_EQ(http::known_header("content-length"), http::header_id::content_length);
+    EXPECT_EQ(http::known_header("X-Requested-With"), http::header_id::x_requested_with);
+    EXPECT_EQ(http::known_header("x-custom-header"), http::header_id::unknown);
+    EXPECT_EQ(http::known_header(""), http::header_id::unknown);
+
+    // every name should be found by its own id
+    for (std::size_t index = 1; index != http::known_header_names.size(); ++index) {
+        EXPECT_EQ(http::known_header(http::known_header_names[index]), static_cast<http::header_id>(index))
+          << http::known_header_names[index];
+    }
+}
+
+TEST(HeadersTest, FieldIsName) {
+    http::header_field_view<> const known{"Content-Type", "text/html"};
+    http::header_field_view<> const unknown{"X-Custom", "value"};
+
+    EXPECT_EQ(known.name_id(), http::header_id::content_type);
+    EXPECT_EQ(unknown.name_id(), http::header_id::unknown);
+    EXPECT_TRUE(known.is_name(http::header_id::content_type));
+    EXPECT_TRUE(known.is_name(http::header_name_key{"CONTENT-TYPE"}));
+    EXPECT_FALSE(known.is_name(http::header_id::content_length));
+    EXPECT_TRUE(unknown.is_name(http::header_name_key{"x-custom"}));
+    EXPECT_FALSE(unknown.is_name(http::header_name_key{"x-customs"}));
+    EXPECT_FALSE(unknown.is_name(http::header_id::content_type));
+}
+
+using headers_t = http::response_headers<http::header_fields_provider<http::header_field_of<default_traits>>>;
+
+TEST(HeadersTest, IndexedLookup) {
+    enable_owner_traits<default_traits> etraits;
+    headers_t                           headers{etraits};
+    headers.set("Content-Type", "text/plain");
+    headers.set("Set-Cookie", "one=1");
+    headers.set("X-Custom", "custom");
+    headers.set("set-cookie", "two=2");
+
+    EXPECT_EQ(headers.get("content-type"), "text/plain");
+    EXPECT_EQ(headers.get(http::header_id::content_type), "text/plain");
+    EXPECT_EQ(headers.get("x-CUSTOM"), "custom");
+    EXPECT_EQ(headers.get("Set-Cookie"), "one=1"); // the first one
+    EXPECT_TRUE(headers.has(http::header_id::set_cookie));
+    EXPECT_FALSE(headers.has("x-custom-2"));
+    EXPECT_FALSE(headers.has(http::header_id::content_length));
+    EXPECT_EQ(headers.has("x-custom", std::string{"Content-Length"}), std::make_tuple(true, false));
+
+    headers_t const copied{headers};
+    EXPECT_EQ(copied.get("set-cookie"), "one=1");
+    EXPECT_EQ(copied.get("X-Custom"), "custom");
+}
+
+TEST(HeadersTest, MovedFromIndex) {
+    enable_owner_traits<default_traits> etraits;
+    headers_t                           headers{etraits};
+    headers.set("Content-Type", "text/plain");
+    headers.set("X-Custom", "custom");
+
+    headers_t moved{stl::move(headers)};
+    EXPECT_EQ(moved.get("x-custom"), "custom");
+
+    // NOLINTBEGIN(bugprone-use-after-move)
+    EXPECT_FALSE(headers.has("content-type")) << "The index of the moved-from headers should be empty";
+    headers.set("X-Other", "other");
+    EXPECT_EQ(headers.get("x-other"), "other");
+    EXPECT_FALSE(headers.has("x-custom"));
+
+    headers_t assigned{etraits};
+    assigned.set("Vary", "Accept");
+    assigned = stl::move(moved);
+    EXPECT_EQ(assigned.get("content-type"), "text/plain");
+    EXPECT_FALSE(assigned.has("vary"));
+    EXPECT_FALSE(moved.has("x-custom"));
+    moved.set("Vary", "Accept");
+    EXPECT_EQ(moved.get("vary"), "Accept");
+    // NOLINTEND(bugprone-use-after-move)
+}
+
+TEST(HeadersTest, LookupWithoutIndex) {
+    enable_owner_traits<default_traits> etraits;
+    headers_t                           headers{etraits};
+
+    auto const count = headers_t::max_indexed_fields * 2;
+    for (std::size_t index = 0; index != count; ++index) {
+        headers.set("X-Header-" + std::to_string(index), std::to_string(index));
+    }
+    headers.set("Content-Length", "10");
+    for (std::size_t index = 0; index != count; ++index) {
+        EXPECT_EQ(std::string_view{headers.get("x-header-" + std::to_string(index))}, std::to_string(index));
+    }
+    EXPECT_EQ(headers.get(http::header_id::content_length), "10");
+    EXPECT_FALSE(headers.has("x-header-" + std::to_string(count)));
+}
@@ -1,9 +1,12 @@
 // Created by moisrex on 9/24/20.
 #include "../webpp/http/codec/http_lexer.hpp"
+#include "../webpp/http/codec/request_head_parser.hpp"
 #include "../webpp/http/codec/request_parser.hpp"
 #include "common/tests_common_pch.hpp"
 
+#include <random>
 #include <ranges>
+#include <tuple>
 
 using namespace webpp;
 using namespace webpp::http;
@@ -82,3 +85,361 @@ TEST(HTTPRequestParser, HeaderLexer) {
     EXPECT_EQ(lexer.header_views.at(0).at(0), "one");
     EXPECT_EQ(lexer.header_views.at(0).at(1), "1");
 }
+
+TEST(HTTPRequestParser, HeadersParserIterator) {
+    std::string_view const sample =
+      "Host: example.com\r\n"
+      "Content-Length:12\r\n"
+      "X-Spaces: \t trimmed value \t\r\n"
+      "Empty:\r\n"
+      "\r\n"
+      "the body";
+    headers_parser_iterator iter{sample};
+    EXPECT_EQ(iter.status(), parsing_status::unknown);
+
+    ++iter;
+    ASSERT_TRUE(iter.has_field());
+    EXPECT_EQ(iter.name(), "Host");
+    EXPECT_EQ(iter.value(), "example.com");
+
+    ++iter;
+    ASSERT_TRUE(iter.has_field());
+    EXPECT_EQ(iter.name(), "Content-Length");
+    EXPECT_EQ(iter.value(), "12");
+
+    ++iter;
+    ASSERT_TRUE(iter.has_field());
+    EXPECT_EQ(iter.name(), "X-Spaces");
+    EXPECT_EQ(iter.value(), "trimmed value");
+
+    ++iter;
+    ASSERT_TRUE(iter.has_field());
+    EXPECT_EQ(iter.name(), "Empty");
+    EXPECT_EQ(iter.value(), "");
+
+    ++iter;
+    EXPECT_TRUE(iter.is_done());
+    EXPECT_EQ(std::string_view(*iter), "the body");
+
+    // staying done
+    ++iter;
+    EXPECT_TRUE(iter.is_done());
+}
+
+TEST(HTTPRequestParser, HeadersParserErrors) {
+    auto status_of = [](std::string_view str) {
+        headers_parser_iterator iter{str};
+        do {
+            ++iter;
+        } while (iter.has_field());
+        return iter.status();
+    };
+    EXPECT_EQ(status_of("One: 1\r\n\r\n"), parsing_status::done);
+    EXPECT_EQ(status_of("One: 1\n\n"), parsing_status::done);
+    EXPECT_EQ(status_of("One: 1\r\n"), parsing_status::bad_eof);
+    EXPECT_EQ(status_of("One: 1"), parsing_status::bad_eof);
+    EXPECT_EQ(status_of(": 1\r\n\r\n"), parsing_status::empty_name);
+    EXPECT_EQ(status_of("One : 1\r\n\r\n"), parsing_status::unexpected_char);
+    EXPECT_EQ(status_of("One: 1\r\n folded\r\n\r\n"), parsing_status::unexpected_char);
+    EXPECT_EQ(status_of("One: 1\r2\r\n\r\n"), parsing_status::unexpected_char);
+    EXPECT_EQ(status_of("One: a\x01z\r\n\r\n"), parsing_status::unexpected_char);
+
+    std::string err;
+    headers_parser_iterator iter{std::string_view{": 1\r\n\r\n"}};
+    ++iter;
+    iter.error_string(err);
+    EXPECT_FALSE(err.empty());
+}
+
+TEST(HTTPRequestParser, Headers) {
+    req_parser                                               parser;
+    std::vector<std::pair<std::string_view, std::string_view>> fields;
+
+    auto const status = parser.parse_header("Host: localhost\r\nAccept: */*\r\n\r\n",
+                                            [&](std::string_view name, std::string_view value) {
+                                                fields.emplace_back(name, value);
+                                            });
+    EXPECT_EQ(status, 200);
+    ASSERT_EQ(fields.size(), 2);
+    EXPECT_EQ(fields[0].first, "Host");
+    EXPECT_EQ(fields[0].second, "localhost");
+    EXPECT_EQ(fields[1].first, "Accept");
+    EXPECT_EQ(fields[1].second, "*/*");
+
+    EXPECT_EQ(400, parser.parse_header("Host localhost\r\n\r\n", [](auto, auto) {}));
+    EXPECT_EQ(400, parser.parse_header("Host: localhost\r\n", [](auto, auto) {}));
+}
+
+namespace {
+
+    // random bytes, mostly the ones that are in the HTTP heads, and the ones that the scanners look for
+    std::string random_head_bytes(std::mt19937& gen, std::size_t size) {
+        static constexpr std::string_view alphabet =
+          "abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ0123456789-_.~!#$%&'*+^`|"
+          "\"(),/:;<=>?@[\\]{} \t\r\n\x01\x7F\x80\xFF";
+        std::uniform_int_distribution<std::size_t> pick{0, alphabet.size() - 1};
+        std::uniform_int_distribution<int>         rare{0, 15};
+        std::string                                str;
+        for (std::size_t index = 0; index != size; ++index) {
+            // make the special characters rarer, so the scanners have long runs to skip over
+            str.push_back(rare(gen) == 0 ? alphabet[pick(gen)] : alphabet[pick(gen) % 62]);
+        }
+        return str;
+    }
+
+    // mutate a valid head: flip, insert, and remove random characters
+    std::string mutate_head(std::mt19937& gen, std::string str) {
+        std::uniform_int_distribution<int> count_dist{0, 3};
+        auto const                         count = count_dist(gen);
+        for (int index = 0; index != count && !str.empty(); ++index) {
+            std::uniform_int_distribution<std::size_t> pos_dist{0, str.size() - 1};
+            auto const                                 pos = pos_dist(gen);
+            auto const                                 chr = random_head_bytes(gen, 1);
+            switch (count_dist(gen)) {
+                case 0: str[pos] = chr[0]; break;
+                case 1: str.insert(pos, chr); break;
+                case 2: str.erase(pos, 1); break;
+                default: break;
+            }
+        }
+        return str;
+    }
+
+    template <typename Scanner>
+    std::vector<std::tuple<parsing_status, std::string_view, std::string_view, std::size_t>> parse_all(
+      std::string_view str) {
+        std::vector<std::tuple<parsing_status, std::string_view, std::string_view, std::size_t>> res;
+        basic_headers_parser_iterator<Scanner> iter{str};
+        do {
+            ++iter;
+            res.emplace_back(iter.status(),
+                             iter.name(),
+                             iter.value(),
+                             static_cast<std::size_t>(*iter - str.data()));
+        } while (iter.has_field());
+        return res;
+    }
+
+} // namespace
+
+TEST(HTTPRequestParser, ScannersEquivalence) {
+    std::mt19937 gen{20'261'017}; // NOLINT(cert-msc32-c,cert-msc51-cpp)
+    for (std::size_t round = 0; round != 20'000; ++round) {
+        auto const  str   = random_head_bytes(gen, round % 97);
+        auto const* first = str.data();
+        auto const* last  = str.data() + str.size();
+        ASSERT_EQ(simd_scanner::token_end(first, last), scalar_scanner::token_end(first, last)) << str;
+        ASSERT_EQ(simd_scanner::value_end(first, last), scalar_scanner::value_end(first, last)) << str;
+        ASSERT_EQ(simd_scanner::target_end(first, last), scalar_scanner::target_end(first, last)) << str;
+    }
+
+    // the constant evaluation uses the scalar scanner
+    static_assert([] {
+        basic_headers_parser_iterator<simd_scanner> iter{std::string_view{"Name: the value \r\n\r\n"}};
+        ++iter;
+        return iter.name() == "Name" && iter.value() == "the value";
+    }());
+}
+
+TEST(HTTPRequestParser, HeadersParserFuzzEquivalence) {
+    static constexpr std::string_view valid =
+      "Host: www.example.com\r\n"
+      "User-Agent: Mozilla/5.0 (X11; Linux x86_64; rv:131.0) Gecko/20100101 Firefox/131.0\r\n"
+      "Accept: text/html,application/xhtml+xml,application/xml;q=0.9,*/*;q=0.8\r\n"
+      "Accept-Language: en-US,en;q=0.5\r\n"
+      "X-Tabs:\tvalue\twith\ttabs \t\r\n"
+      "Cookie: session=0123456789abcdef; theme=dark\r\n"
+      "\r\n"
+      "body";
+
+    EXPECT_EQ(parse_all<simd_scanner>(valid), parse_all<scalar_scanner>(valid));
+    EXPECT_EQ(std::get<0>(parse_all<simd_scanner>(valid).back()), parsing_status::done);
+
+    std::mt19937 gen{1'017}; // NOLINT(cert-msc32-c,cert-msc51-cpp)
+    for (std::size_t round = 0; round != 20'000; ++round) {
+        auto const str = mutate_head(gen, std::string{valid});
+        ASSERT_EQ(parse_all<simd_scanner>(str), parse_all<scalar_scanner>(str)) << str;
+    }
+}
+
+TEST(HTTPRequestParser, RequestLineFuzzEquivalence) {
+    static constexpr std::string_view valid = "GET /api/v1/items?page=2&sort=name%20asc HTTP/1.1";
+
+    std::mt19937 gen{2'017}; // NOLINT(cert-msc32-c,cert-msc51-cpp)
+    for (std::size_t round = 0; round != 20'000; ++round) {
+        auto const                                      str = mutate_head(gen, std::string{valid});
+        http_request_parser<std_traits, simd_scanner>   simd;
+        http_request_parser<std_traits, scalar_scanner> scalar;
+        ASSERT_EQ(simd.parse_request_line(str), scalar.parse_request_line(str)) << str;
+        ASSERT_EQ(simd.method_view, scalar.method_view) << str;
+        ASSERT_EQ(simd.request_target_view, scalar.request_target_view) << str;
+        ASSERT_EQ(simd.http_version_view, scalar.http_version_view) << str;
+    }
+
+    req_parser parser;
+    EXPECT_EQ(400, parser.parse_request_line("G\x01T / HTTP/1.1"));
+    EXPECT_EQ(400, parser.parse_request_line("GET /a\tb HTTP/1.1"));
+    EXPECT_EQ(400, parser.parse_request_line("GET  HTTP/1.1"));
+    auto const long_line = "GET /" + std::string(req_parser::URI_LIMIT, 'a') + " HTTP/1.1";
+    EXPECT_EQ(414, parser.parse_request_line(long_line));
+}
+
+namespace {
+
+    using head_parser = http_request_head_parser<std_traits>;
+
+    struct head_result {
+        std::size_t                                      status = 0;
+        std::size_t                                      size   = 0;
+        std::string                                      method;
+        std::string                                      target;
+        std::vector<std::pair<std::string, std::string>> fields;
+
+        bool operator==(head_result const&) const = default;
+    };
+
+    // feed the head to the parser, "chunk" bytes at a time (all of it at once if it's zero)
+    template <typename ParserT = head_parser>
+    head_result feed_head(std::string_view const str, std::size_t const chunk, ParserT&& parser = {}) {
+        head_result res;
+        std::size_t received = 0;
+        do {
+            received   = chunk == 0 ? str.size() : std::min(str.size(), received + chunk);
+            res.status = parser.feed(str.substr(0, received), [&](auto name, auto value) {
+                res.fields.emplace_back(name, value);
+            });
+        } while (res.status == head_parser::need_more && received != str.size());
+        res.size = parser.head_size();
+        if (parser.has_request_line()) {
+            res.method = parser.method(str);
+            res.target = parser.target(str);
+        }
+        return res;
+    }
+
+    // counts the characters that the parser asks the scanner to look at
+    struct counting_scanner {
+        static inline std::size_t scanned = 0;
+
+        static char const* token_end(char const* pos, char const* end) noexcept {
+            return count(pos, scalar_scanner::token_end(pos, end), end);
+        }
+
+        static char const* value_end(char const* pos, char const* end) noexcept {
+            return count(pos, scalar_scanner::value_end(pos, end), end);
+        }
+
+        static char const* target_end(char const* pos, char const* end) noexcept {
+            return count(pos, scalar_scanner::target_end(pos, end), end);
+        }
+
+      private:
+        static char const* count(char const* pos, char const* res, char const* end) noexcept {
+            scanned += static_cast<std::size_t>(res - pos) + (res == end ? 0 : 1);
+            return res;
+        }
+    };
+
+    constexpr std::string_view valid_head =
+      "POST /api/v1/items?page=2&sort=name%20asc HTTP/1.1\r\n"
+      "Host: www.example.com\r\n"
+      "User-Agent: Mozilla/5.0 (X11; Linux x86_64; rv:131.0) Gecko/20100101 Firefox/131.0\r\n"
+      "Accept: text/html,application/xhtml+xml,application/xml;q=0.9,*/*;q=0.8\r\n"
+      "X-Tabs:\tvalue\twith\ttabs \t\r\n"
+      "Content-Length: 4\r\n"
+      "\r\n"
+      "body";
+
+} // namespace
+
+TEST(HTTPRequestParser, RequestHeadParser) {
+    auto const res = feed_head(valid_head, 0);
+    EXPECT_EQ(res.status, 200);
+    EXPECT_EQ(res.size, valid_head.size() - 4);
+    EXPECT_EQ(res.method, "POST");
+    EXPECT_EQ(res.target, "/api/v1/items?page=2&sort=name%20asc");
+    ASSERT_EQ(res.fields.size(), 5);
+    EXPECT_EQ(res.fields[3], (std::pair<std::string, std::string>{"X-Tabs", "value\twith\ttabs"}));
+
+    // the same as the one-shot parser
+    req_parser                                       parser;
+    auto const                                       line_end = valid_head.find("\r\n");
+    std::vector<std::pair<std::string, std::string>> fields;
+    EXPECT_EQ(200, parser.parse_request_line(valid_head.substr(0, line_end)));
+    EXPECT_EQ(200, parser.parse_header(valid_head.substr(line_end + 2), [&](auto name, auto value) {
+        fields.emplace_back(name, value);
+    }));
+    EXPECT_EQ(res.method, parser.method_view);
+    EXPECT_EQ(res.target, parser.request_target_view);
+    EXPECT_EQ(res.fields, fields);
+
+    head_parser ver_parser;
+    EXPECT_EQ(200, ver_parser.feed("GET / HTTP/1.0\n\n", [](auto, auto) {}));
+    EXPECT_EQ(ver_parser.version().minor_value(), 0);
+    EXPECT_EQ(ver_parser.head_size(), 16);
+}
+
+TEST(HTTPRequestParser, RequestHeadParserResumable) {
+    for (std::size_t chunk = 1; chunk != 40; ++chunk) {
+        ASSERT_EQ(feed_head(valid_head, chunk), feed_head(valid_head, 0)) << chunk;
+    }
+
+    // it doesn't matter how the bytes arrive, the result should be the same
+    std::mt19937 gen{3'017}; // NOLINT(cert-msc32-c,cert-msc51-cpp)
+    for (std::size_t round = 0; round != 5'000; ++round) {
+        auto const str   = mutate_head(gen, std::string{valid_head});
+        auto const whole = feed_head(str, 0);
+        ASSERT_EQ(feed_head(str, 1), whole) << str;
+        ASSERT_EQ(feed_head(str, 1 + (round % 13)), whole) << str;
+    }
+
+    // the buffer may move between the feeds
+    head_parser parser;
+    std::string buf{"GET /index.html HT"};
+    EXPECT_EQ(head_parser::need_more, parser.feed(buf, [](auto, auto) {}));
+    buf += "TP/1.1\r\nHost: example.com\r\n\r\n";
+    buf.shrink_to_fit();
+    std::string host;
+    EXPECT_EQ(200, parser.feed(buf, [&](auto, auto value) {
+        host = value;
+    }));
+    EXPECT_EQ(parser.target(buf), "/index.html");
+    EXPECT_EQ(host, "example.com");
+}
+
+TEST(HTTPRequestParser, RequestHeadParserLimits) {
+    // the errors are found before the rest of the head arrives
+    EXPECT_EQ(501, feed_head("LONGMETHODX", 1).status);
+    EXPECT_EQ(414, feed_head("GET /" + std::string(8000, 'a'), 0).status);
+    EXPECT_EQ(400, feed_head("GET /a\tb", 0).status);
+    EXPECT_EQ(505, feed_head("GET / HTTP/2.0\r\n", 0).status);
+    EXPECT_EQ(400, feed_head("GET / HTTP/1.1\r\nHost : x\r\n", 0).status);
+    EXPECT_EQ(400, feed_head("GET / HTTP/1.1\r\n folded\r\n", 0).status);
+
+    head_parser parser;
+    parser.limits = {.method = 4, .uri = 16, .header = 64};
+    EXPECT_EQ(501, parser.feed("POST / HTTP/1.1\r\n\r\n", [](auto, auto) {}));
+    parser.reset();
+    EXPECT_EQ(414, parser.feed("GET /0123456789abcdef", [](auto, auto) {}));
+    parser.reset();
+    EXPECT_EQ(200, parser.feed("GET /0123456789abcd HTTP/1.1\r\n\r\n", [](auto, auto) {}));
+    parser.reset();
+    auto const fields = "GET / HTTP/1.1\r\nX-Long: " + std::string(64, 'x');
+    EXPECT_EQ(431, feed_head(fields, 7, parser).status);
+    EXPECT_EQ(431, parser.status()); // stays failed
+}
+
+TEST(HTTPRequestParser, RequestHeadParserLinearWork) {
+    // a slow client that sends one byte at a time, shouldn't make us scan the same bytes again
+    std::string head{"GET / HTTP/1.1\r\n"};
+    for (int index = 0; index != 100; ++index) {
+        head += "X-Field-" + std::to_string(index) + ": " + std::string(40, 'v') + "\r\n";
+    }
+    head += "\r\n";
+
+    counting_scanner::scanned = 0;
+    auto const res            = feed_head(head, 1, http_request_head_parser<std_traits, counting_scanner>{});
+    EXPECT_EQ(res.status, 200);
+    EXPECT_EQ(res.fields.size(), 100);
+    EXPECT_LE(counting_scanner::scanned, head.size());
+}
@@ -4,11 +4,15 @@
 #include "../webpp/io/buffer.hpp"
 #include "../webpp/io/file_options.hpp"
 #include "../webpp/io/io_uring/io_uring.hpp"
+#include "../webpp/io/io_uring/io_uring_buffers.hpp"
 #include "../webpp/io/open.hpp"
 #include "common/tests_common_pch.hpp"
 
 #include <array>
+#include <cstdlib>
 #include <sstream>
+#include <sys/socket.h>
+#include <unistd.h>
 
 using namespace webpp;
 using namespace webpp::io;
@@ -80,6 +84,214 @@ TEST(IO, BasicIOUring) {
     EXPECT_EQ(executed, 2) << "Some of the callback functions didn't run";
 }
 
+TEST(IO, IOUringBufferManager) {
+    io_uring_buffer_manager<> buffers{5, 128}; // rounded up to 8 buffers
+
+    EXPECT_EQ(buffers.size(), 8);
+    EXPECT_EQ(buffers.buffer_size(), 128);
+    EXPECT_FALSE(buffers.is_registered());
+    EXPECT_EQ(buffers.buffer(0).size(), 128);
+    EXPECT_EQ(buffers.buffer(1).data(), buffers.buffer(0).data() + 128);
+    EXPECT_EQ(buffers.buffer(7, 10).size(), 10);
+    EXPECT_EQ(buffers.buffer(7, 1000).size(), 128);
+
+    io_uring_cqe cqe{};
+    EXPECT_FALSE(io_uring_buffer_manager<>::selected_id(cqe).has_value());
+    cqe.flags = IORING_CQE_F_BUFFER | (3U << IORING_CQE_BUFFER_SHIFT);
+    EXPECT_EQ(io_uring_buffer_manager<>::selected_id(cqe), 3);
+}
+
+TEST(IO, IOUringProvidedBuffers) {
+    managed_io_uring_service<> io;
+
+    ASSERT_TRUE(io.is_success());
+    if (!io.has_provided_buffers()) {
+        GTEST_SKIP() << "The kernel doesn't support provided buffer rings.";
+    }
+
+    int executed = 0;
+
+    std::array<char, 32>   path{"/tmp/webpp-io-test-XXXXXX"};
+    io::file_handle const  file{::mkstemp(path.data())};
+    std::string_view const data = "this is a text";
+    ::unlink(path.data());
+    io::syscall(syscall_write{},
+                io,
+                file,
+                buffer_view{reinterpret_cast<stl::byte const*>(data.data()), data.size()},
+                0ull,
+                [&executed](io_result const result) {
+                    ++executed;
+                    EXPECT_TRUE(result.is_ok()) << result.to_string();
+                });
+    io(1);
+
+    // the read doesn't own a buffer, the kernel picks one from the pool
+    for (int round = 0; round != 3; ++round) {
+        io::syscall(syscall_read{}, io, file, 0ull, [&io, data, &executed](io_result const result) {
+            ++executed;
+            ASSERT_TRUE(result.is_ok()) << result.to_string();
+            auto const             buf = io.selected_buffer(result);
+            std::string_view const buf_value{reinterpret_cast<char const*>(buf.data()), buf.size()};
+            EXPECT_EQ(data, buf_value);
+        });
+        io(1);
+    }
+    io::syscall(syscall_close{}, io, file);
+
+    EXPECT_EQ(executed, 4) << "Some of the callback functions didn't run";
+}
+
+TEST(IO, IOUringBatchedSubmission) {
+    managed_io_uring_service<> io;
+
+    ASSERT_TRUE(io.is_success());
+
+    std::array<int, 2> pipe_fds{};
+    ASSERT_EQ(::pipe(pipe_fds.data()), 0);
+    io::file_handle const reader{pipe_fds[0]};
+    io::file_handle const writer{pipe_fds[1]};
+
+    int                    executed = 0;
+    std::string_view const data     = "x";
+    for (int index = 0; index != 8; ++index) {
+        io::syscall(syscall_write{},
+                    io,
+                    writer,
+                    buffer_view{reinterpret_cast<stl::byte const*>(data.data()), data.size()},
+                    0ull,
+                    [&executed](io_result const result) {
+                        ++executed;
+                        EXPECT_EQ(result.value(), 1) << result.to_string();
+                    });
+    }
+
+    // nothing is submitted until the event loop runs
+    EXPECT_EQ(io.queued_count(), 8);
+    io(8);
+    EXPECT_EQ(io.queued_count(), 0);
+    EXPECT_EQ(executed, 8) << "Some of the callback functions didn't run";
+
+    std::array<char, 16> buf{};
+    EXPECT_EQ(::read(reader, buf.data(), buf.size()), 8);
+    ::close(reader);
+    ::close(writer);
+}
+
+TEST(IO, IOUringMultishotRecv) {
+    managed_io_uring_service<> io;
+
+    ASSERT_TRUE(io.is_success());
+    if (!io.has_provided_buffers()) {
+        GTEST_SKIP() << "The kernel doesn't support provided buffer rings.";
+    }
+
+    std::array<int, 2> sockets{};
+    ASSERT_EQ(::socketpair(AF_UNIX, SOCK_STREAM, 0, sockets.data()), 0);
+
+    std::string received;
+    int         executed = 0;
+    bool        more     = false;
+
+    // one request, many completions
+    io::syscall(syscall_recv{},
+                io,
+                io::file_handle{sockets[0]},
+                io::multishot,
+                [&](io_result const result) {
+                    ++executed;
+                    more     = io.has_more_completions();
+                    auto buf = io.selected_buffer(result);
+                    received.append(reinterpret_cast<char const*>(buf.data()), buf.size());
+                });
+
+    for (std::string_view const data : {"first", "second", "third"}) {
+        ASSERT_EQ(::send(sockets[1], data.data(), data.size(), 0), static_cast<ssize_t>(data.size()));
+        io(1);
+        EXPECT_TRUE(more);
+        EXPECT_EQ(received, data);
+        received.clear();
+    }
+
+    // the end of the stream is the last completion
+    ::shutdown(sockets[1], SHUT_WR);
+    io(1);
+    EXPECT_FALSE(more);
+    EXPECT_EQ(executed, 4);
+
+    ::close(sockets[0]);
+    ::close(sockets[1]);
+}
+
+TEST(IO, IOUringTimeout) {
+    managed_io_uring_service<> io;
+
+    ASSERT_TRUE(io.is_success());
+
+    int executed = 0;
+    io::syscall(syscall_timeout{}, io, std::chrono::milliseconds{5}, [&executed](io_result const result) {
+        ++executed;
+        EXPECT_EQ(result.error(), ETIME) << result.to_string();
+    });
+    io(1);
+    EXPECT_EQ(executed, 1);
+}
+
+TEST(IO, IOUringLinkedTimeout) {
+    managed_io_uring_service<> io;
+
+    ASSERT_TRUE(io.is_success());
+
+    std::array<int, 2> sockets{};
+    ASSERT_EQ(::socketpair(AF_UNIX, SOCK_STREAM, 0, sockets.data()), 0);
+
+    // nothing to link to
+    EXPECT_FALSE(io::syscall(syscall_timeout{}, io, io::linked, std::chrono::milliseconds{5}));
+
+    // nobody sends anything, so the receive is canceled by its timeout
+    std::array<stl::byte, 16> buf{};
+    int                       executed = 0;
+    io::syscall(syscall_recv{}, io, io::file_handle{sockets[0]}, buf, [&executed](io_result const result) {
+        ++executed;
+        EXPECT_EQ(result.error(), ECANCELED) << result.to_string();
+    });
+    EXPECT_TRUE(io::syscall(syscall_timeout{}, io, io::linked, std::chrono::milliseconds{5}));
+    EXPECT_EQ(io.queued_count(), 2);
+
+    io(2); // the receive, and the timeout itself
+    EXPECT_EQ(executed, 1);
+
+    ::close(sockets[0]);
+    ::close(sockets[1]);
+}
+
+TEST(IO, IOUringCancel) {
+    managed_io_uring_service<> io;
+
+    ASSERT_TRUE(io.is_success());
+
+    std::array<int, 2> sockets{};
+    ASSERT_EQ(::socketpair(AF_UNIX, SOCK_STREAM, 0, sockets.data()), 0);
+
+    std::array<stl::byte, 16> buf{};
+    int                       executed = 0;
+    io::syscall(syscall_recv{}, io, io::file_handle{sockets[0]}, buf, [&executed](io_result const result) {
+        ++executed;
+        EXPECT_EQ(result.error(), ECANCELED) << result.to_string();
+    });
+    io.submit();
+
+    io::syscall(syscall_cancel{}, io, io::file_handle{sockets[0]}, [&executed](io_result const result) {
+        ++executed;
+        EXPECT_EQ(result.value(), 1) << result.to_string();
+    });
+    io(2);
+    EXPECT_EQ(executed, 2);
+
+    ::close(sockets[0]);
+    ::close(sockets[1]);
+}
+
 #    if 0
 TEST(IO, BasicIdea) {
     io_uring_service<> io;
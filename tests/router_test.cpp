@@ -1,6 +1,7 @@
 // #include "../webpp/cgi/cgi.hpp"
 #include "../webpp/http/bodies/string.hpp"
 #include "../webpp/http/routes/context.hpp"
+#include "../webpp/http/routes/methods.hpp"
 #include "../webpp/http/routes/path.hpp"
 #include "../webpp/http/routes/static_router.hpp"
 #include "../webpp/traits/enable_traits.hpp"
@@ -64,6 +65,68 @@ TEST(Router, RouteCreation) {
     EXPECT_EQ(as<std::string>(res3.body), "testing 2");
 }
 
+TEST(Router, StaticRouterChain) {
+    enable_owner_traits<default_dynamic_traits> etraits;
+
+    auto router = s_router;
+
+    auto const response_of = [&](std::string_view uri) {
+        request req{etraits};
+        req.method("GET");
+        req.uri(uri);
+        HTTPResponse auto res = router(req);
+        res.calculate_default_headers();
+        return res.headers.status_code_integer();
+    };
+
+    EXPECT_EQ(response_of("/page"), 200);
+    EXPECT_EQ(response_of("/test"), 404); // the first route doesn't match, so the second one is not run
+}
+
+TEST(Router, StaticRouterResetPath) {
+    enable_owner_traits<default_dynamic_traits> etraits;
+
+    int before = 0;
+    int after  = 0;
+
+    static_router router{
+      [&before](context& ctx) {
+          // runs for every request, and the next routes check the new path
+          ++before;
+          if (ctx.request.uri() == "/old") {
+              ctx.reset_path("/page/one");
+          }
+      },
+      http::get / "page" % "one" >>
+        [] {
+            return "get page one";
+        },
+      [&after] {
+          ++after;
+      }};
+
+    EXPECT_EQ(router.route_count(), 3);
+
+    auto const response_of = [&](std::string_view method, std::string_view uri) {
+        request req{etraits};
+        req.method(method);
+        req.uri(uri);
+        HTTPResponse auto const res = router(req);
+        return as<std::string>(res.body);
+    };
+
+    EXPECT_EQ(response_of("GET", "/page/one"), "get page one");
+    EXPECT_EQ(before, 1);
+    EXPECT_EQ(after, 1);
+    EXPECT_EQ(response_of("POST", "/page/one"), ""); // the method doesn't match
+    EXPECT_EQ(response_of("GET", "/page/two"), "");
+    EXPECT_EQ(response_of("GET", "/"), "");
+    EXPECT_EQ(before, 4);
+    EXPECT_EQ(after, 1); // the chain ends at the route that doesn't match
+    EXPECT_EQ(response_of("GET", "/old"), "get page one");
+    EXPECT_EQ(after, 2);
+}
+
 // namespace webpp {
 //    class fake_cgi;
 //
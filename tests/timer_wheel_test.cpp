@@ -0,0 +1,147 @@
+// Created by moisrex on 10/17/26.
+
+#include "../webpp/io/timer_wheel.hpp"
+
+#include "common/tests_common_pch.hpp"
+
+#include <array>
+#include <random>
+#include <vector>
+
+using namespace webpp;
+
+namespace {
+    struct test_timer : io::timer_wheel_node {
+        std::size_t id      = 0;
+        std::size_t fire_at = 0; // the tick it should expire in
+        std::size_t fired   = 0;
+    };
+} // namespace
+
+TEST(TimerWheel, Empty) {
+    io::timer_wheel wheel;
+    EXPECT_TRUE(wheel.empty());
+    EXPECT_EQ(wheel.advance(1'000, [](auto&) {}), 0);
+    EXPECT_EQ(wheel.now(), 1'000);
+}
+
+TEST(TimerWheel, ScheduleAndExpire) {
+    io::timer_wheel wheel;
+    test_timer      timer;
+    wheel.schedule(timer, 3);
+    EXPECT_TRUE(timer.is_scheduled());
+    EXPECT_EQ(wheel.size(), 1);
+
+    EXPECT_EQ(wheel.advance(2, [](auto&) {}), 0);
+    EXPECT_EQ(wheel.advance(1,
+                            [&](io::timer_wheel_node& node) {
+                                EXPECT_EQ(&node, &timer);
+                                EXPECT_FALSE(node.is_scheduled());
+                            }),
+              1);
+    EXPECT_TRUE(wheel.empty());
+}
+
+TEST(TimerWheel, Cancel) {
+    io::timer_wheel wheel;
+    test_timer      timer;
+    wheel.schedule(timer, 100);
+    wheel.cancel(timer);
+    EXPECT_FALSE(timer.is_scheduled());
+    EXPECT_TRUE(wheel.empty());
+    EXPECT_EQ(wheel.advance(200, [](auto&) {}), 0);
+
+    // canceling twice is fine
+    wheel.cancel(timer);
+}
+
+TEST(TimerWheel, Reschedule) {
+    io::timer_wheel wheel;
+    test_timer      timer;
+    wheel.schedule(timer, 10);
+    wheel.advance(5, [](auto&) {});
+    wheel.schedule(timer, 10);
+    EXPECT_EQ(wheel.size(), 1);
+    EXPECT_EQ(wheel.advance(9, [](auto&) {}), 0);
+    EXPECT_EQ(wheel.advance(1, [](auto&) {}), 1);
+}
+
+TEST(TimerWheel, RescheduleInCallback) {
+    io::timer_wheel wheel;
+    test_timer      timer;
+    std::size_t     fired = 0;
+    wheel.schedule(timer, 1);
+    wheel.advance(10, [&](io::timer_wheel_node& node) {
+        ++fired;
+        wheel.schedule(node, 2);
+    });
+    EXPECT_EQ(fired, 5);
+    EXPECT_TRUE(timer.is_scheduled());
+}
+
+TEST(TimerWheel, Levels) {
+    // small wheel: 4 slots per level, 3 levels; 63 ticks at most
+    io::basic_timer_wheel<3, 2> wheel;
+    std::array<test_timer, 63>  timers{};
+    for (std::size_t index = 0; index != timers.size(); ++index) {
+        timers[index].fire_at = index + 1;
+        wheel.schedule(timers[index], index + 1);
+    }
+    for (std::size_t tick = 1; tick <= timers.size(); ++tick) {
+        EXPECT_EQ(wheel.advance(1,
+                                [&](io::timer_wheel_node& node) {
+                                    EXPECT_EQ(static_cast<test_timer&>(node).fire_at, tick);
+                                }),
+                  1)
+          << tick;
+    }
+    EXPECT_TRUE(wheel.empty());
+
+    // further than the wheel can go
+    test_timer timer;
+    wheel.schedule(timer, 1'000);
+    EXPECT_EQ(wheel.advance(62, [](auto&) {}), 0);
+    EXPECT_EQ(wheel.advance(1, [](auto&) {}), 1);
+}
+
+TEST(TimerWheel, RandomDeadlines) {
+    io::basic_timer_wheel<3, 3> wheel; // 511 ticks at most
+    std::vector<test_timer>     timers(2'000);
+    std::mt19937                gen{42}; // NOLINT(cert-msc32-c,cert-msc51-cpp)
+    std::uniform_int_distribution<std::size_t> dist{1, 511};
+
+    std::size_t now       = 0;
+    auto const  on_expire = [&](io::timer_wheel_node& node) {
+        auto& timer = static_cast<test_timer&>(node);
+        ++timer.fired;
+        EXPECT_EQ(timer.fire_at, now) << timer.id;
+    };
+
+    // schedule them while the clock is moving, so they're not aligned to the slots
+    for (std::size_t index = 0; index != timers.size(); ++index) {
+        if (index % 10 == 0) {
+            ++now;
+            wheel.advance(1, on_expire);
+        }
+        auto const ticks      = dist(gen);
+        timers[index].id      = index;
+        timers[index].fire_at = now + ticks;
+        wheel.schedule(timers[index], ticks);
+    }
+
+    // cancel some of them (the ones that haven't expired already)
+    for (std::size_t index = 0; index < timers.size(); index += 7) {
+        if (timers[index].is_scheduled()) {
+            wheel.cancel(timers[index]);
+            timers[index].fire_at = 0;
+        }
+    }
+
+    while (!wheel.empty()) {
+        ++now;
+        wheel.advance(1, on_expire);
+    }
+    for (auto const& timer : timers) {
+        EXPECT_EQ(timer.fired, timer.fire_at == 0 ? 0 : 1) << timer.id;
+    }
+}
@@ -0,0 +1,111 @@
+// Created by moisrex on 10/17/26.
+
+#include "../webpp/http/bodies/string.hpp"
+#include "../webpp/http/routes/dynamic_router.hpp"
+#include "../webpp/http/routes/tpath.hpp"
+#include "../webpp/traits/enable_traits.hpp"
+#include "common/tests_common_pch.hpp"
+
+#include <string>
+
+using namespace webpp;
+using namespace webpp::http;
+
+TEST(TPath, PatternParsing) {
+    using pattern = http::details::tpath_pattern<"/users/{int:user_id}/posts/p-{page}.html">;
+    static_assert(pattern::from_root);
+    static_assert(pattern::segment_count == 4);
+    static_assert(pattern::var_count == 2);
+    static_assert(pattern::index_of<"user_id"> == 0);
+    static_assert(pattern::index_of<"page"> == 1);
+    static_assert(stl::same_as<pattern::value_type<0>, stl::int32_t>);
+    static_assert(stl::same_as<pattern::value_type<1>, stl::string_view>);
+    static_assert(stl::is_trivially_destructible_v<tpath_captures<"/{uuid:id}/{uint64:num}">>);
+
+    EXPECT_EQ(pattern::view(pattern::segments[3].begin, pattern::segments[3].end), "p-");
+    EXPECT_EQ(pattern::view(pattern::segments[3].suffix_begin, pattern::segments[3].suffix_end), ".html");
+    EXPECT_FALSE(http::details::tpath_pattern<"page/{id}">::from_root);
+}
+
+TEST(TPath, TypedCaptures) {
+    enable_owner_traits<default_dynamic_traits> etraits;
+
+    constexpr auto user_post = tpath<"/users/{int:user_id}/posts/{uuid:post}/{page}">;
+
+    request req{etraits};
+    req.uri("/users/-42/posts/123E4567-e89b-12d3-a456-4266141740ff/comments");
+    context ctx{req};
+    ASSERT_TRUE(user_post(ctx));
+    EXPECT_TRUE(ctx.path_traverser().at_end());
+
+    auto const& vars = user_post.captures(ctx);
+    EXPECT_EQ(vars.size(), 3);
+    EXPECT_EQ(vars.get<"user_id">(), -42);
+    EXPECT_EQ(vars.get<0>(), -42);
+    EXPECT_EQ(vars.get<"post">().bytes[0], 0x12);
+    EXPECT_EQ(vars.get<"post">().bytes[15], 0xFF);
+    EXPECT_EQ(vars.get<"page">(), "comments");
+}
+
+TEST(TPath, Mismatches) {
+    enable_owner_traits<default_dynamic_traits> etraits;
+
+    constexpr auto user_page = tpath<"/users/{uint:user_id}/page-{int:page}">;
+
+    auto const matches = [&](std::string_view uri) {
+        request req{etraits};
+        req.uri(uri);
+        context    ctx{req};
+        bool const res = user_page(ctx);
+        if (!res) {
+            // the path is given back to the next valves
+            EXPECT_TRUE(ctx.path_traverser().at_beginning()) << uri;
+        }
+        return res;
+    };
+
+    EXPECT_TRUE(matches("/users/10/page-2"));
+    EXPECT_TRUE(matches("/users/10/page-2/and/more"));
+    EXPECT_FALSE(matches("/users/10"));
+    EXPECT_FALSE(matches("/users/-10/page-2"));
+    EXPECT_FALSE(matches("/users/ten/page-2"));
+    EXPECT_FALSE(matches("/users/10/page-"));
+    EXPECT_FALSE(matches("/users/10/post-2"));
+    EXPECT_FALSE(matches("/users/99999999999999999999/page-2")); // doesn't fit
+    EXPECT_TRUE(matches("/users/4294967295/page-2147483647"));   // the largest ones
+    EXPECT_TRUE(matches("/users/+10/page--2147483648"));
+    EXPECT_FALSE(matches("/users/4294967296/page-2"));
+    EXPECT_FALSE(matches("/users/10/page-2147483648"));
+    EXPECT_FALSE(matches("/users/10/page-+-2"));
+    EXPECT_FALSE(matches("/users/10/page-++2"));
+    EXPECT_FALSE(matches("/people/10/page-2"));
+
+    uuid id;
+    EXPECT_FALSE(uuid::parse("123e4567e89b12d3a4564266141740ff", id));
+    EXPECT_FALSE(uuid::parse("123e4567-e89b-12d3-a456-42661417400g", id));
+}
+
+TEST(TPath, InDynamicRouter) {
+    enable_owner_traits<default_dynamic_traits> etraits;
+    dynamic_router                              router{etraits};
+
+    constexpr auto user_page = tpath<"/users/{int:user_id}">;
+    router += user_page >> [=](context& ctx) {
+        ctx.response = std::to_string(user_page.captures(ctx).get<"user_id">() * 2);
+    };
+    router += tpath<"/users/{name}/profile"> >> [] {
+        return "profile";
+    };
+
+    request req{etraits};
+    req.method("GET");
+
+    req.uri("/users/21");
+    EXPECT_EQ(as<std::string>(router(req).body), "42") << router.to_string();
+
+    req.uri("/users/moisrex/profile");
+    EXPECT_EQ(as<std::string>(router(req).body), "profile") << router.to_string();
+
+    req.uri("/posts/21");
+    EXPECT_EQ(router(req).headers.status_code(), status_code::not_found);
+}
@@ -3,6 +3,7 @@
 #include "../webpp/http/routes/context.hpp"
 #include "../webpp/traits/default_traits.hpp"
 #include "../webpp/views/mustache_view.hpp"
+#include "../webpp/views/static_mustache.hpp"
 #include "../webpp/views/view_concepts.hpp"
 #include "../webpp/views/view_manager.hpp"
 #include "common/tests_common_pch.hpp"
@@ -49,6 +50,147 @@ TYPED_TEST(TheViews, MustacheView) {
     EXPECT_EQ(str, "My name is The Moisrex");
 }
 
+TYPED_TEST(TheViews, MustacheViewSections) {
+    using fixture_string_type = typename TestFixture::string_type;
+    using list_type           = typename TestFixture::variable_type::list_type;
+
+    enable_owner_traits<typename TestFixture::traits_type> etraits;
+
+    auto data = object::make_object<typename TestFixture::data_type>(etraits);
+    data.emplace_back(etraits, "name", "moisrex");
+    data.emplace_back(etraits, "show", true);
+    data.emplace_back(etraits, "hide", false);
+    data.emplace_back(etraits, "html", "<b>&</b>");
+    list_type items;
+    items.emplace_back(etraits, "a", "1");
+    items.emplace_back(etraits, "b", "2");
+    data.emplace_back(etraits, "items", items);
+    data.emplace_back(etraits, "empty", list_type{});
+    list_type person;
+    person.emplace_back(etraits, "last", "Bahoosh");
+    data.emplace_back(etraits, "person", person);
+
+    auto const render = [&](std::string_view scheme) {
+        typename TestFixture::mustache_view_type view{etraits};
+        view.scheme(scheme);
+        EXPECT_TRUE(view.is_valid()) << view.error_message();
+        fixture_string_type str;
+        view.render(str, data);
+        return str;
+    };
+
+    EXPECT_EQ(render("Hello {{#show}}{{name}}{{/show}}{{^show}}nobody{{/show}}!"), "Hello moisrex!");
+    EXPECT_EQ(render("{{#hide}}shown{{/hide}}{{^hide}}hidden{{/hide}}"), "hidden");
+    EXPECT_EQ(render("{{#missing}}shown{{/missing}}{{^missing}}missing{{/missing}}"), "missing");
+    EXPECT_EQ(render("{{#items}}[{{.}}]{{/items}}{{#empty}}x{{/empty}}{{^empty}}empty{{/empty}}"),
+              "[1][2]empty");
+    EXPECT_EQ(render("{{person.last}}"), "Bahoosh");
+    EXPECT_EQ(render("{{html}} {{&html}} {{{html}}}"), "&lt;b&gt;&amp;&lt;/b&gt; <b>&</b> <b>&</b>");
+    EXPECT_EQ(render("{{=<% %>=}}<% name %> {{name}}"), "moisrex {{name}}");
+    EXPECT_EQ(render("{{! comment }}A\n  {{#show}}  \n{{#show}}\n  {{name}}\n{{/show}}\n  {{/show}}\nB"),
+              "A\n  moisrex\nB");
+}
+
+TYPED_TEST(TheViews, StaticMustacheView) {
+    using fixture_traits_type = typename TestFixture::traits_type;
+    using fixture_string_type = typename TestFixture::string_type;
+    using list_type           = typename TestFixture::variable_type::list_type;
+
+    enable_owner_traits<fixture_traits_type> etraits;
+
+    auto data = object::make_object<typename TestFixture::data_type>(etraits);
+    data.emplace_back(etraits, "name", "moisrex");
+    data.emplace_back(etraits, "show", true);
+    data.emplace_back(etraits, "html", "<b>&</b>");
+    list_type items;
+    items.emplace_back(etraits, "a", "1");
+    items.emplace_back(etraits, "b", "2");
+    data.emplace_back(etraits, "items", items);
+
+    // the compiled template should render exactly what the runtime view renders
+    auto const check = [&]<typename SchemeT>(SchemeT) {
+        using static_view = static_mustache<SchemeT, fixture_traits_type>;
+        typename TestFixture::mustache_view_type view{etraits};
+        view.scheme(static_view::scheme);
+        fixture_string_type expected;
+        view.render(expected, data);
+        fixture_string_type str;
+        static_view::render(str, data);
+        EXPECT_EQ(str, expected) << static_view::scheme;
+    };
+
+    check(fixed_scheme<"My name is {{name}}">{});
+    check(fixed_scheme<"{{#show}}{{name}}{{/show}}{{^show}}nobody{{/show}}">{});
+    check(fixed_scheme<"{{#items}}[{{.}}]{{/items}}{{^missing}}!{{/missing}}">{});
+    check(fixed_scheme<"{{html}} {{&html}} {{{html}}} {{=<% %>=}}<% name %>">{});
+    check(fixed_scheme<"A\n  {{#show}}  \n{{name}}\n  {{/show}}\nB">{});
+
+    // the precompiled views are resolved before the view roots are searched
+    using home_view = static_mustache<fixed_scheme<"Welcome home, {{name}}">, fixture_traits_type>;
+    view_manager<fixture_traits_type> man{etraits};
+    man.template precompiled<home_view>("home");
+    EXPECT_EQ(man.mustache("home", data), "Welcome home, moisrex");
+    EXPECT_EQ(man.view("home", data), "Welcome home, moisrex");
+}
+
+TYPED_TEST(TheViews, MustacheStream) {
+    using fixture_traits_type = typename TestFixture::traits_type;
+    using fixture_string_type = typename TestFixture::string_type;
+    using list_type           = typename TestFixture::variable_type::list_type;
+
+    enable_owner_traits<fixture_traits_type> etraits;
+
+    auto data = object::make_object<typename TestFixture::data_type>(etraits);
+    data.emplace_back(etraits, "title", "Items");
+    list_type items;
+    for (int index = 0; index != 20; ++index) {
+        items.emplace_back(etraits, "item", "item-" + std::to_string(index));
+    }
+    data.emplace_back(etraits, "items", items);
+
+    typename TestFixture::mustache_view_type view{etraits};
+    view.scheme("<h1>{{title}}</h1>\n<ul>\n  {{#items}}\n  <li>{{.}}</li>\n  {{/items}}\n</ul>");
+    fixture_string_type expected;
+    view.render(expected, data);
+
+    // the chunks end at the end of the lines, after they've reached the chunk size
+    mustache_stream<fixture_traits_type> stream{view, data};
+    fixture_string_type                  rendered;
+    std::size_t                          chunks = 0;
+    for (bool more = true; more;) {
+        fixture_string_type chunk;
+        more = stream.render(chunk, 32);
+        if (more) {
+            EXPECT_GE(chunk.size(), 32);
+            EXPECT_TRUE(chunk.ends_with('\n')) << chunk;
+        }
+        rendered += chunk;
+        ++chunks;
+    }
+    EXPECT_TRUE(stream.finished());
+    EXPECT_GT(chunks, 5);
+    EXPECT_EQ(rendered, expected);
+
+    view_manager<fixture_traits_type> man{etraits};
+    man.view_roots.emplace_back("../tests/assets");
+    man.view_roots.emplace_back("../tests");
+    man.view_roots.emplace_back("./tests");
+    man.view_roots.emplace_back("./tests/assets");
+    using home_view = static_mustache<fixed_scheme<"Welcome home, {{title}}">, fixture_traits_type>;
+    man.template precompiled<home_view>("home");
+
+    auto const all_chunks = [](auto body) {
+        std::string out;
+        while (body.next_chunk()) {
+            out += body.chunk();
+        }
+        return out;
+    };
+    EXPECT_EQ(all_chunks(man.chunked_mustache("assets/hello-world", data)), "Hello, ");
+    EXPECT_EQ(all_chunks(man.chunked_mustache("home", data)), "Welcome home, Items");
+    EXPECT_EQ(all_chunks(man.chunked_mustache("not-a-view", data)), "");
+}
+
 TYPED_TEST(TheViews, ViewManagerTest) {
     enable_owner_traits<typename TestFixture::traits_type> etraits;
 
@@ -109,3 +251,102 @@ TYPED_TEST(TheViews, FileView) {
       << "Check out the logs, it shouldn't be empty if the file was found.\n"
       << roots;
 }
+
+TYPED_TEST(TheViews, ViewIndexTest) {
+    namespace fs = std::filesystem;
+
+    enable_owner_traits<typename TestFixture::traits_type> etraits;
+
+    auto const root = fs::temp_directory_path() / "webpp-view-index-test";
+    fs::remove_all(root);
+    fs::create_directories(root / "layout");
+    auto const write = [](fs::path const& file, std::string_view content) {
+        std::ofstream{file} << content;
+    };
+    write(root / "hello.mustache", "Hello, {{name}}");
+    write(root / "layout" / "header.mustache", "Header");
+    write(root / "plain.txt", "plain");
+
+    view_manager<typename TestFixture::traits_type> man{etraits};
+    man.refresh_interval(std::chrono::milliseconds{0});
+    man.view_roots.emplace_back(root / "missing");
+    man.view_roots.emplace_back(root);
+
+    auto data = object::make_object<typename TestFixture::data_type>(etraits);
+    data.emplace_back(etraits, "name", "moisrex");
+    EXPECT_EQ(man.mustache("hello", data), "Hello, moisrex");
+    EXPECT_EQ(man.mustache("hello.mustache", data), "Hello, moisrex");
+    EXPECT_EQ(man.mustache("./layout/../hello", data), "Hello, moisrex");
+    EXPECT_EQ(man.mustache("*header", data), "Header");
+    EXPECT_EQ(man.file("plain.txt"), "plain");
+    EXPECT_EQ(man.file("plain"), "");
+
+    // the cached views are parsed again when their files change
+    write(root / "hello.mustache", "Hi, {{name}}");
+    EXPECT_EQ(man.mustache("hello", data), "Hi, moisrex");
+
+    // new and removed files
+    write(root / "layout" / "footer.mustache", "Footer");
+    EXPECT_EQ(man.mustache("layout/footer", data), "Footer");
+    fs::remove(root / "layout" / "footer.mustache");
+    EXPECT_EQ(man.mustache("layout/footer", data), "");
+
+    fs::remove_all(root);
+}
+
+TEST(HTMLEscape, BlocksAndTails) {
+    // the reference: one character at a time
+    auto const expected = [](std::string_view str) {
+        std::string out;
+        for (auto const chr : str) {
+            switch (chr) {
+                case '&': out += "&amp;"; break;
+                case '<': out += "&lt;"; break;
+                case '>': out += "&gt;"; break;
+                case '"': out += "&quot;"; break;
+                case '\'': out += "&apos;"; break;
+                default: out += chr; break;
+            }
+        }
+        return out;
+    };
+
+    std::string out;
+    EXPECT_EQ(html_escape(std::string_view{}, out), "");
+    EXPECT_EQ(html_escape(std::string_view{"<b>\"Tom\" & 'Jerry'</b>"}, out),
+              "&lt;b&gt;&quot;Tom&quot; &amp; &apos;Jerry&apos;&lt;/b&gt;");
+
+    // it's appended to the output
+    out = "prefix ";
+    EXPECT_EQ(html_escape(std::string_view{"a<b"}, out), "prefix a&lt;b");
+
+    // every special character at every position of (and around) the SIMD blocks
+    for (std::size_t size = 1; size != 100; ++size) {
+        for (std::size_t index = 0; index != size; ++index) {
+            for (char const special : std::string_view{"&<>\"'"}) {
+                std::string input(size, 'x');
+                input[index] = special;
+                if (index + 17 < size) {
+                    input[index + 17] = '\xE2'; // non-ASCII, it's not touched
+                }
+                out.clear();
+                ASSERT_EQ(html_escape(input, out), expected(input)) << input;
+            }
+        }
+    }
+
+    // mostly escaped
+    std::string const heavy(1000, '&');
+    out.clear();
+    EXPECT_EQ(html_escape(heavy, out), expected(heavy));
+
+    // the other character types are escaped one by one
+    std::u8string u8out;
+    EXPECT_TRUE(html_escape(std::u8string_view{u8"<ü & ï>"}, u8out) == u8"&lt;ü &amp; ï&gt;");
+
+    static_assert([] {
+        std::string constexpr_out;
+        html_escape(std::string_view{"a&b"}, constexpr_out);
+        return constexpr_out == "a&amp;b";
+    }());
+}
@@ -9,6 +9,13 @@
 #include "beast_body_communicator.hpp"
 #include "beast_server.hpp"
 
+#include <list>
+
+#ifdef __linux__
+#    include <pthread.h>
+#    include <sched.h>
+#endif
+
 namespace webpp {
 
     /**
@@ -44,11 +51,35 @@ namespace webpp {
           http::simple_request<beast_proto::beast_request, request_headers_type, request_body_type>;
         using response_type = http::simple_response<traits_type>;
 
+#ifdef SO_REUSEPORT
+        using reuse_port_option = asio::detail::socket_option::boolean<SOL_SOCKET, SO_REUSEPORT>;
+#endif
+
+        /**
+         * In the "reuse port" mode, each thread gets one of these; its own io_context, its own
+         * SO_REUSEPORT acceptor, and its own http workers, so the threads don't share any handler state
+         * and the kernel spreads the incoming connections between them.
+         */
+        struct io_shard {
+            asio::io_context   io{1}; // only one thread runs this context
+            acceptor_type      acceptor{io};
+            thread_worker_type thread_workers;
+
+            explicit io_shard(protocol_type& server) : thread_workers{server} {}
+        };
+
+        using io_shard_allocator_type = traits::allocator_type_of<traits_type, io_shard>;
+        using io_shards_type          = stl::list<io_shard, io_shard_allocator_type>;
+
+
+        static constexpr auto        log_cat                       = "Beast";
+        static constexpr port_type   default_http_port             = 80U;
+        static constexpr port_type   default_https_port            = 443U;
+        static constexpr stl::size_t default_http_worker_count     = 20;
+        static constexpr stl::size_t default_max_http_worker_count = 1024;
 
-        static constexpr auto        log_cat                   = "Beast";
-        static constexpr port_type   default_http_port         = 80U;
-        static constexpr port_type   default_https_port        = 443U;
-        static constexpr stl::size_t default_http_worker_count = 20;
+        // maximum number of requests served on a single keep-alive connection; zero means no limit
+        static constexpr stl::size_t default_max_requests_per_connection = 1000;
 
       private:
         using super = http::common_http_protocol<TraitsType, App>;
@@ -61,15 +92,24 @@ namespace webpp {
         asio::io_context   io{static_cast<int>(stl::thread::hardware_concurrency())};
         acceptor_type      acceptor;
         stl::size_t        http_worker_count{default_http_worker_count};
+        stl::size_t        max_http_worker_count{default_max_http_worker_count};
         stl::size_t        thread_worker_count{stl::thread::hardware_concurrency()};
         thread_pool_type   pool{stl::thread::hardware_concurrency() - 1}; // there's a main thread too
         thread_worker_type thread_workers;
+        io_shards_type     io_shards;
         stl::mutex         app_call_mutex;
-        bool               synced = false;
+        bool               synced           = false;
+        bool               reuse_port_mode  = false;
+        bool               pin_threads_mode = false;
 
         // each request should finish before this
         duration timeout_val{stl::chrono::seconds(3)};
 
+        // persistent connections (HTTP/1.1 keep-alive)
+        bool        keep_alive_enabled = true;
+        duration    keep_alive_timeout_val{stl::chrono::seconds(5)}; // idle time between two requests
+        stl::size_t max_requests_per_connection_val{default_max_requests_per_connection};
+
         void async_accept() noexcept {
             acceptor.async_accept(asio::make_strand(io),
                                   [this](boost::beast::error_code ec, socket_type sock) {
@@ -83,6 +123,218 @@ namespace webpp {
                                   });
         }
 
+        void async_accept_shard(io_shard& shard) noexcept {
+            shard.acceptor.async_accept(shard.io,
+                                        [this, &shard](boost::beast::error_code ec, socket_type sock) {
+                                            if (!ec) [[likely]] {
+                                                shard.thread_workers.start_work(stl::move(sock));
+                                            } else [[unlikely]] {
+                                                this->logger.warning(log_cat, "Accepting error", ec);
+                                            }
+                                            this->async_accept_shard(shard);
+                                        });
+        }
+
+        // open, bind, and listen
+        [[nodiscard]] bool open_acceptor(acceptor_type& acc, [[maybe_unused]] bool reuse_port) noexcept {
+            boost::beast::error_code err;
+            endpoint_type const      endp{bind_address, bind_port};
+
+            // open
+            acc.open(endp.protocol(), err);
+            if (err) {
+                this->logger.error(log_cat,
+                                   fmt::format("Cannot open protocol for {}", bound_uri().as_string()),
+                                   err);
+                return false;
+            }
+
+            // Allow address reuse
+            acc.set_option(asio::socket_base::reuse_address(true), err);
+            if (err) {
+                this->logger.error(log_cat,
+                                   fmt::format("Cannot set reuse option on {}", bound_uri().as_string()),
+                                   err);
+                return false;
+            }
+
+#ifdef SO_REUSEPORT
+            // Allow multiple acceptors on the same port; the kernel load-balances between them
+            if (reuse_port) {
+                acc.set_option(reuse_port_option(true), err);
+                if (err) {
+                    this->logger.error(
+                      log_cat,
+                      fmt::format("Cannot set reuse port option on {}", bound_uri().as_string()),
+                      err);
+                    return false;
+                }
+            }
+#endif
+
+            // bind
+            acc.bind(endp, err);
+            if (err) {
+                this->logger.error(log_cat, fmt::format("Cannot bind to {}", bound_uri().as_string()), err);
+                return false;
+            }
+
+            // listen
+            acc.listen(asio::socket_base::max_listen_connections, err);
+            if (err) {
+                this->logger.error(log_cat, fmt::format("Cannot listen to {}", bound_uri().as_string()), err);
+                return false;
+            }
+            return true;
+        }
+
+        // pin the current thread to the specified CPU core; the shards that are more than the CPU cores
+        // are not pinned, so two shards never share a core because of pinning
+        void pin_thread([[maybe_unused]] stl::size_t const cpu) noexcept {
+#ifdef __linux__
+            if (cpu >= stl::thread::hardware_concurrency()) {
+                this->logger.warning(
+                  log_cat,
+                  fmt::format("There are more shards than CPU cores; shard {} is not pinned.", cpu));
+                return;
+            }
+            cpu_set_t cpus;
+            CPU_ZERO(&cpus);
+            CPU_SET(cpu, &cpus);
+            if (pthread_setaffinity_np(pthread_self(), sizeof(cpu_set_t), &cpus) != 0) {
+                this->logger.warning(log_cat, fmt::format("Cannot pin thread to CPU {}", cpu));
+            }
+#else
+            this->logger.warning(log_cat, "Pinning threads to CPUs is not supported on this platform.");
+#endif
+        }
+
+        // get a function that runs the specified io context in the current thread until it's stopped
+        auto io_runner(asio::io_context& ctx, stl::size_t const index) noexcept {
+            return [this, &ctx, io_index = index, tries = 0UL]() mutable noexcept {
+                if (reuse_port_mode && pin_threads_mode) {
+                    pin_thread(io_index);
+                }
+                for (; !ctx.stopped(); ++tries) {
+                    try {
+                        // run executor in this thread
+                        ctx.run();
+                        this->logger.info(log_cat, fmt::format("Thread {} went down peacefully.", io_index));
+                    } catch (stl::exception const& err_exc) {
+                        this->logger.error(log_cat,
+                                           fmt::format("Error while starting io server; restarting io "
+                                                       "runner; io runner id: {}; tries: {}",
+                                                       io_index,
+                                                       tries),
+                                           err_exc);
+                    } catch (...) {
+                        // todo: possible data race
+                        this->logger.error(
+                          log_cat,
+                          fmt::format(
+                            "Unknown server error; restarting io runner; io runner id: {}; tries: {}",
+                            io_index,
+                            tries));
+                    }
+                }
+            };
+        }
+
+        // close the acceptors, and the connections (including the idle keep-alive ones); the io contexts are
+        // stopped, and all of their threads have returned
+        void close_all() noexcept {
+            boost::beast::error_code err;
+            acceptor.close(err);
+            thread_workers.close_connections();
+            for (auto& shard : io_shards) {
+                shard.acceptor.close(err);
+                shard.thread_workers.close_connections();
+            }
+        }
+
+        // run the server with one shared io context, and one acceptor
+        [[nodiscard]] int run_shared() noexcept {
+            // Capture SIGINT and SIGTERM to perform a clean shutdown
+            asio::signal_set signals(io, SIGINT, SIGTERM);
+            signals.async_wait([this](boost::beast::error_code const&, int) {
+                this->logger.info(log_cat, "Stopping the server, got a signal");
+                stop();
+            });
+
+            if (!open_acceptor(acceptor, false)) {
+                return -1;
+            }
+
+            thread_workers.init();
+
+            // We need to be executing within a strand to perform async operations
+            // on the I/O objects in this session.
+            asio::dispatch(acceptor.get_executor(),
+                           boost::beast::bind_front_handler(&protocol_type::async_accept, this));
+
+            this->logger.info(log_cat,
+                              fmt::format("Starting beast server on {} with {} thread workers.",
+                                          bound_uri().as_string(),
+                                          thread_worker_count));
+
+            // start accepting in all workers
+            for (stl::size_t i = 1UL; i < thread_worker_count; ++i) {
+                asio::post(pool, io_runner(io, i));
+            }
+
+            io_runner(io, 0)();
+
+            pool.attach();
+            pool.join();
+            close_all();
+            this->logger.info(log_cat, "Server is down.");
+            return 0;
+        }
+
+        // run the server with one io context, one acceptor, and one set of http workers per thread
+        [[nodiscard]] int run_reuse_port() noexcept {
+            // one shard per thread; the main thread runs the first one, and the thread pool runs the rest
+            auto const shard_count = stl::max<stl::size_t>(thread_worker_count, 1);
+            for (stl::size_t i = 0UL; i != shard_count; ++i) {
+                auto& shard = io_shards.emplace_back(*this);
+                if (!open_acceptor(shard.acceptor, true)) {
+                    io_shards.clear();
+                    return -1;
+                }
+                shard.thread_workers.init();
+                async_accept_shard(shard);
+            }
+
+            // Capture SIGINT and SIGTERM to perform a clean shutdown
+            asio::signal_set signals(io_shards.front().io, SIGINT, SIGTERM);
+            signals.async_wait([this](boost::beast::error_code const&, int) {
+                this->logger.info(log_cat, "Stopping the server, got a signal");
+                stop();
+            });
+
+            this->logger.info(log_cat,
+                              fmt::format("Starting beast server on {} with {} SO_REUSEPORT acceptors.",
+                                          bound_uri().as_string(),
+                                          shard_count));
+
+            // the first shard runs in the main thread
+            stl::size_t index = 0;
+            for (auto& shard : io_shards) {
+                if (index != 0) {
+                    asio::post(pool, io_runner(shard.io, index));
+                }
+                ++index;
+            }
+
+            io_runner(io_shards.front().io, 0)();
+
+            pool.attach();
+            pool.join();
+            close_all();
+            this->logger.info(log_cat, "Server is down.");
+            return 0;
+        }
+
         // call the app
         http::HTTPResponse auto call_app(request_type& req) noexcept {
             if (synced) {
@@ -107,7 +359,8 @@ namespace webpp {
         explicit beast(Args&&... args)
           : super{stl::forward<Args>(args)...},
             acceptor{asio::make_strand(io)},
-            thread_workers{*this} {}
+            thread_workers{*this},
+            io_shards{get_allocator<io_shards_type>(*this)} {}
 
         beast& address(string_view_type addr) noexcept {
             asio::error_code err;
@@ -132,11 +385,104 @@ namespace webpp {
             return timeout_val;
         }
 
+        /**
+         * The time that an idle keep-alive connection is allowed to wait for its next request
+         * before it gets closed.
+         */
+        beast& keep_alive_timeout(duration const dur) noexcept {
+            keep_alive_timeout_val = dur;
+            return *this;
+        }
+
+        [[nodiscard]] duration keep_alive_timeout() const noexcept {
+            return keep_alive_timeout_val;
+        }
+
+        /**
+         * Maximum number of requests that are served on a single connection before the server
+         * closes it; zero means unlimited.
+         */
+        beast& max_requests_per_connection(stl::size_t const val) noexcept {
+            max_requests_per_connection_val = val;
+            return *this;
+        }
+
+        [[nodiscard]] stl::size_t max_requests_per_connection() const noexcept {
+            return max_requests_per_connection_val;
+        }
+
+        beast& enable_keep_alive() noexcept {
+            keep_alive_enabled = true;
+            return *this;
+        }
+
+        beast& disable_keep_alive() noexcept {
+            keep_alive_enabled = false;
+            return *this;
+        }
+
+        [[nodiscard]] bool is_keep_alive_enabled() const noexcept {
+            return keep_alive_enabled;
+        }
+
         beast& set_worker_count(stl::size_t const val) {
             http_worker_count = val;
             return *this;
         }
 
+        /**
+         * The pool of http workers grows on demand up to this many workers, after that the accepted
+         * connections are queued until a worker becomes idle.
+         */
+        beast& set_max_worker_count(stl::size_t const val) {
+            max_http_worker_count = val;
+            return *this;
+        }
+
+        /// Number of times a connection was accepted while all the http workers were busy
+        [[nodiscard]] stl::size_t saturation_count() const noexcept {
+            stl::size_t count = thread_workers.saturation_count();
+            for (auto const& shard : io_shards) {
+                count += shard.thread_workers.saturation_count();
+            }
+            return count;
+        }
+
+        /**
+         * Use one io_context, one SO_REUSEPORT acceptor, and one set of http workers per thread instead of
+         * sharing them between all the threads; the kernel will distribute the connections between
+         * the threads.
+         * Only available on systems that support SO_REUSEPORT.
+         */
+        beast& enable_reuse_port() noexcept {
+#ifdef SO_REUSEPORT
+            reuse_port_mode = true;
+#else
+            this->logger.warning(log_cat, "SO_REUSEPORT is not supported on this system.");
+#endif
+            return *this;
+        }
+
+        beast& disable_reuse_port() noexcept {
+            reuse_port_mode = false;
+            return *this;
+        }
+
+        [[nodiscard]] bool is_reuse_port_enabled() const noexcept {
+            return reuse_port_mode;
+        }
+
+        /// Pin each thread to a CPU core; only used in the SO_REUSEPORT mode
+        beast& enable_thread_pinning() noexcept {
+            pin_threads_mode = true;
+            return *this;
+        }
+
+        beast& disable_thread_pinning() noexcept {
+            pin_threads_mode = false;
+            return *this;
+        }
+
         [[nodiscard]] bool is_ssl_active() const noexcept {
             return false;
         }
@@ -198,106 +544,23 @@ namespace webpp {
             return log_cat;
         }
 
-        // run the server
-        [[nodiscard]] int operator()() noexcept {
-            // Capture SIGINT and SIGTERM to perform a clean shutdown
-            asio::signal_set signals(io, SIGINT, SIGTERM);
-            signals.async_wait([this](boost::beast::error_code const&, int) {
-                this->logger.info(log_cat, "Stopping the server, got a signal");
-
-                // Stop the `io_context`. This will cause `run()`
-                // to return immediately, eventually destroying the
-                // `io_context` and all the sockets in it.
-                io.stop();
-                thread_workers.stop();
-                pool.stop();
-            });
-
-            boost::beast::error_code err;
-            endpoint_type const      endp{bind_address, bind_port};
-
-            // open
-            acceptor.open(endp.protocol(), err);
-            if (err) {
-                this->logger.error(log_cat,
-                                   fmt::format("Cannot open protocol for {}", bound_uri().as_string()),
-                                   err);
-                return -1;
-            }
-
-            // Allow address reuse
-            acceptor.set_option(asio::socket_base::reuse_address(true), err);
-            if (err) {
-                this->logger.error(log_cat,
-                                   fmt::format("Cannot set reuse option on {}", bound_uri().as_string()),
-                                   err);
-                return -1;
-            }
-
-            // bind
-            acceptor.bind(endp, err);
-            if (err) {
-                this->logger.error(log_cat, fmt::format("Cannot bind to {}", bound_uri().as_string()), err);
-                return -1;
-            }
-
-            // listen
-            acceptor.listen(asio::socket_base::max_listen_connections, err);
-            if (err) {
-                this->logger.error(log_cat, fmt::format("Cannot listen to {}", bound_uri().as_string()), err);
-                return -1;
+        void stop() noexcept {
+            // Stop the `io_context`. This will cause `run()`
+            // to return immediately; the connections are closed by the thread that runs the server after
+            // all the threads have returned (see close_all), since the streams are not thread-safe.
+            io.stop();
+            for (auto& shard : io_shards) {
+                shard.io.stop();
             }
+            pool.stop();
+        }
 
-            // We need to be executing within a strand to perform async operations
-            // on the I/O objects in this session.
-            asio::dispatch(acceptor.get_executor(),
-                           boost::beast::bind_front_handler(&protocol_type::async_accept, this));
-
-            this->logger.info(log_cat,
-                              fmt::format("Starting beast server on {} with {} thread workers.",
-                                          bound_uri().as_string(),
-                                          thread_worker_count));
-
-            auto get_thread = [this](stl::size_t index) noexcept {
-                return [this, io_index = index, tries = 0UL]() mutable noexcept {
-                    for (; !io.stopped(); ++tries) {
-                        try {
-                            // run executor in this thread
-                            io.run();
-                            this->logger.info(log_cat,
-                                              fmt::format("Thread {} went down peacefully.", io_index));
-                        } catch (stl::exception const& err_exc) {
-                            this->logger.error(
-                              log_cat,
-                              fmt::format("Error while starting io server; restarting io "
-                                          "runner; io runner id: {}; tries: {}",
-                                          io_index,
-                                          tries),
-                              err_exc);
-                        } catch (...) {
-                            // todo: possible data race
-                            this->logger.error(
-                              log_cat,
-                              fmt::format(
-                                "Unknown server error; restarting io runner; io runner id: {}; tries: {}",
-                                io_index,
-                                tries));
-                        }
-                    }
-                };
-            };
-
-
-            // start accepting in all workers
-            for (stl::size_t i = 1UL; i != thread_worker_count - 1; ++i) {
-                asio::post(pool, get_thread(i));
+        // run the server
+        [[nodiscard]] int operator()() noexcept {
+            if (reuse_port_mode) {
+                return run_reuse_port();
             }
-
-            get_thread(0)();
-
-            pool.attach();
-            this->logger.info(log_cat, "Server is down.");
-            return 0;
+            return run_shared();
         }
     };
 
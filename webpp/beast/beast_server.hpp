@@ -1,18 +1,28 @@
 #ifndef WEBPP_HTTP_PROTO_BEAST_SERVER_HPP
 #define WEBPP_HTTP_PROTO_BEAST_SERVER_HPP
 
+#include "../concurrency/atomic_counter.hpp"
+#include "../concurrency/mpmc_queue.hpp"
 #include "../configs/constants.hpp"
+#include "../http/bodies/chunked.hpp"
+#include "../http/bodies/file.hpp"
 #include "../http/http_concepts.hpp"
 #include "../http/http_version.hpp"
 #include "../http/request.hpp"
+#include "../http/status_code.hpp"
 #include "../libs/asio.hpp"
 #include "../std/format.hpp"
 #include "../std/string_view.hpp"
+#include "../strings/append.hpp"
 #include "../traits/enable_traits.hpp"
 #include "../uri/uri.hpp"
 #include "beast_request.hpp"
 #include "beast_string_body.hpp"
 
+#include <array>
+#include <atomic>
+#include <charconv>
+#include <deque>
 #include <list>
 #include <mutex>
 #include <thread>
@@ -37,12 +47,23 @@
 #include <boost/beast/http/read.hpp>
 #include <boost/beast/http/write.hpp>
 
+#ifdef WEBPP_BOOST_ASIO
+#    include <boost/asio/buffer.hpp>
+#    include <boost/asio/write.hpp>
+#else
+#    include <asio/buffer.hpp>
+#    include <asio/write.hpp>
+#endif
+
 namespace webpp::beast_proto {
 
+    template <typename ServerT>
+    struct thread_worker;
 
     template <typename ServerT>
     struct http_worker : enable_traits<typename ServerT::etraits> {
         using server_type           = ServerT;
+        using thread_worker_type    = thread_worker<server_type>;
         using etraits               = enable_traits<typename server_type::etraits>;
         using duration              = typename server_type::duration;
         using acceptor_type         = typename server_type::acceptor_type;
@@ -69,6 +90,11 @@ namespace webpp::beast_proto {
         using beast_request_parser_type =
           boost::beast::http::request_parser<beast_body_type, char_allocator_type>;
 
+        // the response type that the user's application returns
+        using response_type =
+          stl::remove_cvref_t<stl::invoke_result_t<typename server_type::app_wrapper_type&, request_type&>>;
+        using const_buffer_type = asio::const_buffer;
+
         static constexpr auto log_cat = "BeastWorker";
 
 
@@ -83,10 +109,32 @@ namespace webpp::beast_proto {
         stl::optional<beast_response_type>            bres{stl::nullopt};
         stl::optional<beast_response_serializer_type> str_serializer{stl::nullopt};
         server_type*                                  server;
+        thread_worker_type*                           owner;
         stl::optional<request_type>                   req{stl::nullopt};
         stl::optional<beast_request_parser_type>      parser{stl::nullopt};
         buffer_type buf{default_buffer_size}; // fixme: see if this is using our allocator
 
+        // The user's response is kept alive until it's written, so its body can be sent to the socket
+        // without being copied into a beast response first.
+        stl::optional<response_type>     res{stl::nullopt};
+        string_type                      head;          // status line + headers; reused between responses
+        string_type                      file_chunk;    // only used if sendfile is not available
+        stl::array<const_buffer_type, 2> out_buffers{}; // head + the borrowed body
+
+        // waiting for the socket to be writable while sending a file is bound to the server's timeout
+        stl::optional<steady_timer> send_timer{stl::nullopt};
+        stl::size_t                 send_waits     = 0;
+        bool                        send_timed_out = false;
+
+        // the size of a chunk in hex + CRLF, and the chunk itself + CRLF
+        stl::array<char, sizeof(stl::size_t) * 2 + 2> chunk_size_line{};
+        stl::array<const_buffer_type, 3>              chunk_buffers{};
+        bool chunked_encoding = false; // the chunked body is sent with "Transfer-Encoding: chunked"
+
+        // number of requests that have been served on the current connection
+        stl::size_t served_requests = 0;
+        bool        keep_alive      = false;
+
         template <typename StrT>
         constexpr string_view_type string_viewify(StrT&& str) const noexcept {
             return istl::string_viewify_of<string_view_type>(stl::forward<StrT>(str));
@@ -100,22 +148,29 @@ namespace webpp::beast_proto {
         http_worker& operator=(http_worker&&) noexcept = delete;
         ~http_worker()                                 = default;
 
-        explicit http_worker(server_type* in_server)
+        http_worker(server_type* in_server, thread_worker_type* in_owner)
           : etraits{*in_server},
             server{in_server},
+            owner{in_owner},
             req{*server},
             parser{
               stl::in_place,
               stl::piecewise_construct,
               stl::make_tuple(),                                       // body args
               stl::make_tuple(get_allocator<beast_fields_type>(*this)) // fields args
-            } {}
+            },
+            head{get_alloc_for<string_type>(*this)},
+            file_chunk{get_alloc_for<string_type>(*this)} {}
 
         /**
          * Running async_read_request directly in the constructor will not make
          * make_shared (or alike) functions work properly.
          */
         void set_socket(socket_type&& in_sock) {
+            // Responses of keep-alive and pipelined connections are small writes that shouldn't wait for
+            // the ACK of the previous response (Nagle's algorithm)
+            boost::beast::error_code err;
+            in_sock.set_option(asio::ip::tcp::no_delay(true), err);
             stream.emplace(stl::move(in_sock));
         }
 
@@ -199,6 +254,8 @@ namespace webpp::beast_proto {
                     case text_based: set_response_body_string(body); return;
                     case cstream_based: set_response_body_cstream(body); return;
                     case stream_based: set_response_body_stream(body); return;
+                    case file_based: set_response_body_cstream(body); return;
+                    case chunked_based: set_response_body_cstream(body); return;
                     default: stl::unreachable();
                 }
             } else if constexpr (http::TextBasedBodyReader<body_type>) {
@@ -214,29 +271,301 @@ namespace webpp::beast_proto {
             }
         }
 
-        void make_beast_response() noexcept {
-            // putting the beast's request into webpp's request
-            req->set_beast_parser(*parser);
+        /**
+         * Check if the connection should be kept open after the current response is sent.
+         * The client, the user's response (with a "Connection: close" header), or the server's
+         * settings may ask us to close the connection.
+         */
+        [[nodiscard]] bool should_keep_alive(bool const response_allows) const noexcept {
+            auto const max_requests = server->max_requests_per_connection();
+            return server->is_keep_alive_enabled() && parser->get().keep_alive() && response_allows &&
+                   (max_requests == 0 || served_requests < max_requests);
+        }
+
+        /**
+         * Only the text-based bodies are already in memory in one piece, the files are sent by the
+         * kernel itself, and the chunked bodies are sent chunk by chunk as they're produced; the rest has
+         * to go through beast's serializer.
+         */
+        [[nodiscard]] static constexpr bool is_gatherable(auto const& body) noexcept {
+            using body_type = stl::remove_cvref_t<decltype(body)>;
+            if constexpr (http::UnifiedBodyReader<body_type>) {
+                auto const communicator = body.which_communicator();
+                return communicator == http::communicator_type::text_based ||
+                       communicator == http::communicator_type::nothing ||
+                       communicator == http::communicator_type::file_based ||
+                       communicator == http::communicator_type::chunked_based;
+            } else {
+                return http::TextBasedBodyReader<body_type>;
+            }
+        }
+
+        // The user's response is going to be sent to the socket the way it is
+        [[nodiscard]] bool is_gatherable_response() const noexcept {
+            if constexpr (istl::String<typename response_type::headers_type::field_type::string_type>) {
+                return is_gatherable(res->body);
+            } else {
+                return false;
+            }
+        }
+
+        /**
+         * Serialize the status line and the headers into the reusable head buffer, and point the second
+         * buffer to the body of the user's response; the body is not copied, it's kept alive (in "res")
+         * until the write is done.
+         * The head is one contiguous buffer on purpose; asio splits a write of more than a handful of
+         * buffers into multiple syscalls (and TCP segments).
+         */
+        void gather_response() {
+            bool response_allows = true;
+            for (auto const& hdr : res->headers) {
+                if (hdr.is_name("Connection")) {
+                    response_allows = !ascii::iequals(hdr.value, "close");
+                }
+            }
+            keep_alive = should_keep_alive(response_allows);
+
+            auto const version = parser->get().version();
+            auto const status  = res->headers.status_code_integer();
+
+            // the size of a chunked body is not known; HTTP/1.0 clients don't know about chunks, so the
+            // end of the body is where the connection is closed
+            auto const is_chunked = response_chunks() != nullptr;
+            chunked_encoding      = is_chunked && version != 10;
+            if (is_chunked && version == 10) {
+                keep_alive = false;
+            }
+
+            head.clear();
+            head.append(version == 10 ? "HTTP/1.0 " : "HTTP/1.1 ");
+            append_to(head, status);
+            head.push_back(' ');
+            head.append(http::status_code_reason_phrase(status));
+            head.append("\r\n");
+            for (auto const& hdr : res->headers) {
+                if (hdr.is_name("Connection")) {
+                    continue; // we decide that ourselves
+                }
+                head.append(hdr.name);
+                head.append(": ");
+                head.append(hdr.value);
+                head.append("\r\n");
+            }
+            if (!keep_alive && version != 10) {
+                head.append("Connection: close\r\n");
+            } else if (keep_alive && version == 10) {
+                head.append("Connection: keep-alive\r\n");
+            }
+            if (chunked_encoding) {
+                head.append("Transfer-Encoding: chunked\r\n");
+            }
+            head.append("\r\n");
+
+            out_buffers[0] = const_buffer_type{head.data(), head.size()};
+            out_buffers[1] = const_buffer_type{};
+
+            // responses to HEAD requests only include the Content-Length of the body
+            if (!is_head_request() && res->body.data() != nullptr && res->body.size() != 0) {
+                out_buffers[1] =
+                  const_buffer_type{res->body.data(), res->body.size() * sizeof(*res->body.data())};
+            }
+        }
+
+        [[nodiscard]] bool is_head_request() const noexcept {
+            return parser->get().method() == boost::beast::http::verb::head;
+        }
+
+        // The file that has to be sent after the head, or nullptr if the body is not a file
+        [[nodiscard]] http::file_body* response_file() noexcept {
+            using body_type = stl::remove_cvref_t<decltype(res->body)>;
+            if constexpr (requires { typename body_type::file_communicator_type; }) {
+                if (!is_head_request()) {
+                    return stl::get_if<typename body_type::file_communicator_type>(&res->body.communicator());
+                }
+            }
+            return nullptr;
+        }
+
+        // The chunked body that has to be sent after the head, or nullptr if the body is not chunked
+        [[nodiscard]] auto* response_chunks() noexcept {
+            using body_type = stl::remove_cvref_t<decltype(res->body)>;
+            if constexpr (requires { typename body_type::chunked_communicator_type; }) {
+                using chunked_type = typename body_type::chunked_communicator_type;
+                if (!is_head_request()) {
+                    return stl::get_if<chunked_type>(&res->body.communicator());
+                }
+                return static_cast<chunked_type*>(nullptr);
+            } else {
+                return static_cast<http::chunked_body<traits_type>*>(nullptr);
+            }
+        }
+
+        /**
+         * Produce the next chunk of the chunked body and write it to the socket; the chunks are framed
+         * with their sizes, and the last (empty) chunk is written after the body is finished, unless the
+         * client doesn't know about chunks (HTTP/1.0).
+         * If the producer fails, the connection is closed without the last chunk, so the client knows
+         * that the body is not complete.
+         */
+        void async_write_body_chunk() noexcept {
+            auto* chunks    = response_chunks();
+            bool  has_chunk = false;
+            try {
+                has_chunk = chunks->next_chunk();
+            } catch (...) {
+                this->logger.error(log_cat, "Error while producing the response's body.");
+                keep_alive = false;
+                on_write({});
+                return;
+            }
+            if (!has_chunk) {
+                if (!chunked_encoding) {
+                    on_write({});
+                    return;
+                }
+                asio::async_write(*stream,
+                                  asio::buffer("0\r\n\r\n", 5),
+                                  [this](boost::beast::error_code err, stl::size_t) noexcept {
+                                      on_write(err);
+                                  });
+                return;
+            }
+            auto const data = chunks->chunk();
+            auto       on_chunk_written = [this](boost::beast::error_code err, stl::size_t) noexcept {
+                if (err) [[unlikely]] {
+                    on_write(err);
+                    return;
+                }
+                async_write_body_chunk();
+            };
+            if (!chunked_encoding) {
+                asio::async_write(*stream,
+                                  asio::buffer(data.data(), data.size()),
+                                  stl::move(on_chunk_written));
+                return;
+            }
+            auto* const line_begin = chunk_size_line.data();
+            auto* const line_end =
+              stl::to_chars(line_begin, line_begin + chunk_size_line.size() - 2, data.size(), 16).ptr;
+            line_end[0] = '\r'; // NOLINT(*-pro-bounds-pointer-arithmetic)
+            line_end[1] = '\n'; // NOLINT(*-pro-bounds-pointer-arithmetic)
+            chunk_buffers[0] =
+              const_buffer_type{line_begin, static_cast<stl::size_t>(line_end - line_begin) + 2};
+            chunk_buffers[1] = const_buffer_type{data.data(), data.size()};
+            chunk_buffers[2] = const_buffer_type{"\r\n", 2};
+            asio::async_write(*stream, chunk_buffers, stl::move(on_chunk_written));
+        }
+
+        /**
+         * Send the file body with sendfile(2); the file's content doesn't go through the user-space.
+         * When the socket's buffer is full, we wait for it to be writable again, and if sendfile is not
+         * available, we fall back to reading and writing the file chunk by chunk.
+         */
+        void async_send_file() noexcept {
+            auto*                    file = response_file();
+            auto&                    sock = stream->socket();
+            boost::beast::error_code err;
+            sock.native_non_blocking(true, err);
+            while (!err && !file->empty()) {
+                auto const sent = file->send_to(sock.native_handle());
+                if (sent > 0) {
+                    continue;
+                }
+                if (sent == -EAGAIN || sent == -EWOULDBLOCK) {
+                    async_wait_writable();
+                    return;
+                }
+                if (sent == -ENOSYS || sent == -EINVAL) {
+                    async_write_file_chunk();
+                    return;
+                }
+                err.assign(static_cast<int>(-sent), boost::system::system_category());
+            }
+            on_write(err);
+        }
 
-            http::HTTPResponse auto res = server->call_app(*req);
+        /**
+         * Wait for the socket to be writable again, but not longer than the server's timeout; the beast
+         * stream's timeout doesn't cover the operations on the raw socket, so a client that stops reading
+         * would hold this worker forever.
+         */
+        void async_wait_writable() noexcept {
+            if (!send_timer) {
+                send_timer.emplace(stream->get_executor());
+            }
+            auto const wait_id = send_waits;
+            send_timer->expires_after(server->timeout());
+            send_timer->async_wait([this, wait_id](boost::beast::error_code err) noexcept {
+                if (!err && wait_id == send_waits && stream) {
+                    send_timed_out = true;
+                    stream->socket().cancel(err);
+                }
+            });
+            stream->socket().async_wait(asio::socket_base::wait_write,
+                                        [this](boost::beast::error_code wait_err) noexcept {
+                                            ++send_waits; // the timer of this wait is stale now
+                                            send_timer->cancel();
+                                            if (send_timed_out) [[unlikely]] {
+                                                send_timed_out = false;
+                                                wait_err       = boost::beast::error::timeout;
+                                            }
+                                            if (wait_err) [[unlikely]] {
+                                                on_write(wait_err);
+                                                return;
+                                            }
+                                            async_send_file();
+                                        });
+        }
 
+        // The fallback of sendfile; read the file chunk by chunk and write them to the socket
+        void async_write_file_chunk() noexcept {
+            auto* file = response_file();
+            file_chunk.resize(stl::min<stl::size_t>(file->size(), default_buffer_size));
+            // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+            auto* const chunk_data = reinterpret_cast<stl::byte*>(file_chunk.data());
+            auto const read_size = file->read(chunk_data, static_cast<stl::streamsize>(file_chunk.size()));
+            if (read_size <= 0) {
+                boost::beast::error_code err;
+                if (!file->empty()) {
+                    // the file got smaller after we've sent the headers
+                    err.assign(file->error_number() != 0 ? file->error_number() : EIO,
+                               boost::system::system_category());
+                }
+                on_write(err);
+                return;
+            }
+            asio::async_write(*stream,
+                              asio::buffer(file_chunk.data(), static_cast<stl::size_t>(read_size)),
+                              [this](boost::beast::error_code err, stl::size_t) noexcept {
+                                  if (err) [[unlikely]] {
+                                      on_write(err);
+                                      return;
+                                  }
+                                  async_write_file_chunk();
+                              });
+        }
+
+        void make_beast_response() {
             // putting the user's response into beast's response
             bres.emplace();
-            res.calculate_default_headers();
             bres->version(parser->get().version());
-            for (auto const& hdr : res.headers) {
+            bres->result(res->headers.status_code_integer());
+            for (auto const& hdr : res->headers) {
                 bres->set(hdr.name, hdr.value);
             }
+            keep_alive = should_keep_alive(bres->keep_alive());
+            bres->keep_alive(keep_alive);
 
-            // bres.content_length(res.body.size());
-            set_response_body(res.body);
+            set_response_body(res->body);
             bres->prepare_payload();
             str_serializer.emplace(*bres);
         }
 
         // Asynchronously receive a complete request message.
+        // If the client has pipelined its requests, the next request may already be in the buffer.
         void async_read_request() noexcept {
-            stream->expires_after(server->timeout());
+            // the first request has to finish before the timeout, the next ones are bound to the idle timeout
+            stream->expires_after(served_requests == 0 ? server->timeout() : server->keep_alive_timeout());
             boost::beast::http::async_read(
               *stream,
               buf,
@@ -251,6 +580,9 @@ namespace webpp::beast_proto {
                           // don't need to log if it fails
                           stream->socket().shutdown(asio::ip::tcp::socket::shutdown_send, err);
                           reset();
+                      } else if (err == boost::beast::error::timeout && served_requests != 0) {
+                          // an idle keep-alive connection, nothing to report
+                          reset();
                       } else {
                           this->logger.warning(log_cat, "Connection error.", err);
 
@@ -264,61 +596,121 @@ namespace webpp::beast_proto {
         }
 
         void async_write_response() noexcept {
-            make_beast_response();
-            boost::beast::http::async_write(
-              *stream,
-              *str_serializer,
-              [this](boost::beast::error_code err, stl::size_t) noexcept {
-                  if (err) [[unlikely]] {
-                      this->logger.warning(log_cat, "Write error on socket.", err);
-                  } else {
-                      // todo: check if we need the else part of this condition to be an else stmt.
-                      stream->socket().shutdown(asio::ip::tcp::socket::shutdown_send, err);
-                      if (err) [[unlikely]] {
-                          this->logger.warning(log_cat, "Error on sending shutdown into socket.", err);
-                      }
-                  }
-                  reset();
-              });
-        }
+            ++served_requests;
 
+            // putting the beast's request into webpp's request
+            req->set_beast_parser(*parser);
 
-      public:
-        void reset() noexcept {
-            // todo: half of these things can be yanked out with the help of allocators
-            boost::beast::error_code err;
-            stream->socket().close(err);
+            res.emplace(server->call_app(*req));
+            res->calculate_default_headers();
+
+            auto handler = [this](boost::beast::error_code err, stl::size_t) noexcept {
+                on_write(err);
+            };
+            if (is_gatherable_response()) [[likely]] {
+                gather_response();
+                if (response_file() != nullptr) {
+                    asio::async_write(*stream,
+                                      out_buffers,
+                                      [this](boost::beast::error_code err, stl::size_t) noexcept {
+                                          if (err) [[unlikely]] {
+                                              on_write(err);
+                                              return;
+                                          }
+                                          async_send_file();
+                                      });
+                    return;
+                }
+                if (response_chunks() != nullptr) {
+                    asio::async_write(*stream,
+                                      out_buffers,
+                                      [this](boost::beast::error_code err, stl::size_t) noexcept {
+                                          if (err) [[unlikely]] {
+                                              on_write(err);
+                                              return;
+                                          }
+                                          async_write_body_chunk();
+                                      });
+                    return;
+                }
+                asio::async_write(*stream, out_buffers, stl::move(handler));
+            } else {
+                make_beast_response();
+                boost::beast::http::async_write(*stream, *str_serializer, stl::move(handler));
+            }
+        }
+
+        void on_write(boost::beast::error_code err) noexcept {
             if (err) [[unlikely]] {
-                this->logger.warning(log_cat, "Error on closing the connection.", err);
+                this->logger.warning(log_cat, "Write error on socket.", err);
+            } else if (keep_alive) [[likely]] {
+                // persistent connection; wait for the next request on the same stream
+                prepare_next_request();
+                async_read_request();
+                return;
+            } else {
+                // todo: check if we need the else part of this condition to be an else stmt.
+                stream->socket().shutdown(asio::ip::tcp::socket::shutdown_send, err);
+                if (err) [[unlikely]] {
+                    this->logger.warning(log_cat, "Error on sending shutdown into socket.", err);
+                }
             }
+            reset();
+        }
 
-            // destroy the request type + be ready for the next request
+        // destroy the request type + be ready for the next request
+        void prepare_next_request() {
             req.emplace(*server);
             parser.emplace(stl::piecewise_construct,
                            stl::make_tuple(),                                       // body args
                            stl::make_tuple(get_allocator<beast_fields_type>(*this)) // fields args
             );
+            str_serializer.reset();
+            bres.reset();
+            res.reset();
+        }
 
 
+      public:
+        void reset() noexcept {
+            // todo: half of these things can be yanked out with the help of allocators
+            boost::beast::error_code err;
+            stream->socket().close(err);
+            if (err) [[unlikely]] {
+                this->logger.warning(log_cat, "Error on closing the connection.", err);
+            }
 
-            str_serializer.reset();
-            bres.reset();
+            prepare_next_request();
+            served_requests = 0;
+            keep_alive      = false;
+            buf.clear(); // drop the unprocessed pipelined requests of the closed connection
 
             // Sleep indefinitely until we're given a new deadline.
             stream->expires_never();
+            send_timer.reset(); // it's bound to the connection's strand
+            send_timed_out = false;
 
             stream.reset(); // go in the idle mode
+
+            // this worker may be handed a new connection right away, so this has to be the last thing we do
+            owner->release(this);
         }
 
-        void stop() noexcept {
+        // Beast's streams are not thread-safe; this is only called after the io contexts have stopped,
+        // and all of their threads have returned, so nothing else is using the stream
+        void close() noexcept {
             if (stream) {
-                stream->cancel();
+                boost::beast::error_code err;
+                stream->socket().close(err);
             }
         }
     };
 
     /**
      * A single thread worker which will include multiple http workers.
+     * The idle http workers are kept in a lock-free queue; if there's no idle worker, the pool grows
+     * until it reaches the server's maximum worker count, and after that the sockets are queued until
+     * a worker becomes idle.
      * More info:
      *   https://stackoverflow.com/a/63717201/4987470
      */
@@ -331,6 +723,10 @@ namespace webpp::beast_proto {
         using http_worker_allocator_type = traits::allocator_type_of<traits_type, http_worker_type>;
         using http_workers_type          = stl::list<http_worker_type, http_worker_allocator_type>;
         using socket_type                = asio::ip::tcp::socket;
+        using idle_workers_type =
+          mpmc_queue<http_worker_type*, traits::allocator_type_of<traits_type, http_worker_type*>>;
+        using pending_sockets_type =
+          stl::deque<socket_type, traits::allocator_type_of<traits_type, socket_type>>;
 
         static constexpr auto log_cat = "Beast";
 
@@ -342,50 +738,138 @@ namespace webpp::beast_proto {
 
         explicit thread_worker(server_type& input_server)
           : server(&input_server),
-            http_workers{get_allocator<http_workers_type>(*server)} {
-            for (stl::size_t i = 0UL; i != server->http_worker_count; ++i) {
-                http_workers.emplace_back(server);
+            http_workers{get_allocator<http_workers_type>(*server)},
+            pending_sockets{get_allocator<pending_sockets_type>(*server)} {}
+
+        /**
+         * Create the initial http workers.
+         * This is not done in the constructor because the user may change the worker counts after the
+         * server is constructed.
+         */
+        void init() {
+            auto const initial_count = server->http_worker_count;
+            max_workers              = stl::max(initial_count, server->max_http_worker_count);
+            idle_workers.emplace(max_workers, get_allocator<http_worker_type*>(*server));
+            for (stl::size_t i = 0UL; i != initial_count; ++i) {
+                auto&                       worker_ref = http_workers.emplace_back(server, this);
+                [[maybe_unused]] bool const pushed     = idle_workers->try_push(&worker_ref);
             }
-            worker = http_workers.begin();
+            worker_count_val.store(http_workers.size(), stl::memory_order_relaxed);
         }
 
         void start_work(socket_type&& sock) {
-            http_worker_type* worker_ptr; // NOLINT(cppcoreguidelines-init-variables)
-            {
-                [[maybe_unused]] stl::scoped_lock lock{worker_mutex};
-
-                worker_ptr = worker.operator->();
-                worker_ptr->set_socket(stl::move(sock));
-                next_worker();
+            http_worker_type* worker_ptr = nullptr;
+            if (!idle_workers->try_pop(worker_ptr)) [[unlikely]] {
+                saturations.up();
+                worker_ptr = grow();
+                if (worker_ptr == nullptr) {
+                    // we've reached the maximum number of workers, the socket has to wait for one of them
+                    {
+                        [[maybe_unused]] stl::scoped_lock lock{pending_mutex};
+                        pending_sockets.push_back(stl::move(sock));
+                    }
+                    pending_count.fetch_add(1, stl::memory_order_seq_cst);
+                    drain_pending();
+                    return;
+                }
             }
+            worker_ptr->set_socket(stl::move(sock));
             worker_ptr->start();
         }
 
-        void stop() {
+        /**
+         * The http worker is done with its connection; give it the next queued socket, or put it back
+         * into the idle queue.
+         */
+        void release(http_worker_type* worker_ptr) noexcept {
+            if (pending_count.load(stl::memory_order_acquire) != 0) {
+                if (auto sock = take_pending(); sock) {
+                    worker_ptr->set_socket(stl::move(*sock));
+                    worker_ptr->start();
+                    return;
+                }
+            }
+
+            // the queue's capacity is the maximum number of workers, so this can't fail
+            [[maybe_unused]] bool const pushed = idle_workers->try_push(worker_ptr);
+            drain_pending();
+        }
+
+        /// Close the connections; the io context that runs them should be stopped already
+        void close_connections() {
+            [[maybe_unused]] stl::scoped_lock lock{grow_mutex};
             for (auto& hworker : http_workers) {
-                hworker.stop();
+                hworker.close();
             }
         }
 
+        /// Number of times a connection was accepted while no http worker was idle
+        [[nodiscard]] stl::size_t saturation_count() const noexcept {
+            return saturations.get();
+        }
+
+        /// Number of accepted connections that are waiting for an idle http worker
+        [[nodiscard]] stl::size_t pending_sockets_count() const noexcept {
+            return pending_count.load(stl::memory_order_relaxed);
+        }
+
+        [[nodiscard]] stl::size_t worker_count() const noexcept {
+            return worker_count_val.load(stl::memory_order_relaxed);
+        }
+
       private:
-        // get the next available worker
-        void next_worker() noexcept {
-            // todo: a cooler algorithm can be used here, right? You can even give the user a choice
-            for (;;) {
-                ++worker;
-                if (worker == http_workers.end()) {
-                    worker = http_workers.begin();
+        // add a new http worker if we're allowed to; returns nullptr if the pool is at its cap
+        [[nodiscard]] http_worker_type* grow() {
+            [[maybe_unused]] stl::scoped_lock lock{grow_mutex};
+            if (http_workers.size() >= max_workers) {
+                return nullptr;
+            }
+            auto& worker_ref = http_workers.emplace_back(server, this);
+            worker_count_val.store(http_workers.size(), stl::memory_order_relaxed);
+            return &worker_ref;
+        }
+
+        [[nodiscard]] stl::optional<socket_type> take_pending() noexcept {
+            [[maybe_unused]] stl::scoped_lock lock{pending_mutex};
+            if (pending_sockets.empty()) {
+                return stl::nullopt;
+            }
+            stl::optional<socket_type> sock{stl::move(pending_sockets.front())};
+            pending_sockets.pop_front();
+            pending_count.fetch_sub(1, stl::memory_order_relaxed);
+            return sock;
+        }
+
+        // start the queued sockets as long as there are idle workers for them
+        void drain_pending() noexcept {
+            // pairs with the pending_count increment in start_work, so either the acceptor sees the idle
+            // worker or the idle worker sees the pending socket
+            stl::atomic_thread_fence(stl::memory_order_seq_cst);
+            while (pending_count.load(stl::memory_order_relaxed) != 0) {
+                http_worker_type* worker_ptr = nullptr;
+                if (!idle_workers->try_pop(worker_ptr)) {
+                    return;
                 }
-                if (worker->is_idle()) {
-                    break;
+                auto sock = take_pending();
+                if (!sock) {
+                    [[maybe_unused]] bool const pushed = idle_workers->try_push(worker_ptr);
+                    return;
                 }
+                worker_ptr->set_socket(stl::move(*sock));
+                worker_ptr->start();
             }
         }
 
-        server_type*                         server;
-        http_workers_type                    http_workers;
-        typename http_workers_type::iterator worker;
-        stl::mutex                           worker_mutex;
+        server_type*                     server;
+        http_workers_type                http_workers;
+        stl::optional<idle_workers_type> idle_workers{stl::nullopt};
+        stl::size_t                      max_workers = 0;
+        pending_sockets_type             pending_sockets;
+        stl::atomic<stl::size_t>         pending_count{0};
+        stl::atomic<stl::size_t>         worker_count_val{0};
+        atomic_counter<>                 saturations;
+        stl::mutex                       grow_mutex;
+        stl::mutex                       pending_mutex;
     };
 
 } // namespace webpp::beast_proto
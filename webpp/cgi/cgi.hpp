@@ -13,6 +13,7 @@
 #include "./cgi_request_body_communicator.hpp"
 
 #include <iostream>
+#include <unistd.h>
 
 namespace webpp::http {
 
@@ -137,6 +138,40 @@ namespace webpp::http {
             // NOLINTEND(cppcoreguidelines-pro-type-reinterpret-cast)
         }
 
+        // Send the file straight to the standard output if possible, and read it chunk by chunk if not
+        template <typename BodyType>
+        inline void write_file(BodyType& body) {
+            using body_type = stl::remove_cvref_t<BodyType>;
+            if constexpr (requires { typename body_type::file_communicator_type; }) {
+                using file_type = typename body_type::file_communicator_type;
+                if (auto* file = stl::get_if<file_type>(&body.communicator())) {
+                    stl::cout.flush(); // the headers are still in the stream's buffer
+                    while (!file->empty()) {
+                        if (file->send_to(STDOUT_FILENO) <= 0) {
+                            break;
+                        }
+                    }
+                }
+            }
+            write_cstream(body); // the rest of it, if the zero-copy path isn't available
+        }
+
+        // Write the chunks as soon as they're produced; the web server frames them for the client
+        template <typename BodyType>
+        inline void write_chunks(BodyType& body) {
+            using body_type = stl::remove_cvref_t<BodyType>;
+            if constexpr (requires { typename body_type::chunked_communicator_type; }) {
+                using chunked_type = typename body_type::chunked_communicator_type;
+                if (auto* chunks = stl::get_if<chunked_type>(&body.communicator())) {
+                    while (chunks->next_chunk()) {
+                        auto const chunk = chunks->chunk();
+                        write(chunk.data(), static_cast<stl::streamsize>(chunk.size()));
+                        stl::cout.flush();
+                    }
+                }
+            }
+        }
+
         template <typename BodyType>
         inline void write_response_body(BodyType& body) {
             using body_type = stl::remove_cvref_t<BodyType>;
@@ -158,6 +193,14 @@ namespace webpp::http {
                         write_text(body);
                         break;
                     }
+                    case file_based: {
+                        write_file(body);
+                        break;
+                    }
+                    case chunked_based: {
+                        write_chunks(body);
+                        break;
+                    }
                 }
             } else if constexpr (TextBasedBodyReader<body_type>) {
                 write_text(body);
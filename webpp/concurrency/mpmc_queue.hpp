@@ -0,0 +1,144 @@
+#ifndef WEBPP_CONCURRENCY_MPMC_QUEUE_HPP
+#define WEBPP_CONCURRENCY_MPMC_QUEUE_HPP
+
+#include "../memory/allocator_concepts.hpp"
+#include "../std/vector.hpp"
+
+#include <atomic>
+#include <bit>
+#include <cstddef>
+
+namespace webpp {
+
+    /// The size of a cache line; used for keeping the producer and consumer indices apart
+    static constexpr stl::size_t cache_line_size = 64;
+
+    /**
+     * Bounded lock-free Multi-Producer Multi-Consumer queue.
+     *
+     * Each cell has a sequence number that tells the producers and the consumers whose turn it is to
+     * touch that cell, so neither side needs a lock; the only contention is one CAS on the enqueue or
+     * dequeue position.
+     * The capacity is fixed at construction (rounded up to a power of two) and the queue never allocates
+     * after that.
+     *
+     * More info:
+     *   https://www.1024cores.net/home/lock-free-algorithms/queues/bounded-mpmc-queue
+     */
+    template <typename T, Allocator AllocType = stl::allocator<T>>
+        requires(stl::is_nothrow_move_assignable_v<T> && stl::is_default_constructible_v<T>)
+    struct mpmc_queue {
+        using value_type = T;
+        using size_type  = stl::size_t;
+
+      private:
+        struct cell {
+            stl::atomic<size_type> sequence{0};
+            value_type             data{};
+        };
+
+        using cell_allocator_type = typename stl::allocator_traits<AllocType>::template rebind_alloc<cell>;
+        using cells_type          = stl::vector<cell, cell_allocator_type>;
+
+        cells_type cells;
+        size_type  mask;
+
+        alignas(cache_line_size) stl::atomic<size_type> enqueue_pos{0};
+        alignas(cache_line_size) stl::atomic<size_type> dequeue_pos{0};
+
+      public:
+        explicit mpmc_queue(size_type const capacity, AllocType const& alloc = {})
+          : cells(stl::bit_ceil(capacity < 2 ? size_type{2} : capacity), cell_allocator_type{alloc}),
+            mask{cells.size() - 1} {
+            for (size_type index = 0; index != cells.size(); ++index) {
+                cells[index].sequence.store(index, stl::memory_order_relaxed);
+            }
+        }
+
+        mpmc_queue(mpmc_queue const&)                = delete;
+        mpmc_queue(mpmc_queue&&) noexcept            = delete;
+        mpmc_queue& operator=(mpmc_queue const&)     = delete;
+        mpmc_queue& operator=(mpmc_queue&&) noexcept = delete;
+        ~mpmc_queue()                                = default;
+
+        /**
+         * Add the value to the end of the queue
+         * @returns false if the queue is full
+         */
+        [[nodiscard]] bool try_push(value_type const& value) noexcept
+            requires(stl::is_nothrow_copy_constructible_v<value_type>)
+        {
+            return try_push(value_type{value});
+        }
+
+        /**
+         * Move the value to the end of the queue; it's left untouched if the queue is full
+         * @returns false if the queue is full
+         */
+        [[nodiscard]] bool try_push(value_type&& value) noexcept {
+            auto  pos = enqueue_pos.load(stl::memory_order_relaxed);
+            cell* cur = nullptr;
+            for (;;) {
+                cur             = &cells[pos & mask];
+                auto const seq  = cur->sequence.load(stl::memory_order_acquire);
+                auto const diff = static_cast<stl::ptrdiff_t>(seq) - static_cast<stl::ptrdiff_t>(pos);
+                if (diff == 0) {
+                    if (enqueue_pos.compare_exchange_weak(pos, pos + 1, stl::memory_order_relaxed)) {
+                        break;
+                    }
+                } else if (diff < 0) {
+                    return false; // full
+                } else {
+                    pos = enqueue_pos.load(stl::memory_order_relaxed);
+                }
+            }
+            cur->data = stl::move(value);
+            cur->sequence.store(pos + 1, stl::memory_order_release);
+            return true;
+        }
+
+        /**
+         * Take the first value out of the queue
+         * @returns false if the queue is empty
+         */
+        [[nodiscard]] bool try_pop(value_type& value) noexcept {
+            auto  pos = dequeue_pos.load(stl::memory_order_relaxed);
+            cell* cur = nullptr;
+            for (;;) {
+                cur             = &cells[pos & mask];
+                auto const seq  = cur->sequence.load(stl::memory_order_acquire);
+                auto const diff = static_cast<stl::ptrdiff_t>(seq) - static_cast<stl::ptrdiff_t>(pos + 1);
+                if (diff == 0) {
+                    if (dequeue_pos.compare_exchange_weak(pos, pos + 1, stl::memory_order_relaxed)) {
+                        break;
+                    }
+                } else if (diff < 0) {
+                    return false; // empty
+                } else {
+                    pos = dequeue_pos.load(stl::memory_order_relaxed);
+                }
+            }
+            value = stl::move(cur->data);
+            cur->sequence.store(pos + mask + 1, stl::memory_order_release);
+            return true;
+        }
+
+        [[nodiscard]] size_type capacity() const noexcept {
+            return cells.size();
+        }
+
+        /// The number of elements in the queue; only an estimate if other threads are using the queue
+        [[nodiscard]] size_type size_approx() const noexcept {
+            auto const enq = enqueue_pos.load(stl::memory_order_relaxed);
+            auto const deq = dequeue_pos.load(stl::memory_order_relaxed);
+            return enq > deq ? enq - deq : 0;
+        }
+
+        [[nodiscard]] bool empty_approx() const noexcept {
+            return size_approx() == 0;
+        }
+    };
+
+} // namespace webpp
+
+#endif // WEBPP_CONCURRENCY_MPMC_QUEUE_HPP
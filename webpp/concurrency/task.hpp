@@ -0,0 +1,133 @@
+// Created by moisrex on 10/17/26.
+
+#ifndef WEBPP_CONCURRENCY_TASK_HPP
+#define WEBPP_CONCURRENCY_TASK_HPP
+
+#include "../std/std.hpp"
+
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <type_traits>
+#include <utility>
+
+namespace webpp {
+
+    /**
+     * A move-only `void()` callable for the thread pools.
+     *
+     * The callables that are trivially copyable (the lambdas that capture pointers, references, and
+     * numbers) and fit in the buffer are stored inline, so they're not allocated; the rest are allocated,
+     * and only their pointer is stored. That makes the task itself trivially relocatable: it can be
+     * copied into and out of a lock-free queue word by word (see `raw_type`).
+     */
+    template <stl::size_t BufferWords = 6>
+    struct basic_task {
+        using word_type    = stl::uintptr_t;
+        using storage_type = stl::array<word_type, BufferWords>;
+
+        static constexpr stl::size_t buffer_size = sizeof(storage_type);
+
+        template <typename Callable>
+        static constexpr bool is_inline =
+          stl::is_trivially_copyable_v<Callable> && sizeof(Callable) <= buffer_size &&
+          alignof(Callable) <= alignof(storage_type);
+
+      private:
+        enum struct operation : bool { run, destroy };
+
+        // runs (and destroys), or only destroys the callable
+        using handler_type = void (*)(operation, storage_type&);
+
+      public:
+        /// The bits of a task; trivially copyable, so it can be put in a lock-free queue
+        struct raw_type {
+            handler_type handler = nullptr;
+            storage_type storage{};
+        };
+
+        constexpr basic_task() noexcept = default;
+
+        template <typename Callable>
+            requires(!stl::same_as<stl::remove_cvref_t<Callable>, basic_task> &&
+                     stl::is_invocable_v<stl::decay_t<Callable>&>)
+        explicit(false) basic_task(Callable&& callable) { // NOLINT(*-forwarding-reference-overload)
+            using callable_type = stl::decay_t<Callable>;
+            if constexpr (is_inline<callable_type>) {
+                new (raw.storage.data()) callable_type(stl::forward<Callable>(callable));
+                raw.handler = [](operation const op, storage_type& storage) {
+                    // NOLINTNEXTLINE(*-pro-type-reinterpret-cast)
+                    auto* const ptr = stl::launder(reinterpret_cast<callable_type*>(storage.data()));
+                    if (op == operation::run) {
+                        stl::invoke(*ptr);
+                    }
+                };
+            } else {
+                auto* const ptr = new callable_type(stl::forward<Callable>(callable));
+                new (raw.storage.data()) callable_type*(ptr);
+                raw.handler = [](operation const op, storage_type& storage) {
+                    // NOLINTNEXTLINE(*-pro-type-reinterpret-cast)
+                    stl::unique_ptr<callable_type> owner{*reinterpret_cast<callable_type**>(storage.data())};
+                    if (op == operation::run) {
+                        stl::invoke(*owner);
+                    }
+                };
+            }
+        }
+
+        /// Adopt the bits of a task that were taken by `release`
+        explicit constexpr basic_task(raw_type const& inp_raw) noexcept : raw{inp_raw} {}
+
+        basic_task(basic_task const&)            = delete;
+        basic_task& operator=(basic_task const&) = delete;
+
+        constexpr basic_task(basic_task&& other) noexcept : raw{other.release()} {}
+
+        constexpr basic_task& operator=(basic_task&& other) noexcept {
+            if (this != &other) {
+                reset();
+                raw = other.release();
+            }
+            return *this;
+        }
+
+        constexpr ~basic_task() {
+            reset();
+        }
+
+        [[nodiscard]] explicit constexpr operator bool() const noexcept {
+            return raw.handler != nullptr;
+        }
+
+        /// Run the callable, and destroy it; the task is empty after this
+        void operator()() {
+            // the task is emptied first, so it's still empty if the callable throws
+            auto cur = release();
+            cur.handler(operation::run, cur.storage);
+        }
+
+        /// Destroy the callable without running it
+        constexpr void reset() noexcept {
+            if (raw.handler != nullptr) {
+                auto cur = release();
+                cur.handler(operation::destroy, cur.storage);
+            }
+        }
+
+        /// Give up the ownership of the callable; it should be adopted by another task
+        [[nodiscard]] constexpr raw_type release() noexcept {
+            return stl::exchange(raw, raw_type{});
+        }
+
+      private:
+        raw_type raw{};
+    };
+
+    using task = basic_task<>;
+
+} // namespace webpp
+
+#endif // WEBPP_CONCURRENCY_TASK_HPP
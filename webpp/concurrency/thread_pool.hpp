@@ -3,15 +3,272 @@
 #ifndef WEBPP_THREAD_POOL_HPP
 #define WEBPP_THREAD_POOL_HPP
 
-#include "../std/vector.hpp"
+#include "../memory/allocator_concepts.hpp"
+#include "./mpmc_queue.hpp"
+#include "./task.hpp"
+#include "./work_stealing_deque.hpp"
 
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <deque>
 #include <thread>
 
 namespace webpp {
 
-    template <typename AllocType>
+    /**
+     * Work-Stealing Thread Pool
+     *
+     * Each thread has its own lock-free deque; the tasks that are posted from inside the pool (by the
+     * tasks themselves) go to the deque of the current thread, and the rest go to a shared lock-free
+     * queue. An idle thread takes from its own deque first, then from the shared queue, then it steals
+     * the oldest task of the other threads; the threads only park (futex-based `atomic::wait`) when
+     * there's nothing to steal for a while, and posting a task only wakes one of them up if none of the
+     * threads is already looking for a task.
+     *
+     * The pool is meant to be shared; anything that needs to run something in the background (the
+     * protocols, the utilities) can post to it instead of spawning its own threads.
+     */
+    template <Allocator AllocType = stl::allocator<stl::byte>>
     struct thread_pool {
-        stl::vector<stl::thread, AllocType> threads;
+        using task_type      = task;
+        using allocator_type = AllocType;
+        using size_type      = stl::size_t;
+
+        /// The size of the shared queue of the tasks that are posted from outside the pool
+        static constexpr size_type injector_capacity = 4096;
+
+        /// How many times an idle thread looks for a task (yielding in between) before it parks
+        static constexpr size_type search_rounds = 4;
+
+      private:
+        using raw_task_type = typename task_type::raw_type;
+        using deque_type    = work_stealing_deque<
+          raw_task_type,
+          typename stl::allocator_traits<allocator_type>::template rebind_alloc<raw_task_type>>;
+
+        struct alignas(cache_line_size) worker {
+            thread_pool*  owner;
+            deque_type    tasks;
+            stl::uint32_t seed; // for picking the victims randomly
+            stl::thread   thread{};
+
+            worker(thread_pool& inp_owner, size_type const index, allocator_type const& alloc)
+              : owner{&inp_owner},
+                tasks{deque_type::default_capacity, alloc},
+                seed{static_cast<stl::uint32_t>(index * 2'654'435'761U + 1U)} {}
+        };
+
+        using worker_allocator_type =
+          typename stl::allocator_traits<allocator_type>::template rebind_alloc<worker>;
+        using task_allocator_type =
+          typename stl::allocator_traits<allocator_type>::template rebind_alloc<task_type>;
+
+        // the worker of the current thread, if the current thread is in a pool
+        static inline thread_local worker* current_worker = nullptr;
+
+        stl::deque<worker, worker_allocator_type>  workers;
+        mpmc_queue<task_type, task_allocator_type> injector;
+
+        alignas(cache_line_size) stl::atomic<stl::uint32_t> wake_epoch{0};
+        alignas(cache_line_size) stl::atomic<stl::uint32_t> sleepers{0};
+        stl::atomic<stl::uint32_t> searching{0}; // the threads that are awake, and looking for a task
+        stl::atomic<stl::uint32_t> posting{0}; // the posts from outside the pool that are on their way
+        stl::atomic_bool           stopping{false};
+        stl::atomic_bool           joined{false};
+
+        [[nodiscard]] task_type find_task(worker& self) noexcept {
+            if (auto raw = self.tasks.take()) {
+                return task_type{*raw};
+            }
+            if (task_type cur; injector.try_pop(cur)) {
+                return cur;
+            }
+
+            // steal, starting from a random worker
+            self.seed ^= self.seed << 13U;
+            self.seed ^= self.seed >> 17U;
+            self.seed ^= self.seed << 5U;
+            auto const count = workers.size();
+            auto const start = static_cast<size_type>(self.seed) % count;
+            for (size_type index = 0; index != count; ++index) {
+                auto& victim = workers[(start + index) % count];
+                if (&victim == &self) {
+                    continue;
+                }
+                // a failed steal only means that someone else has got the task; there might be more
+                while (!victim.tasks.empty_approx()) {
+                    if (auto raw = victim.tasks.steal()) {
+                        return task_type{*raw};
+                    }
+                }
+            }
+            return {};
+        }
+
+        [[nodiscard]] task_type search(worker& self) noexcept {
+            searching.fetch_add(1, stl::memory_order_seq_cst);
+            task_type cur;
+            for (size_type round = 0; round != search_rounds && !cur; ++round) {
+                stl::this_thread::yield();
+                cur = find_task(self);
+            }
+            searching.fetch_sub(1, stl::memory_order_seq_cst);
+            if (cur) {
+                // there might be more of them
+                notify_one();
+            }
+            return cur;
+        }
+
+        void run(worker& self) noexcept {
+            current_worker = &self;
+            for (;;) {
+                if (auto cur = find_task(self)) {
+                    cur();
+                    continue;
+                }
+
+                // look for a while before parking; the posters don't wake anyone up while someone is
+                // looking, so a burst of tasks doesn't wake up the threads one by one
+                if (auto cur = search(self)) {
+                    cur();
+                    continue;
+                }
+
+                // park; the epoch is read before looking again, so a task that's posted in between
+                // changes it and the wait returns immediately
+                auto const epoch = wake_epoch.load(stl::memory_order_acquire);
+                sleepers.fetch_add(1, stl::memory_order_seq_cst);
+                stl::atomic_thread_fence(stl::memory_order_seq_cst);
+                if (auto cur = find_task(self)) {
+                    sleepers.fetch_sub(1, stl::memory_order_relaxed);
+                    cur();
+                    continue;
+                }
+                if (stopping.load(stl::memory_order_acquire)) {
+                    sleepers.fetch_sub(1, stl::memory_order_relaxed);
+                    break;
+                }
+                wake_epoch.wait(epoch, stl::memory_order_acquire);
+                sleepers.fetch_sub(1, stl::memory_order_relaxed);
+            }
+            current_worker = nullptr;
+        }
+
+        // wake up a parked thread, if there's any
+        void notify_one() noexcept {
+            stl::atomic_thread_fence(stl::memory_order_seq_cst);
+            if (searching.load(stl::memory_order_relaxed) == 0 &&
+                sleepers.load(stl::memory_order_relaxed) != 0)
+            {
+                wake_epoch.fetch_add(1, stl::memory_order_release);
+                wake_epoch.notify_one();
+            }
+        }
+
+      public:
+        explicit thread_pool(size_type const      count = stl::max(stl::thread::hardware_concurrency(), 1U),
+                             allocator_type const& alloc = {})
+          : workers{worker_allocator_type{alloc}},
+            injector{injector_capacity, task_allocator_type{alloc}} {
+            auto const thread_count = stl::max<size_type>(count, 1);
+            for (size_type index = 0; index != thread_count; ++index) {
+                workers.emplace_back(*this, index, alloc);
+            }
+            // the workers are all there before any of them starts stealing
+            for (auto& cur : workers) {
+                cur.thread = stl::thread{[this, &cur] {
+                    run(cur);
+                }};
+            }
+        }
+
+        explicit thread_pool(allocator_type const& alloc)
+          : thread_pool{stl::max(stl::thread::hardware_concurrency(), 1U), alloc} {}
+
+        thread_pool(thread_pool const&)                = delete;
+        thread_pool(thread_pool&&) noexcept            = delete;
+        thread_pool& operator=(thread_pool const&)     = delete;
+        thread_pool& operator=(thread_pool&&) noexcept = delete;
+
+        ~thread_pool() {
+            join();
+        }
+
+        /**
+         * Run the callable in one of the threads.
+         *
+         * The callables that are posted from inside the pool are run by the same thread unless another
+         * thread steals them; if the shared queue is full, the callable is run right here (the caller
+         * runs it), and so it is once the pool is joining.
+         *
+         * @returns false if the callable was run by the caller instead of the pool
+         */
+        template <typename Callable>
+            requires(stl::is_invocable_v<stl::decay_t<Callable>&>)
+        bool post(Callable&& callable) {
+            task_type cur{stl::forward<Callable>(callable)};
+            if (auto* const self = current_worker; self != nullptr && self->owner == this) {
+                self->tasks.push(cur.release());
+                notify_one();
+                return true;
+            }
+
+            // join() waits for this to drop to zero after it sets `stopping`, so a task that makes it into
+            // the shared queue is in there before the threads are joined and the queue is drained
+            posting.fetch_add(1, stl::memory_order_seq_cst);
+            if (stopping.load(stl::memory_order_seq_cst) || !injector.try_push(stl::move(cur))) [[unlikely]] {
+                posting.fetch_sub(1, stl::memory_order_release);
+                cur();
+                return false;
+            }
+            posting.fetch_sub(1, stl::memory_order_release);
+            notify_one();
+            return true;
+        }
+
+        /// Number of the threads
+        [[nodiscard]] size_type size() const noexcept {
+            return workers.size();
+        }
+
+        /// Check if the current thread is one of the threads of this pool
+        [[nodiscard]] bool is_current_thread() const noexcept {
+            return current_worker != nullptr && current_worker->owner == this;
+        }
+
+        /**
+         * Run the tasks that are posted already (and the tasks that they post), and then stop the
+         * threads; the callables that are posted after this are run by the caller.
+         */
+        void join() {
+            if (joined.exchange(true, stl::memory_order_acq_rel)) {
+                return;
+            }
+            stopping.store(true, stl::memory_order_seq_cst);
+            while (posting.load(stl::memory_order_acquire) != 0) {
+                stl::this_thread::yield();
+            }
+            wake_epoch.fetch_add(1, stl::memory_order_release);
+            wake_epoch.notify_all();
+            for (auto& cur : workers) {
+                if (cur.thread.joinable()) {
+                    cur.thread.join();
+                }
+            }
+
+            // whatever the threads have left behind is run here; the tasks that these post are run by the
+            // caller too, because `stopping` is set
+            for (auto& cur : workers) {
+                while (auto raw = cur.tasks.steal()) {
+                    task_type{*raw}();
+                }
+            }
+            for (task_type cur; injector.try_pop(cur);) {
+                cur();
+            }
+        }
     };
 
 } // namespace webpp
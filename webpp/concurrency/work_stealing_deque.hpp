@@ -0,0 +1,195 @@
+// Created by moisrex on 10/17/26.
+
+#ifndef WEBPP_CONCURRENCY_WORK_STEALING_DEQUE_HPP
+#define WEBPP_CONCURRENCY_WORK_STEALING_DEQUE_HPP
+
+#include "../memory/allocator_concepts.hpp"
+#include "../std/optional.hpp"
+#include "../std/vector.hpp"
+#include "./mpmc_queue.hpp" // cache_line_size
+
+#include <array>
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <cstring> // memcpy
+#include <memory>
+
+namespace webpp {
+
+    /**
+     * Lock-free Chase-Lev work-stealing deque.
+     *
+     * The owner thread pushes and takes from the bottom (LIFO, so the data it has just touched is still
+     * in its cache), and the other threads steal from the top (FIFO, so they take the oldest, and
+     * usually the biggest, pieces of work). The owner only pays for a CAS when it takes the last element,
+     * and a thief only pays for one CAS per steal.
+     *
+     * A thief reads an element before it knows if it has won it, so the elements are stored as atomic
+     * words (that's why T should be trivially copyable) and the read is thrown away if the CAS fails.
+     * The buffer grows when it's full; the old buffers are kept until the deque is destroyed, because a
+     * thief might still be reading them.
+     *
+     * More info:
+     *   "Correct and Efficient Work-Stealing for Weak Memory Models" (Lê, Pop, Cohen, Nardelli; 2013)
+     */
+    template <typename T, Allocator AllocType = stl::allocator<T>>
+        requires(stl::is_trivially_copyable_v<T> && stl::is_default_constructible_v<T>)
+    struct work_stealing_deque {
+        using value_type = T;
+        using size_type  = stl::size_t;
+        using index_type = stl::int64_t;
+
+        static constexpr size_type default_capacity = 256;
+
+      private:
+        using word_type = stl::uintptr_t;
+
+        static constexpr size_type words_per_value = (sizeof(value_type) + sizeof(word_type) - 1) /
+                                                     sizeof(word_type);
+
+        using words_type = stl::array<word_type, words_per_value>;
+
+        struct cell {
+            stl::array<stl::atomic<word_type>, words_per_value> words{};
+
+            void store(value_type const& value) noexcept {
+                words_type bits{};
+                stl::memcpy(bits.data(), &value, sizeof(value_type));
+                for (size_type index = 0; index != words_per_value; ++index) {
+                    words[index].store(bits[index], stl::memory_order_relaxed);
+                }
+            }
+
+            [[nodiscard]] value_type load() const noexcept {
+                words_type bits{};
+                for (size_type index = 0; index != words_per_value; ++index) {
+                    bits[index] = words[index].load(stl::memory_order_relaxed);
+                }
+                value_type value;
+                stl::memcpy(static_cast<void*>(&value), bits.data(), sizeof(value_type));
+                return value;
+            }
+        };
+
+        using cell_allocator_type = typename stl::allocator_traits<AllocType>::template rebind_alloc<cell>;
+        using cells_type          = stl::vector<cell, cell_allocator_type>;
+        using buffers_allocator_type =
+          typename stl::allocator_traits<AllocType>::template rebind_alloc<cells_type>;
+
+        // the current buffer is the last one; the rest are retired
+        stl::vector<cells_type, buffers_allocator_type> buffers;
+
+        alignas(cache_line_size) stl::atomic<index_type> top{0};
+        alignas(cache_line_size) stl::atomic<index_type> bottom{0};
+        alignas(cache_line_size) stl::atomic<cells_type*> current{nullptr};
+
+        [[nodiscard]] static cell& at(cells_type& cells, index_type const index) noexcept {
+            return cells[static_cast<size_type>(index) & (cells.size() - 1)];
+        }
+
+        // double the buffer; only the owner calls this
+        [[nodiscard]] cells_type* grow(cells_type& old_cells, index_type const first, index_type const last) {
+            auto& cells = buffers.emplace_back(old_cells.size() * 2, old_cells.get_allocator());
+            for (index_type index = first; index != last; ++index) {
+                at(cells, index).store(at(old_cells, index).load());
+            }
+            current.store(&cells, stl::memory_order_release);
+            return &cells;
+        }
+
+      public:
+        explicit work_stealing_deque(size_type const capacity = default_capacity, AllocType const& alloc = {})
+          : buffers{buffers_allocator_type{alloc}} {
+            buffers.reserve(sizeof(index_type) * 8); // the buffers never move, so the thieves can use them
+            buffers.emplace_back(stl::bit_ceil(capacity < 2 ? size_type{2} : capacity),
+                                 cell_allocator_type{alloc});
+            current.store(&buffers.back(), stl::memory_order_relaxed);
+        }
+
+        work_stealing_deque(work_stealing_deque const&)                = delete;
+        work_stealing_deque(work_stealing_deque&&) noexcept            = delete;
+        work_stealing_deque& operator=(work_stealing_deque const&)     = delete;
+        work_stealing_deque& operator=(work_stealing_deque&&) noexcept = delete;
+        ~work_stealing_deque()                                         = default;
+
+        /// Add the value to the bottom; only the owner thread may call this
+        void push(value_type const& value) {
+            auto const last  = bottom.load(stl::memory_order_relaxed);
+            auto const first = top.load(stl::memory_order_acquire);
+            auto*      cells = current.load(stl::memory_order_relaxed);
+            if (last - first > static_cast<index_type>(cells->size()) - 1) [[unlikely]] {
+                cells = grow(*cells, first, last);
+            }
+            at(*cells, last).store(value);
+            stl::atomic_thread_fence(stl::memory_order_release);
+            bottom.store(last + 1, stl::memory_order_relaxed);
+        }
+
+        /// Take the value from the bottom (the newest one); only the owner thread may call this
+        [[nodiscard]] stl::optional<value_type> take() noexcept {
+            auto const last  = bottom.load(stl::memory_order_relaxed) - 1;
+            auto*      cells = current.load(stl::memory_order_relaxed);
+            bottom.store(last, stl::memory_order_relaxed);
+            stl::atomic_thread_fence(stl::memory_order_seq_cst);
+            auto first = top.load(stl::memory_order_relaxed);
+            if (first > last) {
+                // empty
+                bottom.store(last + 1, stl::memory_order_relaxed);
+                return stl::nullopt;
+            }
+            auto value = at(*cells, last).load();
+            if (first == last) {
+                // the last one; the thieves might be after it too
+                bool const won = top.compare_exchange_strong(first,
+                                                             first + 1,
+                                                             stl::memory_order_seq_cst,
+                                                             stl::memory_order_relaxed);
+                bottom.store(last + 1, stl::memory_order_relaxed);
+                if (!won) {
+                    return stl::nullopt;
+                }
+            }
+            return value;
+        }
+
+        /// Take the value from the top (the oldest one); any thread may call this
+        [[nodiscard]] stl::optional<value_type> steal() noexcept {
+            auto first = top.load(stl::memory_order_acquire);
+            stl::atomic_thread_fence(stl::memory_order_seq_cst);
+            auto const last = bottom.load(stl::memory_order_acquire);
+            if (first >= last) {
+                return stl::nullopt; // empty
+            }
+            auto* const cells = current.load(stl::memory_order_acquire);
+            auto        value = at(*cells, first).load();
+            if (!top.compare_exchange_strong(first,
+                                             first + 1,
+                                             stl::memory_order_seq_cst,
+                                             stl::memory_order_relaxed))
+            {
+                return stl::nullopt; // lost the race to the owner or another thief
+            }
+            return value;
+        }
+
+        [[nodiscard]] size_type capacity() const noexcept {
+            return current.load(stl::memory_order_relaxed)->size();
+        }
+
+        /// The number of elements; only an estimate if other threads are using the deque
+        [[nodiscard]] size_type size_approx() const noexcept {
+            auto const last  = bottom.load(stl::memory_order_relaxed);
+            auto const first = top.load(stl::memory_order_relaxed);
+            return last > first ? static_cast<size_type>(last - first) : 0;
+        }
+
+        [[nodiscard]] bool empty_approx() const noexcept {
+            return size_approx() == 0;
+        }
+    };
+
+} // namespace webpp
+
+#endif // WEBPP_CONCURRENCY_WORK_STEALING_DEQUE_HPP
@@ -0,0 +1,143 @@
+// Created by moisrex on 10/17/26.
+
+#ifndef WEBPP_HTTP_BODIES_CHUNKED_HPP
+#define WEBPP_HTTP_BODIES_CHUNKED_HPP
+
+#include "../../std/functional.hpp"
+#include "../../std/string.hpp"
+#include "../../std/string_view.hpp"
+#include "../../traits/enable_traits.hpp"
+#include "../body_concepts.hpp"
+
+#include <algorithm>
+#include <cstddef>
+
+namespace webpp::http {
+
+    /**
+     * Chunked Body Communicator
+     *
+     * The body is produced while it's being sent; the producer is asked for the next piece of the body
+     * whenever the protocol is ready to send more, so the whole body is never in memory (a big view that
+     * is being rendered for example). The protocols that know about this communicator send each piece as
+     * a chunk of a "Transfer-Encoding: chunked" response, and the rest of them read it through the
+     * CStream-based interface.
+     *
+     * The producer appends (about) "chunk_size" bytes to the specified string, and returns false when
+     * there's nothing more to produce:
+     *   bool producer(string_type& out, stl::size_t chunk_size);
+     *
+     * Copying the body copies the producer, so the copies share the state of the producer, if it has one.
+     */
+    template <Traits TraitsType>
+    struct chunked_body {
+        using traits_type      = TraitsType;
+        using string_type      = traits::string<traits_type>;
+        using string_view_type = traits::string_view<traits_type>;
+        using byte_type        = stl::byte;
+        using producer_type    = istl::function<bool(string_type&, stl::size_t),
+                                                traits::allocator_type_of<traits_type, stl::byte>>;
+
+        static constexpr stl::size_t default_chunk_size = 16 * 1024; // 16 KiB
+
+        template <EnabledTraits ET, typename ProducerT>
+            requires(stl::is_invocable_r_v<bool, ProducerT&, string_type&, stl::size_t>)
+        chunked_body(ET&&              etraits,
+                     ProducerT&&       inp_producer,
+                     stl::size_t const inp_chunk_size = default_chunk_size)
+          : producer{stl::forward<ProducerT>(inp_producer), get_alloc_for<producer_type>(etraits)},
+            buffer{get_alloc_for<string_type>(etraits)},
+            max_size{stl::max<stl::size_t>(inp_chunk_size, 1)} {}
+
+        /// An empty body; there's nothing to produce
+        template <EnabledTraits ET>
+        explicit chunked_body(ET&& etraits)
+          : producer{get_alloc_for<producer_type>(etraits)},
+            buffer{get_alloc_for<string_type>(etraits)},
+            finished{true} {}
+
+        /**
+         * Produce the next chunk
+         * @returns false if the body is finished, and there's no more chunks
+         */
+        [[nodiscard]] bool next_chunk() {
+            return produce();
+        }
+
+        /// The current chunk (the part of it that is not read yet)
+        [[nodiscard]] string_view_type chunk() const noexcept {
+            return string_view_type{buffer}.substr(position);
+        }
+
+        /// The size that the producer is asked to produce each time
+        [[nodiscard]] stl::size_t chunk_size() const noexcept {
+            return max_size;
+        }
+
+        [[nodiscard]] bool empty() const noexcept {
+            return finished && position == buffer.size();
+        }
+
+        /**
+         * Read the body as a C-Stream; the chunks are produced while they're being read.
+         */
+        [[nodiscard]] stl::streamsize read(byte_type* data, stl::streamsize const count) const {
+            stl::streamsize read_size = 0;
+            while (read_size < count) {
+                if (position == buffer.size() && !produce()) {
+                    break;
+                }
+                auto const size =
+                  stl::min(static_cast<stl::size_t>(count - read_size), buffer.size() - position);
+                // NOLINTBEGIN(*-pro-type-reinterpret-cast, *-pro-bounds-pointer-arithmetic)
+                stl::copy_n(buffer.data() + position, size, reinterpret_cast<char*>(data + read_size));
+                // NOLINTEND(*-pro-type-reinterpret-cast, *-pro-bounds-pointer-arithmetic)
+                position  += size;
+                read_size += static_cast<stl::streamsize>(size);
+            }
+            return read_size;
+        }
+
+      private:
+        // drop the current chunk, and ask the producer for the next one
+        bool produce() const {
+            buffer.clear();
+            position = 0;
+            while (buffer.empty() && !finished) {
+                finished = !producer || !producer(buffer, max_size);
+            }
+            return !buffer.empty();
+        }
+
+        mutable producer_type producer;
+        mutable string_type   buffer;
+        stl::size_t           max_size = default_chunk_size;
+        mutable stl::size_t   position = 0;
+        mutable bool          finished = false;
+    };
+
+    ////////////////////////////// Body Serializer ( Object into Body ) //////////////////////////////
+
+    // Put the chunked body in the body without producing it, if the body supports it
+    template <typename T, HTTPBody BodyType>
+        requires(ChunkedBodyReader<stl::remove_cvref_t<T>>)
+    constexpr void tag_invoke(serialize_body_tag, T&& chunks, BodyType& body) {
+        using body_type  = stl::remove_cvref_t<BodyType>;
+        using chunk_type = stl::remove_cvref_t<T>;
+        if constexpr (requires { body.communicator().template emplace<chunk_type>(stl::move(chunks)); }) {
+            body.communicator().template emplace<chunk_type>(stl::forward<T>(chunks));
+        } else {
+            using traits_type = typename body_type::traits_type;
+            using string_type = traits::string<traits_type>;
+            string_type content{get_alloc_for<string_type>(body)};
+            chunk_type  producing{stl::forward<T>(chunks)};
+            while (producing.next_chunk()) {
+                content.append(producing.chunk());
+            }
+            body = content;
+        }
+    }
+
+} // namespace webpp::http
+
+#endif // WEBPP_HTTP_BODIES_CHUNKED_HPP
@@ -3,13 +3,337 @@
 #ifndef WEBPP_HTTP_BODIES_FILE_HPP
 #define WEBPP_HTTP_BODIES_FILE_HPP
 
+#include "../../std/string_view.hpp"
 #include "../../storage/file.hpp"
+#include "../../strings/append.hpp"
+#include "../../strings/iequals.hpp"
+#include "../status_code.hpp"
 #include "./string.hpp"
 
+#include <cerrno>
+#include <charconv>
 #include <filesystem>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <utility>
+#ifdef __linux__
+#    include <sys/sendfile.h>
+#endif
 
 namespace webpp::http {
 
+    /**
+     * The result of applying the "Range" header of a request to a file body
+     */
+    enum struct file_range_status : stl::uint_fast8_t {
+        whole,        // no (usable) range is specified, the whole file is sent
+        partial,      // only the requested range is sent (206 Partial Content)
+        unsatisfiable // the requested range is outside the file (416 Range Not Satisfiable)
+    };
+
+    /**
+     * File Based Body Communicator
+     *
+     * The file is not loaded into memory; only its file descriptor is kept open. The protocols that know
+     * about this communicator send the file straight from the kernel to the socket (sendfile), and the
+     * rest of them read it chunk by chunk through the CStream-based interface.
+     *
+     * Copying the body duplicates the file descriptor, but the copies share the file offset of the
+     * kernel, that's why "pread" is used for reading instead of "read".
+     */
+    struct file_body {
+        using byte_type   = stl::byte;
+        using handle_type = int;
+
+        constexpr file_body() noexcept = default;
+
+        explicit file_body(stl::filesystem::path const& file_path) noexcept
+          : fd{::open(file_path.c_str(), O_RDONLY | O_CLOEXEC)} { // NOLINT(*-pro-type-vararg)
+            init();
+        }
+
+        /// Take the ownership of the specified file descriptor
+        explicit file_body(handle_type const inp_fd) noexcept : fd{inp_fd} {
+            init();
+        }
+
+        file_body(file_body const& other) noexcept
+          : fd{other.fd < 0 ? -1 : ::dup(other.fd)},
+            error{other.fd >= 0 && fd < 0 ? errno : other.error},
+            whole_size{other.whole_size},
+            range_begin{other.range_begin},
+            range_end{other.range_end},
+            position{other.position},
+            range_status{other.range_status} {}
+
+        file_body(file_body&& other) noexcept
+          : fd{stl::exchange(other.fd, -1)},
+            error{other.error},
+            whole_size{other.whole_size},
+            range_begin{other.range_begin},
+            range_end{other.range_end},
+            position{other.position},
+            range_status{other.range_status} {}
+
+        file_body& operator=(file_body const& other) noexcept {
+            if (this != &other) {
+                *this = file_body{other};
+            }
+            return *this;
+        }
+
+        file_body& operator=(file_body&& other) noexcept {
+            if (this != &other) {
+                close();
+                fd           = stl::exchange(other.fd, -1);
+                error        = other.error;
+                whole_size   = other.whole_size;
+                range_begin  = other.range_begin;
+                range_end    = other.range_end;
+                position     = other.position;
+                range_status = other.range_status;
+            }
+            return *this;
+        }
+
+        ~file_body() noexcept {
+            close();
+        }
+
+        [[nodiscard]] bool is_open() const noexcept {
+            return fd >= 0;
+        }
+
+        [[nodiscard]] handle_type native_handle() const noexcept {
+            return fd;
+        }
+
+        // The "errno" of the last failed operation; zero if there's no error
+        [[nodiscard]] int error_number() const noexcept {
+            return error;
+        }
+
+        // The size of the whole file, as reported by fstat
+        [[nodiscard]] stl::size_t file_size() const noexcept {
+            return whole_size;
+        }
+
+        // The file offset of the next byte that is going to be sent
+        [[nodiscard]] stl::size_t offset() const noexcept {
+            return position;
+        }
+
+        // The first byte of the range that is being sent
+        [[nodiscard]] stl::size_t range_first() const noexcept {
+            return range_begin;
+        }
+
+        // The last byte (inclusive) of the range that is being sent; only meaningful if it's not empty
+        [[nodiscard]] stl::size_t range_last() const noexcept {
+            return range_end - 1;
+        }
+
+        [[nodiscard]] file_range_status status() const noexcept {
+            return range_status;
+        }
+
+        // The number of bytes that are left to be sent
+        [[nodiscard]] stl::size_t size() const noexcept {
+            return range_end - position;
+        }
+
+        [[nodiscard]] bool empty() const noexcept {
+            return position >= range_end;
+        }
+
+        // Mark the specified number of bytes as sent; used by the protocols that send the file themselves
+        void consume(stl::size_t const count) noexcept {
+            position = stl::min(position + count, range_end);
+        }
+
+        // Go to the specified position relative to the beginning of the range
+        void seek(stl::streamsize const count) noexcept {
+            position = stl::min(range_begin + static_cast<stl::size_t>(stl::max(count, stl::streamsize{0})),
+                                range_end);
+        }
+
+        /**
+         * Only send the specified range of the file; the range is clamped to the file's size.
+         * Both first and last are inclusive, the same as the "Range" header.
+         */
+        void set_range(stl::size_t const first, stl::size_t const last) noexcept {
+            range_begin  = stl::min(first, whole_size);
+            range_end    = last >= whole_size ? whole_size : last + 1;
+            range_end    = stl::max(range_begin, range_end);
+            position     = range_begin;
+            range_status = range_begin == 0 && range_end == whole_size ? file_range_status::whole
+                                                                        : file_range_status::partial;
+        }
+
+        /**
+         * Apply the value of the "Range" request header (RFC 9110, section 14.2).
+         * Only single byte-ranges are supported; multiple ranges are ignored and the whole file is sent,
+         * which the RFC allows.
+         */
+        file_range_status apply_range(stl::string_view range) noexcept {
+            static constexpr stl::string_view bytes_unit = "bytes=";
+
+            if (range.size() <= bytes_unit.size() ||
+                !ascii::iequals(range.substr(0, bytes_unit.size()), bytes_unit) ||
+                range.find(',') != stl::string_view::npos)
+            {
+                return range_status;
+            }
+            range.remove_prefix(bytes_unit.size());
+
+            auto const dash = range.find('-');
+            if (dash == stl::string_view::npos) {
+                return range_status;
+            }
+            auto const first_str = range.substr(0, dash);
+            auto const last_str  = range.substr(dash + 1);
+
+            stl::size_t first = 0;
+            stl::size_t last  = 0;
+            if (first_str.empty()) {
+                // suffix range: the last N bytes
+                if (!parse_position(last_str, last)) {
+                    return range_status;
+                }
+                if (last == 0 || whole_size == 0) {
+                    return unsatisfiable();
+                }
+                set_range(whole_size - stl::min(last, whole_size), whole_size - 1);
+                return range_status = file_range_status::partial;
+            }
+            if (!parse_position(first_str, first) || (!last_str.empty() && !parse_position(last_str, last)) ||
+                (!last_str.empty() && last < first))
+            {
+                return range_status;
+            }
+            if (first >= whole_size) {
+                return unsatisfiable();
+            }
+            set_range(first, last_str.empty() ? whole_size - 1 : last);
+            return range_status = file_range_status::partial;
+        }
+
+        /**
+         * Read the next chunk of the file; this is the fallback for when zero-copy is not possible.
+         * @returns the number of bytes read, zero on the end of the range or on error.
+         */
+        [[nodiscard]] stl::streamsize read(byte_type* data, stl::streamsize const count) const noexcept {
+            auto const max_count = stl::min(static_cast<stl::size_t>(stl::max(count, stl::streamsize{0})),
+                                            range_end - position);
+            if (max_count == 0 || fd < 0) {
+                return 0;
+            }
+            for (;;) {
+                auto const read_size = ::pread(fd, data, max_count, static_cast<off_t>(position));
+                if (read_size < 0 && errno == EINTR) {
+                    continue;
+                }
+                if (read_size <= 0) {
+                    error = read_size < 0 ? errno : 0;
+                    return 0;
+                }
+                position += static_cast<stl::size_t>(read_size);
+                return static_cast<stl::streamsize>(read_size);
+            }
+        }
+
+        /**
+         * Send the rest of the range to the specified socket with sendfile(2); the file's content doesn't
+         * go through the user-space at all.
+         * With non-blocking sockets, this may send only a part of the range; call it again when the socket
+         * is writable.
+         *
+         * @returns the number of bytes sent, or a negative errno; -ENOSYS and -EINVAL mean that the
+         * zero-copy path is not available for this file/socket, and the caller should fall back to "read".
+         */
+        [[nodiscard]] stl::ptrdiff_t send_to([[maybe_unused]] handle_type const sock) noexcept {
+#ifdef __linux__
+            if (fd < 0) {
+                return -EBADF;
+            }
+            stl::ptrdiff_t total = 0;
+            while (!empty()) {
+                auto       off  = static_cast<off_t>(position);
+                auto const sent = ::sendfile(sock, fd, &off, size());
+                if (sent > 0) {
+                    position += static_cast<stl::size_t>(sent);
+                    total    += sent;
+                    continue;
+                }
+                if (sent < 0 && errno == EINTR) {
+                    continue;
+                }
+                if (sent == 0) {
+                    // the file got smaller after we've sent the headers; nothing we can do about it
+                    return total != 0 ? total : -EIO;
+                }
+                if (total != 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+                    return total;
+                }
+                return -errno;
+            }
+            return total;
+#else
+            return -ENOSYS;
+#endif
+        }
+
+      private:
+        handle_type         fd = -1;
+        mutable int         error{0};
+        stl::size_t         whole_size  = 0;
+        stl::size_t         range_begin = 0;
+        stl::size_t         range_end   = 0;
+        mutable stl::size_t position    = 0;
+        file_range_status   range_status{file_range_status::whole};
+
+        void init() noexcept {
+            struct stat info {};
+
+            if (fd < 0) {
+                error = errno;
+                return;
+            }
+            if (::fstat(fd, &info) != 0) {
+                error = errno;
+                close();
+                return;
+            }
+            if (!S_ISREG(info.st_mode)) {
+                error = EISDIR;
+                close();
+                return;
+            }
+            whole_size = static_cast<stl::size_t>(info.st_size);
+            range_end  = whole_size;
+        }
+
+        void close() noexcept {
+            if (fd >= 0) {
+                ::close(fd);
+                fd = -1;
+            }
+        }
+
+        file_range_status unsatisfiable() noexcept {
+            range_begin = range_end = position = whole_size;
+            return range_status = file_range_status::unsatisfiable;
+        }
+
+        static bool parse_position(stl::string_view const str, stl::size_t& out) noexcept {
+            auto const* const end = str.data() + str.size(); // NOLINT(*-pro-bounds-pointer-arithmetic)
+            auto const [ptr, err] = stl::from_chars(str.data(), end, out);
+            return !str.empty() && err == stl::errc{} && ptr == end;
+        }
+    };
+
+    static_assert(FileBasedBodyReader<file_body>, "The file body should be a valid file based body reader.");
 
     ////////////////////////////// Body Serializer ( Object into Body ) //////////////////////////////
 
@@ -24,6 +348,64 @@ namespace webpp::http {
         body = file_content;
     }
 
+    // Put the file in the body without reading it, if the body supports it
+    template <typename T, HTTPBody BodyType>
+        requires(stl::same_as<stl::remove_cvref_t<T>, file_body>)
+    constexpr void tag_invoke(serialize_body_tag, T&& file, BodyType& body) {
+        using body_type = stl::remove_cvref_t<BodyType>;
+        if constexpr (requires { body.communicator().template emplace<file_body>(stl::forward<T>(file)); }) {
+            body.communicator().template emplace<file_body>(stl::forward<T>(file));
+        } else {
+            using traits_type = typename body_type::traits_type;
+            using string_type = traits::string<traits_type>;
+            string_type file_content{get_alloc_for<string_type>(body)};
+            file_content.resize(file.size());
+            // NOLINTNEXTLINE(*-pro-type-reinterpret-cast)
+            auto* const data = reinterpret_cast<stl::byte*>(file_content.data());
+            file_content.resize(static_cast<stl::size_t>(file.read(data, file_content.size())));
+            body = file_content;
+        }
+    }
+
+    /**
+     * Set the range related headers as well as the body:
+     *   - Accept-Ranges: bytes
+     *   - Content-Range and "206 Partial Content" if a range of the file is being sent
+     *   - Content-Range and "416 Range Not Satisfiable" if the requested range was out of the file
+     * The Content-Length is calculated from the range by the response itself.
+     */
+    template <typename T, HTTPResponse ResT>
+        requires(stl::same_as<stl::remove_cvref_t<T>, file_body>)
+    constexpr void tag_invoke(serialize_response_body_tag, T&& file, ResT& res) {
+        using string_type = typename stl::remove_cvref_t<decltype(res.headers)>::field_type::string_type;
+
+        res.headers.set("Accept-Ranges", "bytes");
+        switch (file.status()) {
+            case file_range_status::whole: break;
+            case file_range_status::partial: {
+                string_type value{res.headers.get_allocator()};
+                value.append("bytes ");
+                append_to(value, file.range_first());
+                value.push_back('-');
+                append_to(value, file.range_last());
+                value.push_back('/');
+                append_to(value, file.file_size());
+                res.headers.set("Content-Range", stl::move(value));
+                res.headers.status_code(status_code::partial_content);
+                break;
+            }
+            case file_range_status::unsatisfiable: {
+                string_type value{res.headers.get_allocator()};
+                value.append("bytes */");
+                append_to(value, file.file_size());
+                res.headers.set("Content-Range", stl::move(value));
+                res.headers.status_code(status_code::range_not_satisfiable);
+                break;
+            }
+        }
+        serialize_body(stl::forward<T>(file), res.body);
+    }
+
 } // namespace webpp::http
 
 #endif // WEBPP_HTTP_BODIES_FILE_HPP
@@ -17,6 +17,7 @@
 
 #include <filesystem>
 #include <fstream>
+#include <variant>
 
 namespace webpp::http {
 
@@ -137,6 +138,44 @@ namespace webpp::http {
             // NOLINTEND(cppcoreguidelines-pro-type-reinterpret-cast)
         }
 
+        // Read the file of a unified body without moving the body's own read position
+        template <typename T, typename BodyType>
+            requires(istl::String<T>)
+        constexpr void deserialize_file_body(T& str, BodyType const& body) {
+            using body_type = stl::remove_cvref_t<BodyType>;
+            if constexpr (requires { typename body_type::file_communicator_type; }) {
+                using file_type = typename body_type::file_communicator_type;
+                using byte_type = typename file_type::byte_type;
+                if (auto const* file_reader = stl::get_if<file_type>(&body.communicator())) {
+                    file_type   file{*file_reader}; // has its own position
+                    auto const  str_size   = str.size();
+                    stl::size_t read_total = 0;
+                    str.resize(str_size + file.size());
+                    // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+                    auto* const byte_data = reinterpret_cast<byte_type*>(str.data() + str_size);
+                    while (auto const read = file.read(byte_data + read_total,
+                                                       static_cast<stl::streamsize>(file.size())))
+                    {
+                        read_total += static_cast<stl::size_t>(read);
+                    }
+                    str.resize(str_size + read_total);
+                }
+            }
+        }
+
+        // Produce the chunks of a unified body into the string; the chunks are produced only once
+        template <typename T, typename BodyType>
+            requires(istl::String<T>)
+        constexpr void deserialize_chunked_body(T& str, BodyType const& body) {
+            using body_type = stl::remove_cvref_t<BodyType>;
+            if constexpr (requires { typename body_type::chunked_communicator_type; }) {
+                using chunked_type = typename body_type::chunked_communicator_type;
+                if (auto const* chunked_reader = stl::get_if<chunked_type>(&body.communicator())) {
+                    deserialize_cstream_body(str, *chunked_reader);
+                }
+            }
+        }
+
         template <typename T>
             requires(istl::String<T>)
         constexpr void deserialize_stream_body(T& str, StreamBasedBodyReader auto const& body) {
@@ -165,6 +204,14 @@ namespace webpp::http {
                             deserialize_cstream_body(str, body);
                             break;
                         }
+                        case file_based: {
+                            deserialize_file_body(str, body);
+                            break;
+                        }
+                        case chunked_based: {
+                            deserialize_chunked_body(str, body);
+                            break;
+                        }
                         default: stl::unreachable();
                     }
                 } else if constexpr (TextBasedBodyReader<body_type>) {
@@ -187,6 +234,8 @@ namespace webpp::http {
                             case text_based: break;
                             case cstream_based:
                             case stream_based:
+                            case file_based:
+                            case chunked_based:
                                 throw stl::invalid_argument(
                                   "You're asking us to get the data of a body type while the body doesn't "
                                   "contain "
@@ -323,7 +372,9 @@ namespace webpp::http {
         if constexpr (UnifiedBodyReader<body_type>) {
             switch (body.which_communicator()) {
                 using enum communicator_type;
-                case nothing: // nothing in the body, we can set a new string there
+                case nothing:       // nothing in the body, we can set a new string there
+                case file_based:    // files are replaced by the string
+                case chunked_based: // so are the chunks
                 case text_based: {
                     details::serialize_text_body(str_view, body);
                     break;
@@ -9,6 +9,8 @@
 #include "../std/type_traits.hpp"
 #include "../std/vector.hpp"
 #include "../traits/traits.hpp"
+#include "./bodies/chunked.hpp"
+#include "./bodies/file.hpp"
 #include "./bodies/string.hpp"
 #include "./http_concepts.hpp"
 
@@ -37,6 +39,11 @@ namespace webpp::http {
     template <Traits TraitsType>
     using string_response_body_communicator = traits::string<TraitsType>;
 
+    using file_response_body_communicator = file_body;
+
+    template <Traits TraitsType>
+    using chunked_response_body_communicator = chunked_body<TraitsType>;
+
     template <Traits TraitsType>
     using stream_response_body_communicator = stl::shared_ptr<
       stl::basic_stringstream<traits::char_type<TraitsType>,
@@ -114,6 +121,8 @@ namespace webpp::http {
         using string_communicator_type  = string_response_body_communicator<traits_type>;
         using cstream_communicator_type = cstream_response_body_communicator<traits_type>;
         using stream_communicator_type  = stream_response_body_communicator<traits_type>;
+        using file_communicator_type    = file_response_body_communicator;
+        using chunked_communicator_type = chunked_response_body_communicator<traits_type>;
         using stream_type               = typename stream_communicator_type::element_type;
 
         using byte_type  = stl::byte; // required by CStreamBasedBodyWriter
@@ -125,7 +134,9 @@ namespace webpp::http {
           stl::variant<stl::monostate,
                        string_communicator_type,
                        cstream_communicator_type,
-                       stream_communicator_type>;
+                       stream_communicator_type,
+                       file_communicator_type,
+                       chunked_communicator_type>;
 
 
         static_assert(TextBasedBodyCommunicator<string_communicator_type>,
@@ -134,6 +145,10 @@ namespace webpp::http {
                       "Response body Stream Based Body Communicator is not a valid SBBC.");
         static_assert(CStreamBasedBodyCommunicator<cstream_communicator_type>,
                       "Response body CStream Based Body Communicator is not a valid BBBC.");
+        static_assert(FileBasedBodyReader<file_communicator_type>,
+                      "Response body File Based Body Communicator is not a valid file based body reader.");
+        static_assert(ChunkedBodyReader<chunked_communicator_type>,
+                      "Response body Chunked Body Communicator is not a valid chunked body reader.");
 
         static constexpr auto log_cat = "Body";
 
@@ -159,7 +174,9 @@ namespace webpp::http {
             requires(istl::part_of<stl::remove_cvref_t<ComT>,
                                    string_communicator_type,
                                    stream_communicator_type,
-                                   cstream_communicator_type>)
+                                   cstream_communicator_type,
+                                   file_communicator_type,
+                                   chunked_communicator_type>)
         explicit constexpr body_communicator(ET&& etraits, ComT&& inp_communicator)
           : etraits_type{stl::forward<ET>(etraits)},
             communicator_var{stl::forward<ComT>(inp_communicator)} {}
@@ -241,6 +258,8 @@ namespace webpp::http {
         using string_communicator_type  = string_response_body_communicator<traits_type>;
         using cstream_communicator_type = cstream_response_body_communicator<traits_type>;
         using stream_communicator_type  = stream_response_body_communicator<traits_type>;
+        using file_communicator_type    = file_response_body_communicator;
+        using chunked_communicator_type = chunked_response_body_communicator<traits_type>;
         using stream_type               = typename stream_communicator_type::element_type;
 
         using stream_char_type  = typename istl::remove_shared_ptr_t<stream_communicator_type>::char_type;
@@ -253,8 +272,10 @@ namespace webpp::http {
 
         using body_communicator<TraitsType>::body_communicator;
 
-        constexpr body_reader(body_reader const& other)
-          : body_communicator<TraitsType>{other.get_traits(), other.as_string_communicator()} {}
+        // Files are not read into strings on copy; the copy gets its own file descriptor instead
+        constexpr body_reader(body_reader const& other) : body_communicator<TraitsType>{other.get_traits()} {
+            copy_communicator(other);
+        }
 
         template <HTTPBodyHolder H>
             requires(EnabledTraits<H>)
@@ -264,8 +285,7 @@ namespace webpp::http {
 
         constexpr body_reader& operator=(body_reader const& other) {
             if (this != &other) {
-                this->communicator().template emplace<string_communicator_type>(
-                  other.as_string_communicator());
+                copy_communicator(other);
             }
             return *this;
         }
@@ -305,6 +325,9 @@ namespace webpp::http {
                     return cstream_reader->size();
                 }
             }
+            if (auto const* file_reader = stl::get_if<file_communicator_type>(&this->communicator())) {
+                return file_reader->size(); // the remaining bytes of the range, known from fstat
+            }
             return string_communicator_type::npos;
         }
 
@@ -318,6 +341,12 @@ namespace webpp::http {
             if (auto* cstr_reader = stl::get_if<cstream_communicator_type>(&this->communicator())) {
                 return cstr_reader->empty();
             }
+            if (auto const* file_reader = stl::get_if<file_communicator_type>(&this->communicator())) {
+                return file_reader->empty();
+            }
+            if (auto const* chunked_reader = stl::get_if<chunked_communicator_type>(&this->communicator())) {
+                return chunked_reader->empty();
+            }
             return true;
         }
 
@@ -333,6 +362,12 @@ namespace webpp::http {
             if (auto* reader = stl::get_if<cstream_communicator_type>(&this->communicator())) {
                 return reader->read(data, count);
             }
+            if (auto* file_reader = stl::get_if<file_communicator_type>(&this->communicator())) {
+                return file_reader->read(data, count);
+            }
+            if (auto* chunked_reader = stl::get_if<chunked_communicator_type>(&this->communicator())) {
+                return chunked_reader->read(data, count);
+            }
             if (auto* stream_reader = stl::get_if<stream_communicator_type>(&this->communicator())) {
                 // this->logger.warning(log_cat, "Stream to CStream Cross-Talk is discouraged.");
                 // todo: this is kinda implementation defined, it may falsely return 0
@@ -480,6 +515,8 @@ namespace webpp::http {
                     return this_size == body.size() && stl::equal(data(), data() + this_size, body.data());
                 }
                 case stream_based: // we can't check equality of streams without changing them
+                case file_based:
+                case chunked_based: // the chunks are produced only once
                 case cstream_based:
                     return false;  // c-streams don't have a mechanism to read but don't modify, so always
                     // false too
@@ -490,6 +527,20 @@ namespace webpp::http {
         [[nodiscard]] constexpr bool operator!=(body_reader const& body) const noexcept {
             return !operator==(body);
         }
+
+      private:
+        constexpr void copy_communicator(body_reader const& other) {
+            if (auto const* file_reader = stl::get_if<file_communicator_type>(&other.communicator())) {
+                this->communicator().template emplace<file_communicator_type>(*file_reader);
+            } else if (auto const* chunked_reader =
+                         stl::get_if<chunked_communicator_type>(&other.communicator()))
+            {
+                this->communicator().template emplace<chunked_communicator_type>(*chunked_reader);
+            } else {
+                this->communicator().template emplace<string_communicator_type>(
+                  other.as_string_communicator());
+            }
+        }
     };
 
     template <Traits TraitsType>
@@ -499,6 +550,8 @@ namespace webpp::http {
         using string_communicator_type  = string_response_body_communicator<traits_type>;
         using cstream_communicator_type = cstream_response_body_communicator<traits_type>;
         using stream_communicator_type  = stream_response_body_communicator<traits_type>;
+        using file_communicator_type    = file_response_body_communicator;
+        using chunked_communicator_type = chunked_response_body_communicator<traits_type>;
         using stream_type               = typename stream_communicator_type::element_type;
 
         using stream_char_type  = typename istl::remove_shared_ptr_t<stream_communicator_type>::char_type;
@@ -630,6 +683,10 @@ namespace webpp::http {
                           })
             {
                 this->communicator().template emplace<string_communicator_type>(obj.as_string_communicator());
+            } else if constexpr (stl::same_as<stl::remove_cvref_t<T>, file_communicator_type>) {
+                this->communicator().template emplace<file_communicator_type>(stl::forward<T>(obj));
+            } else if constexpr (stl::same_as<stl::remove_cvref_t<T>, chunked_communicator_type>) {
+                this->communicator().template emplace<chunked_communicator_type>(stl::forward<T>(obj));
             } else if constexpr (stl::constructible_from<string_communicator_type, T>) {
                 this->communicator().template emplace<string_communicator_type>(stl::forward<T>(obj));
             } else if constexpr (stl::constructible_from<stream_communicator_type, T>) {
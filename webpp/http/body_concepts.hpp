@@ -4,6 +4,7 @@
 #define WEBPP_HTTP_BODY_CONCEPTS_HPP
 
 #include "../std/memory.hpp"
+#include "../std/optional.hpp"
 #include "../std/tag_invoke.hpp"
 #include "../std/type_traits.hpp"
 
@@ -58,6 +59,38 @@ namespace webpp::http {
     template <typename T>
     concept CStreamBasedBodyCommunicator = CStreamBasedBodyReader<T> && CStreamBasedBodyWriter<T>;
 
+    /**
+     * @brief File Based Body Reader
+     *
+     * The body is a range of a file that is not loaded into memory; the protocols can send it with
+     * sendfile/splice, or read it chunk by chunk since it's a C-Stream based body reader as well.
+     */
+    template <typename T>
+    concept FileBasedBodyReader = CStreamBasedBodyReader<T> && SizableBody<T> && requires(T body) {
+        {
+            body.native_handle()
+        } -> stl::same_as<int>;
+        {
+            body.offset()
+        } -> stl::same_as<stl::size_t>;
+        body.consume(stl::size_t{});
+    };
+
+    /**
+     * @brief Chunked Body Reader
+     *
+     * The body is produced piece by piece while it's being sent (a view that is being rendered for
+     * example), so its size is not known until it's finished; the protocols send it chunk by chunk
+     * (Transfer-Encoding: chunked), or read it through its C-Stream based interface.
+     */
+    template <typename T>
+    concept ChunkedBodyReader = CStreamBasedBodyReader<T> && requires(T body) {
+        {
+            body.next_chunk()
+        } -> stl::same_as<bool>;
+        body.chunk();
+    };
+
     /**
      * @brief Text Based Body Reader
      */
@@ -246,7 +279,9 @@ namespace webpp::http {
         nothing    = 0, // contains nothing (monostate)
         text_based = 1,
         cstream_based,
-        stream_based
+        stream_based,
+        file_based,
+        chunked_based
     };
 
     template <typename T>
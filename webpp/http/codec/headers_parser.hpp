@@ -2,7 +2,7 @@
 #define WEBPP_HTTP_HEADERS_PARSER_HPP
 
 #include "../../std/string_view.hpp"
-#include "tokens.hpp"
+#include "scanner.hpp"
 
 #include <cstdint>
 #include <iterator>
@@ -11,7 +11,8 @@ namespace webpp::http {
 
     enum struct parsing_status : stl::uint_fast8_t {
         unknown,         // unknown status, we haven't started yet
-        done,            // no error
+        field,           // a header field is parsed, and there might be more
+        done,            // no error; reached the empty line at the end of the headers
         bad_eof,         // we reached the end of buffer where we shouldn't have
         unexpected_char, // Unexpected Character found
         empty_name       // Empty field names are not allowed in HTTP
@@ -24,15 +25,23 @@ namespace webpp::http {
      *   - Header Name (Start and End positions)
      *   - Header Value (Start and End positions)
      *
+     * The buffer should start right after the request line (or the status line), and each increment
+     * parses one header field; the status is "field" until the empty line at the end of the headers is
+     * reached ("done"), and the current position is then the start of the body.
+     *
      * Features of this iterator:
      *   - constexpr friendly
      *   - noexcept
      *   - no-allocation
      *   - doesn't parse the values
      *   - doesn't merge header field values
+     *   - rejects obsolete line folding (RFC 9112 Section 5.2) and the white spaces before the colon
+     *   - the names and the values are scanned by the Scanner (see simd_scanner), many characters at a time
      *
      **/
-    struct headers_parser_iterator {
+    template <typename Scanner = simd_scanner>
+    struct basic_headers_parser_iterator {
+        using scanner_type      = Scanner;
         using value_type        = char const*;
         using difference_type   = stl::size_t;
         using reference         = value_type&;
@@ -56,37 +65,48 @@ namespace webpp::http {
 
 
       public:
-        constexpr headers_parser_iterator(value_type inp_buf, value_type inp_end) noexcept
+        constexpr basic_headers_parser_iterator(value_type inp_buf, value_type inp_end) noexcept
           : buf{inp_buf},
             buf_end{inp_end} {}
 
-        constexpr headers_parser_iterator(headers_parser_iterator const&)                = default;
-        constexpr headers_parser_iterator(headers_parser_iterator&&) noexcept            = default;
-        constexpr headers_parser_iterator& operator=(headers_parser_iterator const&)     = default;
-        constexpr headers_parser_iterator& operator=(headers_parser_iterator&&) noexcept = default;
-        constexpr ~headers_parser_iterator() noexcept                                    = default;
+        template <typename StrViewT>
+            requires requires(StrViewT str) {
+                str.data();
+                str.size();
+            }
+        explicit constexpr basic_headers_parser_iterator(StrViewT str) noexcept
+          : buf{str.data()},
+            buf_end{str.data() + str.size()} {}
+
+        constexpr basic_headers_parser_iterator(basic_headers_parser_iterator const&)     = default;
+        constexpr basic_headers_parser_iterator(basic_headers_parser_iterator&&) noexcept = default;
+        constexpr ~basic_headers_parser_iterator() noexcept                               = default;
+        constexpr basic_headers_parser_iterator& operator=(
+          basic_headers_parser_iterator const&) = default;
+        constexpr basic_headers_parser_iterator& operator=(
+          basic_headers_parser_iterator&&) noexcept = default;
 
         /**
          * Check if the name is equal to the specified string view
          **/
         template <typename StrViewT>
-        constexpr bool operator==(StrViewT str) noexcept {
-            return str == name_start;
+        [[nodiscard]] constexpr bool operator==(StrViewT str) const noexcept {
+            return name<StrViewT>() == str;
         }
 
         /**
          * Get the Field Name
          **/
         template <typename StrViewT = stl::string_view>
-        constexpr StrViewT name() const noexcept {
+        [[nodiscard]] constexpr StrViewT name() const noexcept {
             return {name_start, name_size};
         }
 
         /**
-         * Get the Field Value
+         * Get the Field Value; the leading and trailing white spaces are not included
          **/
         template <typename StrViewT = stl::string_view>
-        constexpr StrViewT value() const noexcept {
+        [[nodiscard]] constexpr StrViewT value() const noexcept {
             return {value_start, value_size};
         }
 
@@ -108,7 +128,7 @@ namespace webpp::http {
             return &buf;
         }
 
-        constexpr headers_parser_iterator& operator+=(difference_type val) noexcept {
+        constexpr basic_headers_parser_iterator& operator+=(difference_type val) noexcept {
             for (difference_type i = 0; i != val; ++i) {
                 operator++();
             }
@@ -116,112 +136,111 @@ namespace webpp::http {
         }
 
         /**
-         * Parse the next value
+         * Parse the next field
+         *   field-line   = field-name ":" OWS field-value OWS
+         *   field-value  = *field-content
+         *   field-vchar  = VCHAR / obs-text
          **/
-        constexpr headers_parser_iterator& operator++() noexcept {
-#define WEBPP_CHECK_EOF()                   \
-    if (buf == buf_end) {                   \
-        set_error(parsing_status::bad_eof); \
-        return *this;                       \
-    }
-
-#define WEBPP_EXPECT_CHAR(ch)                       \
-    if (*buf++ != (ch)) {                           \
-        set_error(parsing_status::unexpected_char); \
-        return *this;                               \
-    }
-
-
-            WEBPP_CHECK_EOF();
-            if (*buf == '\015') {
-                ++buf;
-                WEBPP_EXPECT_CHAR('\012');
-                break;
-            } else if (*buf == '\012') {
-                ++buf;
-                break;
+        constexpr basic_headers_parser_iterator& operator++() noexcept {
+            if (status_value != parsing_status::unknown && status_value != parsing_status::field) {
+                return *this; // we're either done or failed
             }
-            if (*num_headers == max_headers) {
-                status_value = -1;
-                buf = buf_end = nullptr;
+
+            name_start  = nullptr;
+            name_size   = 0;
+            value_start = nullptr;
+            value_size  = 0;
+
+            // the empty line; the end of the headers
+            if (buf == buf_end) {
+                set_error(parsing_status::bad_eof);
                 return *this;
             }
-            if (!(*num_headers != 0 && (*buf == ' ' || *buf == '\t'))) {
-                /* parsing name, but do not discard SP before colon, see
-                 * http://www.mozilla.org/security/announce/2006/mfsa2006-33.html */
-                name_start = buf;
-                static constexpr char alignas(16) ranges1[] =
-                  "\x00 "  // control chars and up to SP
-                  "\"\""   // 0x22
-                  "()"     // 0x28,0x29
-                  ",,"     // 0x2c
-                  "//"     // 0x2f
-                  ":@"     // 0x3a-0x40
-                  "[]"     // 0x5b-0x5d
-                  "{\377"; // 0x7b-0xff
-                int found;
-                buf = findchar_fast(buf, buf_end, ranges1, sizeof(ranges1) - 1, &found);
-                if (!found) {
-                    WEBPP_CHECK_EOF();
-                }
-                for (;;) {
-                    if (*buf == ':') {
-                        break;
-                    } else if (!is_http_token(*buf)) {
-                        set_error(parsing_status::unexpected_char);
-                        return *this;
-                    }
-                    ++buf;
-                    WEBPP_CHECK_EOF();
-                }
-
-                name_size = buf - name_start;
-                if (name_size == 0) {
-                    set_error(parsing_status::empty_name);
+            if (*buf == '\r' || *buf == '\n') {
+                if (!skip_eol()) {
                     return *this;
                 }
-                ++buf;
-                for (;; ++buf) {
-                    WEBPP_CHECK_EOF();
-                    if (!(*buf == ' ' || *buf == '\t')) {
-                        break;
-                    }
-                }
-            } else {
-                name_start = nullptr;
-                name_size  = 0;
+                status_value = parsing_status::done;
+                return *this;
             }
-            char const* value;
-            size_t      value_len;
-            if ((buf = get_token_to_eol(buf, buf_end, &value, &value_len, ret)) == nullptr) {
-                buf = buf_end = nullptr;
+
+            // obsolete line folding (a line starting with a white space) is not allowed
+            if (*buf == ' ' || *buf == '\t') {
+                set_error(parsing_status::unexpected_char);
                 return *this;
             }
-            /* remove trailing SPs and HTABs */
-            char const* value_size_ptr = value + value_len;
-            for (; value_size_ptr != value; --value_size) {
-                char const c = *(value_size_ptr - 1);
-                if (!(c == ' ' || c == '\t')) {
-                    break;
-                }
+
+            // field-name = token
+            name_start = buf;
+            buf        = scanner_type::token_end(buf, buf_end);
+            name_size  = static_cast<size_type>(buf - name_start);
+            if (buf == buf_end) {
+                set_error(parsing_status::bad_eof);
+                return *this;
             }
-            value_start = value;
-            value_size  = value_size_ptr - value;
+            if (*buf != ':') {
+                set_error(parsing_status::unexpected_char);
+                return *this;
+            }
+            if (name_size == 0) {
+                set_error(parsing_status::empty_name);
+                return *this;
+            }
+            ++buf; // the colon
 
-            return *this;
+            // leading OWS
+            for (; buf != buf_end && (*buf == ' ' || *buf == '\t'); ++buf) {
+            }
 
-#undef WEBPP_CHECK_EOF
-#undef WEBPP_EXPECT_CHAR
+            // field-value
+            value_start = buf;
+            buf         = scanner_type::value_end(buf, buf_end);
+            if (buf == buf_end) {
+                set_error(parsing_status::bad_eof);
+                return *this;
+            }
+            if (*buf != '\r' && *buf != '\n') { // control characters
+                set_error(parsing_status::unexpected_char);
+                return *this;
+            }
+
+            // trailing OWS
+            value_type value_last = buf;
+            while (value_last != value_start && (value_last[-1] == ' ' || value_last[-1] == '\t')) {
+                --value_last;
+            }
+            value_size = static_cast<size_type>(value_last - value_start);
+            if (!skip_eol()) {
+                return *this;
+            }
+            status_value = parsing_status::field;
+            return *this;
         }
 
-        constexpr headers_parser_iterator operator++(int) const noexcept {
-            return headers_parser_iterator{*this}.operator++();
+        constexpr basic_headers_parser_iterator operator++(int) noexcept {
+            auto const copy = *this;
+            operator++();
+            return copy;
         }
 
         [[nodiscard]] constexpr parsing_status status() const noexcept {
             return status_value;
         }
 
+        /// A field is parsed and its name and value are available
+        [[nodiscard]] constexpr bool has_field() const noexcept {
+            return status_value == parsing_status::field;
+        }
+
+        [[nodiscard]] constexpr bool is_done() const noexcept {
+            return status_value == parsing_status::done;
+        }
+
+        [[nodiscard]] constexpr bool is_error() const noexcept {
+            return status_value != parsing_status::unknown && status_value != parsing_status::field &&
+                   status_value != parsing_status::done;
+        }
+
         /**
          * Put the parsing error message to the specified `out`put string.
          **/
@@ -248,7 +267,9 @@ namespace webpp::http {
                 case empty_name: {
                     out += "Empty HTTP Header Field Names are not allowed.";
                     print_header(out);
+                    break;
                 }
+                case field:
                 case done: {
                     // no error
                     break;
@@ -262,14 +283,36 @@ namespace webpp::http {
             buf_end      = buf;
         }
 
+        // CRLF, or a bare LF (RFC 9112 Section 2.2 allows the recipients to accept it)
+        [[nodiscard]] constexpr bool skip_eol() noexcept {
+            if (*buf == '\r') {
+                ++buf;
+                if (buf == buf_end) {
+                    set_error(parsing_status::bad_eof);
+                    return false;
+                }
+                if (*buf != '\n') {
+                    set_error(parsing_status::unexpected_char);
+                    return false;
+                }
+            }
+            ++buf;
+            return true;
+        }
+
         // This member function calculates how much of the buffer is necessary for debugging,
         // and puts that much of the headers to the specified output string.
         template <typename StrT>
         constexpr void print_header(StrT& out) const {
-            // todo
+            if (name_size != 0) {
+                out += " Header: ";
+                out.append(name_start, name_size);
+            }
         }
     };
 
+    using headers_parser_iterator = basic_headers_parser_iterator<>;
+
 } // namespace webpp::http
 
 #endif
@@ -0,0 +1,349 @@
+// Created by moisrex on 10/17/26.
+
+#ifndef WEBPP_HTTP_CODEC_REQUEST_HEAD_PARSER_HPP
+#define WEBPP_HTTP_CODEC_REQUEST_HEAD_PARSER_HPP
+
+#include "../../std/algorithm.hpp"
+#include "../../std/string_view.hpp"
+#include "../../traits/traits.hpp"
+#include "../http_version.hpp"
+#include "scanner.hpp"
+
+#include <cstdint>
+#include <type_traits>
+
+namespace webpp::http {
+
+    /**
+     * The limits of the request head; they're checked as the bytes arrive, so the request is rejected as
+     * soon as it goes over one of them, not after the whole head is received.
+     */
+    struct request_head_limits {
+        stl::size_t method = 10;        // 501 (Not Implemented) if the method is not shorter than this
+        stl::size_t uri    = 8000;      // 414 (URI Too Long) if the request target is not shorter than this
+        stl::size_t header = 16 * 1024; // 431 (Request Header Fields Too Large); request line + fields
+    };
+
+    /// Where the request head parser is
+    enum struct request_head_state : stl::uint_fast8_t {
+        method_token, // method = token
+        target,       // request-target, up to the SP
+        version,      // HTTP-version = "HTTP/" DIGIT "." DIGIT
+        line_end,     // CRLF, or a bare LF
+        line_feed,    // the LF of the CRLF
+        field_start,  // a field-name, or the empty line at the end of the head
+        field_name,   // field-name = token
+        value_start,  // the OWS before the field-value
+        field_value,  // field-value, up to the CR or LF
+        done,
+        error
+    };
+
+    /**
+     * Resumable HTTP Request Head Parser
+     *
+     * Unlike http_request_parser, the head doesn't have to be received completely before it can be
+     * parsed; give it the bytes as they arrive (see "feed"), and it continues from where it was left
+     * the last time. The bytes that are already parsed are never parsed again, so parsing a head that
+     * arrives byte by byte is as much work as parsing it in one piece.
+     *
+     * The parser doesn't hold any pointers to the buffer (only the positions in it), so the buffer can
+     * be re-allocated between the feeds, as long as its content is not changed.
+     *
+     * The method, the request target, and the header fields are scanned by the Scanner (see simd_scanner).
+     */
+    template <Traits TraitsType, typename Scanner = simd_scanner>
+    struct http_request_head_parser {
+        using traits_type      = TraitsType;
+        using scanner_type     = Scanner;
+        using string_view_type = traits::string_view<traits_type>;
+        using status_code_type = uint_fast16_t;
+        using size_type        = stl::size_t;
+
+        /// The status code of "feed" when the head is not complete yet, and there's no error so far
+        static constexpr status_code_type need_more = 0;
+
+        request_head_limits limits{};
+
+      private:
+        size_type          pos         = 0; // everything before this position is parsed
+        size_type          method_size = 0;
+        size_type          target_size = 0;
+        size_type          name_begin  = 0;
+        size_type          name_end    = 0;
+        size_type          value_begin = 0;
+        size_type          value_end   = 0;
+        http::version      ver{};
+        status_code_type   status_value = need_more;
+        request_head_state state        = request_head_state::method_token;
+        request_head_state after_line   = request_head_state::field_start; // what comes after this line
+        bool               has_field    = false; // the current line is a header field
+
+        [[nodiscard]] constexpr status_code_type fail(status_code_type const status) noexcept {
+            state        = request_head_state::error;
+            status_value = status;
+            return status;
+        }
+
+        // all the received bytes are parsed, and the head is not complete yet
+        [[nodiscard]] constexpr status_code_type wait(size_type const cur,
+                                                      size_type const received) noexcept {
+            pos = cur;
+            if (received >= limits.header) {
+                return fail(431); // there's no room for the rest of the head
+            }
+            return need_more;
+        }
+
+      public:
+        /**
+         * Continue parsing the head.
+         *
+         * @param data everything that is received so far (not just the new bytes), starting from the first
+         *        byte of the request line; it may contain the body and the next requests as well.
+         * @param on_field called with the name and the value of each header field, as soon as the whole
+         *        field is received; the views are only valid as long as the data is valid.
+         * @returns
+         *   - 0 (need_more): the head is not complete yet
+         *   - 200: the head is complete (see head_size)
+         *   - 400 (Bad Request)
+         *   - 414 (URI Too Long)
+         *   - 431 (Request Header Fields Too Large)
+         *   - 501 (Not Implemented): the method is too long
+         *   - 505 (HTTP Version Not Supported)
+         */
+        template <typename Callable>
+            requires(stl::is_invocable_v<Callable, string_view_type, string_view_type>)
+        constexpr status_code_type feed(string_view_type const data, Callable&& on_field)
+          noexcept(stl::is_nothrow_invocable_v<Callable, string_view_type, string_view_type>) {
+            // https://www.rfc-editor.org/rfc/rfc9112#section-2.1
+            //
+            // HTTP-message   = start-line CRLF *( field-line CRLF ) CRLF [ message-body ]
+            // request-line   = method SP request-target SP HTTP-version
+            // field-line     = field-name ":" OWS field-value OWS
+
+            auto const* const begin = data.data();
+            auto const* const end   = begin + stl::min(data.size(), limits.header);
+            auto const*       cur   = begin + pos;
+            auto const        at    = [begin](char const* const ptr) constexpr noexcept {
+                return static_cast<size_type>(ptr - begin);
+            };
+            for (;;) {
+                switch (state) {
+                    using enum request_head_state;
+                    case method_token: {
+                        auto const* const method_max = begin + stl::min(limits.method, at(end));
+                        cur                          = scanner_type::token_end(cur, method_max);
+                        if (at(cur) == limits.method) {
+                            return fail(501); // Not Implemented
+                        }
+                        if (cur == end) {
+                            return wait(at(cur), data.size());
+                        }
+                        if (*cur != ' ' || cur == begin) {
+                            return fail(400);
+                        }
+                        method_size = at(cur);
+                        ++cur; // SP
+                        state = target;
+                        [[fallthrough]];
+                    }
+                    case target: {
+                        auto const target_begin = method_size + 1;
+                        auto const target_max   = stl::min(target_begin + limits.uri, at(end));
+                        cur                     = scanner_type::target_end(cur, begin + target_max);
+                        if (at(cur) == target_begin + limits.uri) {
+                            return fail(414); // URI Too Long
+                        }
+                        if (cur == end) {
+                            return wait(at(cur), data.size());
+                        }
+                        if (*cur != ' ' || at(cur) == target_begin) {
+                            return fail(400); // a control character or a white space other than SP
+                        }
+                        target_size = at(cur) - target_begin;
+                        ++cur; // SP
+                        state = version;
+                        [[fallthrough]];
+                    }
+                    case version: {
+                        static constexpr string_view_type http_prefix = "HTTP/";
+                        static constexpr size_type        version_size = http_prefix.size() + 3; // HTTP/1.1
+                        if (at(end) - at(cur) < version_size) {
+                            return wait(at(cur), data.size());
+                        }
+                        string_view_type const version_str{cur, version_size};
+                        if (!version_str.starts_with(http_prefix)) {
+                            return fail(400);
+                        }
+                        auto const number = version_str.substr(http_prefix.size());
+                        if (number != "1.0" && number != "1.1") { // todo: add 2.0 and 0.9 as well
+                            return fail(505);                    // HTTP Version Not Supported
+                        }
+                        ver         = http::version{1, static_cast<stl::uint16_t>(number.back() - '0')};
+                        cur        += version_size;
+                        after_line  = field_start;
+                        state       = line_end;
+                        break;
+                    }
+                    case field_start: {
+                        if (cur == end) {
+                            return wait(at(cur), data.size());
+                        }
+                        if (*cur == '\r' || *cur == '\n') {
+                            after_line = done; // the empty line
+                            state      = line_end;
+                            break;
+                        }
+                        if (*cur == ' ' || *cur == '\t') {
+                            return fail(400); // obsolete line folding is not allowed
+                        }
+                        name_begin = at(cur);
+                        state      = field_name;
+                        [[fallthrough]];
+                    }
+                    case field_name: {
+                        cur = scanner_type::token_end(cur, end);
+                        if (cur == end) {
+                            return wait(at(cur), data.size());
+                        }
+                        if (*cur != ':' || at(cur) == name_begin) {
+                            return fail(400); // empty names, and the white spaces before the colon
+                        }
+                        name_end = at(cur);
+                        ++cur; // the colon
+                        state = value_start;
+                        [[fallthrough]];
+                    }
+                    case value_start: {
+                        for (; cur != end && (*cur == ' ' || *cur == '\t'); ++cur) {
+                        }
+                        if (cur == end) {
+                            return wait(at(cur), data.size());
+                        }
+                        value_begin = at(cur);
+                        state       = field_value;
+                        [[fallthrough]];
+                    }
+                    case field_value: {
+                        cur = scanner_type::value_end(cur, end);
+                        if (cur == end) {
+                            return wait(at(cur), data.size());
+                        }
+                        if (*cur != '\r' && *cur != '\n') {
+                            return fail(400); // control characters
+                        }
+                        // trailing OWS
+                        auto const* value_last = cur;
+                        while (at(value_last) != value_begin &&
+                               (value_last[-1] == ' ' || value_last[-1] == '\t'))
+                        {
+                            --value_last;
+                        }
+                        value_end  = at(value_last);
+                        has_field  = true;
+                        after_line = field_start;
+                        state      = line_end;
+                        [[fallthrough]];
+                    }
+                    case line_end: {
+                        if (cur == end) {
+                            return wait(at(cur), data.size());
+                        }
+                        if (*cur != '\r' && *cur != '\n') {
+                            return fail(400);
+                        }
+                        ++cur; // CR, or a bare LF (RFC 9112 Section 2.2 allows the recipients to accept it)
+                        state = line_feed;
+                        [[fallthrough]];
+                    }
+                    case line_feed: {
+                        if (cur[-1] == '\r') {
+                            if (cur == end) {
+                                return wait(at(cur), data.size());
+                            }
+                            if (*cur != '\n') {
+                                return fail(400);
+                            }
+                            ++cur;
+                        }
+                        if (has_field) {
+                            has_field = false;
+                            on_field(data.substr(name_begin, name_end - name_begin),
+                                     data.substr(value_begin, value_end - value_begin));
+                        }
+                        state = after_line;
+                        break;
+                    }
+                    case done: {
+                        pos          = at(cur);
+                        status_value = 200;
+                        return 200;
+                    }
+                    case error: {
+                        return status_value;
+                    }
+                }
+            }
+        }
+
+        /// Start parsing the next request; the limits are kept
+        constexpr void reset() noexcept {
+            pos          = 0;
+            method_size  = 0;
+            target_size  = 0;
+            name_begin   = 0;
+            name_end     = 0;
+            value_begin  = 0;
+            value_end    = 0;
+            ver          = http::version{};
+            status_value = need_more;
+            state        = request_head_state::method_token;
+            after_line   = request_head_state::field_start;
+            has_field    = false;
+        }
+
+        /// The last status that "feed" returned
+        [[nodiscard]] constexpr status_code_type status() const noexcept {
+            return status_value;
+        }
+
+        [[nodiscard]] constexpr bool is_done() const noexcept {
+            return state == request_head_state::done;
+        }
+
+        /// The request line is parsed (the method, the target, and the version are available)
+        [[nodiscard]] constexpr bool has_request_line() const noexcept {
+            return state > request_head_state::version && state != request_head_state::error;
+        }
+
+        /// The size of the request line and the header fields, including the empty line at the end;
+        /// the body starts right after it
+        [[nodiscard]] constexpr size_type head_size() const noexcept {
+            return is_done() ? pos : 0;
+        }
+
+        /// How much of the data is parsed so far
+        [[nodiscard]] constexpr size_type parsed_size() const noexcept {
+            return pos;
+        }
+
+        /// Get the method; the data should be the same as the one that's parsed
+        [[nodiscard]] constexpr string_view_type method(string_view_type const data) const noexcept {
+            return data.substr(0, method_size);
+        }
+
+        /// Get the request target; the data should be the same as the one that's parsed
+        [[nodiscard]] constexpr string_view_type target(string_view_type const data) const noexcept {
+            return data.substr(method_size + 1, target_size);
+        }
+
+        /// Get the parsed http version
+        [[nodiscard]] constexpr http::version version() const noexcept {
+            return ver;
+        }
+    };
+
+} // namespace webpp::http
+
+#endif // WEBPP_HTTP_CODEC_REQUEST_HEAD_PARSER_HPP
@@ -3,9 +3,11 @@
 #ifndef WEBPP_REQUEST_PARSER_HPP
 #define WEBPP_REQUEST_PARSER_HPP
 
+#include "../../std/algorithm.hpp"
 #include "../../strings/to_case.hpp"
 #include "../../traits/traits.hpp"
 #include "../http_version.hpp"
+#include "headers_parser.hpp"
 
 namespace webpp::http {
 
@@ -18,11 +20,16 @@ namespace webpp::http {
      * attributes or values. For instance, the cookies will be parsed by the cookie class and this class
      * will not parse those.
      *
+     * The method, the request target, and the header fields are scanned by the Scanner (see simd_scanner).
+     * The whole head should be in the buffer; see http_request_head_parser for the heads that arrive in
+     * pieces.
+     *
      * @tparam TraitsType
      */
-    template <Traits TraitsType>
+    template <Traits TraitsType, typename Scanner = simd_scanner>
     struct http_request_parser {
         using traits_type      = TraitsType;
+        using scanner_type     = Scanner;
         using string_type      = traits::string<traits_type>;
         using string_view_type = traits::string_view<traits_type>;
         using status_code_type = uint_fast16_t;
@@ -52,23 +59,32 @@ namespace webpp::http {
 
             // -------------------------------- parsing method ------------------------------------
 
-            if (auto sp = str.substr(0, METHOD_LIMIT).find(' '); sp != string_view_type::npos) { // find the
-                                                                                                 // first SP
-                method_view = str.substr(0, sp);
-                str.remove_prefix(sp + 1);
-            } else {
+            // method = token
+            auto const* const method_max = str.data() + stl::min<stl::size_t>(str.size(), METHOD_LIMIT);
+            auto const* const method_end = scanner_type::token_end(str.data(), method_max);
+            auto const        method_len = static_cast<stl::size_t>(method_end - str.data());
+            if (method_end == method_max) {
                 return 501; // Now we must return a 501 (Not Implemented) error message to the user
             }
+            if (*method_end != ' ' || method_len == 0) {
+                return 400; // Bad Request
+            }
+            method_view = str.substr(0, method_len);
+            str.remove_prefix(method_len + 1);
 
             // ------------------------------ parsing request target (path) ------------------------------
 
-            if (auto sp = str.substr(0, URI_LIMIT).find(' '); sp != string_view_type::npos) { // find the
-                                                                                              // second SP
-                request_target_view = str.substr(0, sp);
-                str.remove_prefix(sp + 1);
-            } else {
+            auto const* const target_max = str.data() + stl::min<stl::size_t>(str.size(), URI_LIMIT);
+            auto const* const target_end = scanner_type::target_end(str.data(), target_max);
+            auto const        target_len = static_cast<stl::size_t>(target_end - str.data());
+            if (target_end == target_max) {
                 return 414; // URI is either too long or the request has a wrong syntax
             }
+            if (*target_end != ' ' || target_len == 0) {
+                return 400; // Bad Request, a control character or a white space other than SP
+            }
+            request_target_view = str.substr(0, target_len);
+            str.remove_prefix(target_len + 1);
 
             // ------------------------------ parsing http version ------------------------------
 
@@ -82,7 +98,7 @@ namespace webpp::http {
             //                return 400; // Bad Request
             //            }
 
-            http_version_view = str.substr(ascii::size(http_prefix) - 1, 3); // 1.1 and 1.0 are 3 chars
+            http_version_view = str.substr(ascii::size(http_prefix), 3); // 1.1 and 1.0 are 3 chars
             if (http_version_view != "1.0" && http_version_view != "1.1")
             {               // todo: add 2.0 and 0.9 and others as well
                 return 505; // HTTP Version Not Supported
@@ -93,16 +109,21 @@ namespace webpp::http {
             return 200; // so far, it's a good request
         }
 
-        // parse one line of a header (A header field as it called in the RFC)
-        status_code_type parse_header_field(string_view_type& str) noexcept {
-            // todo
-        }
-
-        // parse the header fully
-        void parse_header(string_view_type str) noexcept {
-            auto finish_line = str.end();
-            for (auto it = str.begin(); it != finish_line; ++it) {
+        /**
+         * Parse the header fields (everything after the request line, including the empty line at the
+         * end), and pass the name and the value of each field to the specified callable.
+         *
+         * @returns 200 if the headers are valid, 400 (Bad Request) otherwise
+         */
+        template <typename Callable>
+            requires(stl::is_invocable_v<Callable, string_view_type, string_view_type>)
+        status_code_type parse_header(string_view_type str, Callable&& on_field)
+          noexcept(stl::is_nothrow_invocable_v<Callable, string_view_type, string_view_type>) {
+            basic_headers_parser_iterator<scanner_type> iter{str.data(), str.data() + str.size()};
+            for (++iter; iter.has_field(); ++iter) {
+                on_field(iter.template name<string_view_type>(), iter.template value<string_view_type>());
             }
+            return iter.is_done() ? 200 : 400;
         }
     };
 
@@ -0,0 +1,184 @@
+// Created by moisrex on 10/17/26.
+
+#ifndef WEBPP_HTTP_CODEC_SCANNER_HPP
+#define WEBPP_HTTP_CODEC_SCANNER_HPP
+
+#include "../../libs/eve.hpp"
+#include "tokens.hpp"
+
+#include <bit>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+#ifdef WEBPP_EVE
+#    include <eve/algo/as_range.hpp>
+#    include <eve/algo/find.hpp>
+#    include <eve/wide.hpp>
+#endif
+
+namespace webpp::http {
+
+    /**
+     * The scanners find where each part of an HTTP message head ends; the parsers
+     * (headers_parser_iterator, http_request_parser) only look at the characters that they return.
+     *
+     *   - token_end:  the first character that is not a "tchar" (the end of a method, or a field name)
+     *   - value_end:  the first control character other than HTAB (the end of a field value: CR, LF, ...)
+     *   - target_end: the first space or control character (the end of the request target)
+     *
+     * This one checks the characters one by one; it's the reference for the other scanners.
+     */
+    struct scalar_scanner {
+        [[nodiscard]] static constexpr char const* token_end(char const* pos, char const* end) noexcept {
+            for (; pos != end && is_http_token(*pos); ++pos) {
+            }
+            return pos;
+        }
+
+        [[nodiscard]] static constexpr char const* value_end(char const* pos, char const* end) noexcept {
+            for (; pos != end; ++pos) {
+                auto const chr = static_cast<unsigned char>(*pos);
+                if ((chr < 0x20 && chr != '\t') || chr == 0x7F) {
+                    break;
+                }
+            }
+            return pos;
+        }
+
+        [[nodiscard]] static constexpr char const* target_end(char const* pos, char const* end) noexcept {
+            for (; pos != end; ++pos) {
+                auto const chr = static_cast<unsigned char>(*pos);
+                if (chr <= 0x20 || chr == 0x7F) {
+                    break;
+                }
+            }
+            return pos;
+        }
+    };
+
+    /**
+     * The vectorized scanner
+     *
+     * With EVE (USE_EVE), the characters are checked a whole SIMD register at a time (16, 32, or 64 of
+     * them, depending on the instruction set); without it, the values and the request targets are
+     * checked 8 characters at a time in a 64-bit word, and the tokens (which are short anyway) one by
+     * one. In constant evaluation it's the same as the scalar scanner.
+     */
+    struct simd_scanner {
+      private:
+        using word_type = stl::uint64_t;
+
+        static constexpr word_type ones  = 0x0101'0101'0101'0101ULL;
+        static constexpr word_type highs = ones * 0x80U;
+
+        // the high bit of the first byte that is less than the specified value is set (the bytes after
+        // that one might have false positives, which is fine since we only want the first one)
+        [[nodiscard]] static constexpr word_type less_than(word_type const word,
+                                                           word_type const val) noexcept {
+            return (word - ones * val) & ~word & highs;
+        }
+
+        // the high bit of the first byte that is equal to the specified value is set
+        [[nodiscard]] static constexpr word_type equal_to(word_type const word,
+                                                          word_type const val) noexcept {
+            return less_than(word ^ (ones * val), 1);
+        }
+
+        [[nodiscard]] static word_type load(char const* pos) noexcept {
+            word_type word; // NOLINT(cppcoreguidelines-init-variables)
+            stl::memcpy(&word, pos, sizeof(word));
+            return word;
+        }
+
+        // index of the first byte that is marked in the mask
+        [[nodiscard]] static stl::size_t first_marked(word_type const mask) noexcept {
+            return static_cast<stl::size_t>(stl::countr_zero(mask)) / 8U;
+        }
+
+        static constexpr bool swar = stl::endian::native == stl::endian::little;
+
+#ifdef WEBPP_EVE
+        using uchar = stl::uint8_t;
+
+        template <typename Pred>
+        [[nodiscard]] static char const* eve_find(char const* pos, char const* end, Pred pred) noexcept {
+            // NOLINTBEGIN(cppcoreguidelines-pro-type-reinterpret-cast)
+            auto const* first = reinterpret_cast<uchar const*>(pos);
+            auto const* last  = reinterpret_cast<uchar const*>(end);
+            return reinterpret_cast<char const*>(eve::algo::find_if(eve::algo::as_range(first, last), pred));
+            // NOLINTEND(cppcoreguidelines-pro-type-reinterpret-cast)
+        }
+#endif
+
+      public:
+        [[nodiscard]] static constexpr char const* token_end(char const* pos, char const* end) noexcept {
+#ifdef WEBPP_EVE
+            if (!stl::is_constant_evaluated()) {
+                // anything but: SP, CTLs, DEL, non-ASCII, and the delimiters: "(),/:;<=>?@[\]{}
+                return eve_find(pos, end, [](auto chr) noexcept {
+                    return (chr - uchar{0x21}) >= uchar{0x5E} || chr == uchar{'"'} ||
+                           (chr - uchar{'('}) <= uchar{1} || chr == uchar{','} || chr == uchar{'/'} ||
+                           (chr - uchar{':'}) <= uchar{6} || (chr - uchar{'['}) <= uchar{2} ||
+                           chr == uchar{'{'} || chr == uchar{'}'};
+                });
+            }
+#endif
+            return scalar_scanner::token_end(pos, end);
+        }
+
+        [[nodiscard]] static constexpr char const* value_end(char const* pos, char const* end) noexcept {
+            if (stl::is_constant_evaluated()) {
+                return scalar_scanner::value_end(pos, end);
+            }
+#ifdef WEBPP_EVE
+            return eve_find(pos, end, [](auto chr) noexcept {
+                return (chr < uchar{0x20} && chr != uchar{'\t'}) || chr == uchar{0x7F};
+            });
+#else
+            if constexpr (swar) {
+                while (end - pos >= static_cast<stl::ptrdiff_t>(sizeof(word_type))) {
+                    auto const word = load(pos);
+                    auto const mask = less_than(word, 0x20) | equal_to(word, 0x7F);
+                    if (mask == 0) {
+                        pos += sizeof(word_type);
+                        continue;
+                    }
+                    pos += first_marked(mask);
+                    if (*pos != '\t') {
+                        return pos;
+                    }
+                    ++pos; // the tabs are allowed
+                }
+            }
+            return scalar_scanner::value_end(pos, end);
+#endif
+        }
+
+        [[nodiscard]] static constexpr char const* target_end(char const* pos, char const* end) noexcept {
+            if (stl::is_constant_evaluated()) {
+                return scalar_scanner::target_end(pos, end);
+            }
+#ifdef WEBPP_EVE
+            return eve_find(pos, end, [](auto chr) noexcept {
+                return chr <= uchar{0x20} || chr == uchar{0x7F};
+            });
+#else
+            if constexpr (swar) {
+                while (end - pos >= static_cast<stl::ptrdiff_t>(sizeof(word_type))) {
+                    auto const word = load(pos);
+                    auto const mask = less_than(word, 0x21) | equal_to(word, 0x7F);
+                    if (mask != 0) {
+                        return pos + first_marked(mask);
+                    }
+                    pos += sizeof(word_type);
+                }
+            }
+            return scalar_scanner::target_end(pos, end);
+#endif
+        }
+    };
+
+} // namespace webpp::http
+
+#endif // WEBPP_HTTP_CODEC_SCANNER_HPP
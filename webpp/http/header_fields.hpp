@@ -1,10 +1,16 @@
 #ifndef WEBPP_HTTP_HEADERS_H
 #define WEBPP_HTTP_HEADERS_H
 
+#include "../std/algorithm.hpp"
 #include "../std/span.hpp"
+#include "../std/utility.hpp"
 #include "../strings/iequals.hpp"
 #include "../traits/enable_traits.hpp"
 #include "http_concepts.hpp"
+#include "known_headers.hpp"
+
+#include <array>
+#include <cstdint>
 
 namespace webpp::http {
 
@@ -14,6 +20,10 @@ namespace webpp::http {
      * one single field of a header.
      *
      * This templated struct should satisfy the HTTPHeaderField concept.
+     *
+     * The hash of the lowercased name and the id of the name (if it's a well-known one) are calculated
+     * when the field is constructed, so finding a field is mostly integer comparisons; assign a new field
+     * instead of changing the name in place.
      */
     template <typename StringType>
     struct basic_header_field {
@@ -28,8 +38,11 @@ namespace webpp::http {
 
         // NOLINTEND(misc-non-private-member-variables-in-classes)
 
+      private:
+        stl::uint32_t m_hash = header_name_hash(istl::string_viewify(name));
+        header_id     m_id   = known_header(istl::string_viewify(name), m_hash);
 
-
+      public:
         // NOLINTBEGIN(bugprone-easily-swappable-parameters)
         constexpr basic_header_field(name_type&& _name, value_type&& _value) noexcept
             requires(is_mutable)
@@ -74,6 +87,30 @@ namespace webpp::http {
             return ascii::iequals(name, stl::forward<decltype(_str)>(_str));
         }
 
+        /**
+         * Check if the specified name is the same as the header name; the well-known names are compared
+         * by their ids, the rest of them by their hashes first.
+         */
+        [[nodiscard]] constexpr bool is_name(header_name_key const& key) const noexcept {
+            if (m_hash != key.hash) {
+                return false;
+            }
+            if (m_id != header_id::unknown || key.id != header_id::unknown) {
+                return m_id == key.id;
+            }
+            return details::header_names_equal(istl::string_viewify(name), key.name);
+        }
+
+        /// The case-insensitive hash of the name
+        [[nodiscard]] constexpr stl::uint32_t name_hash() const noexcept {
+            return m_hash;
+        }
+
+        /// The id of the name, if it's a well-known header name
+        [[nodiscard]] constexpr header_id name_id() const noexcept {
+            return m_id;
+        }
+
         constexpr bool operator==(basic_header_field const& field) const noexcept {
             return name == field.name && value == field.value;
         }
@@ -156,6 +193,10 @@ namespace webpp::http {
 
     /**
      * @brief Vector of fields, used as a base for request/response headers
+     *
+     * The fields are indexed by their name hashes in a small open-addressed table as long as there are not
+     * too many of them (which is the case for almost every request/response); more than that and finding
+     * a field goes back to checking them one by one.
      */
     template <HTTPHeaderField FieldType>
     struct header_fields_provider {
@@ -166,13 +207,45 @@ namespace webpp::http {
         using allocator_type = typename string_type::allocator_type;
         // using field_allocator_type = traits::allocator_type_of<traits_type, field_type>;
 
+        /// The number of the slots of the index, a power of 2
+        static constexpr stl::size_t index_size = 64;
+
+        /// The fields are not indexed if there are more of them than this
+        static constexpr stl::size_t max_indexed_fields = index_size * 3 / 4;
+
       private:
         using vector_allocator_type =
           typename stl::allocator_traits<allocator_type>::template rebind_alloc<field_type>;
         using fields_type = stl::vector<field_type, vector_allocator_type>;
 
+        static_assert(max_indexed_fields < 256, "The slots hold the positions of the fields in 8 bits.");
+
         fields_type fields;
 
+        // position + 1 of the fields in the low 8 bits, and the high 8 bits of their name hashes in the
+        // high 8 bits, so the probing doesn't touch the fields that can't match; zero for empty slots
+        stl::array<stl::uint16_t, index_size> index{};
+
+        static constexpr stl::uint16_t hash_tag(stl::uint32_t const hash) noexcept {
+            return static_cast<stl::uint16_t>((hash >> 24U) << 8U);
+        }
+
+        constexpr void index_field(stl::size_t const pos) noexcept {
+            auto const hash = fields[pos].name_hash();
+            auto       slot = hash & (index_size - 1);
+            while (index[slot] != 0) {
+                slot = (slot + 1) & (index_size - 1);
+            }
+            index[slot] = hash_tag(hash) | static_cast<stl::uint16_t>(pos + 1);
+        }
+
+        constexpr void reindex() noexcept {
+            index.fill(0);
+            for (stl::size_t pos = 0; pos != fields.size() && pos != max_indexed_fields; ++pos) {
+                index_field(pos);
+            }
+        }
+
       public:
         template <EnabledTraits ET>
             requires(!HTTPHeaderFieldsProvider<ET>)
@@ -183,22 +256,41 @@ namespace webpp::http {
             requires(
               !istl::cvref_as<T, header_fields_provider> && requires(T other) { other.get_allocator(); })
         explicit constexpr header_fields_provider(T const& other)
-          : fields{other.begin(), other.end(), other.get_allocator()} {}
+          : fields{other.begin(), other.end(), other.get_allocator()} {
+            reindex();
+        }
 
         template <EnabledTraits ET, HTTPHeaderFieldsProvider T>
         constexpr header_fields_provider([[maybe_unused]] ET const& etraits, T const& other)
-          : fields{other.begin(), other.end(), other.get_allocator()} {}
+          : fields{other.begin(), other.end(), other.get_allocator()} {
+            reindex();
+        }
+
+        constexpr header_fields_provider(header_fields_provider const&)            = default;
+        constexpr ~header_fields_provider()                                        = default;
+        constexpr header_fields_provider& operator=(header_fields_provider const&) = default;
 
-        constexpr header_fields_provider(header_fields_provider const&)                = default;
-        constexpr header_fields_provider(header_fields_provider&&) noexcept            = default;
-        constexpr ~header_fields_provider()                                            = default;
-        constexpr header_fields_provider& operator=(header_fields_provider&&) noexcept = default;
-        constexpr header_fields_provider& operator=(header_fields_provider const&)     = default;
+        // the moved-from fields are empty, and so should be their index
+        constexpr header_fields_provider(header_fields_provider&& other) noexcept
+          : fields{stl::move(other.fields)},
+            index{stl::exchange(other.index, {})} {
+            other.fields.clear();
+        }
+
+        constexpr header_fields_provider& operator=(header_fields_provider&& other) noexcept {
+            if (this != &other) {
+                fields = stl::move(other.fields);
+                index  = stl::exchange(other.index, {});
+                other.fields.clear();
+            }
+            return *this;
+        }
 
         template <HTTPHeaderFieldsProvider T>
             requires(!istl::cvref_as<T, header_fields_provider>)
         constexpr header_fields_provider& operator=(T const& other) {
-            stl::copy(other.begin(), other.end(), fields.begin());
+            fields.assign(other.begin(), other.end());
+            reindex();
             return *this;
         }
 
@@ -218,6 +310,31 @@ namespace webpp::http {
             return fields.size();
         }
 
+        /**
+         * Find the first field with the specified name; end() if there's none.
+         */
+        [[nodiscard]] constexpr auto find_field(header_name_key const& key) const noexcept {
+            if (fields.size() > max_indexed_fields) {
+                return stl::find_if(fields.begin(), fields.end(), [&key](field_type const& field) noexcept {
+                    return field.is_name(key);
+                });
+            }
+            // the duplicates are found in the order they were added, there are no removals
+            auto const tag = hash_tag(key.hash);
+            for (auto slot = key.hash & (index_size - 1); index[slot] != 0;
+                 slot      = (slot + 1) & (index_size - 1))
+            {
+                if ((index[slot] & 0xFF00U) != tag) {
+                    continue;
+                }
+                auto const pos = fields.begin() + ((index[slot] & 0xFFU) - 1);
+                if (pos->is_name(key)) {
+                    return pos;
+                }
+            }
+            return fields.end();
+        }
+
         template <typename NameT, typename ValueT>
             requires(istl::String<string_type> && istl::StringifiableOf<string_type, NameT> &&
                      istl::StringifiableOf<string_type, ValueT>)
@@ -225,6 +342,9 @@ namespace webpp::http {
             fields.emplace_back(
               istl::stringify_of<string_type>(stl::forward<NameT>(name), get_allocator()),
               istl::stringify_of<string_type>(stl::forward<ValueT>(value), get_allocator()));
+            if (fields.size() <= max_indexed_fields) {
+                index_field(fields.size() - 1);
+            }
         }
 
         template <typename NameT, typename ValueT>
@@ -233,6 +353,9 @@ namespace webpp::http {
         constexpr void emplace(NameT&& name, ValueT value) {
             fields.emplace_back(istl::string_viewify_of<string_type>(stl::forward<NameT>(name)),
                                 istl::string_viewify_of<string_type>(stl::forward<ValueT>(value)));
+            if (fields.size() <= max_indexed_fields) {
+                index_field(fields.size() - 1);
+            }
         }
 
         /**
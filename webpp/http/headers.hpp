@@ -5,6 +5,7 @@
 
 #include "../convert/lexical_cast.hpp"
 #include "../std/tuple.hpp"
+#include "known_headers.hpp"
 
 #include <algorithm>
 
@@ -116,18 +117,27 @@ namespace webpp::http {
 
         /**
          * Get an iterator pointing to the field value that holds the specified header name
+         * The name can be a string, or a header_id of the well-known headers (like header_id::content_type).
          */
-        [[nodiscard]] constexpr auto iter(name_type name) const noexcept {
-            return stl::find_if(this->begin(), this->end(), [name](field_type const& field) noexcept {
-                return field.is_name(name);
-            });
+        [[nodiscard]] constexpr auto iter(header_name_key const key) const noexcept {
+            if constexpr (requires { this->find_field(key); }) {
+                return this->find_field(key);
+            } else if constexpr (requires(field_type const& field) { field.is_name(key); }) {
+                return stl::find_if(this->begin(), this->end(), [key](field_type const& field) noexcept {
+                    return field.is_name(key);
+                });
+            } else {
+                return stl::find_if(this->begin(), this->end(), [key](field_type const& field) noexcept {
+                    return field.is_name(key.name);
+                });
+            }
         }
 
         /**
          * Get the field value that holds the specified header name
          */
-        [[nodiscard]] constexpr stl::optional<field_type> field(name_type name) const noexcept {
-            auto const res = iter(name);
+        [[nodiscard]] constexpr stl::optional<field_type> field(header_name_key const key) const noexcept {
+            auto const res = iter(key);
             return res == this->end() ? stl::nullopt : *res;
         }
 
@@ -135,8 +145,8 @@ namespace webpp::http {
          * Get the value of a header
          * Returns an empty string if there are no header with that name
          */
-        [[nodiscard]] constexpr value_type get(name_type name) const noexcept {
-            auto const res = iter(name);
+        [[nodiscard]] constexpr value_type get(header_name_key const key) const noexcept {
+            auto const res = iter(key);
             return res == this->end() ? value_type{} : res->value;
         }
 
@@ -182,9 +192,9 @@ namespace webpp::http {
         template <typename... NameType>
         [[nodiscard]] constexpr auto has(NameType&&... name) const noexcept {
             if constexpr (sizeof...(NameType) == 1) {
-                return stl::find(this->begin(), this->end(), name...) != this->end();
+                return (... && (iter(name) != this->end()));
             } else if constexpr (sizeof...(NameType) > 1) {
-                return stl::make_tuple((stl::find(this->begin(), this->end(), name) != this->end())...);
+                return stl::make_tuple((iter(name) != this->end())...);
             } else {
                 return true;
             }
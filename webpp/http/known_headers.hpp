@@ -0,0 +1,321 @@
+// Created by moisrex on 10/17/26.
+
+#ifndef WEBPP_HTTP_KNOWN_HEADERS_HPP
+#define WEBPP_HTTP_KNOWN_HEADERS_HPP
+
+#include "../std/string_view.hpp"
+
+#include <array>
+#include <bit>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+namespace webpp::http {
+
+    /**
+     * The well-known header names; the header fields know which one of these they are, so looking for
+     * them is an integer comparison instead of a case-insensitive string comparison.
+     */
+    enum struct header_id : stl::uint8_t {
+        unknown = 0,
+        accept,
+        accept_charset,
+        accept_encoding,
+        accept_language,
+        accept_ranges,
+        access_control_allow_credentials,
+        access_control_allow_headers,
+        access_control_allow_methods,
+        access_control_allow_origin,
+        access_control_expose_headers,
+        access_control_max_age,
+        access_control_request_headers,
+        access_control_request_method,
+        age,
+        allow,
+        alt_svc,
+        authorization,
+        cache_control,
+        connection,
+        content_disposition,
+        content_encoding,
+        content_language,
+        content_length,
+        content_location,
+        content_range,
+        content_security_policy,
+        content_type,
+        cookie,
+        date,
+        etag,
+        expect,
+        expires,
+        forwarded,
+        from,
+        host,
+        if_match,
+        if_modified_since,
+        if_none_match,
+        if_range,
+        if_unmodified_since,
+        keep_alive,
+        last_modified,
+        link,
+        location,
+        origin,
+        pragma,
+        proxy_authenticate,
+        proxy_authorization,
+        range,
+        referer,
+        retry_after,
+        server,
+        set_cookie,
+        strict_transport_security,
+        te,
+        trailer,
+        transfer_encoding,
+        upgrade,
+        user_agent,
+        vary,
+        via,
+        www_authenticate,
+        x_content_type_options,
+        x_forwarded_for,
+        x_forwarded_host,
+        x_forwarded_proto,
+        x_frame_options,
+        x_requested_with
+    };
+
+    /// The names of the well-known headers, in the order of header_id (lowercased)
+    static constexpr stl::array<stl::string_view, 69> known_header_names{
+      "",
+      "accept",
+      "accept-charset",
+      "accept-encoding",
+      "accept-language",
+      "accept-ranges",
+      "access-control-allow-credentials",
+      "access-control-allow-headers",
+      "access-control-allow-methods",
+      "access-control-allow-origin",
+      "access-control-expose-headers",
+      "access-control-max-age",
+      "access-control-request-headers",
+      "access-control-request-method",
+      "age",
+      "allow",
+      "alt-svc",
+      "authorization",
+      "cache-control",
+      "connection",
+      "content-disposition",
+      "content-encoding",
+      "content-language",
+      "content-length",
+      "content-location",
+      "content-range",
+      "content-security-policy",
+      "content-type",
+      "cookie",
+      "date",
+      "etag",
+      "expect",
+      "expires",
+      "forwarded",
+      "from",
+      "host",
+      "if-match",
+      "if-modified-since",
+      "if-none-match",
+      "if-range",
+      "if-unmodified-since",
+      "keep-alive",
+      "last-modified",
+      "link",
+      "location",
+      "origin",
+      "pragma",
+      "proxy-authenticate",
+      "proxy-authorization",
+      "range",
+      "referer",
+      "retry-after",
+      "server",
+      "set-cookie",
+      "strict-transport-security",
+      "te",
+      "trailer",
+      "transfer-encoding",
+      "upgrade",
+      "user-agent",
+      "vary",
+      "via",
+      "www-authenticate",
+      "x-content-type-options",
+      "x-forwarded-for",
+      "x-forwarded-host",
+      "x-forwarded-proto",
+      "x-frame-options",
+      "x-requested-with"};
+
+    static_assert(known_header_names.size() == static_cast<stl::size_t>(header_id::x_requested_with) + 1,
+                  "The names should be in the order of the header ids.");
+
+    namespace details {
+
+        // up to 8 characters of the string, as a little-endian word
+        [[nodiscard]] constexpr stl::uint64_t load_word(stl::string_view const str,
+                                                        stl::size_t const      pos,
+                                                        stl::size_t const      count) noexcept {
+            stl::uint64_t word = 0;
+            if (!stl::is_constant_evaluated() && stl::endian::native == stl::endian::little && count == 8) {
+                stl::memcpy(&word, str.data() + pos, sizeof(word));
+                return word;
+            }
+            for (stl::size_t index = 0; index != count; ++index) {
+                word |= static_cast<stl::uint64_t>(static_cast<unsigned char>(str[pos + index]))
+                        << (index * 8U);
+            }
+            return word;
+        }
+
+        // lower the ASCII letters of the word, all 8 of them at once
+        [[nodiscard]] constexpr stl::uint64_t lower_word(stl::uint64_t const word) noexcept {
+            constexpr stl::uint64_t ones    = 0x0101'0101'0101'0101ULL;
+            auto const              heptets = word & (ones * 0x7FU);
+            auto const              ge_a    = heptets + (ones * (0x80U - 'A'));
+            auto const              gt_z    = heptets + (ones * (0x80U - 'Z' - 1U));
+            auto const              upper   = ge_a & ~gt_z & ~word & (ones * 0x80U);
+            return word | (upper >> 2U);
+        }
+
+        // compare the names case-insensitively, 8 characters at a time
+        [[nodiscard]] constexpr bool header_names_equal(stl::string_view const lhs,
+                                                        stl::string_view const rhs) noexcept {
+            auto const len = lhs.size();
+            if (rhs.size() != len) {
+                return false;
+            }
+            if (len < 8) {
+                return lower_word(load_word(lhs, 0, len)) == lower_word(load_word(rhs, 0, len));
+            }
+            for (stl::size_t pos = 0; pos + 8 < len; pos += 8) {
+                if (lower_word(load_word(lhs, pos, 8)) != lower_word(load_word(rhs, pos, 8))) {
+                    return false;
+                }
+            }
+            // the last 8 characters, overlapping with the ones before them
+            return lower_word(load_word(lhs, len - 8, 8)) == lower_word(load_word(rhs, len - 8, 8));
+        }
+
+    } // namespace details
+
+    /**
+     * Case-insensitive hash of a header name
+     *
+     * Only the length, the first 8 and the last 8 characters are hashed, so it costs the same for every
+     * name; the names that collide are told apart by comparing them.
+     */
+    [[nodiscard]] constexpr stl::uint32_t header_name_hash(stl::string_view const name) noexcept {
+        auto const len   = name.size();
+        auto const count = len < 8 ? len : 8;
+        auto const head  = details::lower_word(details::load_word(name, 0, count));
+        auto const tail  = details::lower_word(details::load_word(name, len - count, count));
+        auto       hash  = (head * 0x9E37'79B9'7F4A'7C15ULL) ^ (tail * 0xC2B2'AE3D'27D4'EB4FULL) ^ len;
+        hash            ^= hash >> 32U; // the last characters only change the high bits
+        hash            *= 0xFF51'AFD7'ED55'8CCDULL;
+        return static_cast<stl::uint32_t>(hash >> 32U);
+    }
+
+    namespace details {
+
+        // open-addressed table of the known header names, built at compile time
+        struct known_headers_table {
+            static constexpr stl::size_t size = 256; // a power of 2, more than twice the names
+            static constexpr stl::size_t mask = size - 1;
+
+            stl::array<header_id, size> ids{};
+
+            consteval known_headers_table() noexcept {
+                for (stl::size_t index = 1; index != known_header_names.size(); ++index) {
+                    auto slot = header_name_hash(known_header_names[index]) & mask;
+                    while (ids[slot] != header_id::unknown) {
+                        slot = (slot + 1) & mask;
+                    }
+                    ids[slot] = static_cast<header_id>(index);
+                }
+            }
+
+            [[nodiscard]] constexpr header_id find(stl::string_view const name,
+                                                   stl::uint32_t const    hash) const noexcept {
+                for (auto slot = hash & mask;; slot = (slot + 1) & mask) {
+                    auto const cur = ids[slot];
+                    if (cur == header_id::unknown) {
+                        return header_id::unknown;
+                    }
+                    if (header_names_equal(known_header_names[static_cast<stl::size_t>(cur)], name)) {
+                        return cur;
+                    }
+                }
+            }
+        };
+
+        static constexpr known_headers_table known_headers{};
+
+        static constexpr auto known_header_hashes = [] consteval {
+            stl::array<stl::uint32_t, known_header_names.size()> hashes{};
+            for (stl::size_t index = 0; index != known_header_names.size(); ++index) {
+                hashes[index] = header_name_hash(known_header_names[index]);
+            }
+            return hashes;
+        }();
+
+    } // namespace details
+
+    /**
+     * Find the id of the header name; unknown if it's not a well-known header.
+     */
+    [[nodiscard]] constexpr header_id known_header(stl::string_view const name,
+                                                   stl::uint32_t const    hash) noexcept {
+        return details::known_headers.find(name, hash);
+    }
+
+    [[nodiscard]] constexpr header_id known_header(stl::string_view const name) noexcept {
+        return known_header(name, header_name_hash(name));
+    }
+
+    /**
+     * An interned header name: the hash, and the id if it's a well-known one; construct it once and use it
+     * to look for a header in the fields, it makes the comparisons integer comparisons.
+     */
+    struct header_name_key {
+        stl::string_view name;
+        stl::uint32_t    hash = 0;
+        header_id        id   = header_id::unknown;
+
+        // NOLINTBEGIN(*-explicit-*)
+        constexpr header_name_key(stl::string_view const inp_name) noexcept
+          : name{inp_name},
+            hash{header_name_hash(inp_name)},
+            id{known_header(inp_name, hash)} {}
+
+        template <typename StrT>
+            requires(istl::StringViewifiableOf<stl::string_view, StrT> &&
+                     !stl::same_as<stl::remove_cvref_t<StrT>, stl::string_view>)
+        constexpr header_name_key(StrT&& inp_name) noexcept
+          : header_name_key{istl::string_viewify_of<stl::string_view>(stl::forward<StrT>(inp_name))} {}
+
+        constexpr header_name_key(header_id const inp_id) noexcept
+          : name{known_header_names[static_cast<stl::size_t>(inp_id)]},
+            hash{details::known_header_hashes[static_cast<stl::size_t>(inp_id)]},
+            id{inp_id} {}
+
+        // NOLINTEND(*-explicit-*)
+    };
+
+} // namespace webpp::http
+
+#endif // WEBPP_HTTP_KNOWN_HEADERS_HPP
@@ -55,7 +55,7 @@ namespace webpp::http {
          */
         [[nodiscard]] constexpr stl::size_t content_length() const noexcept {
             // todo: this might not be as safe as you thought
-            return to_size_t(this->get("content-length"));
+            return to_size_t(this->get(header_id::content_length));
         }
     };
 
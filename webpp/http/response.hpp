@@ -95,7 +95,8 @@ namespace webpp::http {
             using header_field_type = typename headers_type::field_type;
             using str_t             = typename header_field_type::string_type;
 
-            auto const [has_content_type, has_content_length] = headers.has("content-type", "content-length");
+            auto const [has_content_type, has_content_length] =
+              headers.has(header_id::content_type, header_id::content_length);
 
             // todo: use content_type class
             if (!has_content_type) {
@@ -103,7 +104,12 @@ namespace webpp::http {
             }
 
             if constexpr (SizableBody<body_type>) {
-                if (!has_content_length) {
+                // the size of a chunked body is not known until it's sent
+                bool is_chunked = false;
+                if constexpr (UnifiedBodyReader<body_type>) {
+                    is_chunked = body.which_communicator() == communicator_type::chunked_based;
+                }
+                if (!has_content_length && !is_chunked) {
                     str_t value{headers.get_allocator()};
                     append_to(value, body.size() * sizeof(char));
                     headers.set("Content-Length", stl::move(value));
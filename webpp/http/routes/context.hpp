@@ -9,11 +9,20 @@
 #include "../response.hpp"
 #include "router_concepts.hpp"
 
+#include <array>
+#include <cassert>
+#include <cstddef>
+#include <memory>
+#include <new>
+
 namespace webpp::http {
 
 
     namespace details {
 
+        /// Each type of captures has its own address, which tells what the context's captures buffer has
+        template <typename CapturesT>
+        inline constexpr char path_captures_tag = 0;
 
         template <HTTPRequest RequestType>
         struct common_context_methods : public enable_traits<typename RequestType::traits_type> {
@@ -197,6 +206,9 @@ namespace webpp::http {
         using dynamic_route_type  = dynamic_route<traits_type>;
         using dynamic_route_ptr   = dynamic_route_type*;
 
+        /// The maximum size of the values that a templated path can capture (see tpath_valve)
+        static constexpr stl::size_t path_captures_capacity = 128;
+
         // NOLINTBEGIN(*-non-private-member-variables-in-classes)
         request_type  request;
         response_type response;
@@ -208,6 +220,11 @@ namespace webpp::http {
 
         path_traverser_type traverser;
         dynamic_route_ptr   current_route_ptr = nullptr;
+        stl::size_t         path_changes      = 0;
+
+        // the captures of the last templated path, they're constructed by the valve itself
+        alignas(stl::max_align_t) stl::array<stl::byte, path_captures_capacity> captures_buffer;
+        void const* captures_tag = nullptr; // the type of the captures in the buffer, if there's any
 
       public:
         template <HTTPRequest ReqT>
@@ -265,6 +282,37 @@ namespace webpp::http {
         constexpr void reset_path(URIOrStringType&& new_path) {
             request.uri(stl::forward<URIOrStringType>(new_path));
             traverser = request.uri();
+            ++path_changes;
+            captures_tag = nullptr; // they point to the old path
+        }
+
+        /**
+         * The number of times the path has been reset; the dynamic router uses this to know if a route
+         * has changed the path, and it needs to look up the routes again.
+         */
+        [[nodiscard]] constexpr stl::size_t path_version() const noexcept {
+            return path_changes;
+        }
+
+        /**
+         * The values that the last templated path has captured; CapturesT should be the captures type of
+         * that templated path (tpath_valve::captures_type), prefer using tpath_valve::captures(ctx).
+         * That templated path should have been checked, and the path should not have been reset since then.
+         */
+        template <typename CapturesT>
+        [[nodiscard]] CapturesT const& path_captures() const noexcept {
+            assert(captures_tag == &details::path_captures_tag<CapturesT>); // no such path has been checked
+            return *stl::launder(reinterpret_cast<CapturesT const*>(captures_buffer.data()));
+        }
+
+        /// Construct the captures of a templated path, in place
+        template <typename CapturesT>
+            requires(sizeof(CapturesT) <= path_captures_capacity &&
+                     alignof(CapturesT) <= alignof(stl::max_align_t) &&
+                     stl::is_trivially_destructible_v<CapturesT>)
+        CapturesT& emplace_path_captures() noexcept {
+            captures_tag = &details::path_captures_tag<CapturesT>;
+            return *stl::construct_at(reinterpret_cast<CapturesT*>(captures_buffer.data()));
         }
 
         constexpr dynamic_route_type const& current_route() const noexcept {
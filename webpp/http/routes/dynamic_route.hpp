@@ -4,6 +4,7 @@
 #define WEBPP_DYNAMIC_ROUTE_HPP
 
 #include "../../traits/traits.hpp"
+#include "route_index.hpp"
 #include "valves.hpp"
 
 namespace webpp::http {
@@ -17,6 +18,7 @@ namespace webpp::http {
         using context_type  = basic_context<traits_type>;
         using callable_type = stl::remove_cvref_t<Callable>;
         using router_type   = basic_dynamic_router<traits_type>;
+        using prefix_type   = basic_route_prefix<traits_type>;
 
       private:
         callable_type callable;
@@ -50,6 +52,10 @@ namespace webpp::http {
             valve_to_string(out, callable);
         }
 
+        void literal_prefix(prefix_type& out) const final {
+            valve_literal_prefix(out, callable);
+        }
+
         void setup([[maybe_unused]] router_type& router) final {
             if constexpr (ValveRequiresSetup<router_type, callable_type>) {
                 callable.setup(router);
@@ -63,6 +69,7 @@ namespace webpp::http {
         using string_type  = traits::string<traits_type>;
         using context_type = basic_context<traits_type>;
         using router_type  = basic_dynamic_router<traits_type>;
+        using prefix_type  = basic_route_prefix<traits_type>;
 
         dynamic_route()                                         = default;
         dynamic_route(dynamic_route const&)                     = default;
@@ -75,6 +82,7 @@ namespace webpp::http {
         virtual void operator()(context_type& ctx, [[maybe_unused]] router_type& router) = 0;
         virtual void operator()(context_type& ctx)                                       = 0;
         virtual void to_string(string_type& out) const                                   = 0;
+        virtual void literal_prefix(prefix_type& out) const                              = 0;
         virtual void setup(router_type& out)                                             = 0;
 
         /**
@@ -8,6 +8,7 @@
 #include "../http_concepts.hpp"
 #include "../status_code.hpp"
 #include "dynamic_route.hpp"
+#include "route_index.hpp"
 
 #include <any>
 
@@ -37,6 +38,8 @@ namespace webpp::http {
         using routes_type            = stl::vector<dynamic_route_type, vector_allocator>;
         using response_type          = basic_response<traits_type>;
         using context_type           = basic_context<traits_type>;
+        using index_type             = basic_route_index<traits_type>;
+        using prefix_type            = basic_route_prefix<traits_type>;
 
         static constexpr auto log_cat = "DRouter";
 
@@ -45,6 +48,7 @@ namespace webpp::http {
 
       private:
         routes_type routes;
+        index_type  routes_index;
 
         /**
          * This method checks the context and see if we have reached the end of the routing or not.
@@ -98,6 +102,12 @@ namespace webpp::http {
 
             auto& route =
               routes.emplace_back(stl::type_identity<new_route_type>{}, stl::forward<C>(callable));
+
+            // indexed before the setup, the setup might add more routes
+            prefix_type prefix;
+            route->literal_prefix(prefix);
+            routes_index.insert(prefix);
+
             route->setup(*this);
             return *this;
         }
@@ -131,14 +141,30 @@ namespace webpp::http {
          *
          * This method does not set 404 error message at all, give you a chance to use this router as
          * a sub-router of a parent router and let the parent router to deal with these things.
+         *
+         * Only the routes that can match the path and the method are run (see basic_route_index), in the
+         * order they were added; if a route changes the path (with ctx.reset_path), the routes after it
+         * are looked up again.
          */
         constexpr void operator()(context_type& ctx) {
-            for (auto& route : routes) {
+            auto version    = ctx.path_version();
+            auto candidates = routes_index.lookup(ctx.path_traverser().get_path());
+            for (auto pos = candidates.begin(); pos != candidates.end();) {
+                auto const index = *pos++;
+                if (!routes_index.accepts(index, ctx.request.method())) {
+                    continue;
+                }
+                auto& route = routes[index];
                 ctx.current_route(*route); // set the current route on context
                 route->operator()(ctx);
                 if (!continue_routing(ctx)) {
                     return;
                 }
+                if (ctx.path_version() != version) [[unlikely]] {
+                    version    = ctx.path_version();
+                    candidates = routes_index.lookup(ctx.path_traverser().get_path());
+                    pos        = stl::upper_bound(candidates.begin(), candidates.end(), index);
+                }
             }
             ctx.response = this->error(status_code::not_found);
         }
@@ -180,6 +180,15 @@ namespace webpp::http {
               as_tuple());
         }
 
+        template <typename PrefixT>
+        constexpr bool literal_prefix(PrefixT& out) const {
+            return stl::apply(
+              [&out]<typename... T>(T const&... funcs) constexpr {
+                  return (valve_literal_prefix(out, funcs) && ...);
+              },
+              as_tuple());
+        }
+
         template <typename RouterT>
             requires((ValveRequiresSetup<RouterT, Callables> || ...))
         constexpr void setup(RouterT& inp_router) {
@@ -286,6 +295,16 @@ namespace webpp::http {
             }
         }
 
+        template <typename PrefixT>
+        constexpr bool literal_prefix(PrefixT& out) const {
+            // the pre-routes and the manglers run before the routes, and they may change the path
+            if constexpr (sizeof...(Pres) == 0 && sizeof...(Manglers) == 0) {
+                return valve_literal_prefix(out, routes) && sizeof...(Posts) == 0;
+            } else {
+                return false;
+            }
+        }
+
         [[nodiscard]] constexpr route_type const& get_routes() const noexcept {
             return routes;
         }
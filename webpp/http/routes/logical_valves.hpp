@@ -187,6 +187,11 @@ namespace webpp::http {
             out.append(")");
         }
 
+        template <typename PrefixT>
+        constexpr bool literal_prefix(PrefixT& out) const {
+            return valve_literal_prefix(out, lhs) && valve_literal_prefix(out, rhs);
+        }
+
         template <typename RouterT>
             requires(ValveRequiresSetup<RouterT, left_type> || ValveRequiresSetup<RouterT, right_type>)
         constexpr void setup(RouterT& router) {
@@ -38,6 +38,12 @@ namespace webpp::http {
         void to_string(istl::String auto& out) const {
             append_to(out, method_str);
         }
+
+        template <typename PrefixT>
+        constexpr bool literal_prefix(PrefixT& out) const {
+            out.verb(method_str);
+            return true;
+        }
     };
 
     using method = method;
@@ -16,6 +16,11 @@ namespace webpp::http {
         constexpr void to_string(istl::String auto& out) const {
             out.append(" root");
         }
+
+        template <typename PrefixT>
+        constexpr bool literal_prefix(PrefixT& out) const {
+            return out.at_root(); // no segment can be checked before the root
+        }
     } root;
 
 
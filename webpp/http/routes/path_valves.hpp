@@ -20,6 +20,12 @@ namespace webpp::http {
         constexpr void to_string(istl::String auto& out) const {
             out.append(" endpath");
         }
+
+        template <typename PrefixT>
+        constexpr bool literal_prefix(PrefixT& out) const {
+            out.end_path();
+            return false; // nothing can come after the end
+        }
     } endpath;
 
     /**
@@ -84,6 +90,15 @@ namespace webpp::http {
               as_tuple());
         }
 
+        template <typename PrefixT>
+        constexpr bool literal_prefix(PrefixT& out) const {
+            return stl::apply(
+              [&out]<typename... T>(T const&... callables) constexpr {
+                  return (valve_literal_prefix(out, callables) && ...);
+              },
+              as_tuple());
+        }
+
         template <typename RouterT>
             requires((ValveRequiresSetup<RouterT, CallableSegments> || ...))
         constexpr void setup(RouterT& inp_router) {
@@ -122,6 +137,12 @@ namespace webpp::http {
             out.append(" ");
             out.append(seg);
         }
+
+        template <typename PrefixT>
+        constexpr bool literal_prefix(PrefixT& out) const {
+            out.append_segment(seg);
+            return true;
+        }
     };
 
     template <typename Seg>
@@ -0,0 +1,259 @@
+// Created by moisrex on 10/17/26.
+
+#ifndef WEBPP_HTTP_ROUTES_ROUTE_INDEX_HPP
+#define WEBPP_HTTP_ROUTES_ROUTE_INDEX_HPP
+
+#include "../../std/algorithm.hpp"
+#include "../../std/span.hpp"
+#include "../../std/string.hpp"
+#include "../../std/string_view.hpp"
+#include "../../std/vector.hpp"
+#include "../../traits/traits.hpp"
+
+#include <cstdint>
+#include <iterator>
+
+namespace webpp::http {
+
+    /**
+     * What a route requires of the requests that it can match, collected from its valves (see
+     * `valve_literal_prefix`): the literal segments that it checks from the beginning of the path, the
+     * method, and if the path should end right after those segments.
+     */
+    template <Traits TraitsType>
+    struct basic_route_prefix {
+        using traits_type      = TraitsType;
+        using string_view_type = traits::string_view<traits_type>;
+        using segments_type =
+          stl::vector<string_view_type, traits::allocator_type_of<traits_type, string_view_type>>;
+
+      private:
+        segments_type    segs;
+        string_view_type method_str{};
+        bool             is_exact = false;
+
+      public:
+        template <typename SegT>
+        constexpr void append_segment(SegT const& seg) {
+            segs.push_back(istl::string_viewify_of<string_view_type>(seg));
+        }
+
+        constexpr void verb(string_view_type const inp_method) noexcept {
+            // the first one is the one that is checked first
+            if (method_str.empty()) {
+                method_str = inp_method;
+            }
+        }
+
+        constexpr void end_path() noexcept {
+            is_exact = true;
+        }
+
+        /// No segment has been checked yet
+        [[nodiscard]] constexpr bool at_root() const noexcept {
+            return segs.empty();
+        }
+
+        [[nodiscard]] constexpr segments_type const& segments() const noexcept {
+            return segs;
+        }
+
+        /// The method that the route requires, empty if it doesn't require any
+        [[nodiscard]] constexpr string_view_type verb() const noexcept {
+            return method_str;
+        }
+
+        /// The path should end right after the segments
+        [[nodiscard]] constexpr bool exact() const noexcept {
+            return is_exact;
+        }
+    };
+
+    /**
+     * Radix Tree of the Routes
+     *
+     * The routes are indexed by the literal segments that they check at the beginning of the path; the
+     * chains of segments that don't branch are compressed into one node. Each node holds the positions of
+     * the routes that can match a path which reaches that node, in the order they were added; so looking
+     * up a path gives the only routes that need to run, without running the rest of them one by one.
+     *
+     * The routes that don't start with literal segments (or the ones that change the path before checking
+     * it) are held by the root, which means they're in the list of every node.
+     */
+    template <Traits TraitsType>
+    struct basic_route_index {
+        using traits_type      = TraitsType;
+        using string_type      = traits::string<traits_type>;
+        using string_view_type = traits::string_view<traits_type>;
+        using prefix_type      = basic_route_prefix<traits_type>;
+        using index_type       = stl::uint32_t;
+        using indices_type     = stl::vector<index_type, traits::allocator_type_of<traits_type, index_type>>;
+        using candidates_type  = stl::span<index_type const>;
+
+      private:
+        using labels_type = stl::vector<string_type, traits::allocator_type_of<traits_type, string_type>>;
+        using verbs_type =
+          stl::vector<string_view_type, traits::allocator_type_of<traits_type, string_view_type>>;
+
+        struct node {
+            labels_type  label;    // the segments between the parent and this node
+            indices_type children; // sorted by their first segment
+            indices_type partial;  // the routes, if the path goes further than this node
+            indices_type full;     // the routes, if the path ends at this node
+
+            template <typename AllocT>
+            explicit constexpr node(AllocT const& alloc)
+              : label{alloc},
+                children{alloc},
+                partial{alloc},
+                full{alloc} {}
+        };
+
+        using nodes_type = stl::vector<node, traits::allocator_type_of<traits_type, node>>;
+
+        nodes_type nodes; // the first one is the root
+        verbs_type verbs; // the method that each route requires
+
+        static constexpr auto same_segment = [](auto const& lhs, auto const& rhs) constexpr noexcept {
+            return string_view_type{lhs} == string_view_type{rhs};
+        };
+
+        // the first child whose first segment is not less than the specified segment
+        [[nodiscard]] constexpr auto lower_child(node const& parent, string_view_type const seg) const {
+            return stl::lower_bound(parent.children.begin(),
+                                    parent.children.end(),
+                                    seg,
+                                    [this](index_type const child, string_view_type const inp_seg) {
+                                        return string_view_type{nodes[child].label.front()} < inp_seg;
+                                    });
+        }
+
+        [[nodiscard]] constexpr node const* find_child(node const& parent, string_view_type const seg) const {
+            auto const pos = lower_child(parent, seg);
+            if (pos == parent.children.end() || nodes[*pos].label.front() != seg) {
+                return nullptr;
+            }
+            return &nodes[*pos];
+        }
+
+        // a node that holds the routes of its parent, but not its parent's exact routes
+        [[nodiscard]] constexpr index_type new_node(index_type const parent) {
+            auto const index = static_cast<index_type>(nodes.size());
+            nodes.emplace_back(nodes.get_allocator());
+            nodes[index].partial = nodes[parent].partial;
+            nodes[index].full    = nodes[parent].partial;
+            return index;
+        }
+
+        // add the route to the node, and to the nodes after it
+        constexpr void add_route(index_type const start, index_type const route) {
+            indices_type pending{nodes.get_allocator()};
+            pending.push_back(start);
+            while (!pending.empty()) {
+                auto& cur = nodes[pending.back()];
+                pending.pop_back();
+                cur.partial.push_back(route);
+                cur.full.push_back(route);
+                pending.insert(pending.end(), cur.children.begin(), cur.children.end());
+            }
+        }
+
+      public:
+        /// Index the next route
+        constexpr void insert(prefix_type const& prefix) {
+            if (nodes.empty()) {
+                nodes.emplace_back(nodes.get_allocator()); // the root
+            }
+            auto const route = static_cast<index_type>(verbs.size());
+            verbs.push_back(prefix.verb());
+
+            auto const& segs = prefix.segments();
+            index_type  cur  = 0;
+            for (auto seg = segs.begin(); seg != segs.end();) {
+                auto const slot = static_cast<stl::size_t>(lower_child(nodes[cur], *seg) -
+                                                           nodes[cur].children.begin());
+                if (slot == nodes[cur].children.size() ||
+                    nodes[nodes[cur].children[slot]].label.front() != *seg)
+                {
+                    // a new branch, with the rest of the segments
+                    auto const child = new_node(cur);
+                    nodes[child].label.assign(seg, segs.end());
+                    auto& children = nodes[cur].children;
+                    children.insert(children.begin() + static_cast<stl::ptrdiff_t>(slot), child);
+                    cur = child;
+                    break;
+                }
+
+                auto const child = nodes[cur].children[slot];
+                auto&      label = nodes[child].label;
+                auto const [label_end, seg_end] =
+                  stl::mismatch(label.begin(), label.end(), seg, segs.end(), same_segment);
+                auto const common = label_end - label.begin();
+                seg               = seg_end;
+                if (label_end == label.end()) {
+                    cur = child;
+                    continue;
+                }
+
+                // split the label of the child, the first part goes to a new node in between
+                auto const mid = new_node(cur);
+                auto&      old = nodes[child].label;
+                nodes[mid].label.assign(stl::make_move_iterator(old.begin()),
+                                        stl::make_move_iterator(old.begin() + common));
+                old.erase(old.begin(), old.begin() + common);
+                nodes[mid].children.push_back(child);
+                nodes[cur].children[slot] = mid;
+                cur                       = mid;
+            }
+
+            if (prefix.exact()) {
+                nodes[cur].full.push_back(route);
+            } else {
+                add_route(cur, route);
+            }
+        }
+
+        /**
+         * Get the routes that may match the path, in the order they were added.
+         * The path is the path of the context's path traverser, its segments are checked from the beginning.
+         */
+        template <typename PathT>
+        [[nodiscard]] constexpr candidates_type lookup(PathT const& path) const noexcept {
+            if (nodes.empty()) {
+                return {};
+            }
+            auto const* cur = &nodes.front();
+            auto        seg = path.begin();
+            auto const  end = path.end();
+            while (seg != end) {
+                auto const* child = find_child(*cur, *seg);
+                if (child == nullptr) {
+                    break;
+                }
+                auto const& label = child->label;
+                if (static_cast<stl::size_t>(stl::distance(seg, end)) < label.size() ||
+                    !stl::equal(label.begin(), label.end(), seg, same_segment))
+                {
+                    break;
+                }
+                stl::advance(seg, label.size());
+                cur = child;
+            }
+            return seg == end ? candidates_type{cur->full} : candidates_type{cur->partial};
+        }
+
+        /// Check the method that the route requires
+        [[nodiscard]] constexpr bool accepts(index_type const       route,
+                                             string_view_type const method) const noexcept {
+            return verbs[route].empty() || verbs[route] == method;
+        }
+
+        /// Number of the routes
+        [[nodiscard]] constexpr stl::size_t size() const noexcept {
+            return verbs.size();
+        }
+    };
+
+} // namespace webpp::http
+
+#endif // WEBPP_HTTP_ROUTES_ROUTE_INDEX_HPP
@@ -4,16 +4,23 @@
 #define WEBPP_ROUTES_TEMPLATED_PATH_HPP
 
 #include "../../std/string_view.hpp"
+#include "../../std/tuple.hpp"
+#include "../../strings/fixed_string.hpp"
 #include "../../uri/uri_string.hpp"
+#include "context.hpp"
+#include "valves.hpp"
 
+#include <array>
 #include <cassert>
+#include <charconv>
+#include <cstdint>
 
 namespace webpp::http {
 
     /**
-     * TODO: add types to the "{user_id}" to be able to use it as "{int:user_id}"
+     * Parse the variables of a templated path at runtime; see tpath for the typed, compile-time version.
      */
-    stl::map<stl::string_view, stl::string_view> parse_vars(stl::string_view const& _templ,
+    inline stl::map<stl::string_view, stl::string_view> parse_vars(stl::string_view const& _templ,
                                                             stl::string_view const& _path) noexcept {
         using namespace webpp;
 
@@ -195,11 +202,11 @@ namespace webpp::http {
 
     /**
      * Features:
-     *   - [ ] Type
-     *     - [ ] Default type
+     *   - [x] Type
+     *     - [x] Default type
      *   - [ ] Validating the segments with a custom method
-     *   - [ ] Partial segments: segments that are not between two slashes
-     *   - [ ] Naming the segments
+     *   - [x] Partial segments: segments that are not between two slashes
+     *   - [x] Naming the segments
      *   - [ ] Variadic segments: segments that contain multiple path segments
      *   - [ ] Default value for segments
      *     - [ ] string as default value
@@ -225,14 +232,434 @@ namespace webpp::http {
      * final user should get the data from there; they can use this feature
      * directly here, but it looks nicer if they do it there.
      */
-    //    struct tpath : public valve<tpath_condition> {
-    //        using valve<tpath_condition>::valve;
-    //    };
-    //
-    //    constexpr tpath operator""_tpath(const char* str, std::size_t len) {
-    //        return tpath{std::string_view{str, len}};
-    //    }
-    //
+
+    /**
+     * A parsed UUID (8-4-4-4-12 hex digits), as captured by "{uuid:name}"
+     */
+    struct uuid {
+        stl::array<stl::uint8_t, 16> bytes{}; // NOLINT(*-magic-numbers)
+
+        [[nodiscard]] constexpr bool operator==(uuid const&) const noexcept = default;
+
+        /// Parse the string; the letters can be in either case
+        [[nodiscard]] static constexpr bool parse(stl::string_view const str, uuid& out) noexcept {
+            constexpr stl::size_t uuid_length = 36;
+            if (str.size() != uuid_length) {
+                return false;
+            }
+            auto const hex_value = [](char const cur) constexpr noexcept -> int {
+                if (cur >= '0' && cur <= '9') {
+                    return cur - '0';
+                }
+                if (cur >= 'a' && cur <= 'f') {
+                    return cur - 'a' + 10; // NOLINT(*-magic-numbers)
+                }
+                if (cur >= 'A' && cur <= 'F') {
+                    return cur - 'A' + 10; // NOLINT(*-magic-numbers)
+                }
+                return -1;
+            };
+            stl::size_t byte = 0;
+            for (stl::size_t pos = 0; pos != uuid_length;) {
+                if (pos == 8 || pos == 13 || pos == 18 || pos == 23) { // NOLINT(*-magic-numbers)
+                    if (str[pos++] != '-') {
+                        return false;
+                    }
+                    continue;
+                }
+                auto const high = hex_value(str[pos++]);
+                auto const low  = hex_value(str[pos++]);
+                if (high < 0 || low < 0) {
+                    return false;
+                }
+                out.bytes[byte++] = static_cast<stl::uint8_t>((high << 4) | low); // NOLINT(*-signed-bitwise)
+            }
+            return true;
+        }
+    };
+
+    namespace details {
+
+        enum struct tpath_type : stl::uint8_t {
+            string, // the default type
+            int32,
+            uint32,
+            int64,
+            uint64,
+            uuid
+        };
+
+        // one segment of the templated path: a literal, or a variable with a literal prefix and suffix
+        struct tpath_segment {
+            stl::size_t begin        = 0; // the literal (the whole segment, or the prefix of the variable)
+            stl::size_t end          = 0;
+            stl::size_t suffix_begin = 0;
+            stl::size_t suffix_end   = 0;
+            stl::size_t name_begin   = 0;
+            stl::size_t name_end     = 0;
+            stl::size_t var_index    = 0;
+            tpath_type  type         = tpath_type::string;
+            bool        is_var       = false;
+        };
+
+        template <tpath_type Type>
+        struct tpath_value {
+            using type = stl::string_view;
+        };
+
+        template <>
+        struct tpath_value<tpath_type::int32> {
+            using type = stl::int32_t;
+        };
+
+        template <>
+        struct tpath_value<tpath_type::uint32> {
+            using type = stl::uint32_t;
+        };
+
+        template <>
+        struct tpath_value<tpath_type::int64> {
+            using type = stl::int64_t;
+        };
+
+        template <>
+        struct tpath_value<tpath_type::uint64> {
+            using type = stl::uint64_t;
+        };
+
+        template <>
+        struct tpath_value<tpath_type::uuid> {
+            using type = uuid;
+        };
+
+        /**
+         * The templated path, parsed at compile time.
+         * The pattern is split by slashes (the empty segments are ignored, like the paths themselves), and
+         * each segment is either a literal or a "{type:name}" variable with an optional literal prefix and
+         * suffix ("user-{int:id}.html").
+         */
+        template <fixed_string Pattern>
+        struct tpath_pattern {
+            static constexpr stl::size_t length = Pattern.size();
+
+            // the pattern is ASCII, so we can compare the paths with it as chars
+            static constexpr stl::array<char, length> chars = [] {
+                stl::array<char, length> res{};
+                for (stl::size_t index = 0; index != length; ++index) {
+                    res[index] = static_cast<char>(Pattern[index]);
+                }
+                return res;
+            }();
+
+            static constexpr bool is_ascii = [] {
+                for (stl::size_t index = 0; index != length; ++index) {
+                    if (Pattern[index] > 0x7F) { // NOLINT(*-magic-numbers)
+                        return false;
+                    }
+                }
+                return true;
+            }();
+
+            [[nodiscard]] static constexpr stl::string_view view(stl::size_t const begin,
+                                                                 stl::size_t const end) noexcept {
+                return {chars.data() + begin, end - begin};
+            }
+
+            /// If the pattern starts with a slash, it has to be matched from the beginning of the path
+            static constexpr bool from_root = length != 0 && chars[0] == '/';
+
+            static constexpr stl::size_t segment_count = [] {
+                stl::size_t count = 0;
+                for (stl::size_t index = 0; index != length; ++index) {
+                    count += chars[index] != '/' && (index == 0 || chars[index - 1] == '/');
+                }
+                return count;
+            }();
+
+            [[nodiscard]] static constexpr bool parse_type(stl::string_view const name,
+                                                           tpath_type&            out) noexcept {
+                using enum tpath_type;
+                if (name.empty() || name == "string" || name == "str") {
+                    out = string;
+                } else if (name == "int" || name == "int32") {
+                    out = int32;
+                } else if (name == "uint" || name == "uint32") {
+                    out = uint32;
+                } else if (name == "int64") {
+                    out = int64;
+                } else if (name == "uint64") {
+                    out = uint64;
+                } else if (name == "uuid") {
+                    out = uuid;
+                } else {
+                    return false;
+                }
+                return true;
+            }
+
+            struct parsed_type {
+                stl::array<tpath_segment, segment_count> segments{};
+                stl::size_t                              var_count = 0;
+                bool                                     valid     = true;
+            };
+
+            static constexpr parsed_type parsed = [] {
+                parsed_type res;
+                stl::size_t seg_index = 0;
+                for (stl::size_t pos = 0; pos != length;) {
+                    if (chars[pos] == '/') {
+                        ++pos;
+                        continue;
+                    }
+                    auto const slash   = view(pos, length).find('/');
+                    auto const end     = slash == stl::string_view::npos ? length : pos + slash;
+                    auto&      seg     = res.segments[seg_index++];
+                    auto const segment = view(pos, end);
+                    auto const open    = segment.find('{');
+                    seg.begin          = pos;
+                    seg.end            = end;
+                    if (open != stl::string_view::npos) {
+                        auto const close = segment.find('}');
+                        auto const colon = segment.find(':', open);
+                        if (close == stl::string_view::npos || close < open ||
+                            segment.find('{', open + 1) != stl::string_view::npos ||
+                            segment.find('}', close + 1) != stl::string_view::npos)
+                        {
+                            res.valid = false; // one variable per segment
+                            return res;
+                        }
+                        auto const has_type  = colon != stl::string_view::npos && colon < close;
+                        auto const type_name = has_type ? segment.substr(open + 1, colon - open - 1) : "";
+                        seg.is_var           = true;
+                        seg.var_index        = res.var_count++;
+                        seg.end              = pos + open;
+                        seg.suffix_begin     = pos + close + 1;
+                        seg.suffix_end       = end;
+                        seg.name_begin       = pos + (has_type ? colon : open) + 1;
+                        seg.name_end         = pos + close;
+                        if (!parse_type(type_name, seg.type)) {
+                            res.valid = false; // unknown type
+                            return res;
+                        }
+                    } else if (segment.find('}') != stl::string_view::npos) {
+                        res.valid = false;
+                        return res;
+                    }
+                    pos = end;
+                }
+                return res;
+            }();
+
+            static_assert(is_ascii, "The templated path should only contain ASCII characters.");
+            static_assert(parsed.valid,
+                          "Invalid templated path; the variables look like {type:name} or {name}, one per "
+                          "segment, and the types are: string, int, uint, int64, uint64, and uuid.");
+
+            static constexpr auto        segments  = parsed.segments;
+            static constexpr stl::size_t var_count = parsed.var_count;
+
+            // the segment of each variable
+            static constexpr auto var_segments = [] {
+                stl::array<stl::size_t, var_count> res{};
+                for (stl::size_t index = 0; index != segment_count; ++index) {
+                    if (segments[index].is_var) {
+                        res[segments[index].var_index] = index;
+                    }
+                }
+                return res;
+            }();
+
+            template <stl::size_t VarIndex>
+            using value_type = typename tpath_value<segments[var_segments[VarIndex]].type>::type;
+
+            using values_type = decltype([]<stl::size_t... VarIndex>(stl::index_sequence<VarIndex...>) {
+                return stl::tuple<value_type<VarIndex>...>{};
+            }(stl::make_index_sequence<var_count>{}));
+
+            template <fixed_string Name>
+            static constexpr stl::size_t index_of = [] {
+                for (stl::size_t index = 0; index != var_count; ++index) {
+                    auto const& seg  = segments[var_segments[index]];
+                    auto const  name = view(seg.name_begin, seg.name_end);
+                    if (name.size() != Name.size()) {
+                        continue;
+                    }
+                    bool same = true;
+                    for (stl::size_t pos = 0; pos != name.size(); ++pos) {
+                        same = same && static_cast<char32_t>(name[pos]) == Name[pos];
+                    }
+                    if (same) {
+                        return index;
+                    }
+                }
+                return var_count;
+            }();
+        };
+
+        template <typename T>
+        [[nodiscard]] constexpr bool parse_tpath_value(stl::string_view const str, T& out) noexcept {
+            if constexpr (stl::same_as<T, stl::string_view>) {
+                out = str;
+                return !str.empty();
+            } else if constexpr (stl::same_as<T, uuid>) {
+                return uuid::parse(str, out);
+            } else {
+                // from_chars doesn't accept the plus sign, and says if the number doesn't fit the type
+                auto const num = str.starts_with('+') ? str.substr(1) : str;
+                if (num.empty() || num.front() == '+' || (str.front() == '+' && num.front() == '-')) {
+                    return false;
+                }
+                auto const* const end = num.data() + num.size(); // NOLINT(*-pro-bounds-pointer-arithmetic)
+                auto const [ptr, err] = stl::from_chars(num.data(), end, out);
+                return err == stl::errc{} && ptr == end;
+            }
+        }
+
+    } // namespace details
+
+    /**
+     * The values that a templated path captures; they're addressed by their index (the order of the
+     * variables in the pattern) or by their name, at compile time:
+     * @code
+     *   tpath_captures<"/users/{int:user_id}/{page}"> vars;
+     *   vars.get<0>();          // int
+     *   vars.get<"page">();     // string_view
+     * @endcode
+     * The string views point to the path of the context, which is valid until the path is reset.
+     */
+    template <fixed_string Pattern>
+    struct tpath_captures {
+        using pattern_type = details::tpath_pattern<Pattern>;
+        using values_type  = typename pattern_type::values_type;
+
+        // NOLINTNEXTLINE(*-non-private-member-variables-in-classes)
+        values_type values{};
+
+        [[nodiscard]] static constexpr stl::size_t size() noexcept {
+            return pattern_type::var_count;
+        }
+
+        template <stl::size_t Index>
+        [[nodiscard]] constexpr auto const& get() const noexcept {
+            return stl::get<Index>(values);
+        }
+
+        template <fixed_string Name>
+        [[nodiscard]] constexpr auto const& get() const noexcept {
+            constexpr auto index = pattern_type::template index_of<Name>;
+            static_assert(index != size(), "There's no variable with this name in the templated path.");
+            return stl::get<index>(values);
+        }
+    };
+
+    /**
+     * Templated Path Valve
+     *
+     * The pattern is parsed at compile time; matching it checks the literal parts, and parses the
+     * variables into their types right into the context (see basic_context::path_captures), so there's
+     * no allocation and the captures are fixed-size:
+     * @code
+     *   constexpr auto user_posts = tpath<"/users/{int:user_id}/posts/{uuid:post}">;
+     *   router += user_posts >> [](context& ctx) {
+     *       auto const& vars = user_posts.captures(ctx);
+     *       return fmt::format("user {}", vars.get<"user_id">());
+     *   };
+     * @endcode
+     *
+     * Like the other path valves, the pattern is checked from the current position of the path (or
+     * from the beginning if it starts with a slash), and the segments after it are left for the next
+     * valves.
+     */
+    template <fixed_string Pattern>
+    struct tpath_valve : valve<tpath_valve<Pattern>> {
+        using pattern_type  = details::tpath_pattern<Pattern>;
+        using captures_type = tpath_captures<Pattern>;
+
+      private:
+        template <stl::size_t Index>
+        [[nodiscard]] static constexpr bool match_segment(stl::string_view const slug,
+                                                          captures_type&         caps) noexcept {
+            constexpr auto seg    = pattern_type::segments[Index];
+            constexpr auto prefix = pattern_type::view(seg.begin, seg.end);
+            if constexpr (!seg.is_var) {
+                return slug == prefix;
+            } else {
+                constexpr auto suffix = pattern_type::view(seg.suffix_begin, seg.suffix_end);
+                if (slug.size() < prefix.size() + suffix.size() || !slug.starts_with(prefix) ||
+                    !slug.ends_with(suffix))
+                {
+                    return false;
+                }
+                return details::parse_tpath_value(
+                  slug.substr(prefix.size(), slug.size() - prefix.size() - suffix.size()),
+                  stl::get<seg.var_index>(caps.values));
+            }
+        }
+
+      public:
+        using valve<tpath_valve>::operator();
+
+        template <Traits TraitsType>
+        [[nodiscard]] bool operator()(basic_context<TraitsType>& ctx) const noexcept {
+            static_assert(sizeof(captures_type) <= basic_context<TraitsType>::path_captures_capacity,
+                          "Too many variables in the templated path.");
+            auto& traverser = ctx.path_traverser();
+            if constexpr (pattern_type::from_root) {
+                if (!traverser.at_beginning()) {
+                    return false;
+                }
+            }
+            auto&       caps     = ctx.template emplace_path_captures<captures_type>();
+            stl::size_t consumed = 0;
+            bool const  matched  = [&]<stl::size_t... Index>(stl::index_sequence<Index...>) {
+                return ((!traverser.at_end() &&
+                         match_segment<Index>(istl::string_viewify_of<stl::string_view>(*traverser), caps) &&
+                         (traverser.next(), ++consumed, true)) &&
+                        ...);
+            }(stl::make_index_sequence<pattern_type::segment_count>{});
+            if (!matched) {
+                // give the path back to the next valves
+                for (; consumed != 0; --consumed) {
+                    traverser.prev();
+                }
+            }
+            return matched;
+        }
+
+        /// The values that this path has captured in the context
+        template <Traits TraitsType>
+        [[nodiscard]] captures_type const& captures(basic_context<TraitsType> const& ctx) const noexcept {
+            return ctx.template path_captures<captures_type>();
+        }
+
+        constexpr void to_string(istl::String auto& out) const {
+            out.append(" tpath\"");
+            out.append(pattern_type::view(0, pattern_type::length));
+            out.append("\"");
+        }
+
+        template <typename PrefixT>
+        constexpr bool literal_prefix(PrefixT& out) const {
+            if constexpr (pattern_type::from_root) {
+                if (!out.at_root()) {
+                    return false;
+                }
+            }
+            // the literal segments before the first variable
+            for (auto const& seg : pattern_type::segments) {
+                if (seg.is_var) {
+                    return false;
+                }
+                out.append_segment(pattern_type::view(seg.begin, seg.end));
+            }
+            return true;
+        }
+    };
+
+    /// A templated path valve, see tpath_valve
+    template <fixed_string Pattern>
+    inline constexpr tpath_valve<Pattern> tpath{};
+
 } // namespace webpp::http
 
 #endif // WEBPP_ROUTES_TEMPLATED_PATH_HPP
@@ -67,6 +67,23 @@ namespace webpp::http {
         }
     }
 
+    /**
+     * Describe what the valve requires of the requests in the prefix (the literal path segments that it
+     * checks from the beginning of the path, the method, ...); the dynamic router uses this to skip the
+     * routes that cannot match a request without running them.
+     *
+     * Returns false if the valve does more than what's described (or if it can't be described at all), in
+     * which case the valves that come after it should not be described either.
+     */
+    template <typename PrefixT, typename Callable>
+    static constexpr bool valve_literal_prefix(PrefixT& out, Callable const& func) {
+        if constexpr (requires { func.literal_prefix(out); }) {
+            return func.literal_prefix(out);
+        } else {
+            return false;
+        }
+    }
+
     /// General Valvifier Tag, and its default implementation
     /// We use this Customization Point Object to let the users customize their types that they
     /// use as "valves", hence the name "valvify", because you're converting your random object
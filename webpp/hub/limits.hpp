@@ -10,7 +10,18 @@
 namespace webpp::http::shosted {
 
     struct limits_type {
-        stl::uint16_t uri = 255;
+        // 501 (Not Implemented) if the method is not shorter than this
+        stl::uint16_t method = 10;
+
+        // 414 (URI Too Long) if the request target is not shorter than this
+        stl::uint16_t uri = 8000;
+
+        // the request line + the header fields; 431 (Request Header Fields Too Large) if it's more
+        stl::size_t header = 16 * 1024; // 16KiB
+
+        // the received bytes that are kept while a response is being sent; the connection is not read
+        // from after that, until the responses are sent (a client that pipelines without reading them)
+        stl::size_t pipeline = 64 * 1024; // 64KiB
 
         struct body_limits {
             stl::uint16_t get_method  = 8 * 1024;        // 8KiB
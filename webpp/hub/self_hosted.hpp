@@ -3,48 +3,370 @@
 #ifndef WEBPP_SELF_HOSTED_HPP
 #define WEBPP_SELF_HOSTED_HPP
 
-#include "../http/app_wrapper.hpp"
+#include "../http/http_concepts.hpp"
 #include "../http/protocol/common_http_protocol.hpp"
 #include "../http/request.hpp"
+#include "../http/request_body.hpp"
+#include "../http/request_headers.hpp"
 #include "../http/response.hpp"
+#include "../std/chrono.hpp"
+#include "../std/format.hpp"
 #include "../std/string_view.hpp"
+#include "limits.hpp"
+#include "self_hosted_body_communicator.hpp"
 #include "self_hosted_request.hpp"
-#include "self_hosted_session_manager.hpp"
+#include "self_hosted_server.hpp"
+
+#ifdef WEBPP_IO_URING_SUPPORT
+#    include <arpa/inet.h>
+#    include <iterator>
+#    include <list>
+#    include <mutex>
+#    include <netinet/in.h>
+#    include <netinet/tcp.h>
+#    include <sys/socket.h>
+#    include <thread>
+#    include <unistd.h>
+#    include <vector>
 
 namespace webpp {
 
+    /**
+     * Self-Hosted Server
+     *
+     * An HTTP/1.1 server that runs directly on top of io_uring (Linux 6.0+), no third-party networking
+     * library is involved. Each thread has its own io_uring, and its own SO_REUSEPORT listening socket;
+     * see shosted::io_worker for the details.
+     */
     template <Application App, Traits TraitsType = default_traits>
-    struct host : public common_http_protocol<TraitsType, App> {
-        using traits_type = TraitsType;
+    struct self_hosted : http::common_http_protocol<TraitsType, App> {
+        using application_type          = stl::remove_cvref_t<App>;
+        using traits_type               = TraitsType;
+        using common_http_protocol_type = http::common_http_protocol<TraitsType, App>;
+        using etraits                   = typename common_http_protocol_type::etraits;
+        using protocol_type             = self_hosted<application_type, traits_type>;
+        using string_type               = traits::string<traits_type>;
+        using string_view_type          = traits::string_view<traits_type>;
+        using port_type                 = stl::uint16_t;
+        using io_worker_type            = http::shosted::io_worker<protocol_type>;
+        using io_worker_allocator_type  = traits::allocator_type_of<traits_type, io_worker_type>;
+        using io_workers_type           = stl::list<io_worker_type, io_worker_allocator_type>;
+        using limits_type               = http::shosted::limits_type;
+        using fields_provider           = http::header_fields_provider<http::header_field_of<traits_type>>;
+        using request_body_communicator = http::shosted::self_hosted_request_body_communicator<protocol_type>;
+        using request_headers_type      = http::request_headers<fields_provider>;
+        using request_body_type         = http::request_body<traits_type, request_body_communicator>;
+        using request_type =
+          http::simple_request<http::shosted::self_hosted_request, request_headers_type, request_body_type>;
+        using response_type = http::simple_response<traits_type>;
+        using duration      = typename stl::chrono::steady_clock::duration;
+
+        static constexpr auto      log_cat           = "SelfHosted";
+        static constexpr port_type default_http_port = 80U;
+
+        // maximum number of requests served on a single keep-alive connection; zero means no limit
+        static constexpr stl::size_t default_max_requests_per_connection = 1000;
 
       private:
-        using super = common_http_protocol<traits_type, App>;
+        using super = http::common_http_protocol<TraitsType, App>;
 
-      public:
-        using app_wrapper_type = typename super::app_wrapper_type;
-        using request_type     = typename super::request_type;
+        friend io_worker_type;
+        friend http::shosted::self_hosted_session_manager<protocol_type>;
+
+        string_type     bind_address;
+        port_type       bind_port = default_http_port;
+        stl::size_t     thread_count{stl::max(stl::thread::hardware_concurrency(), 1U)};
+        io_workers_type io_workers;
+        limits_type     limits_val{};
+        stl::mutex      app_call_mutex;
+        bool            synced = false;
+        bool            sqpoll = false;
+
+        // each request should finish before this
+        duration timeout_val{stl::chrono::seconds(3)};
+
+        // persistent connections (HTTP/1.1 keep-alive)
+        bool        keep_alive_enabled = true;
+        duration    keep_alive_timeout_val{stl::chrono::seconds(5)}; // idle time between two requests
+        stl::size_t max_requests_per_connection_val{default_max_requests_per_connection};
+
+        // call the app
+        http::HTTPResponse auto call_app(request_type& req) noexcept {
+            if (synced) {
+                stl::scoped_lock lock{app_call_mutex};
+                return stl::invoke(this->app, req);
+            }
+            return stl::invoke(this->app, req);
+        }
+
+        /**
+         * Open, bind, and listen on a new SO_REUSEPORT socket; each io worker has one of these, and the
+         * kernel load-balances the connections between them.
+         * @returns the socket, or -1 on failure
+         */
+        [[nodiscard]] int open_listener() noexcept {
+            ::sockaddr_storage addr{};
+            ::socklen_t        addr_len = 0;
+            if (!socket_address(addr, addr_len)) {
+                this->logger.error(log_cat, fmt::format("Invalid address: {}", bind_address));
+                return -1;
+            }
+
+            auto const fail = [this](stl::string_view msg, int sock) noexcept {
+                this->logger.error(log_cat,
+                                   fmt::format("{} {}", msg, bound_uri()),
+                                   stl::error_code{errno, stl::system_category()});
+                if (sock >= 0) {
+                    ::close(sock);
+                }
+                return -1;
+            };
+
+            // open
+            int const sock = ::socket(addr.ss_family, SOCK_STREAM | SOCK_CLOEXEC, 0);
+            if (sock < 0) {
+                return fail("Cannot open protocol for", sock);
+            }
+
+            int const enable = 1;
+
+            // Allow address reuse, and multiple listening sockets on the same port
+            if (::setsockopt(sock, SOL_SOCKET, SO_REUSEADDR, &enable, sizeof(enable)) != 0) {
+                return fail("Cannot set reuse option on", sock);
+            }
+            if (::setsockopt(sock, SOL_SOCKET, SO_REUSEPORT, &enable, sizeof(enable)) != 0) {
+                return fail("Cannot set reuse port option on", sock);
+            }
+
+            // Responses of keep-alive and pipelined connections are small writes that shouldn't wait for
+            // the ACK of the previous response (Nagle's algorithm); the accepted sockets inherit this.
+            if (::setsockopt(sock, IPPROTO_TCP, TCP_NODELAY, &enable, sizeof(enable)) != 0) {
+                return fail("Cannot disable Nagle's algorithm on", sock);
+            }
+
+            // bind
+            // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+            if (::bind(sock, reinterpret_cast<::sockaddr const*>(&addr), addr_len) != 0) {
+                return fail("Cannot bind to", sock);
+            }
+
+            // listen
+            if (::listen(sock, SOMAXCONN) != 0) {
+                return fail("Cannot listen to", sock);
+            }
+            return sock;
+        }
 
-        server_type server;
+        [[nodiscard]] bool socket_address(::sockaddr_storage& addr, ::socklen_t& addr_len) const noexcept {
+            stl::string const addr_str{bind_address.empty() ? string_view_type{"0.0.0.0"}
+                                                            : string_view_type{bind_address}};
+            // NOLINTBEGIN(cppcoreguidelines-pro-type-reinterpret-cast)
+            auto& addr4 = reinterpret_cast<::sockaddr_in&>(addr);
+            if (::inet_pton(AF_INET, addr_str.c_str(), &addr4.sin_addr) == 1) {
+                addr4.sin_family = AF_INET;
+                addr4.sin_port   = htons(bind_port);
+                addr_len         = sizeof(::sockaddr_in);
+                return true;
+            }
+            auto& addr6 = reinterpret_cast<::sockaddr_in6&>(addr);
+            if (::inet_pton(AF_INET6, addr_str.c_str(), &addr6.sin6_addr) == 1) {
+                addr6.sin6_family = AF_INET6;
+                addr6.sin6_port   = htons(bind_port);
+                addr_len          = sizeof(::sockaddr_in6);
+                return true;
+            }
+            // NOLINTEND(cppcoreguidelines-pro-type-reinterpret-cast)
+            return false;
+        }
 
-        // todo: SSL options and other options go here
+      public:
+        self_hosted(self_hosted const&)            = delete;
+        self_hosted(self_hosted&&)                 = delete;
+        self_hosted& operator=(self_hosted const&) = delete;
+        self_hosted& operator=(self_hosted&&)      = delete;
+        ~self_hosted()                             = default;
 
         template <typename... Args>
-        explicit host(Args&&... args)
+        explicit self_hosted(Args&&... args)
           : super{stl::forward<Args>(args)...},
-            server{this->app} {}
+            bind_address{get_alloc_for<string_type>(*this)},
+            io_workers{get_allocator<io_workers_type>(*this)} {}
+
+        self_hosted& address(string_view_type addr) {
+            bind_address = addr;
+            return *this;
+        }
+
+        self_hosted& port(port_type const inp_port) noexcept {
+            bind_port = inp_port;
+            return *this;
+        }
+
+        /// Number of the threads (and io_urings, and listening sockets)
+        self_hosted& set_thread_count(stl::size_t const val) noexcept {
+            thread_count = stl::max<stl::size_t>(val, 1);
+            return *this;
+        }
+
+        /**
+         * The time that a request is allowed to take, from the moment the connection is accepted (or
+         * the first byte of the next request on a keep-alive connection) until its response is sent; the
+         * connection is closed if it takes longer.
+         */
+        self_hosted& timeout(duration const dur) noexcept {
+            timeout_val = dur;
+            return *this;
+        }
+
+        [[nodiscard]] duration timeout() const noexcept {
+            return timeout_val;
+        }
+
+        /**
+         * The time that an idle keep-alive connection is allowed to wait for its next request
+         * before it gets closed.
+         */
+        self_hosted& keep_alive_timeout(duration const dur) noexcept {
+            keep_alive_timeout_val = dur;
+            return *this;
+        }
+
+        [[nodiscard]] duration keep_alive_timeout() const noexcept {
+            return keep_alive_timeout_val;
+        }
+
+        [[nodiscard]] limits_type& limits() noexcept {
+            return limits_val;
+        }
+
+        [[nodiscard]] limits_type const& limits() const noexcept {
+            return limits_val;
+        }
+
+        /**
+         * Maximum number of requests that are served on a single connection before the server
+         * closes it; zero means unlimited.
+         */
+        self_hosted& max_requests_per_connection(stl::size_t const val) noexcept {
+            max_requests_per_connection_val = val;
+            return *this;
+        }
+
+        [[nodiscard]] stl::size_t max_requests_per_connection() const noexcept {
+            return max_requests_per_connection_val;
+        }
+
+        self_hosted& enable_keep_alive() noexcept {
+            keep_alive_enabled = true;
+            return *this;
+        }
+
+        self_hosted& disable_keep_alive() noexcept {
+            keep_alive_enabled = false;
+            return *this;
+        }
+
+        [[nodiscard]] bool is_keep_alive_enabled() const noexcept {
+            return keep_alive_enabled;
+        }
+
+        /**
+         * Let a kernel thread poll the submission queue of each io_uring (IORING_SETUP_SQPOLL), so
+         * submitting the requests doesn't need a system call; each of those threads occupies a CPU core
+         * while the server is busy, so this is only worth it if there are cores to spare.
+         */
+        self_hosted& enable_sqpoll() noexcept {
+            sqpoll = true;
+            return *this;
+        }
+
+        self_hosted& disable_sqpoll() noexcept {
+            sqpoll = false;
+            return *this;
+        }
+
+        [[nodiscard]] bool is_sqpoll_enabled() const noexcept {
+            return sqpoll;
+        }
+
+        self_hosted& enable_sync() noexcept {
+            synced = true;
+            return *this;
+        }
+
+        self_hosted& disable_sync() noexcept {
+            synced = false;
+            return *this;
+        }
+
+        [[nodiscard]] bool is_ssl_active() const noexcept {
+            return false;
+        }
 
         [[nodiscard]] static constexpr bool is_ssl_available() noexcept {
             return false; // todo: change this
         }
 
-        void operator()() noexcept {
-            this->server();
+        [[nodiscard]] string_type bound_uri() const {
+            string_type res_url{get_alloc_for<string_type>(*this)};
+            string_view_type const addr{bind_address.empty() ? string_view_type{"0.0.0.0"}
+                                                             : string_view_type{bind_address}};
+            fmt::format_to(stl::back_inserter(res_url), "http://{}:{}", addr, bind_port);
+            return res_url;
+        }
+
+        [[nodiscard]] constexpr string_view_type server_name() const noexcept {
+            return log_cat;
         }
-    };
 
-    //    template <Traits TraitsType, Application App>
-    //    using server =
+        /**
+         * Stop all the threads; it only notifies the threads, so it's safe to call it from other threads
+         * and from signal handlers.
+         */
+        void stop() noexcept {
+            for (auto const& worker : io_workers) {
+                worker.stop();
+            }
+        }
+
+        // run the server; the main thread runs the first io worker
+        [[nodiscard]] int operator()() {
+            io_workers.clear(); // the workers of the previous run
+            for (stl::size_t index = 0; index != thread_count; ++index) {
+                if (!io_workers.emplace_back(*this).init()) {
+                    io_workers.clear();
+                    return -1;
+                }
+            }
+
+            this->logger.info(log_cat,
+                              fmt::format("Starting self-hosted server on {} with {} threads.",
+                                          bound_uri(),
+                                          thread_count));
+
+            stl::vector<stl::thread> threads;
+            threads.reserve(thread_count - 1);
+            for (auto worker = stl::next(io_workers.begin()); worker != io_workers.end(); ++worker) {
+                threads.emplace_back([&worker_ref = *worker] {
+                    worker_ref.run();
+                });
+            }
+            io_workers.front().run();
+
+            stop(); // the main thread might be stopped because of an error
+            for (auto& thread : threads) {
+                thread.join();
+            }
+
+            // the workers are kept (closed) until the next run, so stop() can be called from the other
+            // threads even after the server is down
+            this->logger.info(log_cat, "Server is down.");
+            return 0;
+        }
+    };
 
 } // namespace webpp
 
+#endif // WEBPP_IO_URING_SUPPORT
+
 #endif // WEBPP_SELF_HOSTED_HPP
@@ -0,0 +1,64 @@
+// Created by moisrex on 10/24/20.
+
+#ifndef WEBPP_SELF_HOSTED_BODY_COMMUNICATOR_HPP
+#define WEBPP_SELF_HOSTED_BODY_COMMUNICATOR_HPP
+
+#include "../std/string_view.hpp"
+#include "../std/type_traits.hpp"
+#include "../traits/traits.hpp"
+
+#include <algorithm>
+
+namespace webpp::http::shosted {
+
+    /**
+     * The middle man between the self-hosted server's input buffer and the framework's request body.
+     * The body is a view into the connection's input buffer; nothing is copied.
+     *
+     * This type implements HTTPRequestBodyCommunicator
+     */
+    template <typename ProtocolType>
+    struct self_hosted_request_body_communicator {
+        using protocol_type    = ProtocolType;
+        using traits_type      = typename protocol_type::traits_type;
+        using char_type        = traits::char_type<traits_type>;
+        using byte_type        = stl::byte;
+        using string_view_type = traits::string_view<traits_type>;
+
+        explicit self_hosted_request_body_communicator(auto&) noexcept {}
+
+        void set_body(string_view_type const inp_body) noexcept {
+            content       = inp_body;
+            read_position = 0;
+        }
+
+        [[nodiscard]] stl::streamsize read(byte_type* data, stl::streamsize const count) noexcept {
+            // NOLINTBEGIN(cppcoreguidelines-pro-type-reinterpret-cast)
+            stl::size_t const length =
+              stl::clamp(static_cast<stl::size_t>(count), stl::size_t{0}, size() - read_position);
+            stl::copy_n(reinterpret_cast<byte_type const*>(content.data() + read_position), length, data);
+            read_position += length;
+            return static_cast<stl::streamsize>(length);
+            // NOLINTEND(cppcoreguidelines-pro-type-reinterpret-cast)
+        }
+
+        [[nodiscard]] stl::streamsize read(byte_type* data) noexcept {
+            return read(data, static_cast<stl::streamsize>(size() - read_position));
+        }
+
+        [[nodiscard]] stl::size_t size() const noexcept {
+            return content.size();
+        }
+
+        [[nodiscard]] bool empty() const noexcept {
+            return content.empty();
+        }
+
+      private:
+        string_view_type content{};
+        stl::size_t      read_position = 0;
+    };
+
+} // namespace webpp::http::shosted
+
+#endif // WEBPP_SELF_HOSTED_BODY_COMMUNICATOR_HPP
@@ -4,36 +4,90 @@
 #define WEBPP_SELF_HOSTED_REQUEST_HPP
 
 #include "../http/http_concepts.hpp"
+#include "../http/http_version.hpp"
+#include "../http/request_view.hpp"
+#include "../std/string_view.hpp"
+#include "../traits/traits.hpp"
 
 namespace webpp::http::shosted {
 
+    /**
+     * The request of the self-hosted server.
+     *
+     * The request line and the body are views into the connection's input buffer, they're only valid
+     * while the application is handling the request; the header fields are copied into the headers.
+     */
+    template <typename CommonHTTPRequest>
+    struct self_hosted_request final
+      : public CommonHTTPRequest,
+        protected details::request_view_interface<typename CommonHTTPRequest::traits_type> {
+        using common_http_request_type = CommonHTTPRequest;
+        using traits_type              = typename common_http_request_type::traits_type;
+        using string_type              = traits::string<traits_type>;
+        using string_view_type         = traits::string_view<traits_type>;
+        using headers_type             = typename common_http_request_type::headers_type;
+        using field_type               = typename headers_type::field_type;
 
-    template <Traits TraitsType, typename SessionManager, typename ConnectionType>
-    struct self_hosted_request : private ConnectionType {
       private:
-        using super = common_http_request<TraitsType>;
+        using super = common_http_request_type;
 
-      public:
-        using session_manager_type = SessionManager;
+        string_view_type method_view{};
+        string_view_type uri_view{};
+        http::version    version_value{};
 
-      private:
-        session_manager_type& session;
+      protected:
+        using pstring_type = typename request_view::string_type;
+
+        template <typename T>
+        [[nodiscard]] inline pstring_type pstringify(T&& str) const {
+            return istl::stringify_of<pstring_type>(stl::forward<T>(str), get_alloc_for<pstring_type>(*this));
+        }
+
+        [[nodiscard]] pstring_type get_method() const override {
+            return pstringify(method());
+        }
+
+        [[nodiscard]] pstring_type get_uri() const override {
+            return pstringify(uri());
+        }
+
+        [[nodiscard]] http::version get_version() const noexcept override {
+            return version();
+        }
 
       public:
         template <typename... Args>
-        explicit self_hosted_request(session_manager_type& _session, Args&&... args)
-          : super(stl::forward<Args>(args)...),
-            session{_session} {}
-
-        // #define WEBPP_SHOSTED_HEADER(name, value)
-        //     [[nodiscard]] string_view_type name() const noexcept {
-        //         return protocol_type::header(value);
-        //     }
-        //
-        //
-        // #undef WEBPP_SHOSTED_HEADER
-    };
+        explicit self_hosted_request(Args&&... args) noexcept : super(stl::forward<Args>(args)...) {}
 
+        self_hosted_request(self_hosted_request const&)                = delete;
+        self_hosted_request(self_hosted_request&&) noexcept            = default;
+        self_hosted_request& operator=(self_hosted_request&&) noexcept = delete;
+        self_hosted_request& operator=(self_hosted_request const&)     = delete;
+
+        ~self_hosted_request() final = default;
+
+        [[nodiscard]] string_view_type uri() const noexcept {
+            return uri_view;
+        }
+
+        [[nodiscard]] string_view_type method() const noexcept {
+            return method_view;
+        }
+
+        [[nodiscard]] http::version version() const noexcept {
+            return version_value;
+        }
+
+        //////////////////////////////////////////
+
+        void set_request_line(string_view_type const method_str,
+                              string_view_type const uri_str,
+                              http::version const    ver) noexcept {
+            method_view   = method_str;
+            uri_view      = uri_str;
+            version_value = ver;
+        }
+    };
 
 } // namespace webpp::http::shosted
 
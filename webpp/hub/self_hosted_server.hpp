@@ -0,0 +1,519 @@
+// Created by moisrex on 9/4/20.
+
+#ifndef WEBPP_SELF_HOSTED_SERVER_HPP
+#define WEBPP_SELF_HOSTED_SERVER_HPP
+
+#include "../io/io_uring/io_uring.hpp"
+#include "../io/timer_wheel.hpp"
+#include "../std/chrono.hpp"
+#include "../std/format.hpp"
+#include "../traits/enable_traits.hpp"
+#include "../traits/traits.hpp"
+#include "self_hosted_session_manager.hpp"
+
+#ifdef WEBPP_IO_URING_SUPPORT
+#    include <bit>
+#    include <cerrno>
+#    include <cstdint>
+#    include <iterator>
+#    include <list>
+#    include <sys/eventfd.h>
+#    include <sys/socket.h>
+#    include <system_error>
+#    include <unistd.h>
+
+namespace webpp::http::shosted {
+
+    /// The kind of the io_uring requests that the io worker submits
+    enum struct io_event : stl::uint8_t {
+        accept   = 1,
+        recv     = 2,
+        send     = 3,
+        shutdown = 4,
+        close    = 5,
+        wakeup   = 6,
+        timer    = 7
+    };
+
+    /**
+     * The completion handler of the io worker's requests.
+     *
+     * The address of the target (the io worker, or one of its connections) and the kind of the request
+     * are packed into one integer (the targets are 8-byte aligned, so the lower 3 bits are free), so the
+     * whole callback fits in the io_uring's user_data and nothing is allocated per request.
+     */
+    template <typename WorkerT>
+    struct io_completion {
+        static constexpr stl::uintptr_t event_mask = 0b111U;
+
+        constexpr io_completion() noexcept = default;
+
+        io_completion(void* target, io_event const event) noexcept
+          // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+          : value{reinterpret_cast<stl::uintptr_t>(target) | static_cast<stl::uintptr_t>(event)} {}
+
+        [[nodiscard]] explicit constexpr operator bool() const noexcept {
+            return value != 0;
+        }
+
+        void operator()(io::io_result const result) const noexcept {
+            // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast, performance-no-int-to-ptr)
+            auto* const target = reinterpret_cast<void*>(value & ~event_mask);
+            WorkerT::on_completion(target, static_cast<io_event>(value & event_mask), result);
+        }
+
+      private:
+        stl::uintptr_t value = 0;
+    };
+
+    /**
+     * A single thread worker with its own io_uring, its own SO_REUSEPORT listening socket, and its own
+     * connections; the threads don't share anything, and the kernel spreads the incoming connections
+     * between them.
+     *
+     * Per connection:
+     *   - one multishot accept delivers all the connections of the listening socket
+     *   - one multishot recv delivers all the bytes of the connection into the buffers that the kernel
+     *     picks from the io_uring's provided buffers; they're copied into the session's input buffer
+     *   - one sendmsg per response (the head and the body are sent together without being copied);
+     *     the connection is closed after the last response is sent completely
+     *   - the recv is canceled while the received (pipelined) requests are more than the limits allow
+     *     and a response is being sent, and it's armed again when the responses are sent
+     *
+     * The requests of an event loop iteration are all submitted together, right before waiting for the
+     * next completions; and the completions are handled in batches.
+     *
+     * The deadlines of the connections (the request timeout, and the keep-alive timeout) are kept in a
+     * timer wheel, and they're all driven by a single io_uring timeout that fires once per tick while
+     * there's a deadline; the connections that miss their deadline are closed.
+     */
+    template <typename ServerT>
+    struct io_worker : enable_traits<typename ServerT::etraits> {
+        using server_type          = ServerT;
+        using etraits              = enable_traits<typename server_type::etraits>;
+        using traits_type          = typename server_type::traits_type;
+        using session_manager_type = self_hosted_session_manager<server_type>;
+        using completion_type      = io_completion<io_worker>;
+        using completion_allocator = traits::allocator_type_of<traits_type, completion_type>;
+        using service_type         = io::basic_io_uring_service<completion_type, completion_allocator>;
+
+        using clock_type    = stl::chrono::steady_clock;
+        using duration      = typename clock_type::duration;
+        using tick_duration = stl::chrono::duration<stl::int64_t, stl::ratio<1, 4>>; // timer resolution
+
+        static constexpr auto     log_cat      = "SelfHosted";
+        static constexpr unsigned ring_entries = 256;
+
+        static_assert(service_type::is_callback_optimizable,
+                      "The completion handler should fit in the io_uring's user data.");
+
+        struct connection;
+
+        using connection_allocator_type = traits::allocator_type_of<traits_type, connection>;
+        using connections_type          = stl::list<connection, connection_allocator_type>;
+
+        struct connection : io::timer_wheel_node {
+            io_worker*                          owner;
+            typename connections_type::iterator self{}; // the position of this connection in the list
+            session_manager_type session;
+            int                  fd      = -1;
+            stl::uint32_t        pending = 0; // number of the requests that are not done yet
+
+            bool receiving    = false; // the multishot recv is armed
+            bool paused       = false; // too many bytes are received; waiting for the responses to be sent
+            bool sending      = false;
+            bool eof          = false; // the client is not going to send anything anymore
+            bool close_queued = false;
+            bool idle         = false; // waiting for the next request of a keep-alive connection
+
+            explicit connection(io_worker& inp_owner) : owner{&inp_owner}, session{*inp_owner.server} {}
+        };
+
+        io_worker(io_worker const&)                = delete;
+        io_worker(io_worker&&) noexcept            = delete;
+        io_worker& operator=(io_worker const&)     = delete;
+        io_worker& operator=(io_worker&&) noexcept = delete;
+
+        explicit io_worker(server_type& inp_server)
+          : etraits{inp_server},
+            server{&inp_server},
+            connections{get_allocator<connections_type>(inp_server)},
+            idle_connections{get_allocator<connections_type>(inp_server)},
+            io{ring_entries,
+               inp_server.is_sqpoll_enabled() ? service_type::sqpoll_params() : io_uring_params{},
+               get_allocator<completion_type>(inp_server)} {}
+
+        ~io_worker() {
+            close_all();
+        }
+
+        /**
+         * Open the listening socket, and get ready to run.
+         * @returns false if the io_uring or the socket couldn't be initialized
+         */
+        [[nodiscard]] bool init() {
+            if (!io.is_success()) {
+                this->logger.error(log_cat,
+                                   "Cannot initialize io_uring.",
+                                   stl::error_code{io.last_error(), stl::system_category()});
+                return false;
+            }
+            if (!io.has_provided_buffers()) {
+                this->logger.error(log_cat,
+                                   "Provided buffer rings are not supported; Linux 5.19+ is required.");
+                return false;
+            }
+            wakeup_fd = ::eventfd(0, EFD_CLOEXEC);
+            if (wakeup_fd < 0) {
+                this->logger.error(log_cat,
+                                   "Cannot create an eventfd.",
+                                   stl::error_code{errno, stl::system_category()});
+                return false;
+            }
+            listener = server->open_listener();
+            return listener >= 0;
+        }
+
+        // run the event loop in the current thread until the worker is stopped
+        void run() {
+            accept();
+            wait_for_wakeup();
+            while (!stopped) {
+                io.run_once();
+                if (!io.is_success() && io.last_error() != EINTR) [[unlikely]] {
+                    this->logger.error(log_cat,
+                                       "Waiting for io_uring completions failed.",
+                                       stl::error_code{io.last_error(), stl::system_category()});
+                    break;
+                }
+            }
+            close_all();
+        }
+
+        /// Stop the event loop; this is thread-safe and async-signal-safe
+        void stop() const noexcept {
+            if (wakeup_fd >= 0) {
+                stl::uint64_t const one = 1;
+                [[maybe_unused]] auto const res = ::write(wakeup_fd, &one, sizeof(one));
+            }
+        }
+
+        /// Number of the connections that are currently open (or being closed)
+        [[nodiscard]] stl::size_t connection_count() const noexcept {
+            return connections.size();
+        }
+
+        static void on_completion(void* target, io_event const event, io::io_result const result) noexcept {
+            switch (event) {
+                using enum io_event;
+                case accept: static_cast<io_worker*>(target)->on_accept(result); return;
+                case wakeup: static_cast<io_worker*>(target)->stopped = true; return;
+                case timer: static_cast<io_worker*>(target)->on_timer(); return;
+                default: break;
+            }
+            auto& conn = *static_cast<connection*>(target);
+            switch (event) {
+                using enum io_event;
+                case recv: conn.owner->on_recv(conn, result); break;
+                case send: conn.owner->on_send(conn, result); break;
+                case shutdown: --conn.pending; break;
+                case close: conn.owner->on_close(conn); break;
+                default: stl::unreachable();
+            }
+            conn.owner->release_if_done(conn);
+        }
+
+      private:
+        static_assert(alignof(connection) > completion_type::event_mask,
+                      "Not enough bits to store the event.");
+
+        [[nodiscard]] io_uring_sqe* prepare(void* target, io_event const event) noexcept {
+            auto* const req = io.safe_sqe();
+            io.set_callback(req, completion_type{target, event});
+            return req;
+        }
+
+        // make sure a chain of requests are not split into two submissions
+        void reserve(unsigned const count) noexcept {
+            if (io_uring_sq_space_left(&io.get_handle()) < count) {
+                io.submit();
+            }
+        }
+
+        void accept() noexcept {
+            io::syscall(io::syscall_accept{},
+                        io,
+                        io::file_handle{listener},
+                        io::multishot,
+                        completion_type{this, io_event::accept});
+        }
+
+        void wait_for_wakeup() noexcept {
+            auto* const req = prepare(this, io_event::wakeup);
+            io_uring_prep_read(req, wakeup_fd, &wakeup_value, sizeof(wakeup_value), 0);
+        }
+
+        void on_accept(io::io_result const result) {
+            if (!io.has_more_completions() && !stopped) {
+                accept(); // the kernel has stopped the multishot accept
+            }
+            if (result.is_error()) [[unlikely]] {
+                this->logger.warning(log_cat,
+                                     "Accepting error",
+                                     stl::error_code{result.error(), stl::system_category()});
+                return;
+            }
+            auto& conn = acquire();
+            conn.fd    = result.value();
+            receive(conn);
+            expire_after(conn, server->timeout());
+        }
+
+        void receive(connection& conn) noexcept {
+            io::syscall(io::syscall_recv{},
+                        io,
+                        io::file_handle{conn.fd},
+                        io::multishot,
+                        completion_type{&conn, io_event::recv});
+            conn.receiving = true;
+            ++conn.pending;
+        }
+
+        void on_recv(connection& conn, io::io_result const result) {
+            bool const more = io.has_more_completions();
+            if (!more) {
+                conn.receiving = false;
+                --conn.pending;
+            }
+            if (result.value() > 0) [[likely]] {
+                if (conn.idle && !conn.close_queued) {
+                    // the next request has started
+                    conn.idle = false;
+                    expire_after(conn, server->timeout());
+                }
+                conn.session.append(io.selected_buffer(result));
+                if (!conn.sending && !conn.close_queued) {
+                    respond(conn);
+                }
+                if (is_input_full(conn)) {
+                    pause_receiving(conn, more);
+                    return;
+                }
+                if (!more && !conn.close_queued) {
+                    receive(conn);
+                }
+                return;
+            }
+            if ((result.error() == ECANCELED || result.error() == ENOBUFS) && conn.paused) {
+                resume_receiving(conn); // the responses might have been sent in the meantime
+                return;
+            }
+            if (result.error() == ENOBUFS && !conn.close_queued) {
+                // all the provided buffers are in use; the kernel has stopped the multishot recv
+                receive(conn);
+                return;
+            }
+
+            // the client has closed the connection, or the connection is broken
+            conn.eof = true;
+            if (!conn.sending && !conn.close_queued) {
+                close(conn);
+            }
+        }
+
+        // a response is being sent, and the client has sent more than the limit since then
+        [[nodiscard]] bool is_input_full(connection const& conn) const noexcept {
+            return conn.sending && conn.session.buffered_size() >= server->limits().pipeline;
+        }
+
+        // stop receiving until the responses are sent; the multishot recv is canceled if it's armed.
+        // The cancellation is retried on each completion of the recv that is received after it, because
+        // it doesn't find the recv while the kernel is re-issuing it (the socket keeps getting data).
+        void pause_receiving(connection& conn, bool const armed) noexcept {
+            if (conn.close_queued) {
+                return;
+            }
+            conn.paused = true;
+            if (armed) {
+                auto* const req = io.safe_sqe();
+                io_uring_prep_cancel64(req, stl::bit_cast<__u64>(completion_type{&conn, io_event::recv}), 0);
+                io_uring_sqe_set_data64(req, 0); // nothing to do when the cancellation is done
+            }
+        }
+
+        void resume_receiving(connection& conn) noexcept {
+            if (!conn.paused || conn.receiving || conn.close_queued || conn.eof || is_input_full(conn)) {
+                return;
+            }
+            conn.paused = false;
+            receive(conn);
+        }
+
+        // send the response of the next request, if it's completely received
+        void respond(connection& conn) {
+            if (conn.session.read()) {
+                send(conn);
+            }
+        }
+
+        void send(connection& conn) noexcept {
+            auto* const req = prepare(&conn, io_event::send);
+            io_uring_prep_sendmsg(req, conn.fd, conn.session.output(), MSG_NOSIGNAL);
+            conn.sending = true;
+            ++conn.pending;
+        }
+
+        void on_send(connection& conn, io::io_result const result) {
+            --conn.pending;
+            if (result.is_ok() && !conn.session.consume_output(static_cast<stl::size_t>(result.value()))) {
+                if (!conn.close_queued) [[likely]] {
+                    send(conn); // the rest of the response
+                    return;
+                }
+            } else if (result.is_ok() && conn.session.next_chunk()) {
+                send(conn);
+                return;
+            }
+            conn.sending = false;
+            if (result.is_error() || !conn.session.keep_connection() || conn.close_queued) {
+                conn.session.written();
+                if (!conn.close_queued) {
+                    close(conn);
+                }
+                return;
+            }
+
+            // persistent connection; the next (pipelined) request might be in the input buffer already
+            conn.session.written();
+            respond(conn);
+            resume_receiving(conn);
+            if (conn.sending) {
+                expire_after(conn, server->timeout());
+            } else if (conn.eof) {
+                close(conn);
+            } else {
+                conn.idle = true;
+                expire_after(conn, server->keep_alive_timeout());
+            }
+        }
+
+        // shutdown, and then close the socket; the shutdown finishes the multishot recv
+        void close(connection& conn) noexcept {
+            timers.cancel(conn);
+            reserve(2);
+            auto* const shutdown_req = prepare(&conn, io_event::shutdown);
+            io_uring_prep_shutdown(shutdown_req, conn.fd, SHUT_RDWR);
+            shutdown_req->flags |= IOSQE_IO_HARDLINK;
+            auto* const close_req = prepare(&conn, io_event::close);
+            io_uring_prep_close(close_req, conn.fd);
+            conn.close_queued  = true;
+            conn.idle          = false;
+            conn.pending      += 2;
+        }
+
+        void on_close(connection& conn) noexcept {
+            --conn.pending;
+            conn.fd = -1;
+        }
+
+        // close the connection if it's still there after the specified duration
+        void expire_after(connection& conn, duration const dur) noexcept {
+            if (!timer_armed) {
+                // the wheel's clock doesn't move while there's no deadline
+                advance_timers();
+                arm_timer();
+            }
+            auto const ticks = stl::max<stl::int64_t>(stl::chrono::ceil<tick_duration>(dur).count(), 1);
+            timers.schedule(conn, static_cast<io::timer_wheel::tick_type>(ticks));
+        }
+
+        void arm_timer() noexcept {
+            io::syscall(io::syscall_timeout{}, io, tick_duration{1}, completion_type{this, io_event::timer});
+            timer_armed = true;
+        }
+
+        void on_timer() noexcept {
+            timer_armed = false;
+            if (stopped) {
+                return;
+            }
+            advance_timers();
+            if (!timers.empty()) {
+                arm_timer();
+            }
+        }
+
+        // catch the wheel's clock up with the real one, and close the connections that have expired
+        void advance_timers() noexcept {
+            auto const elapsed = stl::chrono::floor<tick_duration>(clock_type::now() - timers_epoch).count();
+            timers.advance(static_cast<io::timer_wheel::tick_type>(elapsed) - timers.now(),
+                           [this](io::timer_wheel_node& node) noexcept {
+                               auto& conn = static_cast<connection&>(node);
+                               if (!conn.close_queued) {
+                                   close(conn);
+                               }
+                           });
+        }
+
+        [[nodiscard]] connection& acquire() {
+            if (idle_connections.empty()) {
+                auto& conn = connections.emplace_back(*this);
+                conn.self  = stl::prev(connections.end());
+                return conn;
+            }
+            connections.splice(connections.end(), idle_connections, idle_connections.begin());
+            return connections.back();
+        }
+
+        // the connection can be reused when it's closed, and its requests are all done
+        void release_if_done(connection& conn) {
+            if (conn.fd != -1 || !conn.close_queued || conn.pending != 0) {
+                return;
+            }
+            timers.cancel(conn);
+            conn.session.reset();
+            conn.receiving    = false;
+            conn.paused       = false;
+            conn.sending      = false;
+            conn.eof          = false;
+            conn.close_queued = false;
+            conn.idle         = false;
+            idle_connections.splice(idle_connections.begin(), connections, conn.self);
+        }
+
+        // close everything synchronously; the pending requests are canceled when the io_uring is destroyed
+        void close_all() noexcept {
+            for (auto& conn : connections) {
+                if (conn.fd >= 0) {
+                    ::close(conn.fd);
+                    conn.fd = -1;
+                }
+            }
+            if (listener >= 0) {
+                ::close(listener);
+                listener = -1;
+            }
+            if (wakeup_fd >= 0) {
+                ::close(wakeup_fd);
+                wakeup_fd = -1;
+            }
+        }
+
+        server_type*           server;
+        connections_type       connections;
+        connections_type       idle_connections;
+        service_type           io;     // destroyed before the connections; the kernel may still use them
+        io::timer_wheel        timers; // the deadlines of the connections
+        clock_type::time_point timers_epoch = clock_type::now(); // the tick zero of the timers
+        bool                   timer_armed  = false;
+        int                    listener     = -1;
+        int                    wakeup_fd    = -1;
+        stl::uint64_t          wakeup_value = 0;
+        bool                   stopped      = false;
+    };
+
+} // namespace webpp::http::shosted
+
+#endif // WEBPP_IO_URING_SUPPORT
+
+#endif // WEBPP_SELF_HOSTED_SERVER_HPP
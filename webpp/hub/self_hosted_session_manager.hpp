@@ -3,72 +3,544 @@
 #ifndef WEBPP_SELF_HOSTED_SESSION_MANAGER_HPP
 #define WEBPP_SELF_HOSTED_SESSION_MANAGER_HPP
 
-#include "../configs/constants.hpp"
+#include "../http/bodies/chunked.hpp"
+#include "../http/bodies/file.hpp"
+#include "../http/body_concepts.hpp"
+#include "../http/codec/request_head_parser.hpp"
+#include "../http/http_concepts.hpp"
+#include "../http/http_version.hpp"
 #include "../http/status_code.hpp"
-#include "../server/server_concepts.hpp"
+#include "../io/buffer.hpp"
+#include "../std/optional.hpp"
+#include "../std/string_view.hpp"
+#include "../strings/append.hpp"
+#include "../strings/iequals.hpp"
 #include "../traits/enable_traits.hpp"
 #include "../traits/traits.hpp"
+#include "limits.hpp"
 
 #include <array>
+#include <charconv>
+#include <sys/socket.h>
+#include <sys/uio.h>
 
 namespace webpp::http::shosted {
 
     /**
-     * For a self-hosted server, the session manager class will be created once for each request (well,
-     * actually for each connection to be exact); this might not be the case for other server types.
+     * For a self-hosted server, the session manager class will be created once for each connection,
+     * and it's reused for the next connections after the current one is closed.
+     *
+     * The session manager doesn't do any I/O, the server gives it the received bytes and sends what the
+     * session manager tells it to send:
+     *   1. "append" the received bytes to the input buffer
+     *   2. "read" parses the next request in the input buffer (if it's complete), calls the app, and
+     *      prepares the response
+     *   3. "output" is the status line, the headers, and the body of the response, in a message that
+     *      can be sent with one sendmsg; the body is not copied if it's a text, and the files and the
+     *      chunked bodies are put in the output chunk by chunk ("next_chunk") after the head is sent
+     *   4. "written" drops the request and the response, the next pipelined request may already be in
+     *      the input buffer
      *
      * todo: see if we need a "shosted request manager" type too because of HTTP/2.0 that can handle multiple requests within one connection
-     * todo: Send 204 (No Content) when you don't want the application fails to get you a body
+     * todo: chunked request bodies (Transfer-Encoding) are not supported yet, they get 501 (Not Implemented)
      */
-    template <Traits TraitsType, typename AppWrapperType, HTTPRequest RequestType, Connection ConnectionType>
-    struct self_hosted_session_manager : public ConnectionType {
-        static constexpr auto buffer_size     = default_buffer_size;
-        static constexpr auto logger_category = "SelfHosted/Session";
-
-        using connection_type  = ConnectionType;
-        using traits_type      = TraitsType;
-        using string_view_type = traits::string_view<traits_type>;
-        using char_type        = istl::char_type_of_t<string_view_type>;
-        using allocator_type   = traits::allocator_type_of<traits_type, char_type>;
-        using buffer_type      = stl::array<char_type, buffer_size>;
-        using request_type     = RequestType;
-        using app_wrapper_type = AppWrapperType;
-
-        // we use this way so if the application doesn't have any fields, it'll be easier just to
-        // use a copy of it instead of using a reference
-        // todo: add "trivial" here; it's a defect to use copy-ctor or move-ctor
-        using app_wrapper_ref =
-          stl::conditional_t<sizeof(app_wrapper_type) == 0 && stl::is_move_constructible_v<app_wrapper_type>,
-                             app_wrapper_type,
-                             app_wrapper_type&>;
+    template <typename ServerT>
+    struct self_hosted_session_manager : enable_traits<typename ServerT::etraits> {
+        using server_type       = ServerT;
+        using etraits           = enable_traits<typename server_type::etraits>;
+        using traits_type       = typename server_type::traits_type;
+        using string_type       = traits::string<traits_type>;
+        using string_view_type  = traits::string_view<traits_type>;
+        using request_type      = typename server_type::request_type;
+        using parser_type       = http_request_head_parser<traits_type>;
+        using status_code_type  = typename parser_type::status_code_type;
+        using chunked_body_type = http::chunked_body<traits_type>;
+
+        // the response type that the user's application returns
+        using response_type =
+          stl::remove_cvref_t<stl::invoke_result_t<typename server_type::app_wrapper_type&, request_type&>>;
+
+        static constexpr auto        log_cat         = "SelfHosted/Session";
+        static constexpr stl::size_t file_chunk_size = 64 * 1024; // 64 KiB
 
+        // the size of a chunk in hex + CRLF
+        static constexpr stl::size_t chunk_size_line_max_len = sizeof(stl::size_t) * 2 + 2;
 
       private:
-        [[no_unique_address]] app_wrapper_ref app;
-        request_type                          req;
-        buffer_type                           _buffer{}; // todo: should we use char_type here?
+        server_type* server;
+
+        string_type input;  // the received bytes; may contain more than one (pipelined) request
+        string_type head;   // status line + headers; reused between responses
+        string_type body;   // copy of the bodies that are not in memory in one piece
+        string_type chunk;  // the current chunk of a file body
+
+        stl::optional<request_type>  req{stl::nullopt};
+        stl::optional<response_type> res{stl::nullopt};
+        http::file_body*             file   = nullptr; // the file body that has to be sent after the head
+        chunked_body_type*           chunks = nullptr; // the chunked body that is sent after the head
+
+        stl::array<::iovec, 3>                    out{}; // head + the borrowed body (+ the end of a chunk)
+        ::msghdr                                  msg{};
+        stl::array<char, chunk_size_line_max_len> chunk_size_line{}; // the size of the current chunk, in hex
+
+        // the current request's position in the input buffer
+        stl::size_t head_size      = 0; // zero if the request line and the headers are not parsed yet
+        stl::size_t content_length = 0;
+        stl::size_t consumed_size  = 0; // the size of the request that's being responded to
+
+        parser_type parser{};
+
+        // number of requests that have been served on the current connection
+        stl::size_t served_requests = 0;
+
+        bool keep_alive        = false;
+        bool client_keep_alive = false; // the client's preference
+        bool head_request      = false;
+        bool has_length        = false; // the request has a Content-Length header
+        bool bad_length        = false; // the Content-Length is invalid, or there are different ones
+        bool chunked_body      = false;
+        bool chunked_encoding  = false; // the response's body is sent with "Transfer-Encoding: chunked"
 
       public:
-        self_hosted_session_manager(app_wrapper_ref the_app, request_type request, auto&&... args)
-          : app{the_app},
-            req{stl::move(request)},
-            connection_type{stl::forward<decltype(args)>(args)...} {}
+        explicit self_hosted_session_manager(server_type& inp_server)
+          : etraits{inp_server},
+            server{&inp_server},
+            input{get_alloc_for<string_type>(*this)},
+            head{get_alloc_for<string_type>(*this)},
+            body{get_alloc_for<string_type>(*this)},
+            chunk{get_alloc_for<string_type>(*this)} {}
+
+        self_hosted_session_manager(self_hosted_session_manager const&)                = delete;
+        self_hosted_session_manager(self_hosted_session_manager&&) noexcept            = delete;
+        self_hosted_session_manager& operator=(self_hosted_session_manager const&)     = delete;
+        self_hosted_session_manager& operator=(self_hosted_session_manager&&) noexcept = delete;
+        ~self_hosted_session_manager()                                                 = default;
 
         /**
-         * read a batch of input
+         * Add a batch of received bytes to the input buffer
+         */
+        void append(io::buffer_view const data) {
+            // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+            input.append(reinterpret_cast<char const*>(data.data()), data.size());
+        }
+
+        /// Number of the received bytes that are not dropped yet (the current and the pipelined requests)
+        [[nodiscard]] stl::size_t buffered_size() const noexcept {
+            return input.size();
+        }
+
+        /**
+         * Parse the next request in the input buffer and prepare its response.
+         *
+         * Errors that this method identifies (the response is prepared, and the connection is closed
+         * after it's sent):
+         *   - 400 (Bad Request)
+         *   - 413 (Content Too Large): the body is larger than the limits
+         *   - 414 (URI Too Long)
+         *   - 431 (Request Header Fields Too Large): the request line + headers are larger than the limits
          *
-         * Errors that this method should identify:
-         *   - 413 (Entity Too Large): max http header values is about 4k usually
+         * The head is parsed as it arrives, so these are identified as soon as the limits are exceeded,
+         * without waiting for the rest of the head; and the bytes that are parsed once, are not parsed
+         * again on the next reads.
+         *   - 501 (Not Implemented): chunked request bodies, and too long methods
+         *   - 505 (HTTP Version Not Supported)
          *
-         * But this method is in charge of identifying some error codes, but it doesn't produce the output
+         * @returns true if a response is ready to be sent, false if more bytes are needed
          */
-        status_code read(stl::size_t transferred_bytes) noexcept {}
+        [[nodiscard]] bool read() {
+            string_view_type const data{input.data(), input.size()};
+
+            if (head_size == 0) {
+                auto const status = parse_head(data);
+                if (status == parser_type::need_more) {
+                    return false; // wait for the rest of the head
+                }
+                if (status != 200) {
+                    error_response(static_cast<http::status_code_type>(status));
+                    return true;
+                }
+            }
 
-        // making the output
-        string_view_type output() noexcept {}
+            if (data.size() - head_size < content_length) {
+                return false; // wait for the rest of the body
+            }
 
+            // the input buffer might be re-allocated after the request line is parsed
+            req->set_request_line(parser.method(data), parser.target(data), parser.version());
+            req->body.set_body(data.substr(head_size, content_length));
+            consumed_size = head_size + content_length;
+
+            respond();
+            return true;
+        }
+
+        /**
+         * The response that has to be sent; the data has to stay unchanged until the message is sent
+         * (or "consume_output" is called).
+         */
+        [[nodiscard]] ::msghdr* output() noexcept {
+            return &msg;
+        }
+
+        /**
+         * Mark this many bytes of the output as sent
+         * @returns true if the whole output is sent
+         */
+        [[nodiscard]] bool consume_output(stl::size_t sent) noexcept {
+            while (msg.msg_iovlen != 0) {
+                auto& iov = *msg.msg_iov;
+                if (sent < iov.iov_len) {
+                    iov.iov_base = static_cast<char*>(iov.iov_base) + sent;
+                    iov.iov_len -= sent;
+                    return false;
+                }
+                sent -= iov.iov_len;
+                ++msg.msg_iov;
+                --msg.msg_iovlen;
+            }
+            return true;
+        }
+
+        /**
+         * Put the next chunk of the response's body into the output, if it's a file or a chunked body.
+         * @returns false if there's no more chunks; the connection will not be kept alive if the file
+         * couldn't be read completely
+         */
+        [[nodiscard]] bool next_chunk() {
+            if (chunks != nullptr) {
+                return next_body_chunk();
+            }
+            return next_file_chunk();
+        }
+
+        /// The response's body is a file or a chunked body, and there are still chunks of it to be sent
+        [[nodiscard]] bool has_chunks() const noexcept {
+            return (file != nullptr && !file->empty()) || chunks != nullptr;
+        }
+
+        /**
+         * The response is sent; drop it and its request from the input buffer
+         */
+        void written() {
+            input.erase(0, stl::min(consumed_size, input.size()));
+            head_size        = 0;
+            content_length   = 0;
+            consumed_size    = 0;
+            has_length       = false;
+            bad_length       = false;
+            chunked_body     = false;
+            chunked_encoding = false;
+            file             = nullptr;
+            chunks           = nullptr;
+            parser.reset();
+            res.reset();
+            req.reset();
+        }
+
+        /**
+         * Check if the connection should be kept open after the current response is sent.
+         * The client, the user's response (with a "Connection: close" header), or the server's
+         * settings may ask us to close the connection.
+         */
         [[nodiscard]] bool keep_connection() const noexcept {
-            return false;
+            return keep_alive;
+        }
+
+        /// The connection is closed, forget everything about it
+        void reset() {
+            written();
+            input.clear();
+            chunk.clear();
+            body.clear();
+            served_requests = 0;
+            keep_alive      = false;
+        }
+
+      private:
+        [[nodiscard]] bool next_file_chunk() {
+            if (file == nullptr || file->empty()) {
+                return false;
+            }
+            chunk.resize(stl::min(file->size(), file_chunk_size));
+            // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+            auto* const chunk_data = reinterpret_cast<stl::byte*>(chunk.data());
+            auto const  read_size  = file->read(chunk_data, static_cast<stl::streamsize>(chunk.size()));
+            if (read_size <= 0) {
+                // the file got smaller after we've sent the headers, the client can't tell where the
+                // response ends, if we keep the connection
+                keep_alive = false;
+                return false;
+            }
+            set_output(string_view_type{chunk.data(), static_cast<stl::size_t>(read_size)});
+            return true;
+        }
+
+        /**
+         * Produce the next chunk of the chunked body; the chunks are framed with their sizes, and the
+         * last (empty) chunk is sent after the body is finished, unless the client doesn't know about
+         * chunks (HTTP/1.0), in which case the end of the body is where the connection is closed.
+         * If the producer fails, the connection is closed without the last chunk, so the client knows
+         * that the body is not complete.
+         */
+        [[nodiscard]] bool next_body_chunk() noexcept {
+            bool has_chunk = false;
+            try {
+                has_chunk = chunks->next_chunk();
+            } catch (...) {
+                chunks     = nullptr;
+                keep_alive = false;
+                return false;
+            }
+            if (!has_chunk) {
+                chunks = nullptr;
+                if (!chunked_encoding) {
+                    return false;
+                }
+                set_output("0\r\n\r\n");
+                return true;
+            }
+            auto const data = chunks->chunk();
+            if (!chunked_encoding) {
+                set_output(data);
+                return true;
+            }
+            auto* const line_begin = chunk_size_line.data();
+            auto* const line_end =
+              stl::to_chars(line_begin, line_begin + chunk_size_line.size() - 2, data.size(), 16).ptr;
+            line_end[0] = '\r'; // NOLINT(*-pro-bounds-pointer-arithmetic)
+            line_end[1] = '\n'; // NOLINT(*-pro-bounds-pointer-arithmetic)
+            set_output(string_view_type{line_begin, static_cast<stl::size_t>(line_end - line_begin) + 2},
+                       data,
+                       "\r\n");
+            return true;
+        }
+
+        // parse as much of the request line and the headers as there is in the input buffer
+        [[nodiscard]] status_code_type parse_head(string_view_type const data) {
+            auto const& limits = server->limits();
+            parser.limits      = {.method = limits.method, .uri = limits.uri, .header = limits.header};
+
+            auto const status =
+              parser.feed(data, [&](string_view_type const name, string_view_type const value) {
+                  add_field(data, name, value);
+              });
+            if (status != 200 && status != parser_type::need_more) {
+                content_length = 0;
+                return status;
+            }
+            if (has_length && !bad_length && content_length > body_limit(data)) {
+                // no need to wait for the rest of the head
+                content_length = 0;
+                return 413;
+            }
+            if (status == parser_type::need_more) {
+                return status;
+            }
+            if (!req) {
+                begin_request(data); // no header fields
+            }
+            if (bad_length) {
+                content_length = 0;
+                return 400;
+            }
+            if (chunked_body) {
+                return 501;
+            }
+            head_size = parser.head_size();
+            return 200;
+        }
+
+        // a header field of the current request is received
+        void add_field(string_view_type const data,
+                       string_view_type const name,
+                       string_view_type const value) {
+            if (!req) {
+                begin_request(data);
+            }
+            if (ascii::iequals_sl(name, "content-length")) {
+                stl::size_t length    = 0;
+                auto const [ptr, err] = stl::from_chars(value.data(), value.data() + value.size(), length);
+                bad_length = bad_length || err != stl::errc{} || ptr != value.data() + value.size() ||
+                             (has_length && length != content_length);
+                has_length     = true;
+                content_length = length;
+            } else if (ascii::iequals_sl(name, "transfer-encoding")) {
+                chunked_body = true;
+            } else if (ascii::iequals_sl(name, "connection")) {
+                if (ascii::iequals_sl(value, "close")) {
+                    client_keep_alive = false;
+                } else if (ascii::iequals_sl(value, "keep-alive")) {
+                    client_keep_alive = true;
+                }
+            }
+            req->headers.emplace(name, value);
+        }
+
+        // the request line is parsed; the header fields are coming
+        void begin_request(string_view_type const data) {
+            req.emplace(*server);
+            head_request      = parser.method(data) == "HEAD";
+            client_keep_alive = parser.version().minor_value() != 0; // HTTP/1.1 is persistent by default
+        }
+
+        [[nodiscard]] stl::size_t body_limit(string_view_type const data) const noexcept {
+            auto const& limits = server->limits();
+            return (parser.method(data) == "GET" || head_request) ? limits.body.get_method
+                                                                  : limits.body.post_method;
+        }
+
+        // call the app, and put the response in the output
+        void respond() {
+            ++served_requests;
+            res.emplace(server->call_app(*req));
+            res->calculate_default_headers();
+
+            bool response_allows = true;
+            for (auto const& hdr : res->headers) {
+                if (hdr.is_name(http::header_id::connection)) {
+                    response_allows = !ascii::iequals(hdr.value, "close");
+                }
+            }
+            auto const max_requests = server->max_requests_per_connection();
+            keep_alive = server->is_keep_alive_enabled() && client_keep_alive && response_allows &&
+                         (max_requests == 0 || served_requests < max_requests);
+
+            auto const version_10 = req->version().minor_value() == 0;
+            auto const status     = res->headers.status_code_integer();
+
+            // the size of a chunked body is not known; HTTP/1.0 clients don't know about chunks, so the
+            // end of the body is where the connection is closed
+            auto const is_chunked = !head_request && is_chunked_body(res->body);
+            chunked_encoding      = is_chunked && !version_10;
+            if (is_chunked && version_10) {
+                keep_alive = false;
+            }
+
+            head.clear();
+            head.append(version_10 ? "HTTP/1.0 " : "HTTP/1.1 ");
+            append_to(head, status);
+            head.push_back(' ');
+            head.append(http::status_code_reason_phrase(status));
+            head.append("\r\n");
+            for (auto const& hdr : res->headers) {
+                if (hdr.is_name(http::header_id::connection)) {
+                    continue; // we decide that ourselves
+                }
+                head.append(hdr.name);
+                head.append(": ");
+                head.append(hdr.value);
+                head.append("\r\n");
+            }
+            if (!keep_alive && !version_10) {
+                head.append("Connection: close\r\n");
+            } else if (keep_alive && version_10) {
+                head.append("Connection: keep-alive\r\n");
+            }
+            if (chunked_encoding) {
+                head.append("Transfer-Encoding: chunked\r\n");
+            }
+            head.append("\r\n");
+
+            // responses to HEAD requests only include the Content-Length of the body
+            set_output(head, head_request ? string_view_type{} : body_of(res->body));
+        }
+
+        /**
+         * Get the body in one piece; only the text-based bodies are already in memory in one piece, the
+         * files are sent chunk by chunk after the head, and the rest are copied.
+         */
+        template <typename BodyType>
+        [[nodiscard]] string_view_type body_of(BodyType& res_body) {
+            using body_type = stl::remove_cvref_t<BodyType>;
+            if constexpr (http::UnifiedBodyReader<body_type>) {
+                switch (res_body.which_communicator()) {
+                    using enum http::communicator_type;
+                    case nothing: return {};
+                    case text_based: return text_of(res_body);
+                    case file_based:
+                        file = stl::get_if<typename body_type::file_communicator_type>(
+                          &res_body.communicator());
+                        return {};
+                    case chunked_based:
+                        chunks = stl::get_if<typename body_type::chunked_communicator_type>(
+                          &res_body.communicator());
+                        return {};
+                    default: return copy_of(res_body);
+                }
+            } else if constexpr (http::TextBasedBodyReader<body_type>) {
+                return text_of(res_body);
+            } else if constexpr (http::CStreamBasedBodyReader<body_type>) {
+                return copy_of(res_body);
+            } else {
+                static_assert_false(body_type,
+                                    "We don't know how to read your response's body "
+                                    "thus we don't know how to send it to the user.");
+            }
+        }
+
+        template <typename BodyType>
+        [[nodiscard]] static bool is_chunked_body(BodyType const& res_body) noexcept {
+            if constexpr (http::UnifiedBodyReader<stl::remove_cvref_t<BodyType>>) {
+                return res_body.which_communicator() == http::communicator_type::chunked_based;
+            } else {
+                return false;
+            }
+        }
+
+        template <typename BodyType>
+        [[nodiscard]] static string_view_type text_of(BodyType& res_body) noexcept {
+            if (res_body.data() == nullptr) {
+                return {};
+            }
+            // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+            return {reinterpret_cast<char const*>(res_body.data()),
+                    res_body.size() * sizeof(*res_body.data())};
+        }
+
+        template <typename BodyType>
+        [[nodiscard]] string_view_type copy_of(BodyType& res_body) {
+            using byte_type = typename stl::remove_cvref_t<BodyType>::byte_type;
+            stl::array<char, default_buffer_size> static_buf; // NOLINT(*-pro-type-member-init)
+            body.clear();
+            // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+            auto* const buf_data = reinterpret_cast<byte_type*>(static_buf.data());
+            while (stl::streamsize const read_size =
+                     res_body.read(buf_data, static_cast<stl::streamsize>(static_buf.size())))
+            {
+                if (read_size < 0) {
+                    break;
+                }
+                body.append(static_buf.data(), static_cast<stl::size_t>(read_size));
+            }
+            return body;
+        }
+
+        // NOLINTBEGIN(cppcoreguidelines-pro-type-const-cast)
+        void set_output(string_view_type const first,
+                        string_view_type const second = {},
+                        string_view_type const third  = {}) noexcept {
+            out[0]         = ::iovec{const_cast<char*>(first.data()), first.size()};
+            out[1]         = ::iovec{const_cast<char*>(second.data()), second.size()};
+            out[2]         = ::iovec{const_cast<char*>(third.data()), third.size()};
+            msg            = ::msghdr{};
+            msg.msg_iov    = out.data();
+            msg.msg_iovlen = !third.empty() ? 3 : second.empty() ? 1 : 2;
+        }
+
+        // NOLINTEND(cppcoreguidelines-pro-type-const-cast)
+
+        // respond with an error, and close the connection after it's sent
+        void error_response(http::status_code_type const status) {
+            keep_alive    = false;
+            consumed_size = input.size();
+            req.reset();
+            head.clear();
+            head.append("HTTP/1.1 ");
+            append_to(head, status);
+            head.push_back(' ');
+            head.append(http::status_code_reason_phrase(status));
+            head.append("\r\nContent-Length: 0\r\nConnection: close\r\n\r\n");
+            set_output(head);
         }
     };
 
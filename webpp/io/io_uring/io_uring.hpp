@@ -9,22 +9,31 @@
 #include "../../libs/ioring.hpp"
 #ifdef WEBPP_IO_URING_SUPPORT
 #    include "../../async/async.hpp"
+#    include "../../std/chrono.hpp"
 #    include "../../std/coroutine.hpp"
 #    include "../../std/expected.hpp"
+#    include "../../std/filesystem.hpp"
 #    include "../../std/functional.hpp"
 #    include "../../std/optional.hpp"
+#    include "../../std/vector.hpp"
 #    include "../buffer.hpp"
 #    include "../file_handle.hpp"
 #    include "../file_options.hpp"
 #    include "../io_result.hpp"
 #    include "../syscalls.hpp"
+#    include "./io_uring_buffers.hpp"
 
+#    include <array>
 #    include <atomic>
 #    include <bit>
 #    include <cstdint>
+#    include <fcntl.h>
 #    include <iterator>
 #    include <new> // std::launder
+#    include <sys/socket.h>
+#    include <sys/stat.h>
 #    include <system_error>
+#    include <utility>
 
 namespace webpp::io {
 
@@ -32,6 +41,7 @@ namespace webpp::io {
         success          = 0,
         init_failure     = 1, // cannot initialize the parameters of a new io_uring
         SQE_init_failure = 2, // couldn't get a new Submission Queue Entry
+        wait_failure     = 3, // waiting for a completion failed (interrupted by a signal for example)
     };
 
     template <typename IOUringService>
@@ -70,12 +80,20 @@ namespace webpp::io {
         using callback_type = Callback;
         using allocator_type =
           typename stl::allocator_traits<Allocator>::template rebind_alloc<callback_type>;
-        using buffer_manager_type = buffer_manager<allocator_type>;
-        using buffer_type         = typename buffer_manager_type::buffer_type;
+        using buffer_manager_type = io_uring_buffer_manager<allocator_type>;
+        using buffer_id_type      = typename buffer_manager_type::buffer_id_type;
         using scheduler_type      = io_uring_scheduler<basic_io_uring_service>;
+        using timespec_allocator_type =
+          typename stl::allocator_traits<Allocator>::template rebind_alloc<__kernel_timespec>;
 
         static constexpr unsigned default_entries_value = 64;
 
+        /// maximum number of the completions that are taken from the completion queue at once
+        static constexpr unsigned completion_batch_size = 32;
+
+        /// milliseconds that the kernel's submission queue polling thread stays awake without any work
+        static constexpr unsigned default_sq_thread_idle = 1000;
+
 
         /// if the callback's size is less than the io_uring's data type (which is u64 or same as void*),
         /// then we can put the whole thing inside the user_data itself
@@ -128,23 +146,51 @@ namespace webpp::io {
          */
         // NOLINTBEGIN(cppcoreguidelines-pro-type-member-init)
         basic_io_uring_service(unsigned entries, io_uring_params inp_params, Allocator const& inp_alloc = {})
-          noexcept(stl::is_nothrow_copy_constructible_v<Allocator>)
           : alloc{inp_alloc},
-            params{inp_params} {
-            static_cast<void>(error_on_res(io_uring_queue_init_params(entries, &ring, &params),
-                                           io_uring_service_state::init_failure));
+            params{inp_params},
+            buf_pack{buffer_manager_type::default_buffer_count,
+                     buffer_manager_type::default_buffer_size,
+                     buffer_manager_type::default_group_id,
+                     alloc},
+            timespecs{timespec_allocator_type{inp_alloc}} {
+            if (error_on_res(io_uring_queue_init_params(entries, &ring, &params),
+                             io_uring_service_state::init_failure))
+            {
+                // one per submission queue entry, see timespec_of
+                timespecs.resize(ring.sq.ring_entries);
+
+                // the kernel might not support provided buffer rings (< 5.19), in which case only the
+                // reads with a buffer of their own are possible
+                static_cast<void>(buf_pack.register_to(ring));
+            }
         }
 
         // NOLINTEND(cppcoreguidelines-pro-type-member-init)
         explicit basic_io_uring_service(unsigned         entries   = default_entries_value,
                                         Allocator const& inp_alloc = {})
-          noexcept(stl::is_nothrow_copy_constructible_v<Allocator>)
           : basic_io_uring_service{entries, {}, inp_alloc} {}
 
         explicit basic_io_uring_service(Allocator const& inp_alloc)
-          noexcept(stl::is_nothrow_copy_constructible_v<Allocator>)
           : basic_io_uring_service{default_entries_value, {}, inp_alloc} {}
 
+        /**
+         * The parameters of an io_uring whose submission queue is polled by a kernel thread
+         * (IORING_SETUP_SQPOLL); submitting the requests won't need a system call as long as the thread
+         * is awake. The thread goes to sleep after `idle_ms` milliseconds of inactivity, and it occupies
+         * a CPU core while it's awake, so it's only worth it for the very busy rings.
+         *
+         * @code
+         *   basic_io_uring_service io{entries, basic_io_uring_service::sqpoll_params()};
+         * @endcode
+         */
+        [[nodiscard]] static constexpr io_uring_params sqpoll_params(
+          unsigned const idle_ms = default_sq_thread_idle) noexcept {
+            io_uring_params sq_params{};
+            sq_params.flags          = IORING_SETUP_SQPOLL;
+            sq_params.sq_thread_idle = idle_ms;
+            return sq_params;
+        }
+
         /**
          * Create a copy of the io_service which shares the same kernel worker thread.
          *
@@ -182,6 +228,7 @@ namespace webpp::io {
 
         ~basic_io_uring_service() {
             // todo: deallocate unfinished requests
+            buf_pack.unregister_from(ring);
             io_uring_queue_exit(&ring);
         }
 
@@ -218,7 +265,7 @@ namespace webpp::io {
                 // SQ is full, flushing some SQE(s):
                 io_uring_cq_advance(&ring, cqe_count);
                 cqe_count = 0;
-                io_uring_submit(&ring);
+                submit();
                 sqe = io_uring_get_sqe(&ring);
                 if (sqe != nullptr) [[likely]] {
                     return sqe;
@@ -244,10 +291,23 @@ namespace webpp::io {
             return req;
         }
 
+        /**
+         * Submit the queued requests now.
+         *
+         * The requests are not submitted one by one, they're all submitted by the event loop
+         * (`operator()`) right before waiting for the completions, in the same system call; so calling
+         * this is only needed if the requests should be started before the event loop runs again.
+         */
         void submit() noexcept {
+            last_sqe = nullptr;
             io_uring_submit(&ring);
         }
 
+        /// Number of the requests that are queued, but not submitted yet
+        [[nodiscard]] unsigned queued_count() const noexcept {
+            return io_uring_sq_ready(&ring);
+        }
+
         void set_callback(io_uring_sqe* req, rvalue_callback callback) noexcept(is_callback_optimizable) {
             // NOLINTBEGIN(*-pro-type-reinterpret-cast)
             if constexpr (is_callback_optimizable) {
@@ -274,19 +334,32 @@ namespace webpp::io {
             // NOLINTEND(*-pro-type-reinterpret-cast)
         }
 
+        /**
+         * Call the callback of the specified completion.
+         * The callback of a multishot request (accept, recv, ...) is kept alive as long as the kernel
+         * says that more completions are coming for it (IORING_CQE_F_MORE).
+         */
         void call_callback(io_uring_cqe* response, io_result result)
           noexcept(is_callback_optimizable && is_callback_nothrow) {
+            more_completions = (response->flags & IORING_CQE_F_MORE) != 0;
             // NOLINTBEGIN(*-pro-type-reinterpret-cast)
             if constexpr (is_callback_optimizable) {
+                // the user_data owns the callback; the last completion of the request destroys it
                 auto callback_data = io_uring_cqe_get_data64(response);
                 auto callback_ptr  = stl::launder(reinterpret_cast<callback_type*>(&callback_data));
                 if (*callback_ptr) {
                     stl::invoke(*callback_ptr, result);
-                    stl::destroy_at(callback_ptr);
+                    if (!more_completions) {
+                        stl::destroy_at(callback_ptr);
+                    }
                 }
             } else {
                 auto callback_ptr = reinterpret_cast<callback_type*>(io_uring_cqe_get_data(response));
                 if (callback_ptr) {
+                    if (more_completions) {
+                        stl::invoke(*callback_ptr, result);
+                        return;
+                    }
                     stl::invoke(stl::move(*callback_ptr), result);
 
                     // don't deallocate if our kinda-SOO (Small Object Optimization) has kicked in
@@ -305,8 +378,41 @@ namespace webpp::io {
             // NOLINTEND(*-pro-type-reinterpret-cast)
         }
 
-        [[nodiscard]] buffer_type buffer(stl::size_t len) {
-            return buf_pack.new_buffer(len);
+        [[nodiscard]] constexpr buffer_manager_type& buffers() noexcept {
+            return buf_pack;
+        }
+
+        /// Check if the reads can let the kernel choose a buffer from the registered pool
+        [[nodiscard]] constexpr bool has_provided_buffers() const noexcept {
+            return buf_pack.is_registered();
+        }
+
+        /**
+         * The data of a buffer-select read; only valid inside its callback, the buffer is given back to
+         * the kernel after the callback returns (unless `take_selected_buffer` is called).
+         */
+        [[nodiscard]] buffer_view selected_buffer(io_result const result) const noexcept {
+            if (!selected_buf || result.is_error()) {
+                return {};
+            }
+            return buf_pack.buffer(*selected_buf, static_cast<stl::size_t>(result.value()));
+        }
+
+        /**
+         * Check if the running callback is going to be called again; only the multishot requests get
+         * more than one completion, and they're re-armed when this is false.
+         */
+        [[nodiscard]] constexpr bool has_more_completions() const noexcept {
+            return more_completions;
+        }
+
+        /// Keep the selected buffer after the callback returns; give it back with `recycle_buffer`
+        [[nodiscard]] constexpr stl::optional<buffer_id_type> take_selected_buffer() noexcept {
+            return stl::exchange(selected_buf, stl::nullopt);
+        }
+
+        void recycle_buffer(buffer_id_type const bid) noexcept {
+            buf_pack.recycle(bid);
         }
 
         [[nodiscard]] constexpr scheduler_type scheduler() noexcept {
@@ -317,24 +423,45 @@ namespace webpp::io {
             should_stop = true;
         }
 
+        /**
+         * Submit the queued requests, and handle `count` completions.
+         *
+         * The requests are submitted together, and the thread only sleeps if there's no completion
+         * ready, in one system call; then the completions that are ready are handled in batches, and
+         * they're given back to the kernel together.
+         */
         void operator()(stl::size_t count = 1) {
-            should_stop       = false;
-            io_uring_cqe* cqe = nullptr;
-            for (; count; --count) {
-                int const ret = io_uring_wait_cqe(&ring, &cqe);
-                if (ret == 0) {
-                    call_callback(cqe, cqe->res);
-                } else {
-                    call_callback(cqe, io_result::invalid(-ret)); // -errno is saved in the return value
+            should_stop = false;
+            while (count != 0 && submit_and_wait()) {
+                auto const handled = handle_completions(count);
+                if (should_stop) {
+                    break;
                 }
+                count -= handled;
+            }
+        }
 
-                // mark the request as processed
-                io_uring_cqe_seen(&ring, cqe);
-
-                if (should_stop) {
+        /**
+         * One iteration of an event loop: submit the queued requests, wait for at least one completion,
+         * and handle all the completions that are ready.
+         *
+         * @returns the number of the handled completions; zero if waiting has failed (interrupted by a
+         *          signal for example, see last_error)
+         */
+        stl::size_t run_once() {
+            should_stop = false;
+            if (!submit_and_wait()) [[unlikely]] {
+                return 0;
+            }
+            stl::size_t total = 0;
+            while (!should_stop) {
+                auto const handled = handle_completions(completion_batch_size);
+                total += handled;
+                if (handled != completion_batch_size) {
                     break;
                 }
             }
+            return total;
         }
 
         void run_wait() noexcept {
@@ -347,43 +474,272 @@ namespace webpp::io {
         }
 
       private:
+        // submit the queued requests, and wait for a completion if there's none ready (one system call)
+        [[nodiscard]] bool submit_and_wait() noexcept {
+            if (io_uring_cq_ready(&ring) != 0) {
+                if (io_uring_sq_ready(&ring) != 0) {
+                    submit();
+                }
+                return true;
+            }
+            last_sqe = nullptr;
+            // interrupted by a signal (-EINTR) or the ring is broken; there's no completion, so there's no
+            // callback to call either
+            return error_on_res(io_uring_submit_and_wait(&ring, 1), io_uring_service_state::wait_failure);
+        }
+
+        // handle the completions that are ready (at most `max_count` of them) in one batch
+        stl::size_t handle_completions(stl::size_t const max_count) {
+            stl::array<io_uring_cqe*, completion_batch_size> cqes; // NOLINT(*-pro-type-member-init)
+
+            auto const batch_size = static_cast<unsigned>(stl::min<stl::size_t>(max_count, cqes.size()));
+            auto const ready      = io_uring_peek_batch_cqe(&ring, cqes.data(), batch_size);
+            stl::size_t handled   = 0;
+            for (unsigned index = 0; index != ready; ++index) {
+                auto* const cqe = cqes[index];
+                selected_buf    = buffer_manager_type::selected_id(*cqe);
+                call_callback(cqe, cqe->res);
+                if (auto const bid = take_selected_buffer()) {
+                    buf_pack.recycle(*bid);
+                }
+
+                // the handled completions might be given back sooner, if the submission queue gets full
+                // (see safe_sqe)
+                ++cqe_count;
+                ++handled;
+                if (should_stop) {
+                    break;
+                }
+            }
+
+            // mark the requests as processed
+            io_uring_cq_advance(&ring, cqe_count);
+            cqe_count = 0;
+            return handled;
+        }
+
 #    define define_syscall(op, ...)                                  \
         friend auto tag_invoke(io::syscall_operations::syscall_##op, \
                                basic_io_uring_service&     self,     \
                                file_handle file_descriptor __VA_OPT__(, ) __VA_ARGS__)
+
+        // the requests are queued, the event loop submits them all at once
+        [[nodiscard]] io_uring_sqe* prepare(rvalue_callback callback) noexcept(is_callback_optimizable) {
+            auto* const req = safe_sqe();
+            set_callback(req, stl::move(callback));
+            last_sqe = req;
+            return req;
+        }
+
+        // a request without a callback
+        [[nodiscard]] io_uring_sqe* prepare() noexcept {
+            auto* const req = safe_sqe();
+            io_uring_sqe_set_data64(req, 0);
+            last_sqe = req;
+            return req;
+        }
+
+        /**
+         * The timespec of a timeout request; the kernel reads it when the request is submitted, which
+         * might be after the syscall has returned (the submission is deferred to the event loop, or it's
+         * done by the polling thread), so each submission queue entry has its own, which lives as long as
+         * the entry is not reused.
+         */
+        [[nodiscard]] __kernel_timespec* timespec_of(io_uring_sqe const* req,
+                                                     stl::chrono::nanoseconds const duration) noexcept {
+            using stl::chrono::duration_cast;
+            using stl::chrono::seconds;
+
+            auto const secs = duration_cast<seconds>(duration);
+            auto& spec      = timespecs[static_cast<stl::size_t>(req - ring.sq.sqes)];
+            spec.tv_sec     = secs.count();
+            spec.tv_nsec    = (duration - secs).count();
+            return &spec;
+        }
+
+        // let the kernel pick a buffer from the registered pool
+        void select_buffer(io_uring_sqe* req) const noexcept {
+            req->flags     |= IOSQE_BUFFER_SELECT;
+            req->buf_group  = buf_pack.group();
+        }
+
       public:
         define_syscall(read, buffer_span buf, stl::size_t offset, callback_type callback) noexcept -> void {
-            auto req = self.sqe(stl::move(callback));
+            auto req = self.prepare(stl::move(callback));
             io_uring_prep_read(req, file_descriptor, buf.data(), static_cast<unsigned>(buf.size()), offset);
-            self.submit();
+        }
+
+        /**
+         * Read without a buffer; the kernel picks one from the registered pool when the data is ready,
+         * and the callback can get it from `selected_buffer`. The read fails with ENOBUFS if all the
+         * buffers are in use.
+         */
+        define_syscall(read, stl::size_t offset, callback_type callback) noexcept -> void {
+            auto req = self.prepare(stl::move(callback));
+            io_uring_prep_read(req,
+                               file_descriptor,
+                               nullptr,
+                               static_cast<unsigned>(self.buf_pack.buffer_size()),
+                               offset);
+            self.select_buffer(req);
         }
 
         define_syscall(write, buffer_view buf, stl::size_t offset, callback_type callback) noexcept -> void {
-            auto req = self.sqe(stl::move(callback));
+            auto req = self.prepare(stl::move(callback));
             io_uring_prep_write(req, file_descriptor, buf.data(), static_cast<unsigned>(buf.size()), offset);
-            self.submit();
         }
 
         define_syscall(close, callback_type callback) noexcept -> void {
-            auto req = self.sqe(stl::move(callback));
+            auto req = self.prepare(stl::move(callback));
             io_uring_prep_close(req, file_descriptor);
-            self.submit();
         }
 
         define_syscall(close) noexcept -> void {
-            auto req = self.sqe();
+            auto req = self.prepare();
             io_uring_prep_close(req, file_descriptor);
-            self.submit();
+        }
+
+        /// Accept a connection on the listening socket; the result is the new socket
+        define_syscall(accept, callback_type callback) noexcept -> void {
+            auto req = self.prepare(stl::move(callback));
+            io_uring_prep_accept(req, file_descriptor, nullptr, nullptr, SOCK_CLOEXEC);
+        }
+
+        /**
+         * Accept all the connections of the listening socket with one request (Linux 5.19+); the callback
+         * is called once per connection, and `has_more_completions` is false in its last call (on an
+         * error, for example), after which the request should be re-submitted if needed.
+         */
+        define_syscall(accept, multishot_tag, callback_type callback) noexcept -> void {
+            auto req = self.prepare(stl::move(callback));
+            io_uring_prep_multishot_accept(req, file_descriptor, nullptr, nullptr, SOCK_CLOEXEC);
+        }
+
+        define_syscall(recv, buffer_span buf, callback_type callback) noexcept -> void {
+            auto req = self.prepare(stl::move(callback));
+            io_uring_prep_recv(req, file_descriptor, buf.data(), buf.size(), 0);
+        }
+
+        /// Receive into a buffer that the kernel picks from the registered pool (see `selected_buffer`)
+        define_syscall(recv, callback_type callback) noexcept -> void {
+            auto req = self.prepare(stl::move(callback));
+            io_uring_prep_recv(req, file_descriptor, nullptr, self.buf_pack.buffer_size(), 0);
+            self.select_buffer(req);
+        }
+
+        /**
+         * Receive everything the socket gets with one request (Linux 6.0+); each chunk of data comes in a
+         * buffer that the kernel picks from the registered pool (see `selected_buffer`), and the callback
+         * is called once per chunk. The last call has no more completions (`has_more_completions`); the
+         * connection is closed (0), an error happened, or the pool ran out of buffers (ENOBUFS), after
+         * which the request should be re-submitted if needed.
+         */
+        define_syscall(recv, multishot_tag, callback_type callback) noexcept -> void {
+            auto req = self.prepare(stl::move(callback));
+            io_uring_prep_recv_multishot(req, file_descriptor, nullptr, 0, 0);
+            self.select_buffer(req);
+        }
+
+        /// Send the data on a socket; a closed connection is reported as EPIPE, and there's no SIGPIPE
+        define_syscall(send, buffer_view buf, callback_type callback) noexcept -> void {
+            auto req = self.prepare(stl::move(callback));
+            io_uring_prep_send(req, file_descriptor, buf.data(), buf.size(), MSG_NOSIGNAL);
+        }
+
+        /**
+         * Open a file relative to the specified directory (or AT_FDCWD); the result is the new file
+         * descriptor. The path should stay alive until the callback is called.
+         */
+        define_syscall(openat,
+                       char const*            path,
+                       file_options           options,
+                       stl::filesystem::perms permissions,
+                       callback_type          callback) noexcept -> void {
+            auto req = self.prepare(stl::move(callback));
+            io_uring_prep_openat(req,
+                                 file_descriptor,
+                                 path,
+                                 options.native_flags() | O_CLOEXEC,
+                                 static_cast<mode_t>(stl::to_underlying(permissions)));
+        }
+
+        /**
+         * Get the status of a file (relative to the specified directory, or AT_FDCWD; or the file itself if
+         * the path is empty and the AT_EMPTY_PATH flag is set). The path and the output should stay alive
+         * until the callback is called.
+         */
+        define_syscall(statx,
+                       char const*    path,
+                       int            flags,
+                       unsigned       mask,
+                       struct statx*  stats,
+                       callback_type  callback) noexcept -> void {
+            auto req = self.prepare(stl::move(callback));
+            io_uring_prep_statx(req, file_descriptor, path, flags, mask, stats);
+        }
+
+        /// Cancel all the pending requests of the file descriptor; the result is the number of them
+        define_syscall(cancel, callback_type callback) noexcept -> void {
+            auto req = self.prepare(stl::move(callback));
+            io_uring_prep_cancel_fd(req, file_descriptor, IORING_ASYNC_CANCEL_ALL);
+        }
+
+        define_syscall(cancel) noexcept -> void {
+            auto req = self.prepare();
+            io_uring_prep_cancel_fd(req, file_descriptor, IORING_ASYNC_CANCEL_ALL);
         }
 
 #    undef define_syscall
 
+        /**
+         * A timer; the callback is called with ETIME when the duration has passed (or with ECANCELED if
+         * the ring is gone before that). One timer can drive any number of deadlines, see timer_wheel.
+         */
+        friend auto tag_invoke(io::syscall_operations::syscall_timeout,
+                               basic_io_uring_service&        self,
+                               stl::chrono::nanoseconds const duration,
+                               callback_type                  callback) noexcept -> void {
+            auto req = self.prepare(stl::move(callback));
+            io_uring_prep_timeout(req, self.timespec_of(req, duration), 0, 0);
+        }
+
+        /**
+         * Limit the time of the last queued request (IORING_OP_LINK_TIMEOUT); the request is canceled
+         * (its callback gets ECANCELED) if it's not done in the specified duration.
+         *
+         * @code
+         *   syscall(syscall_recv{}, io, fd, buf, callback);
+         *   syscall(syscall_timeout{}, io, linked, 5s);
+         * @endcode
+         *
+         * @returns false if there's no request to link to (the queued requests are submitted already), or
+         *          the submission queue is full (the timeout should be in the same submission as the
+         *          request).
+         */
+        friend auto tag_invoke(io::syscall_operations::syscall_timeout,
+                               basic_io_uring_service&        self,
+                               io::syscall_operations::linked_tag,
+                               stl::chrono::nanoseconds const duration) noexcept -> bool {
+            if (self.last_sqe == nullptr || io_uring_sq_space_left(&self.ring) == 0) {
+                return false;
+            }
+            self.last_sqe->flags |= IOSQE_IO_LINK;
+            auto req              = self.prepare();
+            io_uring_prep_link_timeout(req, self.timespec_of(req, duration), 0);
+            self.last_sqe = nullptr; // a timeout can't be linked to another timeout
+            return true;
+        }
+
       private:
         [[no_unique_address]] allocator_type alloc;
         io_uring_params                      params{};
         io_uring                             ring{};
         buffer_manager_type                  buf_pack;
-        stl::atomic_bool                     should_stop = false;
+        stl::optional<buffer_id_type>        selected_buf = stl::nullopt; // of the running callback
+        bool                                 more_completions = false;    // of the running callback
+        stl::atomic_bool                     should_stop  = false;
+        io_uring_sqe*                        last_sqe     = nullptr; // queued, not submitted yet
+        stl::vector<__kernel_timespec, timespec_allocator_type> timespecs;
 
         unsigned cqe_count = 0;
 
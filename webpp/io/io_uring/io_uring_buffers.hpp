@@ -3,13 +3,236 @@
 #ifndef WEBPP_IO_URING_BUFFERS_HPP
 #define WEBPP_IO_URING_BUFFERS_HPP
 
+#include "../../libs/ioring.hpp"
 #include "../buffer.hpp"
+#ifdef WEBPP_IO_URING_SUPPORT
+#    include "../../std/optional.hpp"
+
+#    include <algorithm>
+#    include <bit>
+#    include <cerrno>
+#    include <cstdint>
+#    include <memory>
+#    include <unistd.h> // sysconf
+#    include <utility>
 
 namespace webpp::io {
 
+    /**
+     * Registered "Provided Buffer Ring" of an io_uring
+     *
+     * Instead of allocating a buffer for each pending read, a fixed pool of equally-sized buffers is
+     * handed to the kernel once; the reads are submitted with IOSQE_BUFFER_SELECT and the kernel picks
+     * one of the free buffers only when the data is actually there. The id of the chosen buffer comes
+     * back in the CQE's flags and the buffer has to be recycled (given back to the kernel) after the
+     * data is consumed.
+     *
+     * All the memory (the buffers and the ring itself) is allocated through the Allocator; the ring
+     * has to be page-aligned, so a page more than needed is allocated for it.
+     *
+     * Requires Linux 5.19+ (io_uring_register_buf_ring); register_to returns -EINVAL on older kernels.
+     */
     template <typename Allocator = stl::allocator<stl::byte>>
-    struct io_uring_buffer_manager {};
+    struct io_uring_buffer_manager {
+        using allocator_type = typename stl::allocator_traits<Allocator>::template rebind_alloc<stl::byte>;
+        using alloc_traits   = stl::allocator_traits<allocator_type>;
+        using size_type      = stl::size_t;
+        using buffer_id_type = stl::uint16_t;
+        using group_id_type  = stl::uint16_t;
+
+        static constexpr size_type     default_buffer_count = 64;
+        static constexpr size_type     default_buffer_size  = 4096;
+        static constexpr size_type     max_buffer_count     = 32'768; // kernel's limit for a buffer ring
+        static constexpr group_id_type default_group_id     = 0;
+
+        /**
+         * @param count number of the buffers; rounded up to a power of two (a ring requirement)
+         * @param size  size of each buffer
+         * @param group the buffer group id that the reads use to find this pool
+         */
+        explicit io_uring_buffer_manager(size_type             count     = default_buffer_count,
+                                         size_type             size      = default_buffer_size,
+                                         group_id_type         group     = default_group_id,
+                                         allocator_type const& inp_alloc = {})
+          : alloc{inp_alloc},
+            buf_count{stl::bit_ceil(stl::clamp<size_type>(count, 1, max_buffer_count))},
+            buf_size{size},
+            group_id{group} {
+            storage      = alloc_traits::allocate(alloc, storage_size());
+            ring_storage = alloc_traits::allocate(alloc, ring_storage_size());
+
+            // page-aligning the ring
+            void*       ptr   = ring_storage;
+            stl::size_t space = ring_storage_size();
+            ring = static_cast<io_uring_buf_ring*>(stl::align(page_size(), ring_size(), ptr, space));
+            io_uring_buf_ring_init(ring);
+        }
+
+        io_uring_buffer_manager(io_uring_buffer_manager const&)            = delete;
+        io_uring_buffer_manager& operator=(io_uring_buffer_manager const&) = delete;
+
+        // the memory doesn't move, so the kernel's view of the ring stays valid
+        io_uring_buffer_manager(io_uring_buffer_manager&& other) noexcept
+          : alloc{stl::move(other.alloc)},
+            buf_count{other.buf_count},
+            buf_size{other.buf_size},
+            group_id{other.group_id},
+            registered{stl::exchange(other.registered, false)},
+            storage{stl::exchange(other.storage, nullptr)},
+            ring_storage{stl::exchange(other.ring_storage, nullptr)},
+            ring{stl::exchange(other.ring, nullptr)} {}
+
+        io_uring_buffer_manager& operator=(io_uring_buffer_manager&& other) noexcept {
+            if (this != &other) {
+                deallocate();
+                alloc        = stl::move(other.alloc);
+                buf_count    = other.buf_count;
+                buf_size     = other.buf_size;
+                group_id     = other.group_id;
+                registered   = stl::exchange(other.registered, false);
+                storage      = stl::exchange(other.storage, nullptr);
+                ring_storage = stl::exchange(other.ring_storage, nullptr);
+                ring         = stl::exchange(other.ring, nullptr);
+            }
+            return *this;
+        }
+
+        /// The ring should be unregistered (or the io_uring should be destroyed) before this point
+        ~io_uring_buffer_manager() {
+            deallocate();
+        }
+
+        /**
+         * Register the buffers to the specified io_uring, all of them are handed to the kernel.
+         * @returns 0 on success, -errno on failure
+         */
+        [[nodiscard]] int register_to(io_uring& inp_ring) noexcept {
+            if (registered) {
+                return -EBUSY;
+            }
+            io_uring_buf_reg reg{};
+            reg.ring_addr    = reinterpret_cast<stl::uintptr_t>(ring); // NOLINT(*-reinterpret-cast)
+            reg.ring_entries = static_cast<stl::uint32_t>(buf_count);
+            reg.bgid         = group_id;
+            if (int const ret = io_uring_register_buf_ring(&inp_ring, &reg, 0); ret != 0) {
+                return ret;
+            }
+            registered = true;
+            for (size_type bid = 0; bid != buf_count; ++bid) {
+                add(static_cast<buffer_id_type>(bid), static_cast<int>(bid));
+            }
+            io_uring_buf_ring_advance(ring, static_cast<int>(buf_count));
+            return 0;
+        }
+
+        /// Take the buffers back from the kernel; io_uring_queue_exit does this implicitly
+        void unregister_from(io_uring& inp_ring) noexcept {
+            if (registered) {
+                io_uring_unregister_buf_ring(&inp_ring, group_id);
+                registered = false;
+            }
+        }
+
+        /// Give the buffer back to the kernel, so it can be selected for another read
+        void recycle(buffer_id_type bid) noexcept {
+            add(bid, 0);
+            io_uring_buf_ring_advance(ring, 1);
+        }
+
+        /**
+         * Get the buffer id that the kernel has selected for a request
+         * @returns nullopt if no buffer was selected (failed request, or not a buffer-select request)
+         */
+        [[nodiscard]] static constexpr stl::optional<buffer_id_type> selected_id(
+          io_uring_cqe const& cqe) noexcept {
+            if ((cqe.flags & IORING_CQE_F_BUFFER) == 0) {
+                return stl::nullopt;
+            }
+            return static_cast<buffer_id_type>(cqe.flags >> IORING_CQE_BUFFER_SHIFT);
+        }
+
+        [[nodiscard]] buffer_span buffer(buffer_id_type bid) const noexcept {
+            return {storage + (static_cast<size_type>(bid) * buf_size), buf_size};
+        }
+
+        /// The part of the buffer that the kernel has filled
+        [[nodiscard]] buffer_view buffer(buffer_id_type bid, size_type len) const noexcept {
+            return buffer(bid).first(stl::min(len, buf_size));
+        }
+
+        [[nodiscard]] constexpr bool is_registered() const noexcept {
+            return registered;
+        }
+
+        [[nodiscard]] constexpr group_id_type group() const noexcept {
+            return group_id;
+        }
+
+        [[nodiscard]] constexpr size_type buffer_size() const noexcept {
+            return buf_size;
+        }
+
+        [[nodiscard]] constexpr size_type size() const noexcept {
+            return buf_count;
+        }
+
+        [[nodiscard]] constexpr allocator_type const& get_allocator() const noexcept {
+            return alloc;
+        }
+
+      private:
+        [[nodiscard]] static size_type page_size() noexcept {
+            static size_type const size = static_cast<size_type>(::sysconf(_SC_PAGESIZE));
+            return size;
+        }
+
+        [[nodiscard]] constexpr size_type storage_size() const noexcept {
+            return buf_count * buf_size;
+        }
+
+        [[nodiscard]] constexpr size_type ring_size() const noexcept {
+            return buf_count * sizeof(io_uring_buf);
+        }
+
+        [[nodiscard]] size_type ring_storage_size() const noexcept {
+            return ring_size() + page_size();
+        }
+
+        void add(buffer_id_type bid, int offset) noexcept {
+            io_uring_buf_ring_add(ring,
+                                  buffer(bid).data(),
+                                  static_cast<unsigned>(buf_size),
+                                  bid,
+                                  io_uring_buf_ring_mask(static_cast<unsigned>(buf_count)),
+                                  offset);
+        }
+
+        void deallocate() noexcept {
+            if (storage != nullptr) {
+                alloc_traits::deallocate(alloc, storage, storage_size());
+                storage = nullptr;
+            }
+            if (ring_storage != nullptr) {
+                alloc_traits::deallocate(alloc, ring_storage, ring_storage_size());
+                ring_storage = nullptr;
+                ring         = nullptr;
+            }
+        }
+
+        [[no_unique_address]] allocator_type alloc;
+
+        size_type     buf_count;
+        size_type     buf_size;
+        group_id_type group_id;
+        bool          registered = false;
+
+        stl::byte*         storage      = nullptr;
+        stl::byte*         ring_storage = nullptr;
+        io_uring_buf_ring* ring         = nullptr;
+    };
 
 } // namespace webpp::io
 
+#endif // WEBPP_IO_URING_SUPPORT
+
 #endif // WEBPP_IO_URING_BUFFERS_HPP
@@ -43,6 +43,28 @@ namespace webpp::io::inline syscall_operations {
 
     struct syscall_remove {};
 
+    struct syscall_accept {};
+
+    struct syscall_recv {};
+
+    struct syscall_send {};
+
+    struct syscall_openat {};
+
+    struct syscall_statx {};
+
+    struct syscall_timeout {};
+
+    struct syscall_cancel {};
+
+    /// Ask for a multishot operation; one request, many completions (each of them calls the callback)
+    inline constexpr struct multishot_tag {
+    } multishot;
+
+    /// Link the operation to the last queued one; e.g. a timeout that cancels the operation before it
+    inline constexpr struct linked_tag {
+    } linked;
+
 #undef impl_syscall
 
 } // namespace webpp::io::inline syscall_operations
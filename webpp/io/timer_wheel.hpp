@@ -0,0 +1,227 @@
+// Created by moisrex on 10/17/26.
+
+#ifndef WEBPP_IO_TIMER_WHEEL_HPP
+#define WEBPP_IO_TIMER_WHEEL_HPP
+
+#include "../std/std.hpp"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+
+namespace webpp::io {
+
+    /**
+     * A timer that can be put in a timer wheel; the objects that need a deadline (the connections, for
+     * example) derive from this, so scheduling and canceling a deadline doesn't allocate anything.
+     *
+     * The node should not be destroyed or moved while it's scheduled.
+     */
+    struct timer_wheel_node {
+        constexpr timer_wheel_node() noexcept = default;
+
+        // a scheduled node is linked into the wheel
+        timer_wheel_node(timer_wheel_node const&)            = delete;
+        timer_wheel_node(timer_wheel_node&&)                 = delete;
+        timer_wheel_node& operator=(timer_wheel_node const&) = delete;
+        timer_wheel_node& operator=(timer_wheel_node&&)      = delete;
+
+        constexpr ~timer_wheel_node() noexcept = default;
+
+        [[nodiscard]] constexpr bool is_scheduled() const noexcept {
+            return next != nullptr;
+        }
+
+      private:
+        template <stl::size_t, stl::size_t>
+        friend struct basic_timer_wheel;
+
+        timer_wheel_node* prev   = nullptr;
+        timer_wheel_node* next   = nullptr;
+        stl::uint64_t     expiry = 0;
+    };
+
+    /**
+     * Hierarchical Timer Wheel
+     *
+     * Schedules any number of deadlines on a single clock; scheduling, canceling, and re-scheduling a
+     * timer are O(1), and each tick only touches the timers that expire in it (plus the timers that move
+     * down a level, once per level). This lets an event loop put the deadlines of all of its connections
+     * on one kernel timeout that fires once per tick, instead of having a timer per connection.
+     *
+     * Each level has 2^SlotBits slots, a slot of level N is 2^(SlotBits * N) ticks wide; the timers are
+     * put in the level of the highest digit (in base 2^SlotBits) that their expiry differs from the
+     * current tick, and they move down to the lower levels when the current tick gets to their slot.
+     * The timers that are further than 2^(SlotBits * Levels) - 1 ticks away are clamped to that.
+     *
+     * The wheel doesn't know how long a tick is, the owner advances it.
+     */
+    template <stl::size_t Levels = 4, stl::size_t SlotBits = 6>
+    struct basic_timer_wheel {
+        static_assert(Levels > 0 && SlotBits > 0 && Levels * SlotBits < 64, "Invalid timer wheel size.");
+
+        using tick_type = stl::uint64_t;
+        using node_type = timer_wheel_node;
+
+        static constexpr stl::size_t levels     = Levels;
+        static constexpr stl::size_t slot_bits  = SlotBits;
+        static constexpr stl::size_t slot_count = stl::size_t{1} << slot_bits;
+        static constexpr tick_type   slot_mask  = slot_count - 1;
+        static constexpr tick_type   max_ticks  = (tick_type{1} << (slot_bits * levels)) - 1;
+
+        constexpr basic_timer_wheel() noexcept {
+            for (auto& level : slots) {
+                for (auto& slot : level) {
+                    slot.prev = &slot;
+                    slot.next = &slot;
+                }
+            }
+        }
+
+        // the slots are linked to themselves
+        basic_timer_wheel(basic_timer_wheel const&)            = delete;
+        basic_timer_wheel(basic_timer_wheel&&)                 = delete;
+        basic_timer_wheel& operator=(basic_timer_wheel const&) = delete;
+        basic_timer_wheel& operator=(basic_timer_wheel&&)      = delete;
+
+        constexpr ~basic_timer_wheel() noexcept {
+            clear();
+        }
+
+        /// The current tick; the number of the ticks that the wheel has been advanced
+        [[nodiscard]] constexpr tick_type now() const noexcept {
+            return current;
+        }
+
+        /// Number of the scheduled timers
+        [[nodiscard]] constexpr stl::size_t size() const noexcept {
+            return count;
+        }
+
+        [[nodiscard]] constexpr bool empty() const noexcept {
+            return count == 0;
+        }
+
+        /**
+         * Schedule the timer to expire after the specified number of ticks (at least one); the timer is
+         * re-scheduled if it's already scheduled.
+         */
+        constexpr void schedule(node_type& node, tick_type const ticks) noexcept {
+            cancel(node);
+            node.expiry = current + stl::clamp<tick_type>(ticks, 1, max_ticks);
+            insert(node);
+            ++count;
+        }
+
+        /// Cancel the timer if it's scheduled
+        constexpr void cancel(node_type& node) noexcept {
+            if (!node.is_scheduled()) {
+                return;
+            }
+            unlink(node);
+            --count;
+        }
+
+        /// Cancel all the timers
+        constexpr void clear() noexcept {
+            for (auto& level : slots) {
+                for (auto& slot : level) {
+                    while (slot.next != &slot) {
+                        unlink(*slot.next);
+                    }
+                }
+            }
+            count = 0;
+        }
+
+        /**
+         * Move the clock forward, and call the callback with each timer that expires; the timers are
+         * canceled before the callback is called, so they can be re-scheduled inside the callback.
+         *
+         * @returns the number of the expired timers
+         */
+        template <typename Callable>
+            requires(stl::is_invocable_v<Callable, node_type&>)
+        constexpr stl::size_t advance(tick_type ticks, Callable&& on_expire) {
+            stl::size_t expired = 0;
+            for (; ticks != 0; --ticks) {
+                if (count == 0) {
+                    current += ticks; // nothing to expire, or to move down a level
+                    break;
+                }
+                ++current;
+                cascade();
+
+                // everything in the current slot of the first level expires now
+                node_type& slot = slots[0][current & slot_mask];
+                while (slot.next != &slot) {
+                    node_type& node = *slot.next;
+                    unlink(node);
+                    --count;
+                    ++expired;
+                    stl::invoke(on_expire, node);
+                }
+            }
+            return expired;
+        }
+
+      private:
+        [[nodiscard]] static constexpr tick_type digit(tick_type const   value,
+                                                       stl::size_t const level) noexcept {
+            return (value >> (level * slot_bits)) & slot_mask;
+        }
+
+        // the level of the highest digit that the expiry is different from the current tick
+        [[nodiscard]] constexpr stl::size_t level_of(tick_type const expiry) const noexcept {
+            stl::size_t level = levels - 1;
+            while (level != 0 && (expiry >> (level * slot_bits)) == (current >> (level * slot_bits))) {
+                --level;
+            }
+            return level;
+        }
+
+        constexpr void insert(node_type& node) noexcept {
+            auto const level = level_of(node.expiry);
+            node_type& slot  = slots[level][digit(node.expiry, level)];
+            node.prev        = slot.prev;
+            node.next        = &slot;
+            slot.prev->next  = &node;
+            slot.prev        = &node;
+        }
+
+        static constexpr void unlink(node_type& node) noexcept {
+            node.prev->next = node.next;
+            node.next->prev = node.prev;
+            node.prev       = nullptr;
+            node.next       = nullptr;
+        }
+
+        // move the timers of the slots that the current tick has just got to, to the lower levels
+        constexpr void cascade() noexcept {
+            // the highest level whose lower digits are all zero; it and the levels below it have just
+            // moved to a new slot
+            stl::size_t top = 0;
+            while (top + 1 < levels && digit(current, top) == 0) {
+                ++top;
+            }
+            for (stl::size_t level = top; level != 0; --level) {
+                node_type& slot = slots[level][digit(current, level)];
+                while (slot.next != &slot) {
+                    node_type& node = *slot.next;
+                    unlink(node);
+                    insert(node);
+                }
+            }
+        }
+
+        stl::array<stl::array<node_type, slot_count>, levels> slots{};
+        tick_type                                             current = 0;
+        stl::size_t                                           count   = 0;
+    };
+
+    using timer_wheel = basic_timer_wheel<>;
+
+} // namespace webpp::io
+
+#endif // WEBPP_IO_TIMER_WHEEL_HPP
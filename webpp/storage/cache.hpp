@@ -79,11 +79,12 @@ namespace webpp {
             return cache_result_type{*this, key, get(key)};
         }
 
-        template <CacheKey K, CacheValue V>
+        // the strategy may accept more arguments; the TTL of the expiring strategy, for example
+        template <CacheKey K, CacheValue V, typename... Args>
             requires(stl::convertible_to<stl::remove_cvref_t<K>, key_type> && // it's a key
                      stl::convertible_to<stl::remove_cvref_t<V>, value_type>) // it's a value
-        constexpr cache& set(K&& key, V&& value) {
-            strategy_type::set(stl::forward<K>(key), stl::forward<V>(value));
+        constexpr cache& set(K&& key, V&& value, Args&&... args) {
+            strategy_type::set(stl::forward<K>(key), stl::forward<V>(value), stl::forward<Args>(args)...);
             return *this;
         }
 
@@ -100,11 +101,11 @@ namespace webpp {
         }
 
         // Get a reference to the values, the life-time of the returned value becomes the problem in parallel
-        // algorithms
+        // algorithms; the strategy decides the type of the pointer (the concurrent ones lock the value)
         template <CacheKey K>
             requires(
               details::CacheStrategyPointerSupport<strategy_type> && stl::is_convertible_v<K, key_type>)
-        constexpr auto* get_ptr(K&& key) {
+        constexpr auto get_ptr(K&& key) {
             return strategy_type::get_ptr(stl::forward<K>(key));
         }
 
@@ -135,8 +136,8 @@ namespace webpp {
          */
         template <CacheKey K, typename... Args>
             requires(stl::is_convertible_v<K, key_type>) // it's convertible to key
-        constexpr auto* emplace_get_ptr(K&& key, Args&&... args) {
-            if (auto* val = get_ptr(key); val) {
+        constexpr auto emplace_get_ptr(K&& key, Args&&... args) {
+            if (auto val = get_ptr(key); val) {
                 return val;
             }
             if constexpr (sizeof...(Args) == 1 &&
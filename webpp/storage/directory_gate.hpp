@@ -164,7 +164,10 @@ namespace webpp {
             string_type serialize_opts(options_type const& opts) {
                 auto opts_str = lexical::cast<traits::string<traits_type>>(opts, *this);
                 if (gate_opts.encode_options) {
-                    base64::encode(opts_str, opts_str);
+                    // the encoder can't write to its own input
+                    string_type encoded_opts = object::make_object<string_type>(*this);
+                    base64::encode(opts_str, encoded_opts);
+                    return encoded_opts;
                 }
                 return opts_str;
             }
@@ -416,7 +419,7 @@ namespace webpp {
                 if (err) {
                     this->logger.error(
                       DIR_GATE_CAT,
-                      fmt::format("Cannot remove cache file {} (key name: {})", key_file, key),
+                      fmt::format("Cannot remove cache file {} (key name: {})", key_file.string(), key),
                       err);
                     return false;
                 }
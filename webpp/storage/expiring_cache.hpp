@@ -0,0 +1,237 @@
+#ifndef WEBPP_STORAGE_EXPIRING_CACHE_HPP
+#define WEBPP_STORAGE_EXPIRING_CACHE_HPP
+
+#include "../io/timer_wheel.hpp"
+#include "../std/chrono.hpp"
+#include "../std/unordered_map.hpp"
+#include "cache.hpp"
+#include "directory_gate.hpp"
+#include "memory_gate.hpp"
+
+#include <cstdint>
+
+namespace webpp {
+
+    /**
+     * Expiring Cache (Time-To-Live Cache)
+     *
+     * Each value is kept for a while (its TTL) and then it's dropped; the time that it expires is stored in
+     * the "options" of the storage gate (milliseconds since the epoch of the clock), so a persistent gate
+     * (directory_gate) keeps the expiry times too, and the values that it has from before are expired
+     * correctly.
+     *
+     * The expired values are dropped in two ways:
+     *   - lazily, when they're accessed: "get" checks the expiry time that the gate returns
+     *   - by "sweep": the keys are scheduled in a hierarchical timer wheel (see io::timer_wheel), so the
+     *     sweep only touches the keys that expire, instead of scanning all of them (erase_if). "set" sweeps
+     *     too; call "sweep" periodically (from the event loop, for example) if the cache isn't set often.
+     *
+     * "TickType" is the resolution of the timer wheel, the values may live up to one tick longer than their
+     * TTL in the gate, but they're never returned after they've expired.
+     */
+    template <typename ClockType = stl::chrono::system_clock, typename TickType = stl::chrono::seconds>
+    struct expiring_strategy {
+        template <Traits TraitsType, CacheKey KeyT, CacheValue ValueT, StorageGate SG>
+        struct strategy {
+            using traits_type   = TraitsType;
+            using key_type      = KeyT;
+            using value_type    = ValueT;
+            using clock_type    = ClockType;
+            using tick_duration = TickType;
+            using time_point    = typename clock_type::time_point;
+            using duration      = stl::chrono::milliseconds;
+            using expiry_type   = stl::int64_t; // milliseconds since the epoch of the clock
+            using storage_gate_type =
+              typename SG::template storage_gate<traits_type, key_type, value_type, expiry_type>;
+            using bundle_type      = typename storage_gate_type::bundle_type;
+            using timer_wheel_type = io::timer_wheel;
+            using tick_type        = typename timer_wheel_type::tick_type;
+
+            static constexpr duration default_ttl{stl::chrono::minutes{5}};
+
+          private:
+            // a key in the timer wheel
+            struct entry : io::timer_wheel_node {
+                key_type const* key    = nullptr; // the key of the index that holds this entry
+                expiry_type     expiry = 0;
+            };
+
+            using index_allocator_type =
+              traits::allocator_type_of<traits_type, stl::pair<key_type const, entry>>;
+            using index_type = stl::unordered_map<key_type,
+                                                  entry,
+                                                  stl::hash<key_type>,
+                                                  stl::equal_to<key_type>,
+                                                  index_allocator_type>;
+
+            duration          ttl;
+            time_point        start = clock_type::now(); // the time of the first tick of the wheel
+            index_type        index;
+            timer_wheel_type  wheel;
+            storage_gate_type gate;
+
+          protected:
+            constexpr storage_gate_type& get_gate() noexcept {
+                return gate;
+            }
+
+          private:
+            [[nodiscard]] static constexpr expiry_type to_expiry(time_point const point) noexcept {
+                return stl::chrono::duration_cast<duration>(point.time_since_epoch()).count();
+            }
+
+            // the tick of the wheel that the time is in
+            [[nodiscard]] constexpr tick_type tick_of(expiry_type const expiry) const noexcept {
+                auto const since_start = duration{expiry} - duration{to_expiry(start)};
+                if (since_start.count() <= 0) {
+                    return 0;
+                }
+                return static_cast<tick_type>(stl::chrono::duration_cast<tick_duration>(since_start).count());
+            }
+
+            // the wheel may have clamped it, or the key is set again; it's checked again when it fires
+            constexpr void schedule(entry& item) noexcept {
+                auto const fire_at = tick_of(item.expiry) + 1; // the tick after the one that it expires in
+                wheel.schedule(item, fire_at > wheel.now() ? fire_at - wheel.now() : 1);
+            }
+
+            template <typename K>
+            constexpr void track(K const& key, expiry_type const expiry) {
+                auto const pos     = index.try_emplace(key_type{key}).first;
+                pos->second.key    = &pos->first;
+                pos->second.expiry = expiry;
+                schedule(pos->second);
+            }
+
+            template <typename K>
+            constexpr void drop(K const& key) {
+                if (auto const pos = index.find(key); pos != index.end()) {
+                    wheel.cancel(pos->second);
+                    index.erase(pos);
+                }
+                gate.erase(key);
+            }
+
+            // drop the key if it's expired, returns true if it's dropped
+            template <typename K>
+            constexpr bool drop_expired(K const& key, expiry_type const expiry, expiry_type const now) {
+                if (expiry > now) {
+                    if (!index.contains(key)) {
+                        track(key, expiry); // the gate had it before this cache
+                    }
+                    return false;
+                }
+                drop(key);
+                return true;
+            }
+
+          public:
+            template <EnabledTraits ET, typename... Args>
+                requires(EnabledTraits<ET> && !stl::same_as<stl::remove_cvref_t<ET>, strategy>)
+            explicit constexpr strategy(ET&& etraits, duration const ttl_value = default_ttl, Args&&... args)
+              : ttl{ttl_value},
+                index{get_alloc_for<index_type>(etraits)},
+                gate{stl::forward<ET>(etraits), stl::forward<Args>(args)...} {}
+
+            // the entries are linked into the wheel
+            strategy(strategy const&)                = delete;
+            strategy(strategy&&) noexcept            = delete;
+            strategy& operator=(strategy const&)     = delete;
+            strategy& operator=(strategy&&) noexcept = delete;
+            constexpr ~strategy()                    = default;
+
+            /// Set the value, it expires after the default TTL
+            template <typename K, typename V>
+                requires(stl::convertible_to<K, key_type> && // it's a key
+                         stl::convertible_to<V, value_type>) // it's a value
+            constexpr void set(K&& key, V&& value) {
+                set(stl::forward<K>(key), stl::forward<V>(value), ttl);
+            }
+
+            /// Set the value, it expires after the specified TTL
+            template <typename K, typename V, typename Rep, typename Period>
+                requires(stl::convertible_to<K, key_type> && // it's a key
+                         stl::convertible_to<V, value_type>) // it's a value
+            constexpr void set(K&& key, V&& value, stl::chrono::duration<Rep, Period> const key_ttl) {
+                auto const now    = clock_type::now();
+                auto const expiry = to_expiry(now) + stl::chrono::duration_cast<duration>(key_ttl).count();
+                sweep(now);
+                track(key, expiry);
+                gate.set(stl::forward<K>(key), stl::forward<V>(value), expiry);
+            }
+
+            template <typename K>
+                requires(stl::convertible_to<K, key_type>) // it's a key
+            constexpr stl::optional<value_type> get(K&& key) {
+                stl::optional<bundle_type> data = gate.get(key);
+                if (!data) {
+                    if (auto const pos = index.find(key); pos != index.end()) {
+                        wheel.cancel(pos->second);
+                        index.erase(pos);
+                    }
+                    return stl::nullopt;
+                }
+                if (drop_expired(key, data->options, to_expiry(clock_type::now()))) {
+                    return stl::nullopt;
+                }
+                return stl::move(data->value);
+            }
+
+            template <typename K>
+                requires(
+                  details::StorageGatePointerSupport<storage_gate_type> && stl::convertible_to<K, key_type>)
+            constexpr auto* get_ptr(K&& key) {
+                using return_type = typename storage_gate_type::value_ptr_type;
+                auto const data   = gate.get_ptr(key);
+                if (!data || drop_expired(key, *data->options, to_expiry(clock_type::now()))) {
+                    return return_type{nullptr};
+                }
+                return return_type{data->value};
+            }
+
+            template <typename K>
+                requires(stl::convertible_to<K, key_type>) // it's a key
+            constexpr void erase(K&& key) {
+                drop(key);
+            }
+
+            /**
+             * Drop the keys that have expired up to the specified time
+             * @returns the number of the dropped keys
+             */
+            constexpr stl::size_t sweep(time_point const now = clock_type::now()) {
+                auto const now_expiry = to_expiry(now);
+                auto const now_tick   = tick_of(now_expiry);
+                if (now_tick <= wheel.now()) {
+                    return 0;
+                }
+                stl::size_t dropped = 0;
+                wheel.advance(now_tick - wheel.now(), [&](io::timer_wheel_node& node) {
+                    auto& item = static_cast<entry&>(node);
+                    if (item.expiry > now_expiry) {
+                        schedule(item); // it was further than the wheel could hold
+                        return;
+                    }
+                    gate.erase(*item.key);
+                    index.erase(index.find(*item.key));
+                    ++dropped;
+                });
+                return dropped;
+            }
+
+            /// Number of the keys that are in the cache (including the expired ones that are not swept yet)
+            [[nodiscard]] constexpr stl::size_t size() const noexcept {
+                return index.size();
+            }
+        };
+    };
+
+    template <Traits      TraitsType   = default_traits,
+              CacheKey    KeyT         = traits::string<TraitsType>,
+              CacheValue  ValT         = traits::string<TraitsType>,
+              StorageGate StorageGateT = memory_gate<directory_gate>>
+    using expiring_cache = cache<TraitsType, KeyT, ValT, expiring_strategy<>, StorageGateT>;
+
+} // namespace webpp
+
+#endif // WEBPP_STORAGE_EXPIRING_CACHE_HPP
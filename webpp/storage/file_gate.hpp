@@ -1,56 +1,578 @@
 #ifndef WEBPP_STORAGE_FILE_GATE_HPP
 #define WEBPP_STORAGE_FILE_GATE_HPP
 
+#include "../convert/lexical_cast.hpp"
+#include "../memory/object.hpp"
+#include "../std/algorithm.hpp"
+#include "../std/string.hpp"
+#include "../std/string_view.hpp"
+#include "../std/unordered_map.hpp"
 #include "../traits/default_traits.hpp"
+#include "../traits/enable_traits.hpp"
 #include "cache_concepts.hpp"
 
+#include <cerrno>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
 #include <filesystem>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <system_error>
+#include <unistd.h>
 
 namespace webpp {
 
     /**
      * File Gate stores the cached data in a file
      *
+     * The file is an append-only log of records; setting a value appends a record of it, and erasing a key
+     * appends a record that says it's erased. An index in memory holds the position of the last record of
+     * each key, and the file is memory-mapped, so getting a value doesn't need any system calls, and the
+     * value can be viewed without copying it (see "view").
+     *
+     * On construction, the log is replayed to build the index, so the cache is warm after a restart; a
+     * record that is not written completely (because of a crash) is detected by its checksum, and the log
+     * is truncated to the last complete record.
+     *
+     * The records that are not in the index anymore are garbage; when they're bigger than the live records
+     * (and bigger than "min_garbage"), the live records are copied to a new file which replaces the old one
+     * (compaction). It runs as a part of "set" and "erase" (its cost is amortized over the writes that
+     * made the garbage), or call "compact" yourself when it suits you (when the server is idle, for
+     * example).
+     *
+     * The records are in the native byte order, the files are not portable between architectures.
+     *
      * The file gate doesn't support a parent because why should it?
      */
     struct file_gate {
+        static constexpr stl::string_view FILE_GATE_CAT = "FileGate";
+
+        struct gate_options {
+            stl::size_t min_garbage  = 1024UL * 1024UL; // don't compact the file before this much garbage
+            bool        auto_compact = true;
+        };
+
         template <Traits TraitsType, CacheFileKey KeyT, CacheFileValue ValueT, CacheFileOptions OptsT>
-        struct storage_gate {
-            using key_type     = KeyT;
-            using value_type   = ValueT;
-            using options_type = OptsT;
-            using traits_type  = TraitsType;
-            using path_type    = stl::filesystem::path;
-            using bundle_type  = cache_tuple<key_type, value_type, options_type>;
+        struct storage_gate : enable_traits<TraitsType> {
+            using key_type         = KeyT;
+            using value_type       = ValueT;
+            using options_type     = OptsT;
+            using traits_type      = TraitsType;
+            using etraits_type     = enable_traits<TraitsType>;
+            using path_type        = stl::filesystem::path;
+            using bundle_type      = cache_tuple<key_type, value_type, options_type>;
+            using string_type      = traits::string<traits_type>;
+            using string_view_type = traits::string_view<traits_type>;
+
+            static constexpr stl::string_view file_magic = "webppfg1"; // the first bytes of the file
 
           private:
-            path_type cache_file;
+            enum struct record_kind : stl::uint8_t { set = 1, erase = 2 };
+
+            // it's followed by the key, the options, and the value
+            struct record_header {
+                stl::uint32_t checksum = 0; // of everything after this field, up to the end of the record
+                record_kind   kind     = record_kind::set;
+                stl::uint8_t  reserved[3]{};
+                stl::uint32_t key_size     = 0;
+                stl::uint32_t options_size = 0;
+                stl::uint32_t value_size   = 0;
+
+                [[nodiscard]] constexpr stl::size_t size() const noexcept {
+                    return sizeof(record_header) + key_size + options_size + value_size;
+                }
+            };
+
+            using index_allocator_type =
+              traits::allocator_type_of<traits_type, stl::pair<key_type const, stl::size_t>>;
+            using index_type = stl::unordered_map<key_type,
+                                                  stl::size_t, // the position of the record in the file
+                                                  stl::hash<key_type>,
+                                                  stl::equal_to<key_type>,
+                                                  index_allocator_type>;
+
+            static constexpr stl::size_t min_map_size = 64UL * 1024UL;
+
+            path_type    cache_file;
+            gate_options gate_opts{};
+            index_type   index;
+            int          fd         = -1;
+            char const*  mapped     = nullptr;
+            stl::size_t  map_size   = 0; // may be larger than the file
+            stl::size_t  file_size  = 0;
+            stl::size_t  live_bytes = 0;     // the size of the records that are in the index
+            bool         temporary  = false; // the file's directory is removed when the gate is destroyed
+
+            // FNV-1a
+            [[nodiscard]] static constexpr stl::uint32_t checksum_of(char const*       data,
+                                                                     stl::size_t const size) noexcept {
+                stl::uint32_t hash = 2'166'136'261U;
+                for (stl::size_t index = 0; index != size; ++index) {
+                    hash ^= static_cast<unsigned char>(data[index]);
+                    hash *= 16'777'619U;
+                }
+                return hash;
+            }
+
+            void log_errno(stl::string_view const msg) {
+                this->logger.error(FILE_GATE_CAT, msg, stl::error_code{errno, stl::system_category()});
+            }
+
+            [[nodiscard]] record_header header_at(stl::size_t const pos) const noexcept {
+                record_header header;
+                stl::memcpy(&header, mapped + pos, sizeof(record_header));
+                return header;
+            }
+
+            [[nodiscard]] string_view_type key_at(stl::size_t const pos, record_header const& header) const {
+                return {mapped + pos + sizeof(record_header), header.key_size};
+            }
+
+            [[nodiscard]] string_view_type options_at(stl::size_t const    pos,
+                                                      record_header const& header) const {
+                return {mapped + pos + sizeof(record_header) + header.key_size, header.options_size};
+            }
+
+            [[nodiscard]] string_view_type value_at(stl::size_t const    pos,
+                                                    record_header const& header) const {
+                return {mapped + pos + sizeof(record_header) + header.key_size + header.options_size,
+                        header.value_size};
+            }
+
+            void unmap() noexcept {
+                if (mapped != nullptr) {
+                    ::munmap(const_cast<char*>(mapped), map_size); // NOLINT(*-const-cast)
+                    mapped   = nullptr;
+                    map_size = 0;
+                }
+            }
+
+            // the mapping covers the whole file; it's larger than the file, so it's not re-mapped on
+            // every append
+            bool map_file() {
+                if (file_size <= map_size) {
+                    return true;
+                }
+                auto const page = static_cast<stl::size_t>(::sysconf(_SC_PAGESIZE));
+                auto       size = stl::max({file_size, map_size * 2, min_map_size});
+                size            = (size + page - 1) / page * page;
+                unmap();
+                void* const ptr = ::mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+                if (ptr == MAP_FAILED) {
+                    log_errno("Cannot map the cache file.");
+                    return false;
+                }
+                mapped   = static_cast<char const*>(ptr);
+                map_size = size;
+                return true;
+            }
+
+            bool write_all(int const out_fd, char const* data, stl::size_t size) {
+                while (size != 0) {
+                    auto const written = ::write(out_fd, data, size);
+                    if (written < 0) {
+                        if (errno == EINTR) {
+                            continue;
+                        }
+                        log_errno("Cannot write to the cache file.");
+                        return false;
+                    }
+                    data += written;
+                    size -= static_cast<stl::size_t>(written);
+                }
+                return true;
+            }
+
+            // open (or create) the file, and replay the log
+            void open_file() {
+                if (fd < 0) {
+                    fd = ::open(cache_file.c_str(), O_RDWR | O_CREAT | O_APPEND | O_CLOEXEC, 0644); // NOLINT
+                }
+                if (fd < 0) {
+                    log_errno("Cannot open the cache file.");
+                    return;
+                }
+                struct stat info {};
+                if (::fstat(fd, &info) != 0) {
+                    log_errno("Cannot get the size of the cache file.");
+                    return;
+                }
+                file_size = static_cast<stl::size_t>(info.st_size);
+                if (file_size != 0 && map_file() &&
+                    string_view_type{mapped, stl::min(file_size, file_magic.size())} == file_magic)
+                {
+                    replay();
+                    return;
+                }
+                if (file_size != 0) {
+                    this->logger.error(FILE_GATE_CAT, "The file is not a cache file, it's cleared.");
+                }
+                reset_file();
+            }
+
+            // the file has only the magic
+            void reset_file() {
+                index.clear();
+                live_bytes = 0;
+                file_size  = 0;
+                if (::ftruncate(fd, 0) != 0) {
+                    log_errno("Cannot truncate the cache file.");
+                    return;
+                }
+                if (write_all(fd, file_magic.data(), file_magic.size())) {
+                    file_size = file_magic.size();
+                }
+            }
+
+            // build the index from the records; the ones after the first broken record are dropped
+            void replay() {
+                auto pos = file_magic.size();
+                while (file_size - pos >= sizeof(record_header)) {
+                    auto const header = header_at(pos);
+                    auto const size   = header.size();
+                    if (size > file_size - pos ||
+                        checksum_of(mapped + pos + sizeof(stl::uint32_t), size - sizeof(stl::uint32_t)) !=
+                          header.checksum)
+                    {
+                        break;
+                    }
+                    auto const key = lexical::cast<key_type>(key_at(pos, header), *this);
+                    if (auto const old = index.find(key); old != index.end()) {
+                        live_bytes -= header_at(old->second).size();
+                        index.erase(old);
+                    }
+                    if (header.kind == record_kind::set) {
+                        index.emplace(key, pos);
+                        live_bytes += size;
+                    }
+                    pos += size;
+                }
+                if (pos != file_size) {
+                    this->logger.error(FILE_GATE_CAT,
+                                       "The cache file has an incomplete record at the end, it's dropped.");
+                    if (::ftruncate(fd, static_cast<off_t>(pos)) != 0) {
+                        log_errno("Cannot truncate the cache file.");
+                    }
+                    file_size = pos;
+                }
+            }
+
+            // append a record, returns its position (or npos if it's not written)
+            stl::size_t append(record_kind const      kind,
+                               string_view_type const key_str,
+                               string_view_type const opts_str,
+                               string_view_type const value_str) {
+                static constexpr auto npos = string_view_type::npos;
+                if (fd < 0) {
+                    return npos;
+                }
+                record_header header{.kind         = kind,
+                                     .key_size     = static_cast<stl::uint32_t>(key_str.size()),
+                                     .options_size = static_cast<stl::uint32_t>(opts_str.size()),
+                                     .value_size   = static_cast<stl::uint32_t>(value_str.size())};
+                auto record = object::make_object<string_type>(*this);
+                record.resize(sizeof(record_header));
+                record.append(key_str);
+                record.append(opts_str);
+                record.append(value_str);
+                stl::memcpy(record.data(), &header, sizeof(record_header));
+                header.checksum = checksum_of(record.data() + sizeof(stl::uint32_t),
+                                              record.size() - sizeof(stl::uint32_t));
+                stl::memcpy(record.data(), &header.checksum, sizeof(stl::uint32_t));
+
+                // one write, so a crash leaves at most one incomplete record at the end
+                if (!write_all(fd, record.data(), record.size())) {
+                    // drop what's written of it, or the next records would come after a broken one
+                    if (::ftruncate(fd, static_cast<off_t>(file_size)) != 0) {
+                        log_errno("Cannot truncate the cache file.");
+                    }
+                    return npos;
+                }
+                auto const pos  = file_size;
+                file_size      += record.size();
+                if (!map_file()) {
+                    return npos;
+                }
+                return pos;
+            }
+
+            // the index doesn't point to this key anymore
+            template <typename K>
+            void unindex(K const& key) {
+                if (auto const pos = index.find(key); pos != index.end()) {
+                    live_bytes -= header_at(pos->second).size();
+                    index.erase(pos);
+                }
+            }
+
+            // append the erase record, and drop the key from the index; it doesn't compact the file
+            template <typename K>
+            bool erase_record(K const& key) {
+                auto const key_str = lexical::cast<string_type>(key, *this);
+                if (append(record_kind::erase, key_str, {}, {}) == string_view_type::npos) {
+                    return false;
+                }
+                unindex(key);
+                return true;
+            }
+
+            void maybe_compact() {
+                auto const garbage = file_size - file_magic.size() - live_bytes;
+                if (gate_opts.auto_compact && garbage > gate_opts.min_garbage && garbage > live_bytes) {
+                    compact();
+                }
+            }
+
+            /**
+             * Create the file in a new directory that only this process can get into; the file that the
+             * compaction creates goes next to it, so nothing in the shared temp directory can be
+             * swapped with a link between checking and opening it.
+             */
+            void create_temp_file() {
+                stl::error_code err;
+                auto            dir  = stl::filesystem::temp_directory_path(err);
+                dir                 /= "webpp-file-gate-XXXXXX";
+                auto dir_name        = dir.native();
+                if (::mkdtemp(dir_name.data()) == nullptr) {
+                    log_errno("Cannot create a directory for the temporary cache file.");
+                    return;
+                }
+                temporary  = true;
+                cache_file = path_type{dir_name} / "cache";
+                fd         = ::open(cache_file.c_str(),
+                                O_RDWR | O_CREAT | O_EXCL | O_APPEND | O_CLOEXEC, // NOLINT
+                                0600);                                            // NOLINT
+                if (fd < 0) {
+                    log_errno("Cannot create the temporary cache file.");
+                }
+            }
 
           public:
-            explicit storage_gate(path_type output_file) : cache_file{stl::move(output_file)} {}
+            // NOLINTBEGIN(bugprone-forwarding-reference-overload)
+            template <EnabledTraits ET>
+                requires(!stl::same_as<stl::remove_cvref_t<ET>, storage_gate>)
+            storage_gate(ET&& etraits, path_type file, gate_options input_opts = {})
+              : etraits_type{etraits},
+                cache_file{stl::move(file)},
+                gate_opts{input_opts},
+                index{get_alloc_for<index_type>(etraits)} {
+                if (cache_file.empty()) {
+                    create_temp_file();
+                }
+                open_file();
+            }
+
+            template <EnabledTraits ET>
+                requires(!stl::same_as<stl::remove_cvref_t<ET>, storage_gate>)
+            explicit storage_gate(ET&& etraits) : storage_gate{etraits, path_type{}} {}
+
+            // NOLINTEND(bugprone-forwarding-reference-overload)
+
+            storage_gate(storage_gate&& other) noexcept
+              : etraits_type{stl::move(other)},
+                cache_file{stl::move(other.cache_file)},
+                gate_opts{other.gate_opts},
+                index{stl::move(other.index)},
+                fd{stl::exchange(other.fd, -1)},
+                mapped{stl::exchange(other.mapped, nullptr)},
+                map_size{stl::exchange(other.map_size, 0)},
+                file_size{stl::exchange(other.file_size, 0)},
+                live_bytes{stl::exchange(other.live_bytes, 0)},
+                temporary{stl::exchange(other.temporary, false)} {}
+
+            storage_gate(storage_gate const&)            = delete;
+            storage_gate& operator=(storage_gate const&) = delete;
+            storage_gate& operator=(storage_gate&&)      = delete;
 
-            template <typename V>
-            stl::optional<bundle_type> get(V&& value) {
-                return stl::nullopt;
+            ~storage_gate() {
+                unmap();
+                if (fd >= 0) {
+                    ::close(fd);
+                }
+                if (temporary) {
+                    stl::error_code err;
+                    stl::filesystem::remove_all(cache_file.parent_path(), err);
+                }
+            }
+
+            [[nodiscard]] path_type const& path() const noexcept {
+                return cache_file;
+            }
+
+            // check if the specified key exists
+            template <typename K>
+            [[nodiscard]] bool has(K const& key) const {
+                return index.contains(key);
+            }
+
+            template <typename K>
+            stl::optional<bundle_type> get(K const& key) {
+                auto const pos = index.find(key);
+                if (pos == index.end()) {
+                    return stl::nullopt;
+                }
+                auto const header    = header_at(pos->second);
+                auto const value_str = value_at(pos->second, header);
+                auto const opts_str  = options_at(pos->second, header);
+                return bundle_type{.key     = pos->first,
+                                   .value   = lexical::cast<value_type>(value_str, *this),
+                                   .options = lexical::cast<options_type>(opts_str, *this)};
+            }
+
+            /**
+             * View the serialized value in the mapped file, without copying it; the view is valid until the
+             * next time something is set or erased.
+             */
+            template <typename K>
+            [[nodiscard]] stl::optional<string_view_type> view(K const& key) const {
+                auto const pos = index.find(key);
+                if (pos == index.end()) {
+                    return stl::nullopt;
+                }
+                return value_at(pos->second, header_at(pos->second));
             }
 
             template <typename K, typename V>
             void set(K&& key, V&& value, options_type opts = {}) {
-                // todo
+                auto const key_str   = lexical::cast<string_type>(key, *this);
+                auto const opts_str  = lexical::cast<string_type>(opts, *this);
+                auto const value_str = lexical::cast<string_type>(value, *this);
+                auto const pos       = append(record_kind::set, key_str, opts_str, value_str);
+                if (pos == string_view_type::npos) {
+                    return;
+                }
+                unindex(key);
+                index.emplace(key_type{stl::forward<K>(key)}, pos);
+                live_bytes += file_size - pos;
+                maybe_compact();
             }
 
             void set_options(key_type const& key, options_type opts) {
-                // todo
+                if (auto const pos = index.find(key); pos != index.end()) {
+                    // the record is copied before the file is re-mapped, so the views are valid in "append"
+                    auto const header   = header_at(pos->second);
+                    auto const opts_str = lexical::cast<string_type>(opts, *this);
+                    auto const new_pos  = append(record_kind::set,
+                                                key_at(pos->second, header),
+                                                opts_str,
+                                                value_at(pos->second, header));
+                    if (new_pos == string_view_type::npos) {
+                        return;
+                    }
+                    live_bytes -= header.size();
+                    live_bytes += file_size - new_pos;
+                    pos->second = new_pos;
+                    maybe_compact();
+                }
             }
 
             template <typename K>
-            void erase(K&& input) {
-                // todo
+            void erase(K&& key) {
+                if (index.contains(key) && erase_record(key)) {
+                    maybe_compact();
+                }
             }
 
+            /**
+             * Erase the records that the predicate says; the file is compacted (if it's needed) after all of
+             * them are erased, since the compaction may build the index again.
+             */
             template <typename Pred>
             void erase_if(Pred&& predicate) {
-                // todo
+                for (auto pos = index.begin(); pos != index.end();) {
+                    auto const cur  = pos++;
+                    auto const data = get(cur->first);
+                    if (data && predicate(*data)) {
+                        erase_record(key_type{cur->first}); // the key is gone after it's unindexed
+                    }
+                }
+                maybe_compact();
+            }
+
+            void clear() {
+                if (fd >= 0) {
+                    reset_file();
+                }
+            }
+
+            /**
+             * Copy the live records to a new file, and replace the old file with it.
+             */
+            void compact() {
+                if (fd < 0) {
+                    return;
+                }
+                auto new_file  = cache_file;
+                new_file      += ".compact";
+                int const out  = ::open(new_file.c_str(),
+                                        O_RDWR | O_CREAT | O_TRUNC | O_APPEND | O_CLOEXEC, // NOLINT
+                                        0644);                                            // NOLINT
+                if (out < 0) {
+                    log_errno("Cannot create the compacted cache file.");
+                    return;
+                }
+
+                static constexpr stl::size_t chunk_size = 256UL * 1024UL;
+
+                auto        buf     = object::make_object<string_type>(*this, file_magic);
+                stl::size_t written = 0;
+                bool        good    = true;
+                for (auto& [key, pos] : index) {
+                    auto const size = header_at(pos).size();
+                    buf.append(mapped + pos, size);
+                    pos = written + buf.size() - size; // the position in the new file
+                    if (buf.size() >= chunk_size) {
+                        good     = good && write_all(out, buf.data(), buf.size());
+                        written += buf.size();
+                        buf.clear();
+                    }
+                }
+                good     = good && write_all(out, buf.data(), buf.size());
+                written += buf.size();
+
+                stl::error_code err;
+                if (good) {
+                    stl::filesystem::rename(new_file, cache_file, err);
+                }
+                if (!good || err) {
+                    if (err) {
+                        this->logger.error(FILE_GATE_CAT, "Cannot replace the cache file.", err);
+                    }
+                    // the positions in the index are of the new file, build it again from the old one
+                    ::close(out);
+                    stl::filesystem::remove(new_file, err);
+                    unmap();
+                    ::close(stl::exchange(fd, -1));
+                    index.clear();
+                    live_bytes = 0;
+                    file_size  = 0;
+                    open_file();
+                    return;
+                }
+                unmap();
+                ::close(fd);
+                fd        = out;
+                file_size = written;
+                map_file();
+            }
+
+            /// Write the file to the disk; the records are in the page cache until then
+            void sync() {
+                if (fd >= 0 && ::fdatasync(fd) != 0) {
+                    log_errno("Cannot sync the cache file.");
+                }
+            }
+
+            /// Number of the keys
+            [[nodiscard]] stl::size_t size() const noexcept {
+                return index.size();
+            }
+
+            /// Size of the file; the live records, and the garbage that's not compacted yet
+            [[nodiscard]] stl::size_t file_bytes() const noexcept {
+                return file_size;
             }
         };
     };
@@ -1,6 +1,7 @@
 #ifndef WEBPP_STORAGE_LRU_CACHE_HPP
 #define WEBPP_STORAGE_LRU_CACHE_HPP
 
+#include "../std/unordered_map.hpp"
 #include "cache.hpp"
 #include "directory_gate.hpp"
 #include "memory_gate.hpp"
@@ -9,6 +10,12 @@ namespace webpp {
 
     /**
      * LRU Cache (Least Recently Used Cache)
+     *
+     * The keys are kept in a hash index whose nodes are linked together from the most recently used one
+     * to the least recently used one (an intrusive doubly linked list); so getting, setting, and evicting
+     * are all O(1), and nothing is scanned. The nodes are allocated with the traits' allocator.
+     *
+     * The storage gate holds the values; the options of the gate are not used by this strategy.
      */
     struct lru_strategy {
         template <Traits TraitsType, CacheKey KeyT, CacheValue ValueT, StorageGate SG>
@@ -24,8 +31,25 @@ namespace webpp {
             static constexpr stl::size_t default_max_size = 1024U;
 
           private:
+            // a key in the recency list
+            struct node {
+                key_type const* key  = nullptr; // the key of the index that holds this node
+                node*           prev = nullptr; // the one that is used more recently
+                node*           next = nullptr; // the one that is used less recently
+            };
+
+            using index_allocator_type =
+              traits::allocator_type_of<traits_type, stl::pair<key_type const, node>>;
+            using index_type = stl::unordered_map<key_type,
+                                                  node,
+                                                  stl::hash<key_type>,
+                                                  stl::equal_to<key_type>,
+                                                  index_allocator_type>;
+
             stl::size_t       max_size;
-            stl::size_t       next_usage = 1; // it's essentially a timestamp
+            index_type        index;
+            node*             head = nullptr; // the most recently used
+            node*             tail = nullptr; // the least recently used
             storage_gate_type gate;
 
           protected:
@@ -34,16 +58,51 @@ namespace webpp {
             }
 
           private:
-            // clean up the old data
-            void clean_up() {
-                if (next_usage <= max_size) {
+            constexpr void unlink(node& cur) noexcept {
+                (cur.prev != nullptr ? cur.prev->next : head) = cur.next;
+                (cur.next != nullptr ? cur.next->prev : tail) = cur.prev;
+                cur.prev                                       = nullptr;
+                cur.next                                       = nullptr;
+            }
+
+            constexpr void push_front(node& cur) noexcept {
+                cur.next = head;
+                (head != nullptr ? head->prev : tail) = &cur;
+                head                                  = &cur;
+            }
+
+            // make it the most recently used key
+            template <typename K>
+            constexpr void touch(K const& key) {
+                if (auto const pos = index.find(key); pos != index.end()) {
+                    if (head != &pos->second) {
+                        unlink(pos->second);
+                        push_front(pos->second);
+                    }
                     return;
                 }
-                stl::size_t break_index = next_usage - max_size;
-                gate.erase_if([break_index](auto const& item) noexcept {
-                    auto const last_used_index = item.options;
-                    return last_used_index < break_index;
-                });
+                auto const pos  = index.emplace(key_type{key}, node{}).first;
+                pos->second.key = &pos->first;
+                push_front(pos->second);
+            }
+
+            // forget a key that the gate doesn't have anymore
+            template <typename K>
+            constexpr void forget(K const& key) {
+                if (auto const pos = index.find(key); pos != index.end()) {
+                    unlink(pos->second);
+                    index.erase(pos);
+                }
+            }
+
+            // evict the least recently used keys
+            constexpr void clean_up() {
+                while (index.size() > max_size) {
+                    auto& old = *tail;
+                    unlink(old);
+                    gate.erase(*old.key);
+                    index.erase(index.find(*old.key));
+                }
             }
 
           public:
@@ -53,32 +112,50 @@ namespace webpp {
                                         stl::size_t const max_size_value = default_max_size,
                                         Args&&... args) noexcept
               : max_size{max_size_value},
+                index{get_alloc_for<index_type>(etraits)},
                 gate{stl::forward<ET>(etraits), stl::forward<Args>(args)...} {}
 
-            explicit constexpr strategy(storage_gate_type&& input_gate,
+            // the gate may not hold the traits (memory_gate doesn't), the index gets its allocator from these
+            template <EnabledTraits ET>
+            explicit constexpr strategy(ET&&                etraits,
+                                        storage_gate_type&& input_gate,
                                         stl::size_t const   max_size_value = default_max_size) noexcept
               : max_size{max_size_value},
+                index{get_alloc_for<index_type>(etraits)},
                 gate{stl::move(input_gate)} {}
 
+            // the nodes point to each other, they can't be copied
+            constexpr strategy(strategy&& other) noexcept
+              : max_size{other.max_size},
+                index{stl::move(other.index)},
+                head{stl::exchange(other.head, nullptr)},
+                tail{stl::exchange(other.tail, nullptr)},
+                gate{stl::move(other.gate)} {}
+
+            strategy(strategy const&)                = delete;
+            strategy& operator=(strategy const&)     = delete;
+            strategy& operator=(strategy&&) noexcept = delete;
+            constexpr ~strategy()                    = default;
+
             template <typename K, typename V>
                 requires(stl::convertible_to<K, key_type> && // it's a key
                          stl::convertible_to<V, value_type>) // it's a value
             constexpr void set(K&& key, V&& value) {
-                gate.set(stl::forward<K>(key), stl::forward<V>(value), next_usage++);
+                touch(key);
+                gate.set(stl::forward<K>(key), stl::forward<V>(value), 0);
                 clean_up();
             }
 
             template <typename K>
                 requires(stl::convertible_to<K, key_type>) // it's a key
             constexpr stl::optional<value_type> get(K&& key) {
-                stl::optional<bundle_type> const data = gate.get(key);
+                stl::optional<bundle_type> data = gate.get(key);
                 if (!data) {
+                    forget(key);
                     return stl::nullopt;
                 }
-
-                gate.set_options(key, next_usage++);
-
-                return data->value;
+                touch(key);
+                return stl::move(data->value);
             }
 
             template <typename K>
@@ -90,15 +167,26 @@ namespace webpp {
                 using return_type = typename storage_gate_type::value_ptr_type;
                 auto const data   = gate.get_ptr(key); // data is optional<bundle_ref_type>
                 if (!data) {
+                    forget(key);
                     return return_type{nullptr};
                 }
-
-                // todo: we have a reference to the options here, don't need to re-write it.
-                gate.set_options(key, next_usage++);
+                touch(key);
 
                 // return optional<value_ptr_type>
                 return return_type{data->value};
             }
+
+            template <typename K>
+                requires(stl::convertible_to<K, key_type>) // it's a key
+            constexpr void erase(K&& key) {
+                forget(key);
+                gate.erase(stl::forward<K>(key));
+            }
+
+            /// Number of the keys that are in the cache
+            [[nodiscard]] constexpr stl::size_t size() const noexcept {
+                return index.size();
+            }
         };
     };
 
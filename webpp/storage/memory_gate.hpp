@@ -38,9 +38,10 @@ namespace webpp {
             template <typename K>
             constexpr stl::optional<bundle_type> get(K&& key) {
                 if (auto it = map.find(stl::forward<K>(key)); it != map.end()) {
-                    return bundle_type{.key     = stl::move(it->first),
-                                       .value   = stl::move(it->second.second),
-                                       .options = stl::move(it->second.first)};
+                    // copy them, getting a value should not change the cache
+                    return bundle_type{.key     = it->first,
+                                       .value   = it->second.second,
+                                       .options = it->second.first};
                 }
                 return stl::nullopt;
             }
@@ -0,0 +1,301 @@
+#ifndef WEBPP_STORAGE_SHARDED_CACHE_HPP
+#define WEBPP_STORAGE_SHARDED_CACHE_HPP
+
+#include "../std/algorithm.hpp"
+#include "../std/unordered_map.hpp"
+#include "../std/vector.hpp"
+#include "cache.hpp"
+#include "memory_gate.hpp"
+
+#include <array>
+#include <atomic>
+#include <bit>
+#include <cstdint>
+#include <mutex>
+#include <shared_mutex>
+#include <utility>
+
+namespace webpp {
+
+    /**
+     * A pointer to a value of a concurrent cache that holds a shared lock of the shard that the value is
+     * in; the value can't be changed or evicted while this pointer exists, so don't keep it for long.
+     *
+     * A thread that holds one of these must not set a value in the same cache (it may be the same shard,
+     * and that dead-locks); a null pointer doesn't hold any locks.
+     */
+    template <typename T, typename MutexType = stl::shared_mutex>
+    struct locked_ptr {
+        using element_type = T;
+        using mutex_type   = MutexType;
+        using lock_type    = stl::shared_lock<mutex_type>;
+
+      private:
+        lock_type lock{};
+        T*        ptr = nullptr;
+
+      public:
+        constexpr locked_ptr() noexcept = default;
+
+        constexpr locked_ptr(stl::nullptr_t) noexcept {} // NOLINT(*-explicit-*)
+
+        constexpr locked_ptr(lock_type&& inp_lock, T* inp_ptr) noexcept
+          : lock{stl::move(inp_lock)},
+            ptr{inp_ptr} {}
+
+        [[nodiscard]] constexpr T* get() const noexcept {
+            return ptr;
+        }
+
+        [[nodiscard]] constexpr T& operator*() const noexcept {
+            return *ptr;
+        }
+
+        [[nodiscard]] constexpr T* operator->() const noexcept {
+            return ptr;
+        }
+
+        [[nodiscard]] explicit constexpr operator bool() const noexcept {
+            return ptr != nullptr;
+        }
+
+        [[nodiscard]] constexpr bool operator==(stl::nullptr_t) const noexcept {
+            return ptr == nullptr;
+        }
+
+        /// Release the lock before the pointer goes out of scope
+        constexpr void reset() noexcept {
+            ptr = nullptr;
+            if (lock.owns_lock()) {
+                lock.unlock();
+            }
+        }
+    };
+
+    /**
+     * Sharded Concurrent Cache
+     *
+     * The keys are distributed between "ShardCount" shards by their hashes; each shard has its own storage
+     * gate, index, and lock, so the threads that use different shards don't wait for each other at all.
+     *
+     * The readers only take the shared lock of the shard: the entries are evicted with the CLOCK algorithm
+     * (an approximation of LRU), and marking an entry as recently used is setting an atomic bit of it, not
+     * moving it to the front of a list; so getting the values is never serialized. Setting a value takes
+     * the exclusive lock of its shard; the "hand" goes around the entries of the shard, clearing their
+     * bits, and evicts the first one whose bit is not set.
+     *
+     * The maximum size is divided between the shards, so a shard may evict an entry while the others still
+     * have room.
+     *
+     * The values that "get" returns are copies; the pointers that "get_ptr" returns hold the shared lock of
+     * their shard (see locked_ptr), and they point to const values.
+     */
+    template <stl::size_t ShardCount = 16>
+    struct clock_sharded_strategy {
+        static_assert(ShardCount != 0 && stl::has_single_bit(ShardCount),
+                      "The number of shards should be a power of 2.");
+
+        template <Traits TraitsType, CacheKey KeyT, CacheValue ValueT, StorageGate SG>
+        struct strategy {
+            using traits_type = TraitsType;
+            using key_type    = KeyT;
+            using value_type  = ValueT;
+            using storage_gate_type =
+              typename SG::template storage_gate<traits_type, key_type, value_type, stl::size_t>;
+            using bundle_type = typename storage_gate_type::bundle_type;
+            using mutex_type  = stl::shared_mutex;
+
+            static constexpr stl::size_t default_max_size = 1024U;
+            static constexpr stl::size_t shard_count      = ShardCount;
+
+          private:
+            // an entry of the clock
+            struct slot {
+                key_type const*   key = nullptr; // the key of the index that holds this slot
+                stl::atomic<bool> referenced{false};
+            };
+
+            using index_allocator_type =
+              traits::allocator_type_of<traits_type, stl::pair<key_type const, stl::size_t>>;
+            using index_type = stl::unordered_map<key_type,
+                                                  stl::size_t,
+                                                  stl::hash<key_type>,
+                                                  stl::equal_to<key_type>,
+                                                  index_allocator_type>;
+            using slots_type = stl::vector<slot, traits::allocator_type_of<traits_type, slot>>;
+
+            struct shard {
+                mutable mutex_type mutex;
+                index_type         index; // key -> position of its slot
+                slots_type         slots; // fixed size, the capacity of the shard
+                stl::size_t        hand = 0;
+                stl::size_t        used = 0;
+                storage_gate_type  gate;
+
+                template <typename ET, typename... Args>
+                constexpr shard(ET& etraits, stl::size_t const capacity, Args const&... args)
+                  : index{get_alloc_for<index_type>(etraits)},
+                    slots{capacity, get_alloc_for<slots_type>(etraits)},
+                    gate{etraits, args...} {}
+
+                // find a slot for a new key; evicts one if the shard is full
+                constexpr stl::size_t take_slot() {
+                    if (used != slots.size()) {
+                        return used++;
+                    }
+                    for (;;) {
+                        auto const cur = hand;
+                        hand           = (hand + 1) % slots.size();
+                        if (!slots[cur].referenced.exchange(false, stl::memory_order_relaxed)) {
+                            gate.erase(*slots[cur].key);
+                            index.erase(index.find(*slots[cur].key));
+                            return cur;
+                        }
+                    }
+                }
+            };
+
+            using shards_type = stl::array<shard, shard_count>;
+
+            shards_type shards;
+
+            template <typename ET, stl::size_t... I, typename... Args>
+            static constexpr shards_type make_shards(ET&                       etraits,
+                                                     stl::size_t const         capacity,
+                                                     stl::index_sequence<I...> /* indices */,
+                                                     Args const&... args) {
+                return {{shard{(static_cast<void>(I), etraits), capacity, args...}...}};
+            }
+
+            // the high bits of the hash choose the shard; the index of the shard uses the low bits
+            template <typename K>
+            [[nodiscard]] constexpr shard& shard_of(K const& key) noexcept {
+                if constexpr (shard_count == 1) {
+                    return shards.front();
+                } else {
+                    constexpr auto shift = 64U - static_cast<unsigned>(stl::bit_width(shard_count) - 1);
+                    auto const     hash  = static_cast<stl::uint64_t>(stl::hash<key_type>{}(key));
+                    return shards[static_cast<stl::size_t>((hash * 0x9E37'79B9'7F4A'7C15ULL) >> shift)];
+                }
+            }
+
+          public:
+            template <EnabledTraits ET, typename... Args>
+                requires(EnabledTraits<ET> && !stl::same_as<stl::remove_cvref_t<ET>, strategy>)
+            explicit constexpr strategy(ET&&              etraits,
+                                        stl::size_t const max_size_value = default_max_size,
+                                        Args&&... args)
+              : shards{make_shards(etraits,
+                                   stl::max<stl::size_t>((max_size_value + shard_count - 1) / shard_count, 1),
+                                   stl::make_index_sequence<shard_count>{},
+                                   args...)} {}
+
+            // the readers may be holding the locks, and the slots point to the keys of the indices
+            strategy(strategy const&)                = delete;
+            strategy(strategy&&) noexcept            = delete;
+            strategy& operator=(strategy const&)     = delete;
+            strategy& operator=(strategy&&) noexcept = delete;
+            constexpr ~strategy()                    = default;
+
+            template <typename K, typename V>
+                requires(stl::convertible_to<K, key_type> && // it's a key
+                         stl::convertible_to<V, value_type>) // it's a value
+            constexpr void set(K&& key, V&& value) {
+                auto&                        cur = shard_of(key);
+                stl::unique_lock<mutex_type> lock{cur.mutex};
+                if (auto const pos = cur.index.find(key); pos != cur.index.end()) {
+                    cur.slots[pos->second].referenced.store(true, stl::memory_order_relaxed);
+                } else {
+                    auto const index      = cur.take_slot();
+                    auto const new_pos    = cur.index.emplace(key_type{key}, index).first;
+                    cur.slots[index].key = &new_pos->first;
+                    cur.slots[index].referenced.store(false, stl::memory_order_relaxed);
+                }
+                cur.gate.set(stl::forward<K>(key), stl::forward<V>(value), 0);
+            }
+
+            /// The keys that are not in the index (not set through this cache) are not looked up in the gate
+            template <typename K>
+                requires(stl::convertible_to<K, key_type>) // it's a key
+            constexpr stl::optional<value_type> get(K&& key) {
+                auto&                        cur = shard_of(key);
+                stl::shared_lock<mutex_type> lock{cur.mutex};
+                auto const                   pos = cur.index.find(key);
+                if (pos == cur.index.end()) {
+                    return stl::nullopt;
+                }
+                stl::optional<bundle_type> data = cur.gate.get(key);
+                if (!data) {
+                    return stl::nullopt; // its slot will be reused, the clock doesn't see it as referenced
+                }
+                cur.slots[pos->second].referenced.store(true, stl::memory_order_relaxed);
+                return stl::move(data->value);
+            }
+
+            template <typename K>
+                requires(
+                  details::StorageGatePointerSupport<storage_gate_type> && stl::convertible_to<K, key_type>)
+            constexpr auto get_ptr(K&& key) {
+                using return_type = locked_ptr<value_type const, mutex_type>;
+                auto&                        cur = shard_of(key);
+                stl::shared_lock<mutex_type> lock{cur.mutex};
+                auto const                   pos = cur.index.find(key);
+                if (pos == cur.index.end()) {
+                    return return_type{nullptr};
+                }
+                auto const data = cur.gate.get_ptr(key);
+                if (!data) {
+                    return return_type{nullptr};
+                }
+                cur.slots[pos->second].referenced.store(true, stl::memory_order_relaxed);
+                return return_type{stl::move(lock), data->value};
+            }
+
+            template <typename K>
+                requires(stl::convertible_to<K, key_type>) // it's a key
+            constexpr void erase(K&& key) {
+                auto&                        cur = shard_of(key);
+                stl::unique_lock<mutex_type> lock{cur.mutex};
+                if (auto const pos = cur.index.find(key); pos != cur.index.end()) {
+                    auto const index = pos->second;
+                    cur.gate.erase(pos->first);
+                    cur.index.erase(pos);
+                    if (index + 1 == cur.used) {
+                        --cur.used;
+                    } else {
+                        // move the last used slot here, so the used slots are always the first ones
+                        auto& last = cur.slots[cur.used - 1];
+                        cur.slots[index].key = last.key;
+                        cur.slots[index].referenced.store(last.referenced.load(stl::memory_order_relaxed),
+                                                          stl::memory_order_relaxed);
+                        cur.index.find(*last.key)->second = index;
+                        --cur.used;
+                    }
+                    if (cur.hand >= cur.used) {
+                        cur.hand = 0;
+                    }
+                }
+            }
+
+            /// Number of the keys that are in the cache
+            [[nodiscard]] constexpr stl::size_t size() const noexcept {
+                stl::size_t count = 0;
+                for (auto const& cur : shards) {
+                    stl::shared_lock<mutex_type> lock{cur.mutex};
+                    count += cur.index.size();
+                }
+                return count;
+            }
+        };
+    };
+
+    template <Traits      TraitsType   = default_traits,
+              CacheKey    KeyT         = traits::string<TraitsType>,
+              CacheValue  ValT         = traits::string<TraitsType>,
+              StorageGate StorageGateT = memory_gate<>,
+              stl::size_t ShardCount   = 16>
+    using concurrent_cache = cache<TraitsType, KeyT, ValT, clock_sharded_strategy<ShardCount>, StorageGateT>;
+
+} // namespace webpp
+
+#endif // WEBPP_STORAGE_SHARDED_CACHE_HPP
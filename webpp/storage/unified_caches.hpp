@@ -2,6 +2,7 @@
 #define WEBPP_UNIFIED_CACHE_CACHE_H
 
 #include "../std/type_traits.hpp"
+#include "../traits/traits.hpp"
 
 #include <utility>
 
@@ -24,6 +25,13 @@ namespace webpp {
       public:
         unified_caches() noexcept = default;
 
+        // NOLINTBEGIN(bugprone-forwarding-reference-overload)
+        template <EnabledTraits ET>
+            requires(!stl::same_as<stl::remove_cvref_t<ET>, unified_caches>)
+        explicit constexpr unified_caches(ET&& etraits) : CacheSystem{etraits}... {}
+
+        // NOLINTEND(bugprone-forwarding-reference-overload)
+
         //
         // template <typename KeyType, typename ValueType>
         // auto set(KeyType&& key, ValueType&& value) noexcept {
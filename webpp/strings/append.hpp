@@ -10,6 +10,7 @@
 #ifndef __cpp_lib_to_chars
 #    include "../std/format.hpp"
 #else
+#    include <array>
 #    include <charconv>
 #    include <stdexcept>
 #endif
@@ -84,14 +85,19 @@ namespace webpp {
                                  float,
                                  stl::conditional_t<(value_size == sizeof(double)), double, long double>>;
 
-            constexpr stl::size_t   _size = ascii::digit_count<value_type>() + 1;
+            constexpr stl::size_t   _size = ascii::digit_count<value_type>() + 2; // +1 for the sign
             stl::array<char, _size> chars;
-            if (auto res = stl::to_chars(chars.data(),
-                                         chars.data() + _size,
-                                         static_cast<float_type>(value), // to remove ambiguity
-                                         stl::forward<R>(args)...);
-                res.ec == stl::errc())
-            {
+            stl::to_chars_result    res; // NOLINT(cppcoreguidelines-pro-type-member-init)
+            if constexpr (stl::is_integral_v<value_type>) {
+                // integers are exact; the float conversion would turn 3000000 into "3e+06"
+                res = stl::to_chars(chars.data(), chars.data() + _size, value, stl::forward<R>(args)...);
+            } else {
+                res = stl::to_chars(chars.data(),
+                                    chars.data() + _size,
+                                    static_cast<float_type>(value), // to remove ambiguity
+                                    stl::forward<R>(args)...);
+            }
+            if (res.ec == stl::errc()) {
                 str.append(chars.data(), static_cast<stl::size_t>(res.ptr - chars.data()));
                 return true;
             }
@@ -7,6 +7,10 @@
 namespace webpp::istl {
     using namespace fixstr;
 }
+
+namespace webpp {
+    using fixstr::fixed_string;
+}
 #else
 
 
@@ -76,8 +80,9 @@ namespace webpp {
         size_t   real_size{0};
         bool     correct_flag{true};
 
+        // not explicit, so string literals can be passed as non-type template parameters
         template <typename T>
-        explicit constexpr fixed_string(T const (&input)[N + 1]) noexcept {
+        constexpr fixed_string(T const (&input)[N + 1]) noexcept { // NOLINT(*-explicit-*)
             if constexpr (stl::is_same_v<T, char>) {
 #    ifdef WEBPP_STRING_IS_UTF8
                 size_t out{0};
@@ -228,11 +233,11 @@ namespace webpp {
             return real_size;
         }
 
-        [[nodiscard]] constexpr char32_t* begin() const noexcept {
+        [[nodiscard]] constexpr char32_t const* begin() const noexcept {
             return content;
         }
 
-        [[nodiscard]] constexpr char32_t* end() const noexcept {
+        [[nodiscard]] constexpr char32_t const* end() const noexcept {
             return content + size();
         }
 
@@ -279,11 +284,11 @@ namespace webpp {
             return 0;
         }
 
-        [[nodiscard]] constexpr char32_t* begin() const noexcept {
+        [[nodiscard]] constexpr char32_t const* begin() const noexcept {
             return empty;
         }
 
-        [[nodiscard]] constexpr char32_t* end() const noexcept {
+        [[nodiscard]] constexpr char32_t const* end() const noexcept {
             return empty + size();
         }
 
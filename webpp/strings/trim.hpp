@@ -42,8 +42,9 @@ namespace webpp::ascii {
 
     template <istl::StringView StrViewType, CharSet CS = decltype(standard_whitespaces)>
     static inline void rtrim(StrViewType& str, CS whitespaces = standard_whitespaces) noexcept {
-        std::size_t found = str.find_last_not_of(whitespaces.data());
-        if (found != stl::remove_cvref_t<StrViewType>::npos) {
+        constexpr auto npos  = stl::remove_cvref_t<StrViewType>::npos;
+        auto const     found = str.find_last_not_of(whitespaces.data(), npos, whitespaces.size());
+        if (found != npos) {
             str.remove_suffix(str.size() - found - 1);
         } else {
             str.remove_suffix(str.size());
@@ -86,7 +87,7 @@ namespace webpp::ascii {
     // trim from start (in place)
     template <CharSet CS = decltype(standard_whitespaces), istl::String StrT = stl::string>
     static inline void ltrim(StrT& inp_str, CS whitespaces = standard_whitespaces) noexcept {
-        auto const pos = inp_str.find_first_not_of(whitespaces.data());
+        auto const pos = inp_str.find_first_not_of(whitespaces.data(), 0, whitespaces.size());
         if (pos != StrT::npos) {
             inp_str.erase(0, pos);
         }
@@ -95,7 +96,7 @@ namespace webpp::ascii {
     // trim from end (in place)
     template <CharSet CS = decltype(standard_whitespaces), istl::String StrT = stl::string>
     static inline void rtrim(StrT& inp_str, CS whitespaces = standard_whitespaces) noexcept {
-        auto const pos = inp_str.find_last_not_of(whitespaces.data());
+        auto const pos = inp_str.find_last_not_of(whitespaces.data(), StrT::npos, whitespaces.size());
         if (pos == StrT::npos) {
             inp_str.clear();
         } else {
@@ -286,12 +286,21 @@ namespace webpp {
         using T::T;
     };
 
+    namespace details {
+        // The owner should be constructed before T is given a reference to it, that's why it's held in a
+        // base class that comes before T, and not in a member.
+        template <Traits TraitsType>
+        struct enable_traits_owner_holder {
+            enable_owner_traits<TraitsType> owner{};
+        };
+    } // namespace details
+
     template <typename T, Traits TraitsType>
-    struct enable_traits_for<T, TraitsType> : T {
+    struct enable_traits_for<T, TraitsType> : private details::enable_traits_owner_holder<TraitsType>, T {
         using etraits = enable_owner_traits<TraitsType>;
 
       private:
-        etraits et{};
+        using holder_type = details::enable_traits_owner_holder<TraitsType>;
 
       public:
         using T::T;
@@ -301,7 +310,7 @@ namespace webpp {
             requires(stl::is_constructible_v<T, etraits, Args...>)
         explicit constexpr enable_traits_for(Args&&... args)
           noexcept(stl::is_nothrow_constructible_v<T, etraits, Args...>)
-          : T{et, stl::forward<Args>(args)...} {}
+          : T{holder_type::owner, stl::forward<Args>(args)...} {}
 
         /// pass a general allocator as the first argument
         template <typename... Args>
@@ -318,7 +327,7 @@ namespace webpp {
                      })
         explicit constexpr enable_traits_for(Args&&... args)
           noexcept(stl::is_nothrow_constructible_v<T, typename T::allocator_type const&, Args...>)
-          : T{get_alloc_for<T>(et), stl::forward<Args>(args)...} {}
+          : T{get_alloc_for<T>(holder_type::owner), stl::forward<Args>(args)...} {}
 
         constexpr enable_traits_for(enable_traits_for const&) noexcept            = default;
         constexpr enable_traits_for(enable_traits_for&&) noexcept                 = default;
@@ -103,8 +103,8 @@ namespace webpp::uri {
             --pos;
         }
 
-        [[nodiscard]] constexpr auto operator*() const noexcept {
-            return pos.operator*();
+        [[nodiscard]] constexpr slug_cref operator*() const noexcept {
+            return *pos;
         }
 
         [[nodiscard]] constexpr auto operator->() const noexcept {
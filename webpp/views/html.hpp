@@ -3,24 +3,198 @@
 #ifndef WEBPP_HTML_HPP
 #define WEBPP_HTML_HPP
 
+#include "../libs/eve.hpp"
 #include "../std/string.hpp"
 #include "../std/string_view.hpp"
+#include "../std/type_traits.hpp"
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstdint>
+#include <cstring>
+
+#ifdef WEBPP_EVE
+#    include <eve/algo/as_range.hpp>
+#    include <eve/algo/find.hpp>
+#    include <eve/wide.hpp>
+#elif defined(__SSE2__)
+#    include <immintrin.h>
+#endif
 
 namespace webpp {
 
+    namespace details {
+
+        [[nodiscard]] constexpr bool is_html_special(char const chr) noexcept {
+            return chr == '&' || chr == '<' || chr == '>' || chr == '"' || chr == '\'';
+        }
+
+        [[nodiscard]] constexpr stl::string_view html_escape_sequence(char const chr) noexcept {
+            switch (chr) {
+                case '&': return "&amp;";
+                case '<': return "&lt;";
+                case '>': return "&gt;";
+                case '"': return "&quot;";
+                case '\'': return "&apos;";
+                default: return {};
+            }
+        }
+
+        /**
+         * Find the next character that has to be escaped.
+         *
+         * With EVE (USE_EVE), the characters are checked a whole SIMD register at a time; without it,
+         * they're checked 32 (AVX2) or 16 (SSE2) characters at a time if the instruction set is
+         * available, and one by one for the rest of them. In constant evaluation it's always one by one.
+         */
+        [[nodiscard]] constexpr char const* find_html_special(char const* pos, char const* end) noexcept {
+            if (!stl::is_constant_evaluated()) {
+#ifdef WEBPP_EVE
+                using uchar = stl::uint8_t;
+                // NOLINTBEGIN(cppcoreguidelines-pro-type-reinterpret-cast)
+                auto const* first = reinterpret_cast<uchar const*>(pos);
+                auto const* last  = reinterpret_cast<uchar const*>(end);
+                return reinterpret_cast<char const*>(
+                  eve::algo::find_if(eve::algo::as_range(first, last), [](auto chr) noexcept {
+                      return chr == uchar{'&'} || chr == uchar{'<'} || chr == uchar{'>'} ||
+                             chr == uchar{'"'} || chr == uchar{'\''};
+                  }));
+                // NOLINTEND(cppcoreguidelines-pro-type-reinterpret-cast)
+#else
+                // NOLINTBEGIN(*-pro-type-reinterpret-cast, *-pro-bounds-pointer-arithmetic)
+#    ifdef __AVX2__
+                while (end - pos >= 32) {
+                    auto const block = _mm256_loadu_si256(reinterpret_cast<__m256i const*>(pos));
+                    auto const found = _mm256_or_si256(
+                      _mm256_or_si256(_mm256_cmpeq_epi8(block, _mm256_set1_epi8('&')),
+                                      _mm256_cmpeq_epi8(block, _mm256_set1_epi8('<'))),
+                      _mm256_or_si256(_mm256_or_si256(_mm256_cmpeq_epi8(block, _mm256_set1_epi8('>')),
+                                                      _mm256_cmpeq_epi8(block, _mm256_set1_epi8('"'))),
+                                      _mm256_cmpeq_epi8(block, _mm256_set1_epi8('\''))));
+                    auto const mask = static_cast<stl::uint32_t>(_mm256_movemask_epi8(found));
+                    if (mask != 0) {
+                        return pos + stl::countr_zero(mask);
+                    }
+                    pos += 32;
+                }
+#    endif
+#    ifdef __SSE2__
+                while (end - pos >= 16) {
+                    auto const block = _mm_loadu_si128(reinterpret_cast<__m128i const*>(pos));
+                    auto const found =
+                      _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(block, _mm_set1_epi8('&')),
+                                                _mm_cmpeq_epi8(block, _mm_set1_epi8('<'))),
+                                   _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(block, _mm_set1_epi8('>')),
+                                                             _mm_cmpeq_epi8(block, _mm_set1_epi8('"'))),
+                                                _mm_cmpeq_epi8(block, _mm_set1_epi8('\''))));
+                    auto const mask = static_cast<stl::uint32_t>(_mm_movemask_epi8(found));
+                    if (mask != 0) {
+                        return pos + stl::countr_zero(mask);
+                    }
+                    pos += 16;
+                }
+#    endif
+                // NOLINTEND(*-pro-type-reinterpret-cast, *-pro-bounds-pointer-arithmetic)
+#endif
+            }
+            for (; pos != end && !is_html_special(*pos); ++pos) {
+            }
+            return pos;
+        }
+
+        // the characters after an escaped character that are escaped together (see html_escape)
+        static constexpr stl::size_t html_escape_block_size = 16;
+
+        struct html_escape_entry {
+            stl::array<char, 8> text{}; // the character itself, or its escape sequence
+            stl::uint8_t        size = 1;
+        };
+
+        static constexpr auto html_escape_table = [] {
+            stl::array<html_escape_entry, 256> table{};
+            for (stl::size_t index = 0; index != table.size(); ++index) {
+                auto const chr = static_cast<char>(index);
+                auto const esc = html_escape_sequence(chr);
+                if (esc.empty()) {
+                    table[index].text[0] = chr;
+                } else {
+                    stl::copy(esc.begin(), esc.end(), table[index].text.begin());
+                    table[index].size = static_cast<stl::uint8_t>(esc.size());
+                }
+            }
+            return table;
+        }();
+
+        /**
+         * Escape the specified characters into the output without any branches; the output should have
+         * room for 8 more characters than the escaped text (the longest escape sequence is 6 characters).
+         * @returns the size of the escaped text
+         */
+        [[nodiscard]] inline stl::size_t
+        html_escape_block(char const* pos, stl::size_t const size, char* out) noexcept {
+            auto* const beg = out;
+            auto const* end = pos + size; // NOLINT(*-pro-bounds-pointer-arithmetic)
+            for (; pos != end; ++pos) {
+                auto const& entry = html_escape_table[static_cast<unsigned char>(*pos)];
+                stl::memcpy(out, entry.text.data(), entry.text.size());
+                out += entry.size; // NOLINT(*-pro-bounds-pointer-arithmetic)
+            }
+            return static_cast<stl::size_t>(out - beg);
+        }
+
+        // One character at a time; for the other character types, and the constant evaluation
+        template <typename StrT, typename StrVT>
+        constexpr void html_escape_chars(StrVT const str, StrT& out) {
+            using char_type       = typename StrT::value_type;
+            using input_char_type = typename StrVT::value_type;
+            for (auto const chr : str) {
+                auto const code = static_cast<stl::make_unsigned_t<input_char_type>>(chr);
+                if (code < 0x80U && is_html_special(static_cast<char>(chr))) {
+                    for (auto const esc : html_escape_sequence(static_cast<char>(chr))) {
+                        out.push_back(static_cast<char_type>(esc));
+                    }
+                } else {
+                    out.push_back(static_cast<char_type>(chr));
+                }
+            }
+        }
+
+    } // namespace details
+
+    /**
+     * Escape the input, and append it to the output.
+     * The runs of characters that don't need to be escaped are found with SIMD (if it's available), and
+     * copied in one go; the output is appended to as is, so it can be the buffer that is being rendered.
+     */
     template <istl::String StrT, istl::StringViewifiable StrVT>
-    static constexpr StrT html_escape(StrVT&& input, StrT& out) {
-        // todo: consider using SIMD if it's not being optimized
-        out.reserve(input.size() * 2);
-        for (auto const ch : input) {
-            switch (ch) {
-                case '&': out.append({'&', 'a', 'm', 'p', ';'}); break;
-                case '<': out.append({'&', 'l', 't', ';'}); break;
-                case '>': out.append({'&', 'g', 't', ';'}); break;
-                case '\"': out.append({'&', 'q', 'u', 'o', 't', ';'}); break;
-                case '\'': out.append({'&', 'a', 'p', 'o', 's', ';'}); break;
-                default: out.append(1, ch); break;
+    static constexpr StrT& html_escape(StrVT&& input, StrT& out) {
+        auto const str = istl::string_viewify(stl::forward<StrVT>(input));
+        out.reserve(out.size() + str.size());
+        if constexpr (stl::same_as<typename StrT::value_type, char> &&
+                      stl::same_as<typename decltype(str)::value_type, char>)
+        {
+            if (stl::is_constant_evaluated()) {
+                details::html_escape_chars(str, out);
+                return out;
+            }
+            auto const* pos = str.data();
+            auto const* end = pos + str.size(); // NOLINT(*-pro-bounds-pointer-arithmetic)
+            for (;;) {
+                auto const* special = details::find_html_special(pos, end);
+                out.append(pos, static_cast<stl::size_t>(special - pos));
+                if (special == end) {
+                    break;
+                }
+                // the escaped characters usually come together, so the next block is escaped at once
+                auto const size = stl::min<stl::size_t>(details::html_escape_block_size,
+                                                        static_cast<stl::size_t>(end - special));
+                stl::array<char, details::html_escape_block_size * 6 + 8> block; // NOLINT(*-init)
+                out.append(block.data(), details::html_escape_block(special, size, block.data()));
+                pos = special + size; // NOLINT(*-pro-bounds-pointer-arithmetic)
             }
+        } else {
+            details::html_escape_chars(str, out);
         }
         return out;
     }
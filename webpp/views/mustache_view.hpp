@@ -39,6 +39,7 @@
 #include "../std/function_ref.hpp"
 #include "../std/functional.hpp"
 #include "../std/string_view.hpp"
+#include "../std/vector.hpp"
 #include "../strings/splits.hpp"
 #include "../strings/trim.hpp"
 #include "../traits/enable_traits.hpp"
@@ -197,12 +198,12 @@ namespace webpp::views {
 
                 [[nodiscard]] constexpr bool is_false() const noexcept {
                     if (auto const* views = get_if_bool()) {
-                        return *views;
+                        return !*views;
                     }
                     if (auto const* vlist = get_if_list()) {
                         return vlist->empty();
                     }
-                    return true;
+                    return false;
                 }
 
                 // search the tree for a key and get a variable*
@@ -275,7 +276,7 @@ namespace webpp::views {
 
                 [[nodiscard]] constexpr bool is_non_empty_list() const noexcept {
                     if (auto const* list = get_if_list()) {
-                        return list->empty();
+                        return !list->empty();
                     }
                     return false;
                 }
@@ -381,23 +382,39 @@ namespace webpp::views {
         variable_type const* get(string_view_type name) const {
             // process {{.}} name
             if (name.size() == 1 && name.at(0) == '.') {
-                return items.front();
+                return self();
             }
             if (name.find('.') == string_view_type::npos) {
                 // process normal name without having to split which is slower
-                for (auto const& item : items) {
-                    if (auto const var = item->get(name)) {
-                        return var;
-                    }
-                }
-                return nullptr;
+                return get_name(name);
             }
             // process x.y-like name
             auto names = object::make_object<stl::vector<string_view_type>>(*this); // todo: use local alloc
             strings::basic_splitter<string_view_type, char_type>(name, char_type{'.'}).split(names);
+            return get_path(names);
+        }
+
+        /// The {{.}} variable
+        [[nodiscard]] variable_type const* self() const noexcept {
+            return items.front();
+        }
+
+        /// Get a name that doesn't have any dots in it
+        [[nodiscard]] variable_type const* get_name(string_view_type name) const {
+            for (auto const& item : items) {
+                if (auto const var = item->get(name)) {
+                    return var;
+                }
+            }
+            return nullptr;
+        }
+
+        /// Get an x.y-like name that is already split by its dots
+        template <typename NamesT>
+        [[nodiscard]] variable_type const* get_path(NamesT&& names) const {
             for (auto const* item : items) {
                 auto* var = item;
-                for (auto const& n : names) {
+                for (string_view_type const n : names) {
                     var = var->get(n);
                     if (!var) {
                         break;
@@ -613,6 +630,244 @@ namespace webpp::views {
         }
     };
 
+    namespace details {
+        enum struct mustache_opcode : stl::uint8_t {
+            text,               // append the text to the current line
+            newline,            // the end of the current line
+            variable,           // append the escaped value of the variable to the current line
+            unescaped_variable, // append the value of the variable to the current line
+            section,            // jumps to the end of the section if it's not rendered
+            inverted_section,   // jumps to the end of the section if it's not rendered
+            section_end,        // jumps back to the beginning of the section for the next item of a list
+            partial,
+            set_delimiter
+        };
+
+        enum struct mustache_name_kind : stl::uint8_t {
+            self,  // {{.}}
+            plain, // a name without dots
+            path,  // x.y-like name, its parts are in the "parts" of the program
+        };
+
+        // a piece of the text of a program, or a range of the parts of a path
+        struct mustache_span {
+            stl::uint32_t offset = 0;
+            stl::uint32_t size   = 0;
+        };
+
+        struct mustache_instruction {
+            mustache_opcode    op   = mustache_opcode::text;
+            mustache_name_kind kind = mustache_name_kind::plain;
+            stl::uint32_t      jump = 0; // sections: the index of their ends, and the ends: their sections
+            mustache_span      text{};   // the text, the name, or the begin delimiter
+            mustache_span      extra{};  // the text of the section (for lambdas), or the end delimiter
+            mustache_span      parts{};  // the parts of the path names
+        };
+    } // namespace details
+
+    /**
+     * A mustache template, compiled to a flat list of instructions
+     *
+     * The texts of the template and the names of its tags are stored in one string (the arena), and the
+     * instructions refer to them by their offsets; the sections are ranges of the instructions that end
+     * with a "section_end" instruction, and they know the index of each other, so the renderer can skip
+     * a section, or go back to its beginning for the next item of a list, without walking a tree.
+     * The names are resolved while compiling: "{{.}}" and the names without dots don't need to be
+     * checked, and the x.y-like names are split once, instead of on every render.
+     *
+     * The offsets are 32-bit, the templates can't be larger than 4GiB.
+     */
+    template <Traits TraitsType>
+    struct mustache_program {
+        using traits_type       = TraitsType;
+        using string_type       = traits::string<traits_type>;
+        using string_view_type  = traits::string_view<traits_type>;
+        using char_type         = traits::char_type<traits_type>;
+        using component_type    = component<traits_type>;
+        using instruction_type  = details::mustache_instruction;
+        using instructions_type = istl::vector<instruction_type, traits_type>;
+        using parts_type        = istl::vector<details::mustache_span, traits_type>;
+
+        // the parts of an x.y-like name, as string views
+        struct path_type {
+            struct iterator {
+                mustache_program const*       program = nullptr;
+                details::mustache_span const* part    = nullptr;
+
+                [[nodiscard]] constexpr string_view_type operator*() const noexcept {
+                    return program->text(*part);
+                }
+
+                constexpr iterator& operator++() noexcept {
+                    ++part;
+                    return *this;
+                }
+
+                [[nodiscard]] constexpr bool operator==(iterator const&) const noexcept = default;
+            };
+
+            mustache_program const* program = nullptr;
+            details::mustache_span  parts{};
+
+            [[nodiscard]] constexpr iterator begin() const noexcept {
+                return {program, program->parts.data() + parts.offset};
+            }
+
+            [[nodiscard]] constexpr iterator end() const noexcept {
+                return {program, program->parts.data() + parts.offset + parts.size};
+            }
+        };
+
+      private:
+        string_type       arena;            // the texts and the names
+        instructions_type instructions;
+        parts_type        parts;            // the parts of the x.y-like names
+        stl::size_t       literal_size = 0; // the size of the texts; a hint for the size of the output
+
+      public:
+        template <EnabledTraits ET>
+        explicit constexpr mustache_program(ET& etraits)
+          : arena{get_alloc_for<string_type>(etraits)},
+            instructions{get_alloc_for<instructions_type>(etraits)},
+            parts{get_alloc_for<parts_type>(etraits)} {}
+
+        /// Compile the parsed template; the section ends should've been removed by the parser
+        constexpr void compile(component_type const& root) {
+            clear();
+            lower(root.children);
+        }
+
+        constexpr void clear() noexcept {
+            arena.clear();
+            instructions.clear();
+            parts.clear();
+            literal_size = 0;
+        }
+
+        [[nodiscard]] constexpr stl::size_t size() const noexcept {
+            return instructions.size();
+        }
+
+        [[nodiscard]] constexpr bool empty() const noexcept {
+            return instructions.empty();
+        }
+
+        [[nodiscard]] constexpr instruction_type const& operator[](stl::size_t index) const noexcept {
+            return instructions[index];
+        }
+
+        [[nodiscard]] constexpr stl::size_t text_size() const noexcept {
+            return literal_size;
+        }
+
+        [[nodiscard]] constexpr string_view_type text(details::mustache_span piece) const noexcept {
+            return string_view_type{arena}.substr(piece.offset, piece.size);
+        }
+
+        [[nodiscard]] constexpr path_type path(instruction_type const& ins) const noexcept {
+            return {this, ins.parts};
+        }
+
+      private:
+        [[nodiscard]] static constexpr stl::uint32_t index_of(stl::size_t index) noexcept {
+            return static_cast<stl::uint32_t>(index);
+        }
+
+        constexpr details::mustache_span add_text(string_view_type str) {
+            details::mustache_span const piece{index_of(arena.size()), index_of(str.size())};
+            arena.append(str);
+            return piece;
+        }
+
+        constexpr void set_name(instruction_type& ins, string_view_type name) {
+            using enum details::mustache_name_kind;
+            ins.text = add_text(name);
+            if (name.size() == 1 && name.front() == '.') {
+                ins.kind = self;
+            } else if (name.find('.') == string_view_type::npos) {
+                ins.kind = plain;
+            } else {
+                ins.kind  = path;
+                ins.parts = {index_of(parts.size()), 0};
+                auto const str = text(ins.text);
+                for (string_view_type const part :
+                     strings::basic_splitter<string_view_type, char_type>(str, char_type{'.'})) {
+                    parts.push_back({index_of(ins.text.offset + (part.data() - str.data())),
+                                     index_of(part.size())});
+                    ++ins.parts.size;
+                }
+            }
+        }
+
+        constexpr void add_literal(details::mustache_opcode op, string_view_type str) {
+            using details::mustache_opcode;
+            literal_size += str.size();
+            // join the texts, the parser splits them by the whitespaces
+            if (op == mustache_opcode::text && !instructions.empty()) {
+                auto& last = instructions.back();
+                if (last.op == mustache_opcode::text && last.text.offset + last.text.size == arena.size()) {
+                    arena.append(str);
+                    last.text.size += index_of(str.size());
+                    return;
+                }
+            }
+            instructions.push_back({.op = op, .text = add_text(str)});
+        }
+
+        constexpr void lower(typename component_type::children_type const& children) {
+            using details::mustache_opcode;
+            for (auto const& comp : children) {
+                if (comp.is_text()) {
+                    add_literal(comp.is_newline() ? mustache_opcode::newline : mustache_opcode::text,
+                                comp.text);
+                    continue;
+                }
+                auto const&      tag = comp.tag;
+                instruction_type ins;
+                switch (tag.type) {
+                    using enum details::tag_type;
+                    case variable:
+                        ins.op = mustache_opcode::variable;
+                        set_name(ins, tag.name);
+                        break;
+                    case unescaped_variable:
+                        ins.op = mustache_opcode::unescaped_variable;
+                        set_name(ins, tag.name);
+                        break;
+                    case section_begin:
+                    case section_begin_inverted: {
+                        ins.op = tag.type == section_begin ? mustache_opcode::section
+                                                           : mustache_opcode::inverted_section;
+                        set_name(ins, tag.name);
+                        if (tag.section_text) {
+                            ins.extra = add_text(*tag.section_text);
+                        }
+                        auto const begin = instructions.size();
+                        instructions.push_back(ins);
+                        lower(comp.children);
+                        instructions.push_back({.op = mustache_opcode::section_end, .jump = index_of(begin)});
+                        instructions[begin].jump = index_of(instructions.size() - 1);
+                        continue;
+                    }
+                    case partial:
+                        ins.op   = mustache_opcode::partial;
+                        ins.text = add_text(tag.name);
+                        break;
+                    case set_delimiter:
+                        ins.op    = mustache_opcode::set_delimiter;
+                        ins.text  = add_text(tag.delim_set.begin);
+                        ins.extra = add_text(tag.delim_set.end);
+                        break;
+                    default: continue; // comments
+                }
+                instructions.push_back(ins);
+            }
+        }
+    };
+
+    template <Traits TraitsType>
+    struct mustache_stream;
+
     template <Traits TraitsType>
     struct mustache_view : enable_traits<TraitsType> {
         using etraits_type     = enable_traits<TraitsType>;
@@ -624,6 +879,7 @@ namespace webpp::views {
         using string_size_type  = typename string_type::size_type;
         using component_type    = component<traits_type>;
         using walk_control_type = typename component_type::walk_control;
+        using program_type      = mustache_program<traits_type>;
 
         using settings      = details::mustache_data_view_settings<traits_type>;
         using data_type     = typename settings::type;
@@ -642,6 +898,7 @@ namespace webpp::views {
       private:
         string_type    error_msg{get_alloc_for<string_type>(*this)};
         component_type root_component;
+        program_type   program;
 
       public:
         // NOLINTBEGIN(bugprone-forwarding-reference-overload)
@@ -649,7 +906,8 @@ namespace webpp::views {
             requires(!stl::same_as<stl::remove_cvref_t<ET>, mustache_view>)
         explicit constexpr mustache_view(ET&& etraits) noexcept
           : etraits_type{etraits},
-            root_component{etraits} {}
+            root_component{etraits},
+            program{etraits} {}
 
         // NOLINTEND(bugprone-forwarding-reference-overload)
 
@@ -678,6 +936,11 @@ namespace webpp::views {
             return error_msg;
         }
 
+        /// The parsed template; the renderer doesn't walk this tree, it runs the program compiled from it
+        [[nodiscard]] constexpr component_type const& components() const noexcept {
+            return root_component;
+        }
+
         template <typename stream_type>
         constexpr stream_type& render(data_type const& data, stream_type& stream) {
             render(data, [&stream](string_view_type str) {
@@ -687,14 +950,15 @@ namespace webpp::views {
         }
 
         constexpr string_type render(data_type const& data) {
-            stl::basic_ostringstream<typename string_type::value_type> oss;
-            return render(data, oss).str();
+            auto out = object::make_object<string_type>(*this);
+            render(out, data);
+            return out;
         }
 
         template <typename stream_type>
         constexpr stream_type& render(context<traits_type>& ctx, stream_type& stream) {
             context_internal<traits_type> context{ctx};
-            render(
+            run(
               [&stream](string_view_type str) {
                   stream << str;
               },
@@ -703,8 +967,8 @@ namespace webpp::views {
         }
 
         constexpr string_type render(context<traits_type>& ctx) {
-            stl::basic_ostringstream<typename string_type::value_type> oss;
-            return render(ctx, oss).str();
+            context_internal<traits_type> internal_ctx{ctx};
+            return render(internal_ctx);
         }
 
         constexpr void render(data_type const& data, render_handler const& handler) {
@@ -713,7 +977,7 @@ namespace webpp::views {
             }
             context<traits_type>          ctx{*this, &data};
             context_internal<traits_type> context{ctx};
-            render(handler, context);
+            run(handler, context);
         }
 
         template <typename DT = data_type>
@@ -725,10 +989,10 @@ namespace webpp::views {
             if constexpr (istl::cvref_as<DT, data_type>) {
                 context<traits_type>          ctx{*this, &data};
                 context_internal<traits_type> context{ctx};
-                // todo: optimization chance: out::reserve
-                render(
-                  [&]<typename ContentT>(ContentT&& content) {
-                      out += stl::forward<ContentT>(content);
+                out.reserve(out.size() + program.text_size());
+                run(
+                  [&out](string_view_type content) {
+                      out.append(content);
                   },
                   context);
             } else if constexpr (stl::same_as<DT, data_type> || istl::Collection<DT>) {
@@ -928,6 +1192,7 @@ namespace webpp::views {
             if (!error_msg.empty()) {
                 return;
             }
+            program.compile(root_component);
 #undef process_current_text
         }
 
@@ -1004,137 +1269,254 @@ namespace webpp::views {
 
         ////// Renderer
 
+        friend struct mustache_stream<traits_type>;
 
+        using list_type = typename variable_type::list_type;
 
+        // a section that is being rendered
+        struct section_frame {
+            stl::size_t      begin  = 0;       // the index of the section instruction
+            list_type const* list   = nullptr; // the list that its items are being rendered
+            stl::size_t      item   = 0;       // the index of the item of the list
+            bool             pushed = false;   // whether a variable is pushed to the context
+        };
 
+        using frames_type = istl::vector<section_frame, traits_type>;
 
         constexpr string_type render(context_internal<traits_type>& ctx) {
             auto out = object::make_object<string_type>(*this);
-            // todo: optimization chance: out::reserve
-            render(
-              [&]<typename ContentT>(ContentT&& content) {
-                  out += stl::forward<ContentT>(content);
+            out.reserve(program.text_size());
+            run(
+              [&out](string_view_type content) {
+                  out.append(content);
               },
               ctx);
             return out;
         }
 
-        constexpr void render(render_handler const&          handler,
-                              context_internal<traits_type>& ctx,
-                              bool const                     root_renderer = true) {
-            root_component.walk_children([&handler, &ctx, this](component_type& comp) -> walk_control_type {
-                return render_component(handler, ctx, comp);
-            });
-            // process the last line, but only for the top-level renderer
-            if (root_renderer) {
-                render_current_line(handler, ctx.line_buffer, nullptr);
+        [[nodiscard]] constexpr variable_type const* lookup(
+          context<traits_type> const&          ctx,
+          details::mustache_instruction const& ins) const {
+            switch (ins.kind) {
+                using enum details::mustache_name_kind;
+                case self: return ctx.self();
+                case plain: return ctx.get_name(program.text(ins.text));
+                case path: return ctx.get_path(program.path(ins));
             }
+            return nullptr;
         }
 
-        constexpr void render_current_line(
-          render_handler const&           handler,
-          line_buffer_state<traits_type>& line_buffer,
-          component_type const*           comp) const {
-            // We're at the end of a line, so check the line buffer state to see
-            // if the line had tags in it, and also if the line is now empty or
-            // contains whitespace only. if this situation is true, skip the line.
-            if (!line_buffer.contained_section_tag && !line_buffer.is_empty_or_contains_only_whitespace()) {
-                handler(line_buffer.data);
-                if (comp) {
-                    handler(comp->text);
-                }
-            }
-            line_buffer.clear();
-        }
+        // where the program is, so it can be paused and resumed (see mustache_stream)
+        struct run_state {
+            stl::size_t index = 0;
+            frames_type frames;
+            bool        finished = false;
+        };
 
-        constexpr walk_control_type render_component(
-          render_handler const&          handler,
-          context_internal<traits_type>& ctx,
-          component_type&                comp) {
-            if (comp.is_text()) {
-                if (comp.is_newline()) {
-                    render_current_line(handler, ctx.line_buffer, &comp);
-                } else {
-                    ctx.line_buffer.data.append(comp.text);
-                }
-                return walk_control_type::walk;
-            }
+        /**
+         * Run the program; the sections are not rendered recursively, the frames of the sections that are
+         * being rendered are kept in a stack, and the program jumps between their beginnings and ends.
+         * Returns false if it's stopped because of an error.
+         */
+        template <typename EmitT>
+        constexpr bool run(EmitT&&                        emit,
+                           context_internal<traits_type>& ctx,
+                           bool const                     root_renderer = true) {
+            run_state state{.frames = object::make_object<frames_type>(*this)};
+            return run(
+              emit,
+              ctx,
+              state,
+              [] {
+                  return false;
+              },
+              root_renderer);
+        }
 
-            mstch_tag<traits_type> const& tag{comp.tag};
-            variable_type const*          var; // NOLINT(cppcoreguidelines-init-variables)
-            switch (tag.type) {
-                using enum details::tag_type;
-                case variable:
-                case unescaped_variable:
-                    var = ctx.ctx->get(tag.name);
-                    if (var != nullptr) {
-                        if (!render_variable(handler, var, ctx, tag.type == variable)) {
-                            return walk_control_type::stop;
+        /**
+         * Run the program until it's finished, or "pause" asks it to stop; it's only asked at the end of
+         * the lines, and the program continues from the same state the next time it's run.
+         */
+        template <typename EmitT, typename PauseT>
+        constexpr bool run(EmitT&&                        emit,
+                           context_internal<traits_type>& ctx,
+                           run_state&                     state,
+                           PauseT&&                       pause,
+                           bool const                     root_renderer = true) {
+            auto& frames = state.frames;
+            for (auto& index = state.index; index != program.size(); ++index) {
+                auto const& ins = program[index];
+                switch (ins.op) {
+                    using enum details::mustache_opcode;
+                    case text: ctx.line_buffer.data.append(program.text(ins.text)); break;
+                    case newline:
+                        render_current_line(emit, ctx.line_buffer, program.text(ins.text));
+                        if (pause()) {
+                            ++index;
+                            return true;
                         }
-                    }
-                    break;
-                case section_begin:
-                    var = ctx.ctx->get(tag.name);
-                    if (var != nullptr) {
-                        if (auto lambda_var = var->get_if_lambda()) {
-                            if (!render_lambda(handler,
+                        break;
+                    case variable:
+                    case unescaped_variable:
+                        if (auto const* var = lookup(*ctx.ctx, ins);
+                            var != nullptr && !render_variable(emit, var, ctx, ins.op == variable))
+                        {
+                            return unwind(ctx, frames);
+                        }
+                        break;
+                    case section: {
+                        auto const* var = lookup(*ctx.ctx, ins);
+                        if (var == nullptr) {
+                            index = ins.jump;
+                        } else if (auto const* lambda_var = var->get_if_lambda()) {
+                            if (!render_lambda(emit,
                                                *lambda_var,
                                                ctx,
                                                details::render_lambda_escape::optional,
-                                               *comp.tag.section_text,
+                                               program.text(ins.extra),
                                                true))
                             {
-                                return walk_control_type::stop;
+                                return unwind(ctx, frames);
                             }
-                        } else if (!var->is_false()) {
-                            render_section(handler, ctx, comp, var);
+                            index = ins.jump;
+                        } else if (var->is_false()) {
+                            index = ins.jump;
+                        } else {
+                            index = enter_section(ctx, frames, index, var);
                         }
+                        break;
                     }
-                    return walk_control_type::skip;
-                case section_begin_inverted:
-                    var = ctx.ctx->get(tag.name);
-                    if (var == nullptr || var->is_false()) {
-                        render_section(handler, ctx, comp, var);
-                    }
-                    return walk_control_type::skip;
-                case partial:
-                    var = ctx.ctx->get_partial(tag.name);
-                    if (var != nullptr && (var->is_partial() || var->is_string())) {
-                        auto const& partial_result =
-                          var->is_partial() ? var->partial_value()() : var->string_value();
-                        mustache_view tmpl{this->get_traits()};
-                        tmpl.scheme(partial_result);
-                        if (!tmpl.is_valid()) {
-                            error_msg = tmpl.error_message();
+                    case inverted_section: {
+                        auto const* var = lookup(*ctx.ctx, ins);
+                        if (var != nullptr && !var->is_false()) {
+                            index = ins.jump;
                         } else {
-                            tmpl.render(handler, ctx, false);
-                            if (!tmpl.is_valid()) {
-                                error_msg = tmpl.error_message();
-                            }
+                            index = enter_section(ctx, frames, index, var);
                         }
-                        if (!tmpl.is_valid()) {
-                            return walk_control_type::stop;
-                        }
-                    } else {
-                        // todo: add more debugging information here, including:
-                        //  - Partial name
-                        //  - File
-                        //  - Line
-                        //  - Column
-                        this->logger.error(MUSTACHE_CAT,
-                                           "The mustache template requested a partial which we're not able "
-                                           "to find; it's getting ignored.");
+                        break;
                     }
-                    break;
-                case set_delimiter: ctx.delim_set = comp.tag.delim_set; break;
-                default: break;
+                    case section_end: index = leave_section(ctx, frames, index); break;
+                    case partial:
+                        if (!render_partial(emit, ctx, program.text(ins.text))) {
+                            return unwind(ctx, frames);
+                        }
+                        break;
+                    case set_delimiter:
+                        ctx.delim_set.begin = program.text(ins.text);
+                        ctx.delim_set.end   = program.text(ins.extra);
+                        break;
+                }
+            }
+            // process the last line, but only for the top-level renderer
+            if (root_renderer) {
+                render_current_line(emit, ctx.line_buffer, {});
+            }
+            state.finished = true;
+            return true;
+        }
+
+        // returns the index of the instruction before the next one that runs
+        constexpr stl::size_t enter_section(context_internal<traits_type>& ctx,
+                                            frames_type&                   frames,
+                                            stl::size_t const              index,
+                                            variable_type const*           var) {
+            section_frame frame{.begin = index};
+            if (var != nullptr && var->is_non_empty_list()) {
+                auto const& list = var->list_value();
+                if (list.empty()) {
+                    return program[index].jump;
+                }
+                frame.list = &list;
+                var        = &list.front();
+            }
+            // account for the section begin tag
+            ctx.line_buffer.contained_section_tag = true;
+            if (var != nullptr) {
+                ctx.ctx->push(var);
+                frame.pushed = true;
+            }
+            frames.push_back(frame);
+            return index;
+        }
+
+        // returns the index of the instruction before the next one that runs
+        constexpr stl::size_t leave_section(context_internal<traits_type>& ctx,
+                                            frames_type&                   frames,
+                                            stl::size_t const              index) {
+            auto& frame = frames.back();
+            // ctx may have been cleared. account for the section end tag
+            ctx.line_buffer.contained_section_tag = true;
+            if (frame.pushed) {
+                ctx.ctx->pop();
+            }
+            if (frame.list != nullptr && ++frame.item != frame.list->size()) {
+                // the section begin tag of the next item
+                ctx.line_buffer.contained_section_tag = true;
+                ctx.ctx->push(&(*frame.list)[frame.item]);
+                return frame.begin;
+            }
+            frames.pop_back();
+            return index;
+        }
+
+        // pop the variables that the sections have pushed to the context, the context may belong to a parent
+        constexpr bool unwind(context_internal<traits_type>& ctx, frames_type const& frames) {
+            for (auto const& frame : frames) {
+                if (frame.pushed) {
+                    ctx.ctx->pop();
+                }
+            }
+            return false;
+        }
+
+        template <typename EmitT>
+        constexpr void render_current_line(EmitT&&                         emit,
+                                           line_buffer_state<traits_type>& line_buffer,
+                                           string_view_type                newline) const {
+            // We're at the end of a line, so check the line buffer state to see
+            // if the line had tags in it, and also if the line is now empty or
+            // contains whitespace only. if this situation is true, skip the line.
+            if (!line_buffer.contained_section_tag || !line_buffer.is_empty_or_contains_only_whitespace()) {
+                emit(string_view_type{line_buffer.data});
+                if (!newline.empty()) {
+                    emit(newline);
+                }
             }
+            line_buffer.clear();
+        }
 
-            return walk_control_type::walk;
+        template <typename EmitT>
+        constexpr bool render_partial(EmitT&&                        emit,
+                                      context_internal<traits_type>& ctx,
+                                      string_view_type               name) {
+            auto const* var = ctx.ctx->get_partial(name);
+            if (var == nullptr || (!var->is_partial() && !var->is_string())) {
+                // todo: add more debugging information here, including:
+                //  - Partial name
+                //  - File
+                //  - Line
+                //  - Column
+                this->logger.error(MUSTACHE_CAT,
+                                   "The mustache template requested a partial which we're not able "
+                                   "to find; it's getting ignored.");
+                return true;
+            }
+            auto const& partial_result = var->is_partial() ? var->partial_value()() : var->string_value();
+            mustache_view tmpl{this->get_traits()};
+            tmpl.scheme(partial_result);
+            if (tmpl.is_valid()) {
+                tmpl.run(emit, ctx, false);
+            }
+            if (!tmpl.is_valid()) {
+                error_msg = tmpl.error_message();
+                return false;
+            }
+            return true;
         }
 
+        template <typename EmitT>
         constexpr bool render_lambda(
-          render_handler const&          handler,
+          EmitT&&                        emit,
           lambda_type const&             var,
           context_internal<traits_type>& ctx,
           details::render_lambda_escape  escape,
@@ -1176,63 +1558,93 @@ namespace webpp::views {
               typename renderer_type::type{render, get_alloc_for<typename renderer_type::type>(*this)}
             };
             // todo: in original source, the next line wouldn't run if the user is getting a renderer as input
-            render_current_line(handler, ctx.line_buffer, nullptr);
+            render_current_line(emit, ctx.line_buffer, {});
             ctx.line_buffer.data.append(var(text, renderer));
             return error_msg.empty();
         }
 
+        template <typename EmitT>
         constexpr bool render_variable(
-          render_handler const&          handler,
+          EmitT&&                        emit,
           variable_type const*           var,
           context_internal<traits_type>& ctx,
           bool                           escaped) {
             if (auto val_str = var->get_if_string()) {
-                ctx.line_buffer.data.append(escaped ? escaper(*val_str) : *val_str);
+                if (escaped) {
+                    html_escape(*val_str, ctx.line_buffer.data); // escaped while it's appended
+                } else {
+                    ctx.line_buffer.data.append(*val_str);
+                }
             } else if (auto val_lambda = var->get_if_lambda()) {
                 using enum details::render_lambda_escape;
                 details::render_lambda_escape const escape_opt = escaped ? escape : unescape;
-                return render_lambda(handler, *val_lambda, ctx, escape_opt, {}, false);
+                return render_lambda(emit, *val_lambda, ctx, escape_opt, {}, false);
             }
             return true;
         }
+    };
 
-        constexpr void render_section(
-          render_handler const&          handler,
-          context_internal<traits_type>& ctx,
-          component_type&                incomp,
-          variable_type const*           var) {
-            auto const callback = [&handler, &ctx, this](component_type& comp) -> walk_control_type {
-                return render_component(handler, ctx, comp);
-            };
-            if (var && var->is_non_empty_list()) {
-                for (auto const& item : var->list_value()) {
-                    // account for the section begin tag
-                    ctx.line_buffer.contained_section_tag = true;
-
-                    context_pusher<traits_type> const ctxpusher{ctx, &item};
-                    incomp.walk_children(callback);
-
-                    // ctx may have been cleared. account for the section end tag
-                    ctx.line_buffer.contained_section_tag = true;
-                }
-            } else if (var) {
-                // account for the section begin tag
-                ctx.line_buffer.contained_section_tag = true;
-
-                context_pusher<traits_type> const ctxpusher{ctx, var};
-                incomp.walk_children(callback);
+    /**
+     * A mustache view that is rendered piece by piece, while it's being sent for example (see
+     * http::chunked_body); it keeps its own copy of the view and the data, so it doesn't depend on their
+     * lifetime.
+     */
+    template <Traits TraitsType>
+    struct mustache_stream {
+        using traits_type      = TraitsType;
+        using view_type        = mustache_view<traits_type>;
+        using string_type      = typename view_type::string_type;
+        using string_view_type = typename view_type::string_view_type;
+        using data_type        = typename view_type::data_type;
 
-                // ctx may have been cleared. account for the section end tag
-                ctx.line_buffer.contained_section_tag = true;
-            } else {
-                // account for the section begin tag
-                ctx.line_buffer.contained_section_tag = true;
+      private:
+        using run_state   = typename view_type::run_state;
+        using frames_type = typename view_type::frames_type;
 
-                incomp.walk_children(callback);
+        view_type                     view;
+        data_type                     data;
+        context<traits_type>          ctx;
+        context_internal<traits_type> ctx_internal;
+        run_state                     state;
 
-                // ctx may have been cleared. account for the section end tag
-                ctx.line_buffer.contained_section_tag = true;
+      public:
+        constexpr mustache_stream(view_type inp_view, data_type inp_data)
+          : view{stl::move(inp_view)},
+            data{stl::move(inp_data)},
+            ctx{view, &data},
+            ctx_internal{ctx},
+            state{.frames = object::make_object<frames_type>(view), .finished = !view.is_valid()} {}
+
+        // the contexts point to the view and the data
+        mustache_stream(mustache_stream const&)            = delete;
+        mustache_stream(mustache_stream&&)                 = delete;
+        mustache_stream& operator=(mustache_stream const&) = delete;
+        mustache_stream& operator=(mustache_stream&&)      = delete;
+        constexpr ~mustache_stream()                       = default;
+
+        /**
+         * Render the next piece of the view into "out"; it stops at the end of the first line that makes
+         * the output at least "chunk_size" bytes long, or at the end of the view.
+         * @returns false if the whole view is rendered
+         */
+        constexpr bool render(string_type& out, stl::size_t const chunk_size) {
+            if (state.finished) {
+                return false;
+            }
+            auto emit = [&out](string_view_type content) {
+                out.append(content);
+            };
+            auto pause = [&out, chunk_size] {
+                return out.size() >= chunk_size;
+            };
+            if (!view.run(emit, ctx_internal, state, pause)) {
+                state.finished = true; // stopped because of an error
             }
+            return !state.finished;
+        }
+
+        [[nodiscard]] constexpr bool finished() const noexcept {
+            return state.finished;
         }
     };
 
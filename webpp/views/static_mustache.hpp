@@ -0,0 +1,506 @@
+// Created by moisrex on 10/17/26.
+
+#ifndef WEBPP_VIEWS_STATIC_MUSTACHE_HPP
+#define WEBPP_VIEWS_STATIC_MUSTACHE_HPP
+
+#include "../std/algorithm.hpp"
+#include "../std/string_view.hpp"
+#include "../std/utility.hpp"
+#include "../std/vector.hpp"
+#include "../storage/embedded_file.hpp"
+#include "../strings/fixed_string.hpp"
+#include "html.hpp"
+#include "mustache_view.hpp"
+
+#include <array>
+#include <cstdint>
+
+namespace webpp::views {
+
+    namespace details {
+
+        static constexpr stl::size_t no_section = static_cast<stl::size_t>(-1);
+
+        struct static_mustache_instruction {
+            mustache_opcode    op          = mustache_opcode::text;
+            mustache_name_kind kind        = mustache_name_kind::plain;
+            stl::size_t        jump        = 0;          // sections: the index of their ends
+            stl::size_t        parent      = no_section; // the index of the section that it's in
+            stl::size_t        parts_begin = 0;          // the parts of the x.y-like names
+            stl::size_t        parts_count = 0;
+            stl::string_view   text{};                   // the text, or the name
+        };
+
+        // the sizes that a compiled template needs, found by parsing it once
+        struct static_mustache_stats {
+            bool        valid        = true;
+            stl::size_t instructions = 0;
+            stl::size_t parts        = 0;
+            stl::size_t depth        = 0; // the maximum number of the nested sections
+            stl::size_t text_size    = 0;
+        };
+
+        [[nodiscard]] constexpr bool is_mustache_space(char const ch) noexcept {
+            return ch == ' ' || ch == '\t' || ch == '\r' || ch == '\n' || ch == '\v' || ch == '\f';
+        }
+
+        [[nodiscard]] constexpr stl::string_view static_mustache_trim(stl::string_view str) noexcept {
+            while (!str.empty() && is_mustache_space(str.front())) {
+                str.remove_prefix(1);
+            }
+            while (!str.empty() && is_mustache_space(str.back())) {
+                str.remove_suffix(1);
+            }
+            return str;
+        }
+
+        /**
+         * Parse the template at compile-time; it understands the same syntax as mustache_view except for
+         * the partials. The "handler" is called for each instruction with its opcode and text (the sections
+         * ends are checked by the parser).
+         * Returns false if the template is not valid.
+         */
+        template <typename HandlerT>
+        [[nodiscard]] constexpr bool parse_static_mustache(stl::string_view const input, HandlerT&& handler) {
+            using enum mustache_opcode;
+
+            stl::string_view begin_delim = "{{";
+            stl::string_view end_delim   = "}}";
+            stl::size_t      text_start  = 0;
+            stl::size_t      pos         = 0;
+
+            stl::vector<stl::string_view> sections;
+
+            auto const flush_text = [&] {
+                if (pos != text_start) {
+                    handler(text, input.substr(text_start, pos - text_start));
+                }
+            };
+
+            while (pos != input.size()) {
+                if (input[pos] == '\r' || input[pos] == '\n') {
+                    flush_text();
+                    auto const size = input.substr(pos).starts_with("\r\n") ? 2UL : 1UL;
+                    handler(newline, input.substr(pos, size));
+                    pos        += size;
+                    text_start  = pos;
+                    continue;
+                }
+                if (!input.substr(pos).starts_with(begin_delim)) {
+                    ++pos;
+                    continue;
+                }
+                flush_text();
+
+                auto       contents_start = pos + begin_delim.size();
+                bool const is_triple      = begin_delim == "{{" && end_delim == "}}" &&
+                                       contents_start != input.size() && input[contents_start] == '{';
+                stl::string_view const tag_end = is_triple ? "}}}" : end_delim;
+                if (is_triple) {
+                    ++contents_start;
+                }
+                auto const contents_end = input.find(tag_end, contents_start);
+                if (contents_end == stl::string_view::npos) {
+                    return false; // unclosed tag
+                }
+                auto const contents =
+                  static_mustache_trim(input.substr(contents_start, contents_end - contents_start));
+                pos        = contents_end + tag_end.size();
+                text_start = pos;
+
+                if (is_triple) {
+                    handler(unescaped_variable, contents);
+                    continue;
+                }
+                if (contents.empty()) {
+                    handler(variable, contents);
+                    continue;
+                }
+                auto const name = static_mustache_trim(contents.substr(1));
+                switch (contents.front()) {
+                    case '#':
+                        sections.push_back(name);
+                        handler(section, name);
+                        break;
+                    case '^':
+                        sections.push_back(name);
+                        handler(inverted_section, name);
+                        break;
+                    case '/':
+                        if (sections.empty() || sections.back() != name) {
+                            return false; // unopened section
+                        }
+                        sections.pop_back();
+                        handler(section_end, name);
+                        break;
+                    case '&': handler(unescaped_variable, name); break;
+                    case '!': break;
+                    case '>': return false; // the partials are rendered at run-time
+                    case '=': {
+                        // "=<% %>=", the delimiters may not contain whitespace or the equals sign
+                        if (contents.size() < 5 || contents.back() != '=') {
+                            return false;
+                        }
+                        auto const delims = static_mustache_trim(contents.substr(1, contents.size() - 2));
+                        auto const space  = delims.find(' ');
+                        if (space == stl::string_view::npos) {
+                            return false;
+                        }
+                        begin_delim = delims.substr(0, space);
+                        end_delim   = static_mustache_trim(delims.substr(space));
+                        if (begin_delim.find('=') != stl::string_view::npos ||
+                            end_delim.find_first_of("= \t") != stl::string_view::npos)
+                        {
+                            return false;
+                        }
+                        break;
+                    }
+                    default: handler(variable, contents); break;
+                }
+            }
+            flush_text();
+            return sections.empty(); // unclosed sections
+        }
+
+        [[nodiscard]] constexpr stl::size_t static_mustache_part_count(stl::string_view const name) noexcept {
+            if (name.size() == 1 && name.front() == '.') {
+                return 0;
+            }
+            auto const count = static_cast<stl::size_t>(stl::count(name.begin(), name.end(), '.'));
+            return count == 0 ? 0 : count + 1;
+        }
+
+        [[nodiscard]] constexpr static_mustache_stats stats_of_static_mustache(stl::string_view const input) {
+            static_mustache_stats stats;
+            stl::size_t           depth = 0;
+            stats.valid                 = parse_static_mustache(input, [&](mustache_opcode op, auto str) {
+                using enum mustache_opcode;
+                ++stats.instructions;
+                switch (op) {
+                    case text:
+                    case newline: stats.text_size += str.size(); break;
+                    case section:
+                    case inverted_section:
+                        stats.depth  = stl::max(stats.depth, ++depth);
+                        stats.parts += static_mustache_part_count(str);
+                        break;
+                    case section_end: --depth; break;
+                    default: stats.parts += static_mustache_part_count(str); break;
+                }
+            });
+            return stats;
+        }
+
+        template <stl::size_t InstructionCount, stl::size_t PartCount>
+        struct static_mustache_program {
+            stl::array<static_mustache_instruction, InstructionCount> instructions{};
+            stl::array<stl::string_view, PartCount>                   parts{};
+        };
+
+        template <stl::size_t InstructionCount, stl::size_t PartCount>
+        [[nodiscard]] constexpr auto compile_static_mustache(stl::string_view const input) {
+            static_mustache_program<InstructionCount, PartCount> program;
+
+            stl::size_t              count      = 0;
+            stl::size_t              part_count = 0;
+            stl::vector<stl::size_t> sections;
+            static_cast<void>(parse_static_mustache(input, [&](mustache_opcode op, stl::string_view str) {
+                using enum mustache_opcode;
+                auto& ins  = program.instructions[count];
+                ins.op     = op;
+                ins.text   = str;
+                ins.parent = sections.empty() ? no_section : sections.back();
+                switch (op) {
+                    case text:
+                    case newline: break;
+                    case section_end:
+                        ins.jump                                   = sections.back();
+                        program.instructions[sections.back()].jump = count;
+                        sections.pop_back();
+                        break;
+                    default:
+                        if (str.size() == 1 && str.front() == '.') {
+                            ins.kind = mustache_name_kind::self;
+                        } else if (str.find('.') != stl::string_view::npos) {
+                            ins.kind        = mustache_name_kind::path;
+                            ins.parts_begin = part_count;
+                            for (auto dot = str.find('.'); dot != stl::string_view::npos; dot = str.find('.')) {
+                                program.parts[part_count++] = str.substr(0, dot);
+                                str.remove_prefix(dot + 1);
+                            }
+                            program.parts[part_count++] = str;
+                            ins.parts_count             = part_count - ins.parts_begin;
+                        }
+                        if (op == section || op == inverted_section) {
+                            sections.push_back(count);
+                        }
+                        break;
+                }
+                ++count;
+            }));
+            return program;
+        }
+
+#ifdef WEBPP_STRING_IS_UTF8
+        // fixed_string has decoded the UTF-8 string literals to code points
+        static constexpr bool fixed_string_is_decoded = true;
+#else
+        // fixed_string holds the bytes of the string literals
+        static constexpr bool fixed_string_is_decoded = false;
+#endif
+
+        // the length of the string when it's encoded in UTF-8
+        template <typename StrT>
+        [[nodiscard]] constexpr stl::size_t utf8_length_of(StrT const& str) noexcept {
+            if constexpr (!fixed_string_is_decoded) {
+                return str.size();
+            } else {
+                stl::size_t length = 0;
+                for (auto const code_point : str) {
+                    auto const value = static_cast<stl::uint32_t>(code_point);
+                    length += value < 0x80U ? 1 : value < 0x800U ? 2 : value < 0x1'0000U ? 3 : 4;
+                }
+                return length;
+            }
+        }
+
+    } // namespace details
+
+    /**
+     * A scheme that is a string literal:
+     *   static_mustache<fixed_scheme<"Hello, {{name}}">>
+     */
+    template <fixed_string Scheme>
+    struct fixed_scheme {
+      private:
+        static constexpr auto chars = [] {
+            // NOLINTBEGIN(*-magic-numbers)
+            stl::array<char, details::utf8_length_of(Scheme)> out{};
+            stl::size_t                                        pos = 0;
+            for (auto const code_point : Scheme) {
+                auto const value = static_cast<stl::uint32_t>(code_point);
+                if (!details::fixed_string_is_decoded || value < 0x80U) {
+                    out[pos++] = static_cast<char>(value);
+                } else if (value < 0x800U) {
+                    out[pos++] = static_cast<char>(0xC0U | (value >> 6U));
+                    out[pos++] = static_cast<char>(0x80U | (value & 0x3FU));
+                } else if (value < 0x1'0000U) {
+                    out[pos++] = static_cast<char>(0xE0U | (value >> 12U));
+                    out[pos++] = static_cast<char>(0x80U | ((value >> 6U) & 0x3FU));
+                    out[pos++] = static_cast<char>(0x80U | (value & 0x3FU));
+                } else {
+                    out[pos++] = static_cast<char>(0xF0U | (value >> 18U));
+                    out[pos++] = static_cast<char>(0x80U | ((value >> 12U) & 0x3FU));
+                    out[pos++] = static_cast<char>(0x80U | ((value >> 6U) & 0x3FU));
+                    out[pos++] = static_cast<char>(0x80U | (value & 0x3FU));
+                }
+            }
+            return out;
+            // NOLINTEND(*-magic-numbers)
+        }();
+
+      public:
+        static constexpr stl::string_view value{chars.data(), chars.size()};
+    };
+
+    /**
+     * A scheme that is embedded on build-time (see embedded_file):
+     *   static_mustache<embedded_scheme<"hello.mustache">>
+     */
+    template <fixed_string Path>
+    struct embedded_scheme {
+        static constexpr auto file = embedded_file::search(fixed_scheme<Path>::value);
+
+        static_assert(file.has_value(), "The specified mustache file is not embedded.");
+
+        static constexpr stl::string_view value = file->content();
+    };
+
+    /**
+     * Static Mustache View
+     *
+     * The template ("SchemeT::value") is parsed and compiled at compile-time, and the renderer is generated
+     * for its instructions: the literal texts are constants, the names of the variables are resolved (and
+     * the x.y-like names are split), and the sections are nested function calls, so rendering doesn't
+     * parse anything, and it doesn't allocate anything other than the output.
+     *
+     * It renders the same data as mustache_view, the same way; except that the partials are not supported
+     * (a template that has a partial doesn't compile), and the lambdas are not called.
+     */
+    template <typename SchemeT, Traits TraitsType = default_traits>
+    struct static_mustache {
+        using traits_type      = TraitsType;
+        using string_type      = traits::string<traits_type>;
+        using string_view_type = traits::string_view<traits_type>;
+        using mustache_type    = mustache_view<traits_type>;
+        using data_type        = typename mustache_type::data_type;
+        using variable_type    = typename mustache_type::variable_type;
+
+        static constexpr stl::string_view scheme = SchemeT::value;
+
+      private:
+        static constexpr auto stats = details::stats_of_static_mustache(scheme);
+
+        static_assert(stats.valid, "The mustache template is not valid, or it has partials.");
+
+        static constexpr auto program =
+          details::compile_static_mustache<stats.instructions, stats.parts>(scheme);
+
+        struct state {
+            string_type&                                   out;
+            data_type const&                               data;
+            stl::array<variable_type const*, stats.depth> stack{}; // the variables that the sections pushed
+            stl::size_t                                    depth      = 0;
+            stl::size_t                                    line_start = 0;
+            bool                                           contained_section_tag = false;
+
+            [[nodiscard]] constexpr bool is_line_empty_or_contains_only_whitespace() const noexcept {
+                for (auto const cur_char : string_view_type{out}.substr(line_start)) {
+                    if (cur_char != ' ' && cur_char != '\t') {
+                        return false;
+                    }
+                }
+                return true;
+            }
+
+            // the same as what mustache_view does with its line buffer: the lines that only have section
+            // tags and whitespaces are removed
+            constexpr void end_line(string_view_type const newline) {
+                if (!contained_section_tag || !is_line_empty_or_contains_only_whitespace()) {
+                    out.append(newline);
+                } else {
+                    out.resize(line_start);
+                }
+                line_start            = out.size();
+                contained_section_tag = false;
+            }
+
+            template <typename GetT>
+            [[nodiscard]] constexpr variable_type const* find(GetT&& get) const {
+                for (auto index = depth; index-- != 0;) {
+                    if (auto const* var = get(*stack[index])) {
+                        return var;
+                    }
+                }
+                for (auto const& item : data) {
+                    if (auto const* var = get(item)) {
+                        return var;
+                    }
+                }
+                return nullptr;
+            }
+        };
+
+        template <stl::size_t Index>
+        [[nodiscard]] static constexpr variable_type const* lookup(state const& st) {
+            constexpr auto const& ins = program.instructions[Index];
+            if constexpr (ins.kind == details::mustache_name_kind::self) {
+                if (st.depth != 0) {
+                    return st.stack[st.depth - 1];
+                }
+                return st.data.empty() ? nullptr : &st.data.front();
+            } else if constexpr (ins.kind == details::mustache_name_kind::plain) {
+                return st.find([](variable_type const& item) {
+                    return item.get(ins.text);
+                });
+            } else {
+                return st.find([](variable_type const& item) {
+                    auto const* var = &item;
+                    for (stl::size_t index = 0; index != ins.parts_count && var != nullptr; ++index) {
+                        var = var->get(program.parts[ins.parts_begin + index]);
+                    }
+                    return var;
+                });
+            }
+        }
+
+        template <stl::size_t Index>
+        static constexpr void render_section(state& st, variable_type const* var) {
+            if (var != nullptr && var->is_non_empty_list()) {
+                for (auto const& item : var->list_value()) {
+                    render_section_with<Index>(st, &item);
+                }
+            } else {
+                render_section_with<Index>(st, var);
+            }
+        }
+
+        template <stl::size_t Index>
+        static constexpr void render_section_with(state& st, variable_type const* var) {
+            // account for the section begin tag
+            st.contained_section_tag = true;
+            if (var != nullptr) {
+                st.stack[st.depth++] = var;
+            }
+            render_range<Index, Index + 1, program.instructions[Index].jump>(st);
+            // account for the section end tag
+            st.contained_section_tag = true;
+            if (var != nullptr) {
+                --st.depth;
+            }
+        }
+
+        template <stl::size_t Index>
+        static constexpr void render_instruction(state& st) {
+            using enum details::mustache_opcode;
+            constexpr auto const& ins = program.instructions[Index];
+            if constexpr (ins.op == text) {
+                st.out.append(ins.text);
+            } else if constexpr (ins.op == newline) {
+                st.end_line(ins.text);
+            } else if constexpr (ins.op == variable || ins.op == unescaped_variable) {
+                auto const* var = lookup<Index>(st);
+                if (var != nullptr && var->is_string()) {
+                    if constexpr (ins.op == variable) {
+                        html_escape(var->string_value(), st.out);
+                    } else {
+                        st.out.append(var->string_value());
+                    }
+                }
+            } else if constexpr (ins.op == section) {
+                auto const* var = lookup<Index>(st);
+                if (var != nullptr && !var->is_false()) {
+                    render_section<Index>(st, var);
+                }
+            } else if constexpr (ins.op == inverted_section) {
+                auto const* var = lookup<Index>(st);
+                if (var == nullptr || var->is_false()) {
+                    render_section<Index>(st, var);
+                }
+            }
+        }
+
+        // render the instructions of the specified section that are in the range
+        template <stl::size_t Parent, stl::size_t Begin, stl::size_t End>
+        static constexpr void render_range(state& st) {
+            [&st]<stl::size_t... I>(stl::index_sequence<I...>) {
+                (
+                  [&st] {
+                      if constexpr (program.instructions[Begin + I].parent == Parent) {
+                          render_instruction<Begin + I>(st);
+                      }
+                  }(),
+                  ...);
+            }(stl::make_index_sequence<End - Begin>{});
+        }
+
+      public:
+        /// The size of the literal texts of the template
+        [[nodiscard]] static constexpr stl::size_t text_size() noexcept {
+            return stats.text_size;
+        }
+
+        static constexpr void render(string_type& out, data_type const& data) {
+            out.reserve(out.size() + stats.text_size);
+            state st{.out = out, .data = data, .line_start = out.size()};
+            render_range<details::no_section, 0, stats.instructions>(st);
+            // process the last line
+            if (st.contained_section_tag && st.is_line_empty_or_contains_only_whitespace()) {
+                out.resize(st.line_start);
+            }
+        }
+    };
+
+} // namespace webpp::views
+
+#endif // WEBPP_VIEWS_STATIC_MUSTACHE_HPP
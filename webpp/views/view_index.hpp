@@ -0,0 +1,369 @@
+// Created by moisrex on 10/17/26.
+
+#ifndef WEBPP_VIEWS_VIEW_INDEX_HPP
+#define WEBPP_VIEWS_VIEW_INDEX_HPP
+
+#include "../std/algorithm.hpp"
+#include "../std/chrono.hpp"
+#include "../std/format.hpp"
+#include "../std/span.hpp"
+#include "../std/string.hpp"
+#include "../std/string_view.hpp"
+#include "../std/unordered_map.hpp"
+#include "../std/vector.hpp"
+#include "../traits/enable_traits.hpp"
+
+#include <filesystem>
+#include <system_error>
+
+#ifdef __linux__
+#    include <cerrno>
+#    include <cstring>
+#    include <sys/inotify.h>
+#    include <unistd.h>
+#endif
+
+namespace webpp::views {
+
+    /**
+     * The files of the view roots, indexed by the names that the views are requested with
+     *
+     * The roots are walked once, and each file is indexed by:
+     *   - its path relative to its root ("layout/header.mustache")
+     *   - the same path without one of the valid extensions ("layout/header")
+     *   - its stem, for the recursive requests ("*header")
+     * so finding a view is a hash lookup, instead of checking the files of each root on every request.
+     * When more than one file has the same name, the one that would be found first by checking the roots in
+     * order wins (the exact names before the ones without extensions in each root).
+     *
+     * The index is kept fresh on "refresh", which does its job at most once every "refresh_interval":
+     *   - on Linux, the directories are watched by inotify; "refresh" reads the events (without blocking),
+     *     re-indexes the files if any file is created, removed, or renamed, and reports the changed files
+     *   - on the other platforms, it walks the roots again and reports the files whose modification times
+     *     have changed
+     */
+    template <Traits TraitsType>
+    struct view_index : enable_traits<TraitsType> {
+        using etraits          = enable_traits<TraitsType>;
+        using traits_type      = TraitsType;
+        using string_type      = traits::string<traits_type>;
+        using string_view_type = traits::string_view<traits_type>;
+        using path_type        = stl::filesystem::path;
+        using clock_type       = stl::chrono::steady_clock;
+        using extensions_type  = stl::span<string_view_type const>;
+
+        static constexpr auto logging_category = "ViewIndex";
+
+        // NOLINTBEGIN(cppcoreguidelines-non-private-member-variables-in-classes)
+        stl::chrono::milliseconds refresh_interval{stl::chrono::seconds{1}};
+
+        // NOLINTEND(cppcoreguidelines-non-private-member-variables-in-classes)
+
+      private:
+        struct name_hash {
+            using is_transparent = void;
+
+            [[nodiscard]] stl::size_t operator()(string_view_type const name) const noexcept {
+                return stl::hash<string_view_type>{}(name);
+            }
+        };
+
+        struct located_file {
+            path_type   file;
+            stl::size_t rank = 0; // the lower one wins; it's the order that the roots are checked in
+        };
+
+        // the names can be found by their views
+        template <typename V>
+        using map_of =
+          stl::unordered_map<string_type,
+                             V,
+                             name_hash,
+                             stl::equal_to<>,
+                             traits::allocator_type_of<traits_type, stl::pair<string_type const, V>>>;
+
+        using names_type = map_of<located_file>;
+        using stems_type = map_of<path_type>;
+        using times_type = map_of<stl::filesystem::file_time_type>;
+        using roots_type = stl::vector<path_type, traits::allocator_type_of<traits_type, path_type>>;
+#ifdef __linux__
+        using watches_type =
+          stl::unordered_map<int,
+                             path_type,
+                             stl::hash<int>,
+                             stl::equal_to<int>,
+                             traits::allocator_type_of<traits_type, stl::pair<int const, path_type>>>;
+
+        int          inotify_fd = -1;
+        watches_type watches; // watch descriptor -> the directory
+#endif
+
+        extensions_type        extensions;
+        names_type             names;
+        stems_type             stems;
+        times_type             times; // the modification times of the files, by their paths
+        roots_type             roots; // the roots that are indexed
+        clock_type::time_point next_refresh{};
+        bool                   is_built = false;
+
+        void watch([[maybe_unused]] path_type const& dir) noexcept {
+#ifdef __linux__
+            if (inotify_fd < 0) {
+                return;
+            }
+            static constexpr stl::uint32_t events = IN_CREATE | IN_DELETE | IN_MOVED_FROM | IN_MOVED_TO |
+                                                    IN_CLOSE_WRITE | IN_DELETE_SELF | IN_MOVE_SELF;
+            int const wd = ::inotify_add_watch(inotify_fd, dir.c_str(), events);
+            if (wd < 0) {
+                this->logger.error(logging_category,
+                                   fmt::format("Cannot watch directory {}", dir.string()),
+                                   stl::error_code{errno, stl::system_category()});
+                return;
+            }
+            watches.insert_or_assign(wd, dir);
+#endif
+        }
+
+        void unwatch() noexcept {
+#ifdef __linux__
+            if (inotify_fd >= 0) {
+                ::close(inotify_fd);
+            }
+            watches.clear();
+            inotify_fd = ::inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+            if (inotify_fd < 0) {
+                this->logger.error(logging_category,
+                                   "Cannot watch the view roots, they're checked periodically instead.",
+                                   stl::error_code{errno, stl::system_category()});
+            }
+#endif
+        }
+
+        [[nodiscard]] string_type make_string(string_view_type const str) const {
+            return string_type{str, get_alloc_for<string_type>(*this)};
+        }
+
+        void add_name(string_view_type const name, path_type const& file, stl::size_t const rank) {
+            auto const pos = names.find(name);
+            if (pos == names.end()) {
+                names.emplace(make_string(name), located_file{file, rank});
+            } else if (rank < pos->second.rank) {
+                pos->second = located_file{file, rank};
+            }
+        }
+
+        void add_file(path_type const& root, path_type const& file, stl::size_t const root_index) {
+            auto const rel = file.lexically_relative(root).generic_string();
+            add_name(rel, file, root_index * 2);
+            for (string_view_type const ext : extensions) {
+                if (rel.size() > ext.size() && string_view_type{rel}.ends_with(ext)) {
+                    auto const name = string_view_type{rel}.substr(0, rel.size() - ext.size());
+                    add_name(name, file, root_index * 2 + 1);
+                }
+            }
+            auto const stem = file.stem().string();
+            if (!stems.contains(string_view_type{stem})) {
+                stems.emplace(make_string(stem), file);
+            }
+        }
+
+        // walk the roots, and index their files
+        template <typename RootsT>
+        void build(RootsT const& inp_roots) {
+            namespace fs = stl::filesystem;
+
+            names.clear();
+            stems.clear();
+            times.clear();
+            roots.assign(inp_roots.begin(), inp_roots.end());
+            unwatch();
+            is_built = true;
+
+            stl::error_code ec;
+            for (stl::size_t root_index = 0; root_index != roots.size(); ++root_index) {
+                auto const& root = roots[root_index];
+                if (!fs::is_directory(root, ec)) {
+                    continue;
+                }
+                watch(root);
+                fs::recursive_directory_iterator iter{root,
+                                                      fs::directory_options::skip_permission_denied,
+                                                      ec};
+                if (ec) {
+                    this->logger.error(logging_category,
+                                       fmt::format("Cannot read dir {}", root.string()),
+                                       ec);
+                    continue;
+                }
+                for (; iter != fs::recursive_directory_iterator{}; iter.increment(ec)) {
+                    if (ec) {
+                        this->logger.error(logging_category,
+                                           fmt::format("Cannot traverse directory {}", root.string()),
+                                           ec);
+                        break;
+                    }
+                    auto const& entry = *iter;
+                    if (entry.is_directory(ec)) {
+                        watch(entry.path());
+                        continue;
+                    }
+                    if (!entry.is_regular_file(ec)) {
+                        continue;
+                    }
+                    add_file(root, entry.path(), root_index);
+                    times.insert_or_assign(make_string(entry.path().string()), entry.last_write_time(ec));
+                }
+            }
+        }
+
+        // the files that have changed since the last build
+        template <typename RootsT, typename Callable>
+        void rebuild(RootsT const& inp_roots, Callable& on_change) {
+            auto old_times = stl::move(times);
+            build(inp_roots);
+            for (auto const& [file, time] : old_times) {
+                if (auto const pos = times.find(file); pos == times.end() || pos->second != time) {
+                    on_change(path_type{file});
+                }
+            }
+        }
+
+#ifdef __linux__
+        // read the events of the watched directories; returns true if the files should be indexed again
+        template <typename Callable>
+        [[nodiscard]] bool read_events(Callable& on_change) {
+            bool reindex = false;
+            alignas(inotify_event) char buf[4096]; // NOLINT(*-avoid-c-arrays)
+            for (;;) {
+                auto const len = ::read(inotify_fd, buf, sizeof(buf));
+                if (len <= 0) {
+                    break;
+                }
+                for (char const* ptr = buf; ptr < buf + len;) {
+                    inotify_event event; // NOLINT(cppcoreguidelines-pro-type-member-init)
+                    stl::memcpy(&event, ptr, sizeof(inotify_event));
+                    char const* const name = ptr + sizeof(inotify_event);
+                    ptr += sizeof(inotify_event) + event.len;
+                    if ((event.mask & IN_Q_OVERFLOW) != 0) {
+                        return true; // we don't know what has changed
+                    }
+                    auto const dir = watches.find(event.wd);
+                    if (dir == watches.end()) {
+                        continue;
+                    }
+                    if ((event.mask & (IN_CLOSE_WRITE | IN_IGNORED)) == 0) {
+                        reindex = true; // created, removed, or renamed
+                    }
+                    if (event.len != 0) {
+                        on_change(dir->second / name);
+                    }
+                }
+            }
+            return reindex;
+        }
+#endif
+
+      public:
+        // NOLINTBEGIN(bugprone-forwarding-reference-overload)
+        template <EnabledTraits ET>
+            requires(!stl::same_as<stl::remove_cvref_t<ET>, view_index>)
+        explicit view_index(ET&& et, extensions_type const inp_extensions)
+          : etraits{et},
+            extensions{inp_extensions},
+            names{get_alloc_for<names_type>(*this)},
+            stems{get_alloc_for<stems_type>(*this)},
+            times{get_alloc_for<times_type>(*this)},
+            roots{get_alloc_for<roots_type>(*this)} {}
+
+        // NOLINTEND(bugprone-forwarding-reference-overload)
+
+        // the inotify file descriptor is owned
+        view_index(view_index&& other) noexcept
+          : etraits{stl::move(other)},
+            refresh_interval{other.refresh_interval},
+#ifdef __linux__
+            inotify_fd{stl::exchange(other.inotify_fd, -1)},
+            watches{stl::move(other.watches)},
+#endif
+            extensions{other.extensions},
+            names{stl::move(other.names)},
+            stems{stl::move(other.stems)},
+            times{stl::move(other.times)},
+            roots{stl::move(other.roots)},
+            next_refresh{other.next_refresh},
+            is_built{stl::exchange(other.is_built, false)} {}
+
+        view_index(view_index const&)            = delete;
+        view_index& operator=(view_index const&) = delete;
+        view_index& operator=(view_index&&)      = delete;
+
+        ~view_index() {
+#ifdef __linux__
+            if (inotify_fd >= 0) {
+                ::close(inotify_fd);
+            }
+#endif
+        }
+
+        /**
+         * Make sure the index is of the specified roots, and it's fresh; the callback is called with the path
+         * of each file that has changed since the last refresh.
+         */
+        template <typename RootsT, typename Callable>
+        void refresh(RootsT const& inp_roots, Callable&& on_change) {
+            auto const now = clock_type::now();
+            if (is_built && inp_roots.size() == roots.size() && now < next_refresh) {
+                return;
+            }
+            next_refresh = now + refresh_interval;
+            if (!is_built || !stl::equal(inp_roots.begin(), inp_roots.end(), roots.begin(), roots.end())) {
+                rebuild(inp_roots, on_change);
+                return;
+            }
+#ifdef __linux__
+            if (inotify_fd >= 0) {
+                if (read_events(on_change)) {
+                    rebuild(inp_roots, on_change);
+                }
+                return;
+            }
+#endif
+            rebuild(inp_roots, on_change);
+        }
+
+        /// Index the roots again on the next refresh
+        void invalidate() noexcept {
+            is_built = false;
+        }
+
+        /**
+         * Find the file that the view name refers to
+         *
+         * @param request the name of the view, relative to the roots ("layout/header")
+         * @param recursive find it by its stem, in all the sub-directories ("*header" requests)
+         */
+        [[nodiscard]] path_type const* find(string_view_type request, bool const recursive) const {
+            if (recursive) {
+                auto const pos = stems.find(request);
+                return pos == stems.end() ? nullptr : &pos->second;
+            }
+            if (request.starts_with("./") || request.find("/.") != string_view_type::npos ||
+                request.find("//") != string_view_type::npos || request.ends_with('/'))
+            {
+                auto const normal = path_type{request}.lexically_normal().generic_string();
+                auto const pos    = names.find(string_view_type{normal});
+                return pos == names.end() ? nullptr : &pos->second.file;
+            }
+            auto const pos = names.find(request);
+            return pos == names.end() ? nullptr : &pos->second.file;
+        }
+
+        /// Number of the indexed names
+        [[nodiscard]] stl::size_t size() const noexcept {
+            return names.size();
+        }
+    };
+
+} // namespace webpp::views
+
+#endif // WEBPP_VIEWS_VIEW_INDEX_HPP
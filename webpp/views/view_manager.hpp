@@ -3,8 +3,10 @@
 #ifndef WEBPP_VIEW_MANAGER_HPP
 #define WEBPP_VIEW_MANAGER_HPP
 
+#include "../http/bodies/chunked.hpp"
 #include "../http/http_concepts.hpp"
 #include "../std/format.hpp"
+#include "../std/map.hpp"
 #include "../std/string.hpp"
 #include "../storage/file.hpp"
 #include "../storage/lru_cache.hpp"
@@ -15,6 +17,7 @@
 #include "file_view.hpp"
 #include "json_view.hpp"
 #include "mustache_view.hpp"
+#include "view_index.hpp"
 
 #include <filesystem>
 #include <fstream>
@@ -42,6 +45,7 @@ namespace webpp::views {
         using mustache_view_type = mustache_view<traits_type>;
         using json_view_type     = json_view<traits_type>;
         using file_view_type     = file_view<traits_type>;
+        using chunked_body_type  = http::chunked_body<traits_type>;
 
         static constexpr stl::size_t default_cache_limit = 100u;
         static constexpr auto        logging_category    = "ViewMan";
@@ -55,11 +59,18 @@ namespace webpp::views {
         // using json_data_type = typename json_view_type::data_type;
         using file_data_type     = typename file_view_type::data_type;
         using cache_type         = lru_cache<traits_type, path_type, view_types, memory_gate<null_gate>>;
+        using view_index_type    = view_index<traits_type>;
+
+        // the templates that are compiled on compile-time (see static_mustache)
+        using precompiled_renderer = void (*)(string_type&, mustache_data_type const&);
+        using precompiled_type     = istl::map<traits_type, string_type, precompiled_renderer, stl::less<>>;
 
         static constexpr stl::array<string_view_type, 1> valid_extensions{".mustache"};
 
 
-        cache_type cached_views;
+        cache_type       cached_views;
+        view_index_type  view_files; // where the views are
+        precompiled_type precompiled_views;
 
 
       public:
@@ -74,6 +85,8 @@ namespace webpp::views {
           stl::size_t cache_limit = default_cache_limit) noexcept
           : etraits{et},
             cached_views{et, cache_limit},
+            view_files{et, valid_extensions},
+            precompiled_views{get_alloc_for<precompiled_type>(*this)},
             view_roots{get_alloc_for<view_roots_type>(*this)} {}
 
 
@@ -86,6 +99,9 @@ namespace webpp::views {
          *   - Variables Support
          *   - Recursive finder: Add '*' at the start, and then let us recursively search for it
          *
+         * The files of the view roots are indexed (see view_index), so it doesn't check the file system on
+         * every request; the index is refreshed at most once per second (inotify, where it's available).
+         *
          * Possible syntax:
          *   - [ ] /absolute/path/to/file.json
          *   - [ ] file_in_one_of_the_root_dirs.json
@@ -93,13 +109,12 @@ namespace webpp::views {
          *   - [ ] layout/header
          *   - [ ] *header.html
          */
-        [[nodiscard]] stl::optional<path_type> find_file(stl::string_view request) const noexcept {
+        [[nodiscard]] stl::optional<path_type> find_file(stl::string_view request) noexcept {
             namespace fs = stl::filesystem;
 
-            stl::error_code ec;
-
             // an absolute path should
             if (request.starts_with('/')) {
+                stl::error_code ec;
                 path_type const file{request};
                 if (!fs::is_regular_file(file, ec)) {
                     if (ec) {
@@ -118,96 +133,13 @@ namespace webpp::views {
                 request.remove_prefix(1);
             }
 
-            // traverse the root directories
-            for (path_type dir : view_roots) {
-                fs::file_status status = fs::status(dir, ec);
-                if (ec && !fs::status_known(status)) {
-                    this->logger.error(logging_category,
-                                       fmt::format("Cannot check directory status of {}", dir.string()),
-                                       ec);
-                    continue;
-                }
-
-                // make sure the path is a directory
-                if (!fs::is_directory(status)) {
-                    continue;
-                }
-
-                if (recursive_search) {
-                    fs::recursive_directory_iterator const iter(dir, ec);
-                    if (ec) {
-                        this->logger.error(logging_category,
-                                           fmt::format("Cannot read dir {}", dir.string()),
-                                           ec);
-                        continue;
-                    }
-                    fs::recursive_directory_iterator       it     = fs::begin(iter);
-                    fs::recursive_directory_iterator const it_end = fs::end(iter);
-                    for (; it != it_end; it.increment(ec)) {
-                        if (ec) {
-                            this->logger.error(logging_category,
-                                               fmt::format("Cannot traverse directory {}", dir.string()),
-                                               ec);
-                            continue;
-                        }
-                        path_type const file      = *it;
-                        auto const      file_stem = file.stem();
-                        if (file_stem == request) {
-                            goto found_it;
-                        }
-                        // The user may have omitted the extension, we are searching for them
-                        for (string_view_type ext : valid_extensions) {
-                            auto new_file = file;
-                            new_file.concat(ext.begin(), ext.end()); // append the extension
-
-                            if (file_stem == new_file) {
-                                goto found_it;
-                            }
-                        }
-
-                        // did not find it
-                        continue;
-                    found_it:
-                        status = fs::status(file, ec);
-                        if (fs::is_regular_file(status)) {
-                            return file;
-                        } else if (ec && !fs::status_known(status)) {
-                            this->logger.error(logging_category,
-                                               fmt::format("Cannot check file type of {}", dir.string()),
-                                               ec);
-                        }
-                    }
-                } else { // non-recursive normal path appending
-                    dir.append(request.begin(), request.end());
-                    status = fs::status(dir, ec);
-                    if (fs::exists(status)) {
-                        return dir;
-                    } else if (ec && !fs::status_known(status)) {
-                        this->logger.error(logging_category,
-                                           fmt::format("Cannot check file type of {}", dir.string()),
-                                           ec);
-                        // no need to "continue"
-                    }
-
-
-                    // The user may have omitted the extension, we are searching for them
-                    for (string_view_type ext : valid_extensions) {
-                        auto file = dir;
-                        file.concat(ext.begin(), ext.end()); // append the extension
-
-                        status = fs::status(file, ec);
-                        if (fs::exists(status)) {
-                            return file;
-                        }
-                        if (ec && !fs::status_known(status)) {
-                            this->logger.error(logging_category,
-                                               fmt::format("Cannot check file type of {}", dir.string()),
-                                               ec);
-                        }
-                    }
-                }
+            // the changed files are parsed again the next time they're rendered
+            view_files.refresh(view_roots, [this](path_type const& file) {
+                cached_views.erase(file);
+            });
+            if (auto const* file = view_files.find(request, recursive_search); file != nullptr) {
+                return *file;
             }
-
             return stl::nullopt;
         }
 
@@ -230,26 +162,54 @@ namespace webpp::views {
             return cached_views.emplace_get_ptr(file, default_view);
         }
 
-        template <typename ViewType, typename OutT, typename... DataType>
-        constexpr void view_to(OutT& out, path_type const& file, DataType&&... data) {
-            using view_type = ViewType;
-            auto* cached    = get_view<view_type>(file);
-            auto& view      = stl::get<view_type>(*cached);
+        // Get the view of the file from the cache, and parse it if it's not parsed yet
+        template <typename ViewType>
+        [[nodiscard]] ViewType* load_view(path_type const& file) {
+            auto* cached = get_view<ViewType>(file);
+            auto& view   = stl::get<ViewType>(*cached);
             if (!view.has_scheme()) {
                 auto file_content = object::make_object<string_type>(*this);
                 if (!read_file(file, file_content)) {
-                    return; // We weren't able to read the file.
+                    return nullptr; // We weren't able to read the file.
                 }
                 view.scheme(file_content);
                 // since we got a pointer, we don't need to save it the cache again
             }
+            return &view;
+        }
 
-            // Render the view based on the data that passed to us
-            view.render(out, stl::forward<DataType>(data)...);
+        template <typename ViewType, typename OutT, typename... DataType>
+        constexpr void view_to(OutT& out, path_type const& file, DataType&&... data) {
+            if (auto* view = load_view<ViewType>(file); view != nullptr) {
+                // Render the view based on the data that passed to us
+                view->render(out, stl::forward<DataType>(data)...);
+            }
+        }
+
+        /**
+         * Render the precompiled view if there's one with this name.
+         * Returns false if the view should be looked up in the view roots.
+         */
+        [[nodiscard]] bool
+        precompiled_to(string_type& out, stl::string_view const name, mustache_data_type const& data) {
+            auto const view = precompiled_views.find(name);
+            if (view == precompiled_views.end()) {
+                return false;
+            }
+            view->second(out, data);
+            return true;
         }
 
         template <typename ViewType, istl::StringViewifiable StrT, typename OutT, typename... DataType>
         constexpr void view_to(OutT& out, StrT&& file_request, DataType&&... data) {
+            if constexpr (stl::same_as<ViewType, mustache_view_type> && stl::same_as<OutT, string_type> &&
+                          sizeof...(DataType) == 1 &&
+                          (stl::same_as<stl::remove_cvref_t<DataType>, mustache_data_type> && ...))
+            {
+                if (precompiled_to(out, istl::to_std_string_view(file_request), data...)) {
+                    return;
+                }
+            }
             auto const file = find_file(istl::to_std_string_view(stl::forward<StrT>(file_request)));
             if (!file) {
                 this->logger.error(logging_category,
@@ -261,6 +221,25 @@ namespace webpp::views {
 
 
       public:
+        /// Check the view roots for the changed files at most once per this interval
+        void refresh_interval(stl::chrono::milliseconds const interval) noexcept {
+            view_files.refresh_interval = interval;
+        }
+
+        /**
+         * Register a template that is compiled on compile-time; the views with this name are rendered by it
+         * instead of being looked up in the view roots:
+         *   views.precompiled<static_mustache<embedded_scheme<"home.mustache">>>("home");
+         */
+        template <typename StaticView, istl::StringViewifiable StrT>
+        void precompiled(StrT&& name) {
+            static_assert(stl::same_as<typename StaticView::data_type, mustache_data_type>,
+                          "The precompiled view should use the same traits as the view manager.");
+            auto const name_view = istl::to_std_string_view(stl::forward<StrT>(name));
+            precompiled_views.insert_or_assign(string_type{name_view, get_alloc_for<string_type>(*this)},
+                                               &StaticView::render);
+        }
+
         /**
          * This is essentially the same as ".view" but it's specialized for a mustache file.
          */
@@ -271,6 +250,47 @@ namespace webpp::views {
             return out;
         }
 
+        /**
+         * Render the mustache view while the response is being sent; the view is rendered into the
+         * response body chunk by chunk (see http::chunked_body), so the page is never in memory as a whole.
+         * The view and the data are copied, they don't have to outlive the response.
+         * The precompiled views can't be paused, they're rendered as one chunk.
+         */
+        template <istl::StringViewifiable StrT>
+        [[nodiscard]] chunked_body_type
+        chunked_mustache(StrT&&             file_request,
+                         mustache_data_type data,
+                         stl::size_t const  chunk_size = chunked_body_type::default_chunk_size) {
+            auto const name = istl::to_std_string_view(file_request);
+            if (auto const precompiled_view = precompiled_views.find(name);
+                precompiled_view != precompiled_views.end())
+            {
+                auto producer = [render = precompiled_view->second,
+                                 data   = stl::move(data)](string_type& out, stl::size_t) {
+                    render(out, data);
+                    return false;
+                };
+                return chunked_body_type{*this, stl::move(producer), chunk_size};
+            }
+            auto const file = find_file(name);
+            if (!file) {
+                this->logger.error(logging_category,
+                                   fmt::format("We can't find the specified view {}.", file_request));
+                return chunked_body_type{*this};
+            }
+            auto const* view = load_view<mustache_view_type>(file.value());
+            if (view == nullptr) {
+                return chunked_body_type{*this};
+            }
+            using stream_type = mustache_stream<traits_type>;
+            auto stream =
+              stl::allocate_shared<stream_type>(get_allocator<stream_type>(*this), *view, stl::move(data));
+            auto producer = [stream = stl::move(stream)](string_type& out, stl::size_t const size) {
+                return stream->render(out, size);
+            };
+            return chunked_body_type{*this, stl::move(producer), chunk_size};
+        }
+
         template <istl::StringViewifiable StrT, typename... StrT2, typename... DataType>
         [[nodiscard]] constexpr auto mustache(StrT&& file_request, stl::pair<StrT2, DataType>... data) {
             return mustache<StrT>(stl::forward<StrT>(file_request),
@@ -305,8 +325,13 @@ namespace webpp::views {
             requires(PossibleDataTypes<mustache_view_type, stl::remove_cvref_t<DT>> ||
                      PossibleDataTypes<file_view_type, stl::remove_cvref_t<DT>>)
         [[nodiscard]] auto view(StrT&& file_request, DT&& data) {
+            auto out = object::make_object<string_type>(*this);
+            if constexpr (stl::same_as<stl::remove_cvref_t<DT>, mustache_data_type>) {
+                if (precompiled_to(out, istl::to_std_string_view(file_request), data)) {
+                    return out;
+                }
+            }
             auto const file = find_file(istl::to_std_string_view(stl::forward<StrT>(file_request)));
-            auto       out  = object::make_object<string_type>(*this);
             if (!file) {
                 this->logger.error(logging_category,
                                    fmt::format("We can't find the specified view {}.", file_request));